@@ -173,6 +173,9 @@ main() {
             ./rtl/friscv_alu.sv\
             ./rtl/friscv_processing.sv\
             ./rtl/friscv_memfy.sv\
+            ./rtl/friscv_store_buffer.sv\
+            ./rtl/friscv_tcm.sv\
+            ./rtl/friscv_addr_tracker.sv\
             ./rtl/friscv_registers.sv\
             ./rtl/friscv_m_ext.sv\
             ./rtl/friscv_csr.sv\
@@ -185,7 +188,9 @@ main() {
             ./rtl/friscv_cache_io_fetcher.sv\
             ./rtl/friscv_cache_ooo_mgt.sv\
             ./rtl/friscv_cache_pusher.sv\
+            ./rtl/friscv_cache_evict_buffer.sv\
             ./rtl/friscv_cache_blocks.sv\
+            ./rtl/friscv_cache_victim.sv\
             ./rtl/friscv_cache_memctrl.sv\
             ./rtl/friscv_axi_or_tracker.sv\
             --top-module friscv_rv32i_core 2> lint.log
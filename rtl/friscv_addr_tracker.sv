@@ -0,0 +1,120 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Address tracker of the outstanding requests of a direction, read or write
+//
+// - store the block address of the requests issued, released in-order by
+//   their completion, the requests using a single ID
+// - flag if a block is under access, to order a request of the other
+//   direction only against the requests to its block
+// - flag if a request is pending, an IO request being ordered against all
+//   the requests of the other direction
+//
+///////////////////////////////////////////////////////////////////////////////
+
+module friscv_addr_tracker
+
+    #(
+        // Maximum number of outstanding requests
+        parameter DEPTH = 8,
+        // Address bus width
+        parameter AXI_ADDR_W = 32,
+        // Width of the block an address is compared on
+        parameter BLOCK_W = 128
+    )(
+        input  wire                       aclk,
+        input  wire                       aresetn,
+        input  wire                       srst,
+        // Request issued
+        input  wire                       push,
+        input  wire  [AXI_ADDR_W    -1:0] push_addr,
+        output logic                      full,
+        // Request completed
+        input  wire                       pop,
+        // Block lookup
+        input  wire  [AXI_ADDR_W    -1:0] addr,
+        output logic                      match,
+        // Pending requests
+        output logic                      pending
+    );
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Parameters and variables declarations
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    localparam PTR_W = (DEPTH>1) ? $clog2(DEPTH) : 1;
+    localparam NB = 2**PTR_W;
+
+    // Lowest part of the address selecting a byte in a block
+    localparam BLOCK_LSB_W = $clog2(BLOCK_W/8);
+
+    logic [AXI_ADDR_W-BLOCK_LSB_W-1:0] blk [NB-1:0];
+    logic [NB                    -1:0] valid;
+    logic [NB                    -1:0] blk_match;
+
+    // Push and pop pointers, the MSB flagging a wrap
+    logic [PTR_W                   :0] wr_ptr;
+    logic [PTR_W                   :0] rd_ptr;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Requests storage
+    ///////////////////////////////////////////////////////////////////////////
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            wr_ptr <= '0;
+            rd_ptr <= '0;
+            valid <= '0;
+        end else if (srst) begin
+            wr_ptr <= '0;
+            rd_ptr <= '0;
+            valid <= '0;
+        end else begin
+
+            if (push)
+                wr_ptr <= wr_ptr + 1'b1;
+
+            if (pop && valid[rd_ptr[PTR_W-1:0]])
+                rd_ptr <= rd_ptr + 1'b1;
+
+            for (int i=0;i<NB;i=i+1) begin
+                if (push && wr_ptr[PTR_W-1:0]==i[PTR_W-1:0])
+                    valid[i] <= 1'b1;
+                else if (pop && rd_ptr[PTR_W-1:0]==i[PTR_W-1:0])
+                    valid[i] <= 1'b0;
+            end
+        end
+    end
+
+    always @ (posedge aclk) begin
+        if (push)
+            blk[wr_ptr[PTR_W-1:0]] <= push_addr[AXI_ADDR_W-1:BLOCK_LSB_W];
+    end
+
+    assign full = (wr_ptr ^ rd_ptr) == {1'b1, {PTR_W{1'b0}}};
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Lookup and status
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (genvar i=0;i<NB;i=i+1) begin: MATCH
+        assign blk_match[i] = valid[i] && blk[i]==addr[AXI_ADDR_W-1:BLOCK_LSB_W];
+    end
+
+    assign match = |blk_match;
+    assign pending = |valid;
+
+endmodule
+
+`resetall
@@ -67,6 +67,8 @@ module friscv_alu
     logic        [XLEN -1:0] _slli;
     logic        [XLEN -1:0] _srli;
     logic        [XLEN -1:0] _srai;
+    logic        [XLEN -1:0] _zext;
+    logic                    fused;
 
     ///////////////////////////////////////////////////////////////////////////
     //
@@ -82,6 +84,7 @@ module friscv_alu
     assign rd     = alu_instbus[`RD     +: `RD_W    ];
     assign imm12  = alu_instbus[`IMM12  +: `IMM12_W ];
     assign shamt  = alu_instbus[`SHAMT  +: `SHAMT_W ];
+    assign fused  = alu_instbus[`FUSED];
 
     assign alu_ready = 1'b1;
 
@@ -109,7 +112,8 @@ module friscv_alu
 
            alu_rd_addr <= rd;
 
-           alu_rd_val <= (opcode==`I_ARITH && funct3==`ADDI)                    ? _addi :
+           alu_rd_val <= (fused)                                                ? _zext :
+                         (opcode==`I_ARITH && funct3==`ADDI)                    ? _addi :
                          (opcode==`I_ARITH && funct3==`SLTI)                    ? _slti :
                          (opcode==`I_ARITH && funct3==`SLTIU)                   ? _sltiu :
                          (opcode==`I_ARITH && funct3==`XORI)                    ? _xori :
@@ -258,6 +262,9 @@ module friscv_alu
                    (shamt == 5'd31) ? {{31{alu_rs1_val[XLEN-1]}}, alu_rs1_val[XLEN-1:31]} :
                                       {alu_rs1_val[XLEN-1:0]} ;
 
+    // SLLI + SRLI fused pair, clearing the shamt upper bits
+    assign _zext = alu_rs1_val & ({XLEN{1'b1}} >> shamt);
+
     ///////////////////////////////////////////////////////////////////////////
     // R-type instructions
     ///////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,408 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+`include "friscv_h.sv"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Dynamic branch predictor, steering the instruction fetch of the control
+// unit before the branches are executed:
+//
+// - BHT: branch history table, a 2-bits saturating counter per entry
+//   indexed by the program counter, predicting a branch taken/not taken
+// - BTB: branch target buffer, direct-mapped, storing the target of the
+//   taken branches and JAL/JALR instructions. Jump entries are always taken.
+// - RAS: return address stack, pushed by the calls (JAL/JALR with rd=x1/x5)
+//   and popped by the returns (JALR with rs1=x1/x5) to predict the target
+//   of the returns, the BTB only storing the last one seen.
+//
+// The RAS is maintained twice: a speculative copy updated by the fetch stage
+// along the predictions and a copy updated by the execution stage. When the
+// fetch restarts, the speculative copy is restored from the executed one.
+//
+// Every fetch predicted taken is recorded into a FIFO along the fetch
+// address and the target, in the same order the instructions will be
+// executed. When the control unit executes the instruction, the FIFO head
+// gives back the next program counter the fetch stage selected, to be
+// compared against the real one. The FIFO is flushed each time the control
+// unit restarts a new fetch batch (new AXI ID), the outstanding predictions
+// being discarded along the instructions.
+//
+// With the compressed extension, the fetch addresses are word-aligned and a
+// word can hold two instructions, or the end of a 32 bits one. The tables
+// are indexed with the address of the last halfword of the instructions,
+// the BTB recording in which halfword the jump ends so the fetch stage
+// drops the instructions following it in the word. A prediction for the
+// lower halfword is ignored when the fetch enters the word at its upper one.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+module friscv_bpred
+
+    #(
+        // Architecture selection
+        parameter XLEN = 32,
+        // Number of entries in the branch history table, power of two
+        parameter BHT_DEPTH = 64,
+        // Number of entries in the branch target buffer, power of two
+        parameter BTB_DEPTH = 16,
+        // Number of entries in the return address stack, power of two,
+        // 0 to disable it
+        parameter RAS_DEPTH = 4,
+        // Number of taken predictions in-flight, between fetch and execute
+        parameter PRED_OSTD_NUM = 4,
+        // Compressed extension support
+        parameter C_EXTENSION = 0
+    )(
+        // clock & reset
+        input  wire                       aclk,
+        input  wire                       aresetn,
+        input  wire                       srst,
+        // Invalidate all the predictions (FENCE.i)
+        input  wire                       flush_tables,
+        // Drop the in-flight predictions, a new fetch batch starts
+        input  wire                       flush_preds,
+        // Fetch stage lookup
+        input  wire                       fetch_en,
+        input  wire  [XLEN          -1:0] fetch_addr,
+        input  wire                       fetch_half,
+        output logic                      pred_taken,
+        output logic [XLEN          -1:0] pred_target,
+        output logic                      pred_half,
+        // Execution stage, resolving the prediction and updating the tables
+        input  wire                       exec_en,
+        input  wire  [XLEN          -1:0] exec_pc,
+        input  wire                       exec_rvc,
+        input  wire                       exec_branch,
+        input  wire                       exec_jump,
+        input  wire                       exec_call,
+        input  wire                       exec_ret,
+        input  wire                       exec_taken,
+        input  wire  [XLEN          -1:0] exec_target,
+        output logic [XLEN          -1:0] exec_pred_pc,
+        // Performance events
+        output logic                      pred_hit,
+        output logic                      pred_miss
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Parameters and variables declaration
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    localparam BHT_W = $clog2(BHT_DEPTH);
+    localparam BTB_W = $clog2(BTB_DEPTH);
+    localparam TAG_W = XLEN - 2 - BTB_W;
+    localparam RAS_W = (RAS_DEPTH>1) ? $clog2(RAS_DEPTH) : 1;
+
+    // 2-bits counters, starting weakly not-taken
+    localparam [1:0] WEAK_NT = 2'b01;
+
+    logic [2            -1:0] bht [BHT_DEPTH-1:0];
+    logic [BTB_DEPTH    -1:0] btb_valid;
+    logic [BTB_DEPTH    -1:0] btb_jump;
+    logic [BTB_DEPTH    -1:0] btb_call;
+    logic [BTB_DEPTH    -1:0] btb_ret;
+    logic [BTB_DEPTH    -1:0] btb_half;
+    logic [TAG_W        -1:0] btb_tag [BTB_DEPTH-1:0];
+    logic [XLEN         -1:0] btb_target [BTB_DEPTH-1:0];
+
+    logic [BHT_W        -1:0] fetch_bht_ix;
+    logic [BTB_W        -1:0] fetch_btb_ix;
+    logic                     fetch_btb_hit;
+    logic                     fetch_call;
+    logic                     fetch_ret;
+    logic [XLEN         -1:0] fetch_end;
+
+    logic                     ras_valid;
+    logic [XLEN         -1:0] ras_target;
+
+    logic [BHT_W        -1:0] exec_bht_ix;
+    logic [BTB_W        -1:0] exec_btb_ix;
+    logic [XLEN         -1:0] exec_end;
+    logic [XLEN         -1:0] exec_next;
+    logic                     exec_ctrl;
+
+    logic                     push_pred;
+    logic                     pull_pred;
+    logic                     preds_full;
+    logic                     preds_empty;
+    logic                     head_match;
+    logic [XLEN         -1:0] head_pc;
+    logic [XLEN         -1:0] head_target;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Fetch stage: predict the next address to fetch
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign fetch_bht_ix = fetch_addr[2+:BHT_W];
+    assign fetch_btb_ix = fetch_addr[2+:BTB_W];
+
+    assign fetch_btb_hit = btb_valid[fetch_btb_ix] &&
+                           btb_tag[fetch_btb_ix] == fetch_addr[2+BTB_W+:TAG_W];
+
+    assign fetch_call = fetch_btb_hit & btb_call[fetch_btb_ix];
+    assign fetch_ret = fetch_btb_hit & btb_ret[fetch_btb_ix];
+
+    // Can't predict if no more room to track the prediction, nor if the
+    // predicted instruction is in the lower halfword while the fetch
+    // enters the word at its upper halfword (jump target)
+    assign pred_taken = fetch_btb_hit && !preds_full &&
+                        !(fetch_half && !btb_half[fetch_btb_ix]) &&
+                        (btb_jump[fetch_btb_ix] || bht[fetch_bht_ix][1]);
+
+    // Returns jump to the top of the stack, else to the last target seen
+    assign pred_target = (fetch_ret && ras_valid) ? ras_target :
+                                                    btb_target[fetch_btb_ix];
+
+    assign pred_half = btb_half[fetch_btb_ix];
+
+    // Address of the last halfword of the predicted instruction
+    assign fetch_end = (C_EXTENSION) ? {fetch_addr[XLEN-1:2], pred_half, 1'b0} :
+                                       fetch_addr;
+
+    assign push_pred = fetch_en & pred_taken & !flush_preds;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // In-flight predictions, following the instructions' order
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    friscv_scfifo
+    #(
+        .PASS_THRU  (0),
+        .ADDR_WIDTH ($clog2(PRED_OSTD_NUM)),
+        .DATA_WIDTH (2*XLEN)
+    )
+    preds_fifo
+    (
+        .aclk     (aclk),
+        .aresetn  (aresetn),
+        .srst     (srst),
+        .flush    (flush_preds),
+        .data_in  ({pred_target, fetch_end}),
+        .push     (push_pred),
+        .full     (preds_full),
+        .afull    (),
+        .data_out ({head_target, head_pc}),
+        .pull     (pull_pred),
+        .empty    (preds_empty),
+        .aempty   ()
+    );
+
+    // Address of the last halfword of the executed instruction
+    assign exec_end = (C_EXTENSION && !exec_rvc) ? exec_pc + 2 : exec_pc;
+
+    assign exec_next = (exec_rvc) ? exec_pc + 2 : exec_pc + 4;
+
+    // The instruction to execute has been predicted taken when fetched
+    assign head_match = !preds_empty && head_pc == exec_end;
+
+    assign pull_pred = exec_en & head_match;
+
+    assign exec_pred_pc = (head_match) ? head_target : exec_next;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Execution stage: update the tables with the branch resolution
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign exec_bht_ix = exec_end[2+:BHT_W];
+    assign exec_btb_ix = exec_end[2+:BTB_W];
+    assign exec_ctrl = exec_en & (exec_branch | exec_jump);
+
+    always @ (posedge aclk or negedge aresetn) begin
+        if (!aresetn) begin
+            for (int i=0;i<BHT_DEPTH;i=i+1)
+                bht[i] <= WEAK_NT;
+        end else if (srst || flush_tables) begin
+            for (int i=0;i<BHT_DEPTH;i=i+1)
+                bht[i] <= WEAK_NT;
+        end else begin
+            if (exec_en && exec_branch) begin
+                if (exec_taken && bht[exec_bht_ix]!=2'b11)
+                    bht[exec_bht_ix] <= bht[exec_bht_ix] + 1'b1;
+                else if (!exec_taken && bht[exec_bht_ix]!=2'b00)
+                    bht[exec_bht_ix] <= bht[exec_bht_ix] - 1'b1;
+            end
+        end
+    end
+
+    always @ (posedge aclk or negedge aresetn) begin
+        if (!aresetn) begin
+            btb_valid <= '0;
+            btb_jump <= '0;
+            btb_call <= '0;
+            btb_ret <= '0;
+            btb_half <= '0;
+            for (int i=0;i<BTB_DEPTH;i=i+1) begin
+                btb_tag[i] <= '0;
+                btb_target[i] <= '0;
+            end
+        end else if (srst || flush_tables) begin
+            btb_valid <= '0;
+            btb_jump <= '0;
+            btb_call <= '0;
+            btb_ret <= '0;
+            btb_half <= '0;
+            for (int i=0;i<BTB_DEPTH;i=i+1) begin
+                btb_tag[i] <= '0;
+                btb_target[i] <= '0;
+            end
+        end else begin
+            // Only the taken branches allocate an entry, the BHT then
+            // decides the direction
+            if (exec_ctrl && exec_taken) begin
+                btb_valid[exec_btb_ix] <= 1'b1;
+                btb_jump[exec_btb_ix] <= exec_jump;
+                btb_call[exec_btb_ix] <= exec_call;
+                btb_ret[exec_btb_ix] <= exec_ret;
+                btb_half[exec_btb_ix] <= exec_end[1];
+                btb_tag[exec_btb_ix] <= exec_end[2+BTB_W+:TAG_W];
+                btb_target[exec_btb_ix] <= exec_target;
+            end
+        end
+    end
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Return address stack, circular to drop the oldest entries on overflow
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (RAS_DEPTH>0) begin: RAS
+
+        // Executed stack
+        logic [XLEN     -1:0] exe_ras [RAS_DEPTH-1:0];
+        logic [RAS_W    -1:0] exe_tos;
+        logic [RAS_W      :0] exe_cnt;
+        logic [RAS_W    -1:0] exe_tos_nxt;
+        logic [RAS_W      :0] exe_cnt_nxt;
+        logic                 exe_push;
+        logic                 exe_pop;
+        // Speculative stack
+        logic [XLEN     -1:0] spec_ras [RAS_DEPTH-1:0];
+        logic [RAS_W    -1:0] spec_tos;
+        logic [RAS_W      :0] spec_cnt;
+        logic [RAS_W    -1:0] spec_tos_nxt;
+        logic [RAS_W      :0] spec_cnt_nxt;
+        logic                 spec_push;
+        logic                 spec_pop;
+
+        assign exe_push = exec_en & exec_call;
+        assign exe_pop = exec_en & exec_ret;
+
+        assign spec_push = push_pred & fetch_call;
+        assign spec_pop = push_pred & fetch_ret;
+
+        // A pop followed by a push (coroutine) overwrites the top of stack
+        always @ (*) begin
+            exe_tos_nxt = exe_tos;
+            exe_cnt_nxt = exe_cnt;
+            if (exe_push && !exe_pop) begin
+                exe_tos_nxt = exe_tos + 1'b1;
+                if (exe_cnt!=RAS_DEPTH) exe_cnt_nxt = exe_cnt + 1'b1;
+            end else if (exe_pop && !exe_push) begin
+                exe_tos_nxt = exe_tos - 1'b1;
+                if (exe_cnt!=0) exe_cnt_nxt = exe_cnt - 1'b1;
+            end else if (exe_pop && exe_push) begin
+                if (exe_cnt==0) exe_cnt_nxt = 1;
+            end
+        end
+
+        always @ (*) begin
+            spec_tos_nxt = spec_tos;
+            spec_cnt_nxt = spec_cnt;
+            if (spec_push && !spec_pop) begin
+                spec_tos_nxt = spec_tos + 1'b1;
+                if (spec_cnt!=RAS_DEPTH) spec_cnt_nxt = spec_cnt + 1'b1;
+            end else if (spec_pop && !spec_push) begin
+                spec_tos_nxt = spec_tos - 1'b1;
+                if (spec_cnt!=0) spec_cnt_nxt = spec_cnt - 1'b1;
+            end else if (spec_pop && spec_push) begin
+                if (spec_cnt==0) spec_cnt_nxt = 1;
+            end
+        end
+
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                exe_tos <= '0;
+                exe_cnt <= '0;
+                for (int i=0;i<RAS_DEPTH;i=i+1)
+                    exe_ras[i] <= '0;
+            end else if (srst || flush_tables) begin
+                exe_tos <= '0;
+                exe_cnt <= '0;
+                for (int i=0;i<RAS_DEPTH;i=i+1)
+                    exe_ras[i] <= '0;
+            end else begin
+                exe_tos <= exe_tos_nxt;
+                exe_cnt <= exe_cnt_nxt;
+                if (exe_push)
+                    exe_ras[exe_tos_nxt] <= exec_next;
+            end
+        end
+
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                spec_tos <= '0;
+                spec_cnt <= '0;
+                for (int i=0;i<RAS_DEPTH;i=i+1)
+                    spec_ras[i] <= '0;
+            end else if (srst || flush_tables) begin
+                spec_tos <= '0;
+                spec_cnt <= '0;
+                for (int i=0;i<RAS_DEPTH;i=i+1)
+                    spec_ras[i] <= '0;
+            // The fetch restarts from the executed instruction, the
+            // speculative pushes/pops are dropped
+            end else if (flush_preds) begin
+                spec_tos <= exe_tos_nxt;
+                spec_cnt <= exe_cnt_nxt;
+                for (int i=0;i<RAS_DEPTH;i=i+1)
+                    spec_ras[i] <= (exe_push && exe_tos_nxt==i) ? exec_next :
+                                                                  exe_ras[i];
+            end else begin
+                spec_tos <= spec_tos_nxt;
+                spec_cnt <= spec_cnt_nxt;
+                if (spec_push)
+                    spec_ras[spec_tos_nxt] <= (C_EXTENSION) ? fetch_end + 2 :
+                                                              fetch_addr + 4;
+            end
+        end
+
+        assign ras_valid = (spec_cnt!=0);
+        assign ras_target = spec_ras[spec_tos];
+
+    end else begin: NO_RAS
+
+        assign ras_valid = 1'b0;
+        assign ras_target = {XLEN{1'b0}};
+
+    end
+    endgenerate
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Performance events
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign pred_hit = exec_ctrl && exec_target == exec_pred_pc;
+    assign pred_miss = exec_ctrl && exec_target != exec_pred_pc;
+
+endmodule
+
+`resetall
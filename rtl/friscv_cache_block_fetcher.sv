@@ -10,6 +10,14 @@
 // Fetcher stage: manages the read request in the cache or issue
 // a read request in central memory
 //
+// Without MSHR, a miss blocks the following requests until the block is
+// written in the cache and the missing request replayed, or completed with
+// the block written if early restart is enabled. With MSHRs, the
+// missing requests are parked in the miss status holding registers, the
+// fetcher serving the next requests meanwhile. A single memory read is
+// issued per missing block, the parked requests being replayed once the
+// block is written in the cache. The requests complete out-of-order.
+//
 ///////////////////////////////////////////////////////////////////////////
 
 
@@ -30,6 +38,15 @@ module friscv_cache_block_fetcher
         parameter OSTDREQ_NUM = 4,
         // Read data channel doesn't assert back-pressure, can drive completion directly
         parameter NO_CPL_BACKPRESSURE = 0,
+        // Number of miss status holding registers, 0 blocks on a miss. Imply
+        // NO_CPL_BACKPRESSURE = 1 and an out-of-order completion manager
+        parameter MSHR_NUM = 0,
+        // ID of the block read of the first MSHR, the next ones being XORed
+        // with the MSHR index
+        parameter MSHR_ID = 'h10,
+        // Complete a missing request with the block written in the cache,
+        // without replaying it (MSHR_NUM = 0 only)
+        parameter EARLY_RESTART = 0,
 
         ///////////////////////////////////////////////////////////////////////
         // Interface Setup
@@ -69,8 +86,19 @@ module friscv_cache_block_fetcher
         output logic [3             -1:0] cache_rprot,
         input  wire  [ILEN          -1:0] cache_rdata,
         input  wire                       block_fill,
+        input  wire                       block_word,
         input  wire                       cache_hit,
-        input  wire                       cache_miss
+        input  wire                       cache_miss,
+        // Block written in the cache, from the memory controller
+        input  wire  [AXI_ADDR_W    -1:0] block_addr,
+        input  wire  [AXI_ID_W      -1:0] block_rid,
+        input  wire  [AXI_DATA_W    -1:0] block_data,
+        // Block read issued by the MSHRs
+        output logic                      miss_arvalid,
+        input  wire                       miss_arready,
+        output logic [AXI_ADDR_W    -1:0] miss_araddr,
+        output logic [3             -1:0] miss_arprot,
+        output logic [AXI_ID_W      -1:0] miss_arid
     );
 
     ///////////////////////////////////////////////////////////////////////////
@@ -78,8 +106,10 @@ module friscv_cache_block_fetcher
     ///////////////////////////////////////////////////////////////////////////
 
     // Lowest part of the address replaced by 0 to access a complete cache block
-    // (AXI_DATA_W = CACHE_BLOCK_W is the only setup supported)
+    // (AXI_DATA_W is the block width completed by the memory controller)
     localparam ADDR_LSB_W = $clog2(AXI_DATA_W/8);
+    // Lowest part of the address selecting a word in a block
+    localparam WORD_LSB_W = $clog2(ILEN/8);
 
     // Control fsm, the sequencer driving the cache read and the memory controller
     typedef enum logic[1:0] {
@@ -161,6 +191,11 @@ module friscv_cache_block_fetcher
         .aempty   ()
     );
 
+    assign arvalid = !rac_empty;
+
+    generate
+    if (MSHR_NUM == 0) begin: BLOCKING
+
     // FFD stage to propagate potential addr/id to fetch
     // later in cache miss
     always @ (posedge aclk or negedge aresetn) begin
@@ -176,8 +211,56 @@ module friscv_cache_block_fetcher
         end
     end
 
+    ///////////////////////////////////////////////////////////////////////////
+    // Early restart: the missing request completes with the block written in
+    // the cache, its word being extracted from the memory completion. The
+    // lookup replayed meanwhile is dropped.
+    //
+    // If the block is read with a burst starting on the word missing
+    // (critical word first), the request completes with the beat holding its
+    // word, flagged by block_word, the next requests missing the block still
+    // in flight restarting once it is written.
+    ///////////////////////////////////////////////////////////////////////////
+
+    logic                     restart;
+    logic                     restart_r;
+    logic [ILEN         -1:0] restart_data;
+    logic                     blk_hit;
+    logic                     blk_miss;
+
+    if (EARLY_RESTART) begin: EARLY_RESTART_ON
+
+        assign restart = fetching && !flush &&
+                         (block_word &&
+                          block_addr[AXI_ADDR_W-1:WORD_LSB_W]==araddr_ffd[AXI_ADDR_W-1:WORD_LSB_W] ||
+                          block_fill &&
+                          block_addr[AXI_ADDR_W-1:ADDR_LSB_W]==araddr_ffd[AXI_ADDR_W-1:ADDR_LSB_W]);
+
+        assign restart_data = block_data[araddr_ffd[ADDR_LSB_W-1:WORD_LSB_W]*ILEN+:ILEN];
+
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                restart_r <= 1'b0;
+            end else if (srst) begin
+                restart_r <= 1'b0;
+            end else begin
+                restart_r <= restart;
+            end
+        end
+
+    end else begin: EARLY_RESTART_OFF
+
+        assign restart = 1'b0;
+        assign restart_r = 1'b0;
+        assign restart_data = {ILEN{1'b0}};
+
+    end
+
+    assign blk_hit = cache_hit & !restart_r;
+    assign blk_miss = cache_miss & !restart_r;
+
     // Multiplexer stage to drive missed-fetch or to-fetch requests to the blocks
-    assign sel_mf = (fetching || cache_miss) && !flush && !cache_hit;
+    assign sel_mf = (fetching || blk_miss) && !flush && !blk_hit;
 
     // Cache read interface
     assign cache_ren = arvalid & arready | sel_mf | (flush & arvalid);
@@ -186,12 +269,11 @@ module friscv_cache_block_fetcher
     assign cache_rid =   sel_mf ? arid_ffd   : arid;
     assign cache_rprot = sel_mf ? arprot_ffd : arprot;
 
-    assign pull_rac = (!(cache_miss & !flush) & !(fetching & !cache_hit) |
-                      ((!cache_hit & !cache_miss) & flush)) &
+    assign pull_rac = (!(blk_miss & !flush) & !(fetching & !blk_hit) |
+                      ((!blk_hit & !blk_miss) & flush)) &
                       !((rdc_full | rdc_afull) & !flush);
 
     assign arready = pull_rac;
-    assign arvalid = !rac_empty;
 
 
     ///////////////////////////////////////////////////////////////////////////
@@ -200,19 +282,24 @@ module friscv_cache_block_fetcher
 
     always @ (posedge aclk) begin
         `ifdef TRACE_CACHE
-        if (cache_hit) begin
+        if (restart) begin
+            $fwrite(f, "@ %0t: Early restart\n", $realtime);
+            $fwrite(f, "  - addr 0x%x\n", araddr_ffd);
+            $fwrite(f, "  - data 0x%x\n", restart_data);
+        end
+        if (blk_hit) begin
             $fwrite(f, "@ %0t: Cache hit\n", $realtime);
             $fwrite(f, "  - addr 0x%x\n", araddr_ffd);
             $fwrite(f, "  - data 0x%x\n", cache_rdata);
         end
-        if (cache_miss) begin
+        if (blk_miss) begin
             $fwrite(f, "@ %0t: Cache miss\n", $realtime);
             $fwrite(f, "  - addr 0x%x\n", araddr_ffd);
         end
         `endif
     end
 
-    generate if (NO_CPL_BACKPRESSURE == 0) begin
+    if (NO_CPL_BACKPRESSURE == 0) begin: CPL_FIFO
 
     friscv_scfifo
     #(
@@ -226,7 +313,7 @@ module friscv_cache_block_fetcher
         .aresetn  (aresetn),
         .srst     (srst),
         .flush    (flush),
-        .data_in  ({arid_ffd, cache_rdata}),
+        .data_in  ({arid_ffd, (restart) ? restart_data : cache_rdata}),
         .push     (push_rdc),
         .full     (rdc_full),
         .afull    (rdc_afull),
@@ -236,7 +323,7 @@ module friscv_cache_block_fetcher
         .aempty   ()
     );
 
-    assign push_rdc = cache_hit & !flush;
+    assign push_rdc = blk_hit & !flush | restart;
     assign pull_rdc = mst_rready;
     assign mst_rvalid = !rdc_empty;
     assign mst_rresp = 2'b0;
@@ -244,10 +331,10 @@ module friscv_cache_block_fetcher
     // read data channel will always be sinked by the requester, being always ready
     end else begin
 
-    assign mst_rvalid = cache_hit & !flush;
+    assign mst_rvalid = blk_hit & !flush | restart;
     assign mst_rresp = 2'b0;
     assign mst_rid = arid_ffd; 
-    assign mst_rdata = cache_rdata;
+    assign mst_rdata = (restart) ? restart_data : cache_rdata;
     
     assign push_rdc = '0;
     assign pull_rdc = '0;
@@ -256,7 +343,6 @@ module friscv_cache_block_fetcher
     assign rdc_empty = 0;
 
     end
-    endgenerate
 
     ///////////////////////////////////////////////////////////////////////////
     // Sequencer to switch between cache load and cache fetch
@@ -280,7 +366,7 @@ module friscv_cache_block_fetcher
 
                 // Wait for the address requests from the instruction fetcher
                 default: begin
-                    if (cache_miss && !flush && loader_prev == IDLE) begin
+                    if (blk_miss && !flush && loader_prev == IDLE) begin
                         loader <= LOAD;
                     end
                 end
@@ -289,9 +375,11 @@ module friscv_cache_block_fetcher
                 LOAD: begin
                     // Go to read the cache lines once the memory controller
                     // wrote a new cache line, being the read completion
-                    if (block_fill) begin
+                    if (restart) begin
+                        loader <= IDLE;
+                    end else if (block_fill) begin
                         loader <= FETCH;
-                    end else if (cache_hit) begin
+                    end else if (blk_hit) begin
                         loader <= IDLE;
                     end
                 end 
@@ -306,6 +394,256 @@ module friscv_cache_block_fetcher
         end
     end
 
+    // No block read issued apart the prefetcher one
+    assign miss_arvalid = 1'b0;
+    assign miss_araddr = {AXI_ADDR_W{1'b0}};
+    assign miss_arprot = 3'b0;
+    assign miss_arid = {AXI_ID_W{1'b0}};
+
+    end else begin: NON_BLOCKING
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Miss status holding registers
+    //
+    // An entry is allocated when a new request misses the cache and released
+    // once replayed and hit, and once its block read, issued with the entry's
+    // ID, is completed. An entry is:
+    //
+    //   - req: parking a request missing the cache
+    //   - rdy: the block has been written, the request needs to be replayed
+    //   - issue: the block read needs to be issued to the memory controller
+    //   - ostd: the block read is outstanding
+    //
+    // A request missing a block already read by another entry or written in
+    // the cache while looked up doesn't issue a new read. The replays are
+    // served first, then a new request is looked up if an entry can be
+    // allocated for it. The flush controls are unused, the MSHRs being used
+    // by the data cache only.
+    ///////////////////////////////////////////////////////////////////////////
+
+    localparam MSHR_W = (MSHR_NUM>1) ? $clog2(MSHR_NUM) : 1;
+
+    logic [MSHR_NUM     -1:0] req;
+    logic [MSHR_NUM     -1:0] rdy;
+    logic [MSHR_NUM     -1:0] issue;
+    logic [MSHR_NUM     -1:0] ostd;
+    logic [AXI_ADDR_W   -1:0] mshr_addr [MSHR_NUM-1:0];
+    logic [AXI_ID_W     -1:0] mshr_id [MSHR_NUM-1:0];
+    logic [3            -1:0] mshr_prot [MSHR_NUM-1:0];
+
+    logic [MSHR_NUM     -1:0] free;
+    logic [MSHR_NUM     -1:0] fill_match;
+    logic [MSHR_NUM     -1:0] pending;
+    logic [MSHR_W         :0] free_nb;
+    logic [MSHR_W       -1:0] alloc_ix;
+    logic [MSHR_W       -1:0] replay_ix;
+    logic [MSHR_W       -1:0] issue_ix;
+    logic [MSHR_W       -1:0] lkp_res_ix;
+    logic                     replay;
+    logic                     can_alloc;
+
+    // Lookup stage, the hit/miss status being received on next cycle
+    logic                     lkp_valid;
+    logic                     lkp_replay;
+    logic [MSHR_W       -1:0] lkp_ix;
+    logic [AXI_ADDR_W   -1:0] lkp_addr;
+    logic [AXI_ID_W     -1:0] lkp_id;
+    logic [3            -1:0] lkp_prot;
+    logic                     lkp_fill;
+    logic                     lkp_pending;
+
+    // Block written on previous cycle, not yet visible by the lookup
+    logic                     fill_r;
+    logic [AXI_ADDR_W   -1:0] fill_addr_r;
+
+    function automatic logic same_block(
+        input logic [AXI_ADDR_W-1:0] addr_a,
+        input logic [AXI_ADDR_W-1:0] addr_b
+    );
+        same_block = addr_a[AXI_ADDR_W-1:ADDR_LSB_W]==addr_b[AXI_ADDR_W-1:ADDR_LSB_W];
+    endfunction
+
+    always @ (*) begin
+
+        free_nb = '0;
+        alloc_ix = '0;
+        replay_ix = '0;
+        issue_ix = '0;
+
+        for (int i=MSHR_NUM-1;i>=0;i=i-1) begin
+            if (free[i]) alloc_ix = i[MSHR_W-1:0];
+            if (req[i] && rdy[i]) replay_ix = i[MSHR_W-1:0];
+            if (issue[i] && !fill_match[i]) issue_ix = i[MSHR_W-1:0];
+        end
+
+        for (int i=0;i<MSHR_NUM;i=i+1)
+            free_nb = free_nb + free[i];
+    end
+
+    for (genvar i=0;i<MSHR_NUM;i=i+1) begin: MSHR_STATUS
+        assign free[i] = !req[i] && !issue[i] && !ostd[i];
+        assign fill_match[i] = block_fill && same_block(block_addr, mshr_addr[i]);
+        assign pending[i] = (issue[i] || ostd[i]) && same_block(lkp_addr, mshr_addr[i]);
+    end
+
+    assign replay = |(req & rdy);
+
+    // A new request under lookup will take an entry if missing
+    assign can_alloc = free_nb > ((lkp_valid && !lkp_replay) ? 1 : 0);
+
+    assign arready = !replay && can_alloc;
+    assign pull_rac = arvalid && arready;
+
+    assign cache_ren = replay || pull_rac;
+    assign cache_raddr = (replay) ? mshr_addr[replay_ix] : araddr;
+    assign cache_rid = (replay) ? mshr_id[replay_ix] : arid;
+    assign cache_rprot = (replay) ? mshr_prot[replay_ix] : arprot;
+
+    // The block of the request looked up is being written or already read
+    assign lkp_fill = block_fill && same_block(block_addr, lkp_addr) ||
+                      fill_r && same_block(fill_addr_r, lkp_addr);
+    assign lkp_pending = |pending;
+
+    assign lkp_res_ix = (lkp_replay) ? lkp_ix : alloc_ix;
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            lkp_valid <= 1'b0;
+            lkp_replay <= 1'b0;
+            lkp_ix <= '0;
+            lkp_addr <= '0;
+            lkp_id <= '0;
+            lkp_prot <= '0;
+            fill_r <= 1'b0;
+            fill_addr_r <= '0;
+            req <= '0;
+            rdy <= '0;
+            issue <= '0;
+            ostd <= '0;
+            miss_arvalid <= 1'b0;
+            miss_araddr <= '0;
+            miss_arprot <= '0;
+            miss_arid <= '0;
+            for (int i=0;i<MSHR_NUM;i=i+1) begin
+                mshr_addr[i] <= '0;
+                mshr_id[i] <= '0;
+                mshr_prot[i] <= '0;
+            end
+        end else if (srst) begin
+            lkp_valid <= 1'b0;
+            lkp_replay <= 1'b0;
+            lkp_ix <= '0;
+            lkp_addr <= '0;
+            lkp_id <= '0;
+            lkp_prot <= '0;
+            fill_r <= 1'b0;
+            fill_addr_r <= '0;
+            req <= '0;
+            rdy <= '0;
+            issue <= '0;
+            ostd <= '0;
+            miss_arvalid <= 1'b0;
+            miss_araddr <= '0;
+            miss_arprot <= '0;
+            miss_arid <= '0;
+            for (int i=0;i<MSHR_NUM;i=i+1) begin
+                mshr_addr[i] <= '0;
+                mshr_id[i] <= '0;
+                mshr_prot[i] <= '0;
+            end
+        end else begin
+
+            lkp_valid <= cache_ren;
+            lkp_replay <= replay;
+            lkp_ix <= replay_ix;
+            lkp_addr <= cache_raddr;
+            lkp_id <= cache_rid;
+            lkp_prot <= cache_rprot;
+
+            fill_r <= block_fill;
+            fill_addr_r <= block_addr;
+
+            for (int i=0;i<MSHR_NUM;i=i+1) begin
+
+                // Block read of the entry completed
+                if (block_fill && block_rid==(MSHR_ID ^ i))
+                    ostd[i] <= 1'b0;
+
+                // Block written in the cache, replay the parked request
+                if (fill_match[i]) begin
+                    issue[i] <= 1'b0;
+                    if (req[i]) rdy[i] <= 1'b1;
+                end
+            end
+
+            // Issue the block reads, one after the other
+            if (!miss_arvalid || miss_arready) begin
+                if (|(issue & ~fill_match)) begin
+                    `ifdef TRACE_CACHE
+                    $fwrite(f, "@ %0t: MSHR %0d reads 0x%x\n", $realtime, issue_ix, mshr_addr[issue_ix]);
+                    `endif
+                    miss_arvalid <= 1'b1;
+                    miss_araddr <= {mshr_addr[issue_ix][AXI_ADDR_W-1:ADDR_LSB_W], {ADDR_LSB_W{1'b0}}};
+                    miss_arprot <= mshr_prot[issue_ix];
+                    miss_arid <= MSHR_ID ^ issue_ix;
+                    issue[issue_ix] <= 1'b0;
+                    ostd[issue_ix] <= 1'b1;
+                end else begin
+                    miss_arvalid <= 1'b0;
+                end
+            end
+
+            if (replay)
+                rdy[replay_ix] <= 1'b0;
+
+            // Lookup status: a replay hitting releases the request, a new
+            // request missing takes a free entry
+            if (lkp_valid && cache_hit && lkp_replay) begin
+                req[lkp_ix] <= 1'b0;
+                rdy[lkp_ix] <= 1'b0;
+            end else if (lkp_valid && cache_miss) begin
+
+                `ifdef TRACE_CACHE
+                $fwrite(f, "@ %0t: MSHR %0d parks 0x%x\n", $realtime, lkp_res_ix, lkp_addr);
+                `endif
+
+                if (!lkp_replay) begin
+                    req[lkp_res_ix] <= 1'b1;
+                    mshr_addr[lkp_res_ix] <= lkp_addr;
+                    mshr_id[lkp_res_ix] <= lkp_id;
+                    mshr_prot[lkp_res_ix] <= lkp_prot;
+                end
+
+                if (lkp_fill) begin
+                    rdy[lkp_res_ix] <= 1'b1;
+                    issue[lkp_res_ix] <= 1'b0;
+                end else if (lkp_pending) begin
+                    rdy[lkp_res_ix] <= 1'b0;
+                    issue[lkp_res_ix] <= 1'b0;
+                end else begin
+                    rdy[lkp_res_ix] <= 1'b0;
+                    issue[lkp_res_ix] <= 1'b1;
+                end
+            end
+        end
+    end
+
+    // Hits complete directly, out-of-order
+    assign mst_rvalid = lkp_valid & cache_hit;
+    assign mst_rresp = 2'b0;
+    assign mst_rid = lkp_id;
+    assign mst_rdata = cache_rdata;
+
+    assign push_rdc = 1'b0;
+    assign pull_rdc = 1'b0;
+    assign rdc_full = 1'b0;
+    assign rdc_afull = 1'b0;
+    assign rdc_empty = 1'b0;
+
+    end
+    endgenerate
+
 endmodule
 
 `resetall
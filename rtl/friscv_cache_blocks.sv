@@ -9,11 +9,18 @@
 // Instruction cache blocks
 //
 // - classic RAM interface (wr/rd, addr, data)
-// - direct-mapped (1-way) cache
+// - direct-mapped (1-way) or N-way set-associative cache, the ways being
+//   replaced with a tree pseudo-LRU policy
 // - hit/miss flags to indicate cache status on read operation
 // - format the cache line (block) fetched from the memory before storage
 // - extract the requested instruction and manage hit/miss flags
 // - manage multipe R/W ports but only exclusive access are supported
+// - optional write-back support: a dirty bit per block, set by port 2, and
+//   an eviction interface driving the dirty blocks replaced or cleaned
+// - optional victim cache storing the last blocks replaced, serving port 1
+//   reads missing the blocks
+// - an epoch stored along the tags, a block being valid only if written in
+//   the current epoch. Moving to the next epoch invalidates all the blocks
 //
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -28,13 +35,26 @@ module friscv_cache_blocks
         parameter ADDR_W = 32,
         // Line width defining only the data payload, in bits
         parameter CACHE_BLOCK_W = 128,
-        // Number of blocks in the cache
-        parameter CACHE_DEPTH = 512
+        // Number of blocks in the cache, shared across the ways
+        parameter CACHE_DEPTH = 512,
+        // Number of ways, 1 (direct-mapped) or a power of two
+        parameter CACHE_WAYS = 1,
+        // Track the blocks modified by port 2 to write them back on eviction
+        parameter WRITE_BACK = 0,
+        // Number of entries of the victim cache, 0 disables it
+        parameter VICTIM_NB = 0,
+        // Width of the epoch stored along the tags
+        parameter EPOCH_W = 2
     )(
         input  wire                           aclk,
         input  wire                           aresetn,
         input  wire                           srst,
         input  wire                           flush,
+        // Current epoch, the blocks of the other epochs being invalid
+        input  wire  [EPOCH_W           -1:0] epoch,
+        // Clean the block selected by the write index and the tag's LSBs
+        // (the way), along a port 1 write
+        input  wire                           clean,
         input  wire                           p1_wen,
         input  wire  [ADDR_W            -1:0] p1_waddr,
         input  wire  [CACHE_BLOCK_W     -1:0] p1_wdata,
@@ -52,7 +72,15 @@ module friscv_cache_blocks
         input  wire  [ADDR_W            -1:0] p2_raddr,
         output logic [WLEN              -1:0] p2_rdata,
         output logic                          p2_hit,
-        output logic                          p2_miss
+        output logic                          p2_miss,
+        // Way hit on a read, asserted along p1_hit / p2_hit
+        output logic [CACHE_WAYS        -1:0] way_hits,
+        // Port 1 read served by the victim cache, asserted along p1_hit
+        output logic                          victim_hit,
+        // Dirty block to write back, replaced or cleaned by port 1
+        output logic                          evict_valid,
+        output logic [ADDR_W            -1:0] evict_addr,
+        output logic [CACHE_BLOCK_W     -1:0] evict_data
     );
 
 
@@ -64,9 +92,14 @@ module friscv_cache_blocks
     localparam OFFSET_IX = (WLEN==32) ? 2 : 3;
     localparam OFFSET_W = $clog2(CACHE_BLOCK_W/WLEN);
 
-    // Index part into address value, to parse the cache blocks
+    // Index part into address value, to parse the sets
     localparam INDEX_IX = OFFSET_IX + OFFSET_W;
-    localparam INDEX_W = $clog2(CACHE_DEPTH);
+    localparam INDEX_W = $clog2(CACHE_DEPTH/CACHE_WAYS);
+    localparam SET_NUM = CACHE_DEPTH / CACHE_WAYS;
+
+    // Way selection and pseudo-LRU tree, one bit per node
+    localparam WAY_W = (CACHE_WAYS>1) ? $clog2(CACHE_WAYS) : 1;
+    localparam PLRU_W = (CACHE_WAYS>1) ? CACHE_WAYS - 1 : 1;
 
     // Tag part, address's MSB stored along the data values,
     localparam TAG_IX = INDEX_IX + INDEX_W;
@@ -90,6 +123,11 @@ module friscv_cache_blocks
     logic [CACHE_BLOCK_W/8   -1:0] wstrb;
     logic [TAG_W             -1:0] wtag;
     logic [INDEX_W           -1:0] rindex;
+    logic [TAG_W             -1:0] rtag;
+    logic [CACHE_WAYS        -1:0] way_wen;
+    logic                          refill;
+    logic                          drop;
+    logic                          dirty;
 
     // extracted from the write interface
     logic [INDEX_W        -1:0] p1_windex;
@@ -114,11 +152,36 @@ module friscv_cache_blocks
     logic [TAG_W          -1:0] rblock_tag;
     logic [CACHE_BLOCK_W  -1:0] rblock_data;
     logic                       rblock_set;
+    // extracted from each way
+    logic [CACHE_WAYS              -1:0] rway_valid;
+    logic [CACHE_WAYS*EPOCH_W      -1:0] rway_epoch;
+    logic [CACHE_WAYS              -1:0] rway_set;
+    logic [CACHE_WAYS*TAG_W        -1:0] rway_tag;
+    logic [CACHE_WAYS*CACHE_BLOCK_W-1:0] rway_data;
+    logic [CACHE_WAYS              -1:0] rway_hit;
+    logic [WAY_W                   -1:0] rway;
+    // extracted from each way on the write index
+    logic [CACHE_WAYS              -1:0] wway_valid;
+    logic [CACHE_WAYS*EPOCH_W      -1:0] wway_epoch;
+    logic [CACHE_WAYS              -1:0] wway_set;
+    logic [CACHE_WAYS*TAG_W        -1:0] wway_tag;
+    logic [CACHE_WAYS              -1:0] wway_hit;
+    logic [CACHE_WAYS              -1:0] wway_dirty;
+    logic [CACHE_WAYS*CACHE_BLOCK_W-1:0] wway_data;
+    logic [WAY_W                   -1:0] victim;
+    logic [WAY_W                   -1:0] eway;
+    // victim cache lookup
+    logic                                rblock_hit;
+    logic                                vc_hit;
+    logic [CACHE_BLOCK_W           -1:0] vc_data;
 
     genvar i;
     integer j;
     genvar k;
 
+    // Pseudo-LRU tree functions, shared with the other caches
+    `include "friscv_cache_h.sv"
+
     // Tracer setup
     `ifdef TRACE_CACHE
     integer f;
@@ -165,12 +228,18 @@ module friscv_cache_blocks
     assign wstrb = (p1_wen) ? p1_wstrb : p2_wstrb;
     assign wdata = (p1_wen) ? p1_wdata : p2_wdata;
 
+    // A block read from the memory, not a flush or clean operation
+    assign refill = p1_wen & !flush & !clean;
+    // Only port 2 modifies the blocks
+    assign dirty = !p1_wen;
+
     `ifdef TRACE_BLOCKS
     always @ (posedge aclk) begin
         if (wen) begin
             if (p1_wen) $fwrite(f, "@ %0t: Port 1 write @ 0x%x\n", $realtime, p1_waddr);
             else        $fwrite(f, "@ %0t: Port 2 write @ 0x%x\n", $realtime, p2_waddr);
             $fwrite(f, "  - index 0x%x\n", windex);
+            $fwrite(f, "  - ways 0x%x\n", way_wen);
             $fwrite(f, "  - tag 0x%x\n", wtag);
             $fwrite(f, "  - data 0x%x\n", wdata);
             $fwrite(f, "  - strb 0x%x\n", wstrb);
@@ -180,47 +249,325 @@ module friscv_cache_blocks
 
 
     //////////////////////////////////////////////////////////////////////////
-    // Two RAM / regfiles to store the cache blocks
+    // Two RAM / regfiles per way to store the cache blocks
     //////////////////////////////////////////////////////////////////////////
 
-    friscv_rambe
-    #(
-        `ifdef CACHE_SIM_ENV
-        .INIT       (1),
-        `endif
-        .ADDR_WIDTH ($clog2(CACHE_DEPTH)),
-        .DATA_WIDTH (CACHE_BLOCK_W),
-        .FFD_EN     (0)
-    )
-    data_ram
-    (
-        .aclk     (aclk),
-        .wr_en    (wen),
-        .wr_be    (wstrb),
-        .addr_in  (windex),
-        .data_in  (wdata),
-        .addr_out (rindex),
-        .data_out (rblock_data)
-    );
+    for (i=0;i<CACHE_WAYS;i=i+1) begin: WAYS
+
+        friscv_rambe
+        #(
+            `ifdef CACHE_SIM_ENV
+            .INIT       (1),
+            `endif
+            .ADDR_WIDTH (INDEX_W),
+            .DATA_WIDTH (CACHE_BLOCK_W),
+            .FFD_EN     (0)
+        )
+        data_ram
+        (
+            .aclk     (aclk),
+            .wr_en    (wen & way_wen[i] & !clean & !drop),
+            .wr_be    (wstrb),
+            .addr_in  (windex),
+            .data_in  (wdata),
+            .addr_out (rindex),
+            .data_out (rway_data[i*CACHE_BLOCK_W+:CACHE_BLOCK_W])
+        );
+
+        friscv_ram
+        #(
+            `ifdef CACHE_SIM_ENV
+            .INIT       (1),
+            `endif
+            .ADDR_WIDTH (INDEX_W),
+            .DATA_WIDTH (1+EPOCH_W+TAG_W),
+            .FFD_EN     (0)
+        )
+        metadata_ram
+        (
+            .aclk     (aclk),
+            .wr_en    (wen & way_wen[i] & !clean & !drop),
+            .addr_in  (windex),
+            .data_in  ({~flush, epoch, wtag}),
+            .addr_out (rindex),
+            .data_out ({rway_valid[i], rway_epoch[i*EPOCH_W+:EPOCH_W], rway_tag[i*TAG_W+:TAG_W]})
+        );
+
+        assign rway_set[i] = rway_valid[i] && rway_epoch[i*EPOCH_W+:EPOCH_W]==epoch;
+        assign rway_hit[i] = rway_set[i] && rway_tag[i*TAG_W+:TAG_W]==rtag;
+    end
 
-    friscv_ram
-    #(
-        `ifdef CACHE_SIM_ENV
-        .INIT       (1),
-        `endif
-        .ADDR_WIDTH ($clog2(CACHE_DEPTH)),
-        .DATA_WIDTH (1+TAG_W),
-        .FFD_EN     (0)
-    )
-    metadata_ram
-    (
-        .aclk     (aclk),
-        .wr_en    (wen),
-        .addr_in  (windex),
-        .data_in  ({~flush, wtag}),
-        .addr_out (rindex),
-        .data_out ({rblock_set, rblock_tag})
-    );
+
+    //////////////////////////////////////////////////////////////////////////
+    // Replica of the blocks read on the write index, to check if a block is
+    // already present and to extract the block to write back. Port 1 doesn't
+    // overwrite a block already present, likely more recent than the memory.
+    //////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (CACHE_WAYS>1 || WRITE_BACK || VICTIM_NB>0) begin: WRITE_LOOKUP
+
+        for (i=0;i<CACHE_WAYS;i=i+1) begin: WAYS_WR
+
+            friscv_ram
+            #(
+                `ifdef CACHE_SIM_ENV
+                .INIT       (1),
+                `endif
+                .ADDR_WIDTH (INDEX_W),
+                .DATA_WIDTH (1+EPOCH_W+TAG_W),
+                .FFD_EN     (0)
+            )
+            metadata_ram
+            (
+                .aclk     (aclk),
+                .wr_en    (wen & way_wen[i] & !clean & !drop),
+                .addr_in  (windex),
+                .data_in  ({~flush, epoch, wtag}),
+                .addr_out (windex),
+                .data_out ({wway_valid[i], wway_epoch[i*EPOCH_W+:EPOCH_W], wway_tag[i*TAG_W+:TAG_W]})
+            );
+
+            assign wway_set[i] = wway_valid[i] && wway_epoch[i*EPOCH_W+:EPOCH_W]==epoch;
+            assign wway_hit[i] = wway_set[i] && wway_tag[i*TAG_W+:TAG_W]==wtag;
+        end
+
+        assign drop = refill & |wway_hit;
+
+    end else begin: NO_WRITE_LOOKUP
+
+        assign wway_valid = {CACHE_WAYS{1'b0}};
+        assign wway_epoch = {CACHE_WAYS*EPOCH_W{1'b0}};
+        assign wway_set = {CACHE_WAYS{1'b0}};
+        assign wway_tag = {CACHE_WAYS*TAG_W{1'b0}};
+        assign wway_hit = {CACHE_WAYS{1'b0}};
+        assign drop = 1'b0;
+
+    end
+    endgenerate
+
+
+    //////////////////////////////////////////////////////////////////////////
+    // Replica of the blocks' data read on the write index, to extract the
+    // block replaced by a refill
+    //////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (WRITE_BACK || VICTIM_NB>0) begin: WRITE_DATA_LOOKUP
+
+        for (i=0;i<CACHE_WAYS;i=i+1) begin: WAYS_WR_DATA
+
+            friscv_rambe
+            #(
+                `ifdef CACHE_SIM_ENV
+                .INIT       (1),
+                `endif
+                .ADDR_WIDTH (INDEX_W),
+                .DATA_WIDTH (CACHE_BLOCK_W),
+                .FFD_EN     (0)
+            )
+            data_ram
+            (
+                .aclk     (aclk),
+                .wr_en    (wen & way_wen[i] & !clean & !drop),
+                .wr_be    (wstrb),
+                .addr_in  (windex),
+                .data_in  (wdata),
+                .addr_out (windex),
+                .data_out (wway_data[i*CACHE_BLOCK_W+:CACHE_BLOCK_W])
+            );
+        end
+
+    end else begin: NO_WRITE_DATA_LOOKUP
+
+        assign wway_data = {CACHE_WAYS*CACHE_BLOCK_W{1'b0}};
+
+    end
+    endgenerate
+
+
+    //////////////////////////////////////////////////////////////////////////
+    // Write-back support. A dirty bit per block is set on a port 2 write and
+    // cleared on a port 1 write, a refill or a clean. The victim of a refill
+    // or the block cleaned is driven to the eviction interface if dirty. The
+    // flush at boot time only invalidates the blocks.
+    //////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (WRITE_BACK) begin: DIRTY_TRACKING
+
+        for (i=0;i<CACHE_WAYS;i=i+1) begin: WAYS_DIRTY
+
+            friscv_ram
+            #(
+                `ifdef CACHE_SIM_ENV
+                .INIT       (1),
+                `endif
+                .ADDR_WIDTH (INDEX_W),
+                .DATA_WIDTH (1),
+                .FFD_EN     (0)
+            )
+            dirty_ram
+            (
+                .aclk     (aclk),
+                .wr_en    (wen & way_wen[i] & !drop),
+                .addr_in  (windex),
+                .data_in  (dirty),
+                .addr_out (windex),
+                .data_out (wway_dirty[i])
+            );
+        end
+
+        assign evict_valid = p1_wen & !flush & (clean | refill & !drop) &
+                             wway_set[eway] & wway_dirty[eway];
+        assign evict_addr = {wway_tag[eway*TAG_W+:TAG_W], windex, {OFFSET_W+OFFSET_IX{1'b0}}};
+        assign evict_data = wway_data[eway*CACHE_BLOCK_W+:CACHE_BLOCK_W];
+
+    end else begin: NO_DIRTY_TRACKING
+
+        assign wway_dirty = {CACHE_WAYS{1'b0}};
+        assign evict_valid = 1'b0;
+        assign evict_addr = {ADDR_W{1'b0}};
+        assign evict_data = {CACHE_BLOCK_W{1'b0}};
+
+    end
+    endgenerate
+
+
+    //////////////////////////////////////////////////////////////////////////
+    // Way selection on write. A flush clears all the ways of a set, a clean
+    // selects the way with the tag's LSBs. Else the ways already storing the
+    // block are updated, port 1 allocating a way if none: the first invalid
+    // one or the pseudo-LRU victim. Port 2 only updates a block present in
+    // the cache.
+    //////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (CACHE_WAYS>1) begin: SET_ASSOCIATIVE
+
+        logic [WAY_W             -1:0] wway;
+        logic [PLRU_W            -1:0] plru [SET_NUM-1:0];
+
+        always @ (*) begin
+            victim = plru_victim(plru[windex]);
+            for (int w=CACHE_WAYS-1;w>=0;w=w-1)
+                if (!wway_set[w]) victim = w[WAY_W-1:0];
+        end
+
+        always @ (*) begin
+            wway = victim;
+            for (int w=CACHE_WAYS-1;w>=0;w=w-1)
+                if (wway_hit[w]) wway = w[WAY_W-1:0];
+        end
+
+        assign eway = (clean) ? wtag[WAY_W-1:0] : victim;
+
+        assign way_wen = (flush)     ? {CACHE_WAYS{1'b1}} :
+                         (clean)     ? {{CACHE_WAYS-1{1'b0}}, 1'b1} << eway :
+                         (|wway_hit) ? wway_hit :
+                         (p1_wen)    ? {{CACHE_WAYS-1{1'b0}}, 1'b1} << victim :
+                                       {CACHE_WAYS{1'b0}};
+
+        always @ (*) begin
+            rway = {WAY_W{1'b0}};
+            for (int w=CACHE_WAYS-1;w>=0;w=w-1)
+                if (rway_hit[w]) rway = w[WAY_W-1:0];
+        end
+
+        // The tree is updated on a read hit and on a block write, the most
+        // recently used way being protected from the next replacement
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                for (int s=0;s<SET_NUM;s=s+1)
+                    plru[s] <= {PLRU_W{1'b0}};
+            end else if (srst) begin
+                for (int s=0;s<SET_NUM;s=s+1)
+                    plru[s] <= {PLRU_W{1'b0}};
+            end else begin
+                if ((p1_ren || p2_ren) && |rway_hit)
+                    plru[rindex] <= plru_update(plru[rindex], rway);
+                if (wen && !flush && !clean && |way_wen)
+                    plru[windex] <= plru_update(plru[windex], wway);
+            end
+        end
+
+    end else begin: DIRECT_MAPPED
+
+        assign way_wen = 1'b1;
+        assign victim = 1'b0;
+        assign eway = 1'b0;
+        assign rway = 1'b0;
+
+    end
+    endgenerate
+
+    assign rblock_set = rway_set[rway];
+    assign rblock_tag = rway_tag[rway*TAG_W+:TAG_W];
+    assign rblock_data = rway_data[rway*CACHE_BLOCK_W+:CACHE_BLOCK_W];
+
+    assign rblock_hit = rblock_set && rtag==rblock_tag;
+
+
+    //////////////////////////////////////////////////////////////////////////
+    // Victim cache, receiving the valid block replaced by a refill. A port 1
+    // read missing the blocks is served by the victim cache, a port 2 read
+    // invalidates the copy of the block, the store updating it or not the
+    // blocks. A refill invalidates the copy of the block written. A new epoch
+    // flushes the victim cache, its entries being ignored meanwhile.
+    //////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (VICTIM_NB>0) begin: VICTIM_CACHE
+
+        logic [EPOCH_W-1:0] vc_epoch;
+        logic               vc_stale;
+        logic               vc_match;
+
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                vc_epoch <= {EPOCH_W{1'b0}};
+            end else if (srst) begin
+                vc_epoch <= {EPOCH_W{1'b0}};
+            end else begin
+                vc_epoch <= epoch;
+            end
+        end
+
+        assign vc_stale = vc_epoch != epoch;
+        assign vc_hit = vc_match & !vc_stale;
+
+        friscv_cache_victim
+        #(
+            .NAME          ({NAME, "-victim"}),
+            .ADDR_W        (TAG_W+INDEX_W),
+            .CACHE_BLOCK_W (CACHE_BLOCK_W),
+            .DEPTH         (VICTIM_NB)
+        )
+        victim_cache
+        (
+            .aclk      (aclk),
+            .aresetn   (aresetn),
+            .srst      (srst),
+            .flush     (p1_wen & flush | vc_stale),
+            .push      (refill & !drop & wway_set[victim]),
+            .push_addr ({wway_tag[victim*TAG_W+:TAG_W], windex}),
+            .push_data (wway_data[victim*CACHE_BLOCK_W+:CACHE_BLOCK_W]),
+            .wr_inval  (refill),
+            .wr_addr   ({wtag, windex}),
+            .rd_addr   ({rtag, rindex}),
+            .rd_use    (p1_ren & !rblock_hit),
+            .rd_inval  (!p1_ren & p2_ren),
+            .rd_hit    (vc_match),
+            .rd_data   (vc_data)
+        );
+
+    end else begin: NO_VICTIM_CACHE
+
+        assign vc_hit = 1'b0;
+        assign vc_data = {CACHE_BLOCK_W{1'b0}};
+
+    end
+    endgenerate
 
 
     //////////////////////////////////////////////////////////////////////////
@@ -237,6 +584,7 @@ module friscv_cache_blocks
     //
     // The MSB of a cache block is the set bit, set to 1 once the block
     // has been written and so valid. This bit is set back to 0 during flush.
+    // A block written in a previous epoch is not valid anymore.
     //////////////////////////////////////////////////////////////////////////
 
     // offset is used to select the correct instruction across the cache line
@@ -251,6 +599,7 @@ module friscv_cache_blocks
 
     // read the corresponding cache line
     assign rindex = (p1_ren) ? p1_rindex : p2_rindex;
+    assign rtag = (p1_ren) ? p1_rtag : p2_rtag;
 
 
     always @ (posedge aclk or negedge aresetn) begin
@@ -261,6 +610,8 @@ module friscv_cache_blocks
             p2_hit <= 1'b0;
             p2_miss <= 1'b0;
             p2_rdata <= {WLEN{1'b0}};
+            way_hits <= {CACHE_WAYS{1'b0}};
+            victim_hit <= 1'b0;
         end else if (srst) begin
             p1_hit <= 1'b0;
             p1_miss <= 1'b0;
@@ -268,14 +619,25 @@ module friscv_cache_blocks
             p2_hit <= 1'b0;
             p2_miss <= 1'b0;
             p2_rdata <= {WLEN{1'b0}};
+            way_hits <= {CACHE_WAYS{1'b0}};
+            victim_hit <= 1'b0;
         end else begin
             // - hit indicates the cache line store the expected instruction
             // - miss indicates the cache is not initialized or doesn't contain
             //   the expected instruction address
+            way_hits <= (p1_ren || p2_ren) ? rway_hit : {CACHE_WAYS{1'b0}};
+            victim_hit <= p1_ren & !rblock_hit & vc_hit;
+
             if (p1_ren) begin
-                p1_hit <= (rblock_set && p1_rtag==rblock_tag) ? 1'b1 : 1'b0;
-                p1_miss <= (~rblock_set || p1_rtag!=rblock_tag) ? 1'b1 : 1'b0;
-                p1_rdata <= rblock_data[p1_roffset*WLEN+:WLEN];
+                p1_hit <= (rblock_hit || vc_hit) ? 1'b1 : 1'b0;
+                p1_miss <= (!rblock_hit && !vc_hit) ? 1'b1 : 1'b0;
+                if (rblock_hit)
+                    p1_rdata <= rblock_data[p1_roffset*WLEN+:WLEN];
+                else
+                    p1_rdata <= vc_data[p1_roffset*WLEN+:WLEN];
+                // Port 2 not serviced, neither hit nor miss
+                p2_hit <= 1'b0;
+                p2_miss <= 1'b0;
                 `ifdef TRACE_BLOCKS
                 `trace_read(1)
                 `endif
@@ -283,6 +645,8 @@ module friscv_cache_blocks
                 p2_hit <= (rblock_set && p2_rtag==rblock_tag) ? 1'b1 : 1'b0;
                 p2_miss <= (~rblock_set || p2_rtag!=rblock_tag) ? 1'b1 : 1'b0;
                 p2_rdata <= rblock_data[p2_roffset*WLEN+:WLEN];
+                p1_hit <= 1'b0;
+                p1_miss <= 1'b0;
                 `ifdef TRACE_BLOCKS
                 `trace_read(2)
                 `endif
@@ -0,0 +1,197 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Eviction buffer of the write-back data cache
+//
+// - store the dirty blocks replaced or cleaned by the cache blocks
+// - write them back to the memory with a single beat, full strobes requests
+// - an entry is released once its write response has been received, the
+//   requests being issued with a single ID and so completed in-order
+// - flag a block read while the block is still waiting to be written
+//
+///////////////////////////////////////////////////////////////////////////////
+
+module friscv_cache_evict_buffer
+
+    #(
+        ///////////////////////////////////////////////////////////////////////
+        // General Setup
+        ///////////////////////////////////////////////////////////////////////
+
+        // Name used for tracer file name
+        parameter NAME = "evict-buffer",
+        // Number of blocks buffered, a power of two
+        parameter DEPTH = 2,
+
+        ///////////////////////////////////////////////////////////////////////
+        // Interface Setup
+        ///////////////////////////////////////////////////////////////////////
+
+        // Address bus width defined for both control and AXI4 address signals
+        parameter AXI_ADDR_W = 8,
+        // AXI ID width, setup by default to 8 and unused
+        parameter AXI_ID_W = 8,
+        // AXI4 data width, setup to the cache block width
+        parameter AXI_DATA_W = 128,
+        // ID used by the write requests
+        parameter EVICT_ID = 'h28
+    )(
+        // Global interface
+        input  wire                            aclk,
+        input  wire                            aresetn,
+        input  wire                            srst,
+        // All blocks written back to the memory
+        output logic                           drained,
+
+        // Dirty blocks from the cache blocks
+        input  wire                            evict_valid,
+        output logic                           evict_ready,
+        input  wire  [AXI_ADDR_W         -1:0] evict_addr,
+        input  wire  [AXI_DATA_W         -1:0] evict_data,
+
+        // Block read hazard check
+        input  wire  [AXI_ADDR_W         -1:0] rd_addr,
+        output logic                           rd_hazard,
+
+        // Data memory interface
+        output logic                           memctrl_awvalid,
+        input  wire                            memctrl_awready,
+        output logic [AXI_ADDR_W         -1:0] memctrl_awaddr,
+        output logic [3                  -1:0] memctrl_awprot,
+        output logic [AXI_ID_W           -1:0] memctrl_awid,
+        output logic                           memctrl_wvalid,
+        input  wire                            memctrl_wready,
+        output logic [AXI_DATA_W         -1:0] memctrl_wdata,
+        output logic [AXI_DATA_W/8       -1:0] memctrl_wstrb,
+        input  wire                            memctrl_bvalid,
+        output logic                           memctrl_bready
+    );
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Parameters and variables declarations
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    localparam PTR_W = (DEPTH>1) ? $clog2(DEPTH) : 1;
+
+    // Lowest part of the address replaced by 0 to access a complete block
+    localparam ADDR_LSB_W = $clog2(AXI_DATA_W/8);
+
+    logic [AXI_ADDR_W   -1:0] addr [DEPTH-1:0];
+    logic [AXI_DATA_W   -1:0] data [DEPTH-1:0];
+    logic [DEPTH        -1:0] pending;
+
+    // Push, address, data and response pointers, the MSB flagging a wrap
+    logic [PTR_W          :0] wr_ptr;
+    logic [PTR_W          :0] aw_ptr;
+    logic [PTR_W          :0] w_ptr;
+    logic [PTR_W          :0] b_ptr;
+
+    logic [DEPTH        -1:0] match;
+
+    // Tracer setup
+    `ifdef TRACE_CACHE
+    string fname;
+    integer f;
+    initial begin
+        $sformat(fname, "trace_%s.txt", NAME);
+        f = $fopen(fname, "w");
+    end
+    `endif
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Blocks storage
+    ///////////////////////////////////////////////////////////////////////////
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            wr_ptr <= '0;
+            aw_ptr <= '0;
+            w_ptr <= '0;
+            b_ptr <= '0;
+            pending <= '0;
+        end else if (srst) begin
+            wr_ptr <= '0;
+            aw_ptr <= '0;
+            w_ptr <= '0;
+            b_ptr <= '0;
+            pending <= '0;
+        end else begin
+
+            if (evict_valid && evict_ready) begin
+                `ifdef TRACE_CACHE
+                $fwrite(f, "@ %0t: Evict block 0x%x\n", $realtime, evict_addr);
+                `endif
+                wr_ptr <= wr_ptr + 1'b1;
+            end
+
+            if (memctrl_awvalid && memctrl_awready)
+                aw_ptr <= aw_ptr + 1'b1;
+
+            if (memctrl_wvalid && memctrl_wready)
+                w_ptr <= w_ptr + 1'b1;
+
+            if (memctrl_bvalid)
+                b_ptr <= b_ptr + 1'b1;
+
+            for (int i=0;i<DEPTH;i=i+1) begin
+                if (evict_valid && evict_ready && wr_ptr[PTR_W-1:0]==i[PTR_W-1:0])
+                    pending[i] <= 1'b1;
+                else if (memctrl_bvalid && b_ptr[PTR_W-1:0]==i[PTR_W-1:0])
+                    pending[i] <= 1'b0;
+            end
+        end
+    end
+
+    always @ (posedge aclk) begin
+        if (evict_valid && evict_ready) begin
+            addr[wr_ptr[PTR_W-1:0]] <= evict_addr;
+            data[wr_ptr[PTR_W-1:0]] <= evict_data;
+        end
+    end
+
+    assign evict_ready = (wr_ptr ^ b_ptr) != {1'b1, {PTR_W{1'b0}}};
+    assign drained = (wr_ptr == b_ptr);
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // A block can't be read from the memory while its write is pending, nor
+    // while being pushed
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (genvar i=0;i<DEPTH;i=i+1) begin: HAZARD
+        assign match[i] = pending[i] &&
+                          addr[i][AXI_ADDR_W-1:ADDR_LSB_W]==rd_addr[AXI_ADDR_W-1:ADDR_LSB_W];
+    end
+
+    assign rd_hazard = |match ||
+                       evict_valid && evict_addr[AXI_ADDR_W-1:ADDR_LSB_W]==rd_addr[AXI_ADDR_W-1:ADDR_LSB_W];
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Write requests, address and data channels being independent
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign memctrl_awvalid = (aw_ptr != wr_ptr);
+    assign memctrl_awaddr = addr[aw_ptr[PTR_W-1:0]];
+    assign memctrl_awprot = 3'b0;
+    assign memctrl_awid = EVICT_ID;
+
+    assign memctrl_wvalid = (w_ptr != wr_ptr);
+    assign memctrl_wdata = data[w_ptr[PTR_W-1:0]];
+    assign memctrl_wstrb = {AXI_DATA_W/8{1'b1}};
+
+    assign memctrl_bready = 1'b1;
+
+endmodule
+
+`resetall
@@ -10,6 +10,16 @@
 //
 // State machine managing cache initialization and cache flush (FENCE.i)
 //
+// A flush request increments the epoch stored along the blocks' tags, the
+// blocks of the previous epochs being invalid once the epoch changed. The
+// sets are only parsed to invalidate the blocks after the reset and when the
+// epoch wraps. A flush request first waits for the refills still in-flight,
+// else a block requested before the flush would land valid in the new epoch.
+//
+// With a write-back cache, a flush request cleans the blocks: the dirty ones
+// are written back to the memory, then the acknowledgement waits for all the
+// writes to complete. The initialization still only invalidates the blocks.
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 module friscv_cache_flusher
@@ -31,8 +41,14 @@ module friscv_cache_flusher
         parameter CACHE_BLOCK_W = 128,
         // Number of lines in the cache
         parameter CACHE_DEPTH = 512,
+        // Number of ways, all the ways of a set being invalidated at once
+        parameter CACHE_WAYS = 1,
+        // Width of the epoch, the sets being parsed every 2**EPOCH_W flushes
+        parameter EPOCH_W = 2,
         // Address width, common with AXI4 bus
-        parameter AXI_ADDR_W = 12
+        parameter AXI_ADDR_W = 12,
+        // Clean the blocks on flush request instead of invalidating them
+        parameter WRITE_BACK = 0
 
     )(
         // Global signals
@@ -42,8 +58,14 @@ module friscv_cache_flusher
         output logic                      ready,
         // Flush interface
         input  wire                       flush_blocks,
+        input  wire                       refilling,
         output logic                      flush_ack,
         output logic                      flushing,
+        output logic [EPOCH_W       -1:0] epoch,
+        // Clean interface, write-back only
+        output logic                      cleaning,
+        input  wire                       stall,
+        input  wire                       drained,
 
         // Control read completion
         output logic                      cache_wren,
@@ -57,23 +79,27 @@ module friscv_cache_flusher
     //////////////////////////////////////////////////////////////////////////
 
     localparam MAX_CACHE_ADDR = CACHE_DEPTH << $clog2(CACHE_BLOCK_W/8);
+    localparam MAX_SET_ADDR = (CACHE_DEPTH/CACHE_WAYS) << $clog2(CACHE_BLOCK_W/8);
 
-    typedef enum logic[1:0] {
+    typedef enum logic[2:0] {
         IDLE = 0,
         FLUSH = 1,
-        ACK = 2
+        ACK = 2,
+        CLEAN = 3,
+        DRAIN = 4
     } ctrl_fsm;
 
     ctrl_fsm cfsm;
 
     logic blocks_zeroed;
+    logic wren;
 
 
     ///////////////////////////////////////////////////////////////////////////
     // Flush support on FENCE.i instruction execution
     //
     // flush_ack is asserted for one cycle once flush_blocks has been asserted
-    // and the entire cache lines have been erased
+    // and the epoch incremented or the entire cache lines have been erased
     ///////////////////////////////////////////////////////////////////////////
 
     assign cache_wdata = {CACHE_BLOCK_W{1'b0}};
@@ -84,16 +110,20 @@ module friscv_cache_flusher
             cfsm <= IDLE;
             flush_ack <= 1'b0;
             flushing <= 1'b0;
-            cache_wren <= 1'b0;
+            cleaning <= 1'b0;
+            wren <= 1'b0;
             cache_waddr <= {AXI_ADDR_W{1'b0}};
             blocks_zeroed <= 1'b0;
+            epoch <= {EPOCH_W{1'b0}};
         end else if (srst == 1'b1) begin
             cfsm <= IDLE;
             flush_ack <= 1'b0;
             flushing <= 1'b0;
-            cache_wren <= 1'b0;
+            cleaning <= 1'b0;
+            wren <= 1'b0;
             cache_waddr <= {AXI_ADDR_W{1'b0}};
             blocks_zeroed <= 1'b0;
+            epoch <= {EPOCH_W{1'b0}};
         end else begin
 
             case (cfsm)
@@ -101,26 +131,60 @@ module friscv_cache_flusher
                 default: begin
                     flushing <= 1'b0;
                     flush_ack <= 1'b0;
-                    if (flush_blocks || !blocks_zeroed) begin
+                    // Let the pending refills complete in the current epoch
+                    if (flush_blocks && refilling) begin
+                        cfsm <= IDLE;
+                    end else if (flush_blocks && blocks_zeroed && WRITE_BACK) begin
+                        cleaning <= 1'b1;
+                        wren <= 1'b1;
+                        cfsm <= CLEAN;
+                    // Invalidate the blocks by moving to the next epoch
+                    end else if (flush_blocks && blocks_zeroed && epoch!={EPOCH_W{1'b1}}) begin
+                        epoch <= epoch + 1'b1;
+                        flush_ack <= 1'b1;
+                        cfsm <= ACK;
+                    end else if (flush_blocks || !blocks_zeroed) begin
                         flushing <= 1'b1;
-                        cache_wren <= 1'b1;
+                        wren <= 1'b1;
                         cfsm <= FLUSH;
                     end
                 end
                 FLUSH: begin
                     flushing <= 1'b1;
-                    cache_wren <= 1'b1;
-                    // Increment erase address by the number of byte per cache block
+                    wren <= 1'b1;
+                    // Increment erase address by the number of byte per cache
+                    // block, all the ways of a set being erased at once
                     cache_waddr <= cache_waddr + CACHE_BLOCK_W/8;
-                    if (cache_waddr==MAX_CACHE_ADDR) begin
+                    if (cache_waddr==MAX_SET_ADDR) begin
                         blocks_zeroed <= 1'b1;
-                        cache_wren <= 1'b0;
+                        epoch <= {EPOCH_W{1'b0}};
+                        wren <= 1'b0;
                         cache_waddr <= {AXI_ADDR_W{1'b0}};
                         flushing <= 1'b0;
                         flush_ack <= 1'b1;
                         cfsm <= ACK;
                     end
                 end
+                // Parse the blocks to write back the dirty ones, waiting
+                // while the eviction can't be accepted
+                CLEAN: begin
+                    if (!stall) begin
+                        cache_waddr <= cache_waddr + CACHE_BLOCK_W/8;
+                        if (cache_waddr==MAX_CACHE_ADDR) begin
+                            wren <= 1'b0;
+                            cache_waddr <= {AXI_ADDR_W{1'b0}};
+                            cleaning <= 1'b0;
+                            cfsm <= DRAIN;
+                        end
+                    end
+                end
+                // Wait for the blocks to be written in memory
+                DRAIN: begin
+                    if (drained) begin
+                        flush_ack <= 1'b1;
+                        cfsm <= ACK;
+                    end
+                end
                 // Once cache has been erased wait for req deassertion
                 ACK: begin
                     flushing <= 1'b0;
@@ -134,6 +198,9 @@ module friscv_cache_flusher
 
     assign ready = blocks_zeroed;
 
+    // A clean step is held while stalled
+    assign cache_wren = wren & !(cleaning & stall);
+
 endmodule
 
 `resetall
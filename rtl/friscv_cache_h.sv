@@ -0,0 +1,55 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+// Included inside the cache modules, each one needing its own copy of the
+// functions, so the file is not guarded. The includer declares WAY_W, the
+// number of bits to index a way, and PLRU_W, the number of tree nodes.
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Tree pseudo-LRU replacement Functions
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Select the victim way by following the tree, a node pointing to its
+    // upper half when set
+    // Args:
+    //      - tree: the PLRU nodes of the set
+    // Returns:
+    //      - the way to replace
+    ///////////////////////////////////////////////////////////////////////////
+    function automatic [WAY_W-1:0] plru_victim(
+        input logic [PLRU_W-1:0] tree
+    );
+        integer node;
+        plru_victim = {WAY_W{1'b0}};
+        node = 0;
+        for (int l=0;l<WAY_W;l=l+1) begin
+            plru_victim = {plru_victim, tree[node]};
+            node = 2 * node + 1 + tree[node];
+        end
+    endfunction
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Make the nodes on the path of the accessed way point to the other half
+    // Args:
+    //      - tree: the PLRU nodes of the set
+    //      - way: the way accessed
+    // Returns:
+    //      - the updated nodes
+    ///////////////////////////////////////////////////////////////////////////
+    function automatic [PLRU_W-1:0] plru_update(
+        input logic [PLRU_W-1:0] tree,
+        input logic [WAY_W -1:0] way
+    );
+        integer node;
+        plru_update = tree;
+        node = 0;
+        for (int l=0;l<WAY_W;l=l+1) begin
+            plru_update[node] = ~way[WAY_W-1-l];
+            node = 2 * node + 1 + way[WAY_W-1-l];
+        end
+    endfunction
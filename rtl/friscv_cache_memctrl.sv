@@ -11,9 +11,17 @@
 // Memory controller managing AXI4-lite read request from Fetcher to read
 // central memory to fill caches lines.
 //
-// TODO: Support AXI4 transfer with different width than the cache block width
-// TODO: Support width adaptation between ctrl and memory (a5f613f50f861)
-// TODO: Support Wrap mode for read channel
+// The control interfaces carry a whole cache block, the controller adapting
+// it to the AXI4 data width:
+//
+// - a block read is a burst of CACHE_BLOCK_W/AXI_DATA_W beats, assembled
+//   before being completed. The burst is an INCR one starting on the block's
+//   first beat, or a WRAP one starting on the beat of the word requested
+// - an IO read is a single beat
+// - a write is a burst covering only the beats enabled by the write strobes,
+//   a single store or an IO write being a single beat
+// - the read bursts must not be interleaved by the memory
+//
 // TODO: Manage RRESP
 // TODO: Add tracer
 //
@@ -49,6 +57,9 @@ module friscv_cache_memctrl
         parameter AXI_IN_ORDER = 1,
         // ID Mask to apply to identify the data cache in the AXI4 infrastructure
         parameter AXI_ID_MASK = 'h20,
+        // Read a block with a WRAP burst starting on the word requested,
+        // else with an INCR burst starting on the block's first beat
+        parameter AXI_WRAP = 0,
 
         ///////////////////////////////////////////////////////////////////////
         // Cache Setup
@@ -78,6 +89,7 @@ module friscv_cache_memctrl
         output logic [2             -1:0] mst_rresp,
         output logic [CACHE_BLOCK_W -1:0] mst_rdata_blk,
         output logic [XLEN          -1:0] mst_rdata,
+        output logic                      mst_rword,
         // ctrl write interface
         input  wire                       mst_awvalid,
         output logic                      mst_awready,
@@ -87,8 +99,8 @@ module friscv_cache_memctrl
         input  wire  [AXI_ID_W      -1:0] mst_awid,
         input  wire                       mst_wvalid,
         output logic                      mst_wready,
-        input  wire  [XLEN          -1:0] mst_wdata,
-        input  wire  [XLEN/8        -1:0] mst_wstrb,
+        input  wire  [CACHE_BLOCK_W -1:0] mst_wdata,
+        input  wire  [CACHE_BLOCK_W/8-1:0] mst_wstrb,
         output logic [AXI_ID_W      -1:0] mst_bid,
         output logic [2             -1:0] mst_bresp,
         output logic                      mst_bvalid,
@@ -144,11 +156,16 @@ module friscv_cache_memctrl
     // Used along the module to buffer the outstanding requests' IDs
     localparam NB_TAG_W = $clog2(OSTDREQ_NUM);
     // Lowest part of the address replaced by 0 to access a complete cache block
-    // (AXI_DATA_W = CACHE_BLOCK_W is the only setup supported)
-    localparam ADDR_LSB_W = $clog2(AXI_DATA_W/8);
+    localparam ADDR_LSB_W = $clog2(CACHE_BLOCK_W/8);
+    // Lowest part of the address replaced by 0 to access a data beat
+    localparam BEAT_LSB_W = $clog2(AXI_DATA_W/8);
+    // Number of beats to transfer a cache block
+    localparam NB_BEAT = CACHE_BLOCK_W / AXI_DATA_W;
+    localparam BEAT_W = (NB_BEAT>1) ? $clog2(NB_BEAT) : 1;
+    localparam [8-1:0] BLOCK_LEN = NB_BEAT - 1;
 
     // Offset part into address to index a DWORD or QWORD
-    localparam SCALE = AXI_DATA_W / XLEN;
+    localparam SCALE = CACHE_BLOCK_W / XLEN;
     localparam OFFSET_IX = (XLEN==32) ? 2 : 3;
     localparam OFFSET_W = $clog2(SCALE);
 
@@ -158,17 +175,9 @@ module friscv_cache_memctrl
     logic                  arcache;
     logic [OFFSET_W  -1:0] roffset;
     logic                  rch_full;
-    logic                  wch_full;
     logic                  rch_empty;
-    logic                  wch_empty;
-    logic                  wch_aempty;
-    logic                  push_woffset;
-    logic                  push_woffset_r;
-    logic                  pull_woffset;
-
-    logic [OFFSET_W  -1:0] wr_strb_pos;
-    logic [OFFSET_W  -1:0] woffset;
-    logic [OFFSET_W  -1:0] woffset_r;
+    logic                  rd_burst;
+    logic                  rlast;
 
     logic [AXI_ID_W  -1:0] arid_m;
     logic [AXI_ID_W  -1:0] rid_m;
@@ -200,11 +209,12 @@ module friscv_cache_memctrl
     // Hardcoded setup
     ///////////////////////////////////////////////////////////////////////////
 
-    // Always use INCR mode
-    assign mem_arburst = 2'b01;
+    // A block read is a burst over the whole block, an IO read a single beat
+    assign rd_burst = !mst_arcache[1] && NB_BEAT>1;
 
-    // Issue only transfer with a single dataphase
-    assign mem_arlen = 8'b0;
+    assign mem_arburst = (rd_burst && AXI_WRAP>0) ? 2'b10 : 2'b01;
+
+    assign mem_arlen = (rd_burst) ? BLOCK_LEN : 8'b0;
 
     // Fixed ASIZE, narrow transfers are not supported neither necessary
     assign mem_arsize = asize;
@@ -217,7 +227,11 @@ module friscv_cache_memctrl
     assign mem_arvalid = mst_arvalid;
     assign mst_arready = mem_arready && !rch_full;
 
-    assign mem_araddr = mst_araddr;
+    // An IO read uses the address requested, a block read starts on the
+    // block's first beat or on the beat of the word requested
+    assign mem_araddr = (mst_arcache[1])         ? mst_araddr :
+                        (rd_burst && AXI_WRAP>0) ? {mst_araddr[AXI_ADDR_W-1:BEAT_LSB_W], {BEAT_LSB_W{1'b0}}} :
+                                                   {mst_araddr[AXI_ADDR_W-1:ADDR_LSB_W], {ADDR_LSB_W{1'b0}}};
     assign mem_arprot = mst_arprot;
     assign mem_arid = mst_arid;
 
@@ -241,7 +255,7 @@ module friscv_cache_memctrl
             .full     (rch_full),
             .afull    (),
             .data_out ({arcache, araddr}),
-            .pull     (mem_rvalid & mem_rready),
+            .pull     (mem_rvalid & mem_rready & rlast),
             .empty    (rch_empty),
             .aempty   ()
         );
@@ -251,18 +265,20 @@ module friscv_cache_memctrl
     
     end else begin
 
+        // Entries above the outstanding requests' range are used by the block
+        // refills of the pusher, the prefetches and the MSHRs' block reads
         friscv_ram
         #(
-            .ADDR_WIDTH (NB_TAG_W),
+            .ADDR_WIDTH (NB_TAG_W+2),
             .DATA_WIDTH (AXI_ADDR_W + 1 /*ARCACHE[1]*/)
         )
         araddr_ram
         (
             .aclk       (aclk),
             .wr_en      (mst_arvalid & mst_arready),
-            .addr_in    (arid_m[NB_TAG_W-1:0]),
+            .addr_in    (arid_m[NB_TAG_W+1:0]),
             .data_in    ({mst_arcache[1], mst_araddr}),
-            .addr_out   (rid_m[NB_TAG_W-1:0]),
+            .addr_out   (rid_m[NB_TAG_W+1:0]),
             .data_out   ({arcache, araddr})
         );
 
@@ -298,34 +314,109 @@ module friscv_cache_memctrl
     //  - rcache: ARCACHE[1], used to drive IO request to cache completion
     //    channel and so bypass the cache blocks
     //  - rdata_blk: the whole address line fetched, the controller always
-    //    read a whole block
+    //    read a whole block, completed along the last beat of the burst
     //  - rdata: RDATA extracted from the interface to match the exact address 
     //    while we always fetch a whole cache block. Make the controller usable 
     //    for both instruction and data cache
+    //  - rword: the beat holding the word of the original ARADDR is received,
+    //    rdata_blk carrying it ahead of the block completion
     ///////////////////////////////////////////////////////////////////////////
 
-    assign mst_rvalid = mem_rvalid;
-    assign mem_rready = mst_rready;
+    generate if (NB_BEAT>1) begin: BURST_READ
+
+        logic [BEAT_W       -1:0] rbeat_cnt;
+        logic [BEAT_W       -1:0] rbeat;
+        logic [CACHE_BLOCK_W-1:0] rblock;
+
+        // The first beat received is the block's first one for an INCR burst,
+        // the one of the address requested for a WRAP burst or an IO read
+        assign rbeat = ((AXI_WRAP>0 || arcache) ? araddr[BEAT_LSB_W+:BEAT_W] : {BEAT_W{1'b0}})
+                       + rbeat_cnt;
+
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                rbeat_cnt <= {BEAT_W{1'b0}};
+            end else if (srst) begin
+                rbeat_cnt <= {BEAT_W{1'b0}};
+            end else if (mem_rvalid && mem_rready) begin
+                if (rlast) rbeat_cnt <= {BEAT_W{1'b0}};
+                else       rbeat_cnt <= rbeat_cnt + 1'b1;
+            end
+        end
+
+        // Store the beats until the last one completing the block
+        always @ (posedge aclk) begin
+            if (mem_rvalid && mem_rready && !rlast)
+                rblock[rbeat*AXI_DATA_W+:AXI_DATA_W] <= mem_rdata;
+        end
+
+        always @ (*) begin
+            mst_rdata_blk = rblock;
+            mst_rdata_blk[rbeat*AXI_DATA_W+:AXI_DATA_W] = mem_rdata;
+        end
+
+        assign rlast = mem_rlast;
+
+        assign mst_rword = mem_rvalid & mem_rready & !rch_empty &
+                           rbeat==araddr[BEAT_LSB_W+:BEAT_W];
+
+    end else begin: SINGLE_READ
+
+        assign mst_rdata_blk = mem_rdata;
+
+        // A single beat, RLAST not being driven by an AXI4-lite memory
+        assign rlast = 1'b1;
+
+        assign mst_rword = mem_rvalid & mem_rready;
+
+    end
+    endgenerate
+
+    // The beats before the last one are always accepted
+    assign mst_rvalid = mem_rvalid & rlast;
+    assign mem_rready = mst_rready | !rlast;
     assign mst_rid = mem_rid ;
     assign mst_rresp = mem_rresp;
-    assign mst_rdata = mem_rdata[XLEN*roffset+:XLEN];
+    assign mst_rdata = mst_rdata_blk[XLEN*roffset+:XLEN];
     // custom signals
     assign mst_raddr = araddr;
     assign mst_rcache = (rch_empty) ? 1'b0 : arcache;
-    assign mst_rdata_blk = mem_rdata;
 
 
     ///////////////////////////////////////////////////////////////////////////
     // Write channels
     ///////////////////////////////////////////////////////////////////////////
-    generate if (RW_MODE) begin : WRITE_CHANNELS
+    generate if (RW_MODE && NB_BEAT>1) begin : BURST_WRITE_CHANNELS
+
+        logic [NB_BEAT      -1:0] wbeat_en;
+        logic [BEAT_W       -1:0] wbeat_first;
+        logic [BEAT_W       -1:0] wbeat_last;
+        logic [BEAT_W       -1:0] wbeat_cnt;
+        logic [BEAT_W       -1:0] wbeat;
+        logic                     aw_sent;
+
+        // The beats of the block enabled by the write strobes, the burst
+        // covering the first to the last of them
+        for (genvar i=0;i<NB_BEAT;i=i+1) begin: BEAT_EN
+            assign wbeat_en[i] = |mst_wstrb[i*AXI_DATA_W/8+:AXI_DATA_W/8];
+        end
 
-        // Write address channel
-        assign mem_awvalid = mst_awvalid & !wch_full;
-        assign mst_awready = mem_awready & !wch_full;
-        assign mem_awaddr = mst_awaddr;
-        // Single beat request
-        assign mem_awlen = 8'b0;
+        always @ (*) begin
+            wbeat_first = {BEAT_W{1'b0}};
+            wbeat_last = {BEAT_W{1'b0}};
+            for (int i=NB_BEAT-1;i>=0;i=i-1)
+                if (wbeat_en[i]) wbeat_first = i[BEAT_W-1:0];
+            for (int i=0;i<NB_BEAT;i=i+1)
+                if (wbeat_en[i]) wbeat_last = i[BEAT_W-1:0];
+        end
+
+        // Write address channel, issued once the data of the request is
+        // available to size the burst
+        assign mem_awvalid = mst_awvalid & mst_wvalid & !aw_sent;
+        assign mst_awready = mem_awready & mst_wvalid & !aw_sent;
+        assign mem_awaddr = {mst_awaddr[AXI_ADDR_W-1:ADDR_LSB_W], wbeat_first,
+                             mst_awaddr[BEAT_LSB_W-1:0]};
+        assign mem_awlen = {{(8-BEAT_W){1'b0}}, wbeat_last - wbeat_first};
         // No narrow request support
         assign mem_awsize = asize;
         // Always use INCR mode
@@ -338,66 +429,68 @@ module friscv_cache_memctrl
         assign mem_awregion = 4'b0;
         assign mem_awid = mst_awid;
 
-        // Write data channel
-        assign mem_wvalid = mst_wvalid & !wch_full;
-        assign mst_wready = mem_wready & !wch_full;
-        assign mem_wlast = 1'b1;
-        assign mem_wdata = {SCALE{mst_wdata}};
-
-        always @ (*) begin: GEN_WSTRB
-            for (int i=0;i<SCALE;i=i+1) begin
-                if (i==wr_strb_pos) begin: WSTRB_ON
-                    mem_wstrb[i*XLEN/8+:XLEN/8] = mst_wstrb;
-                end else begin: WSTRB_OFF
-                    mem_wstrb[i*XLEN/8+:XLEN/8] = {XLEN/8{1'b0}};
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                aw_sent <= 1'b0;
+                wbeat_cnt <= {BEAT_W{1'b0}};
+            end else if (srst) begin
+                aw_sent <= 1'b0;
+                wbeat_cnt <= {BEAT_W{1'b0}};
+            end else begin
+                if (mst_wvalid && mst_wready)
+                    aw_sent <= 1'b0;
+                else if (mem_awvalid && mem_awready)
+                    aw_sent <= 1'b1;
+
+                if (mem_wvalid && mem_wready) begin
+                    if (mem_wlast) wbeat_cnt <= {BEAT_W{1'b0}};
+                    else           wbeat_cnt <= wbeat_cnt + 1'b1;
                 end
             end
         end
 
+        // Write data channel, the block being released along the last beat
+        assign wbeat = wbeat_first + wbeat_cnt;
 
-        friscv_scfifo
-        #(
-            .PASS_THRU  (0),
-            .ADDR_WIDTH (NB_TAG_W),
-            .DATA_WIDTH (OFFSET_W)
-        )
-        wroffset_fifo
-        (
-            .aclk     (aclk),
-            .aresetn  (aresetn),
-            .srst     (srst),
-            .flush    (1'b0),
-            .data_in  (woffset),
-            .push     (push_woffset),
-            .full     (wch_full),
-            .afull    (),
-            .data_out (woffset_r),
-            .pull     (pull_woffset),
-            .empty    (wch_empty),
-            .aempty   (wch_aempty)
-        );
+        assign mem_wvalid = mst_wvalid & aw_sent;
+        assign mst_wready = mem_wready & aw_sent & mem_wlast;
+        assign mem_wlast = (wbeat==wbeat_last);
+        assign mem_wdata = mst_wdata[wbeat*AXI_DATA_W+:AXI_DATA_W];
+        assign mem_wstrb = mst_wstrb[wbeat*AXI_DATA_W/8+:AXI_DATA_W/8];
 
-        assign woffset = mst_awaddr[OFFSET_IX+:OFFSET_W];
+        // Write response channel
+        assign mst_bvalid = mem_bvalid;
+        assign mst_bresp = mem_bresp;
+        assign mst_bid = mem_bid;
+        assign mem_bready = mst_bready;
 
-        // Push in the FIFO if data channel not ready or if previous request on data channel has
-        // been stalled
-        assign push_woffset = mem_awvalid & mem_awready & (mem_wvalid & (!mem_wready | push_woffset_r));
-        assign pull_woffset = mem_wvalid & mem_wready & push_woffset_r;
-        assign wr_strb_pos = (wch_empty) ? woffset : woffset_r;
+    end else if (RW_MODE) begin : WRITE_CHANNELS
 
-        always @ (posedge aclk or negedge aresetn) begin
-            if (!aresetn) begin
-                push_woffset_r <= 1'b0;
-            end else if (srst) begin
-                push_woffset_r <= 1'b0;
-            end else begin
-                if (mem_awvalid && mem_awready && (mem_wvalid && !mem_wready)) begin
-                    push_woffset_r <= 1'b1;
-                end else if (wch_aempty && pull_woffset && !push_woffset) begin
-                    push_woffset_r <= 1'b0;
-                end
-            end
-        end
+        // Write address channel
+        assign mem_awvalid = mst_awvalid;
+        assign mst_awready = mem_awready;
+        assign mem_awaddr = mst_awaddr;
+        // Single beat request
+        assign mem_awlen = 8'b0;
+        // No narrow request support
+        assign mem_awsize = asize;
+        // Always use INCR mode
+        assign mem_awburst = 2'b1;
+        // Unused features
+        assign mem_awlock = 2'b0;
+        assign mem_awcache = 4'b0;
+        assign mem_awprot = mst_awprot;
+        assign mem_awqos = 4'b0;
+        assign mem_awregion = 4'b0;
+        assign mem_awid = mst_awid;
+
+        // Write data channel, the data being already placed in the block by
+        // the write sources
+        assign mem_wvalid = mst_wvalid;
+        assign mst_wready = mem_wready;
+        assign mem_wlast = 1'b1;
+        assign mem_wdata = mst_wdata;
+        assign mem_wstrb = mst_wstrb;
 
         // Write response channel
         assign mst_bvalid = mem_bvalid;
@@ -423,15 +516,6 @@ module friscv_cache_memctrl
         assign mem_wdata = {AXI_DATA_W{1'b0}};
         assign mem_wstrb = {AXI_DATA_W/8{1'b0}};
         assign mem_bready = 1'b1;
-        assign wr_strb_pos = {OFFSET_W{1'b0}};
-        assign woffset = {OFFSET_W{1'b0}};
-        assign woffset_r = {OFFSET_W{1'b0}};
-        assign wch_full = 1'b0;
-        assign wch_empty = 1'b0;
-        assign wch_aempty = 1'b0;
-        assign push_woffset = 1'b0;
-        assign push_woffset_r = 1'b0;
-        assign pull_woffset = 1'b0;
     end
     endgenerate
 
@@ -224,7 +224,7 @@ module friscv_cache_ooo_mgt
                         cpl_ram[i] <= {cpl2_resp, cpl2_data};
                     else 
                         cpl_ram[i] <= cpl2_resp;
-                else if (cpl1_valid && cpl1_ready && cpl1_id_m==i)
+                if (cpl1_valid && cpl1_ready && cpl1_id_m==i)
                     if (CPL_PAYLOAD)
                         cpl_ram[i] <= {cpl1_resp, cpl1_data};
                     else 
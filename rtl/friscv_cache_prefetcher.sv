@@ -4,12 +4,23 @@
 `timescale 1 ns / 1 ps
 `default_nettype none
 `include "friscv_h.sv"
+`include "friscv_checkers.sv"
 
 ///////////////////////////////////////////////////////////////////////////
 //
 // Prefetcher stage: manages the read request on cache miss and speculative
 // load
 //
+// - next-line prefetch: a miss prefetches the next blocks
+// - stride prefetch: a table indexed by the PC of the loads learns the
+//   distance between the consecutive accesses of an instruction. Once the
+//   same stride has been observed twice, the blocks ahead of the stream are
+//   prefetched
+// - the prefetches are issued one by one, a miss having the priority, and
+//   only inside the 4KB page of the access which triggered them
+// - the last prefetched blocks are recorded to filter the duplicated
+//   prefetches, a load accessing one of them being counted as useful
+//
 ///////////////////////////////////////////////////////////////////////////
 
 
@@ -45,7 +56,17 @@ module friscv_cache_prefetcher
         // Enable automatic prefetch in memory controller
         parameter CACHE_PREFETCH_EN = 0,
         // Block width defining only the data payload, in bits
-        parameter CACHE_BLOCK_W = 128
+        parameter CACHE_BLOCK_W = 128,
+        // Read the missing blocks, 0 if read by the fetcher's MSHRs, only the
+        // prefetches being issued
+        parameter MISS_FETCH = 1,
+        // ID of the prefetches
+        parameter PREFETCH_ID = 'h11,
+        // Number of entries of the stride table, indexed by the load PC,
+        // 0 disables the stride prefetch. A power of two
+        parameter STRIDE_TABLE = 0,
+        // Number of blocks prefetched ahead of an access
+        parameter PREFETCH_DEGREE = 1
     )(
         // Clock / Reset
         input  wire                       aclk,
@@ -67,7 +88,14 @@ module friscv_cache_prefetcher
         input  wire  [3             -1:0] cache_rprot,
         input  wire  [ILEN          -1:0] cache_rdata,
         input  wire                       cache_hit,
-        input  wire                       cache_miss
+        input  wire                       cache_miss,
+        // Loads accepted by the cache, training the stride table
+        input  wire                       train_valid,
+        input  wire  [AXI_ADDR_W    -1:0] train_addr,
+        input  wire  [XLEN          -1:0] train_pc,
+        // Performance events, prefetches issued and used by a load
+        output logic                      perf_pf_issue,
+        output logic                      perf_pf_useful
     );
 
     ///////////////////////////////////////////////////////////////////////////
@@ -75,8 +103,18 @@ module friscv_cache_prefetcher
     ///////////////////////////////////////////////////////////////////////////
 
     // Lowest part of the address replaced by 0 to access a complete cache block
-    // (AXI_DATA_W = CACHE_BLOCK_W is the only setup supported)
-    localparam ADDR_LSB_W = $clog2(AXI_DATA_W/8);
+    localparam ADDR_LSB_W = $clog2(CACHE_BLOCK_W/8);
+
+    localparam BLOCK_BYTES = CACHE_BLOCK_W/8;
+
+    // The prefetches don't cross the page of the access triggering them
+    localparam PAGE_W = 12;
+
+    // Number of prefetched blocks recorded
+    localparam FILTER_NB = 8;
+    localparam FILTER_W = $clog2(FILTER_NB);
+
+    localparam DEGREE_W = $clog2(PREFETCH_DEGREE+1);
 
     // Control fsm, the sequencer driving the cache read and the memory controller
     typedef enum logic[1:0] {
@@ -92,9 +130,33 @@ module friscv_cache_prefetcher
     logic [AXI_ID_W     -1:0] arid_ffd;
     logic [3            -1:0] arprot_ffd;
 
-    logic                     fetch_next;
-    logic [AXI_ADDR_W   -1:0] next_addr;
     logic [AXI_ADDR_W   -1:0] addr_to_fetch;
+    logic                     miss_fetch;
+
+    // Prefetch generator, walking the blocks ahead of an access
+    logic                     pf_valid;
+    logic [AXI_ADDR_W   -1:0] pf_addr;
+    logic [AXI_ADDR_W   -1:0] pf_step;
+    logic [AXI_ADDR_W   -1:0] pf_page;
+    logic [3            -1:0] pf_prot;
+    logic [DEGREE_W     -1:0] pf_cnt;
+    logic [AXI_ADDR_W   -1:0] pf_block;
+    logic                     pf_in_page;
+    logic                     pf_filtered;
+    logic                     pf_issue;
+    logic                     pf_next;
+
+    // Stream detected by the stride table
+    logic                     stride_trig;
+    logic [AXI_ADDR_W   -1:0] stride_addr;
+    logic [AXI_ADDR_W   -1:0] stride_step;
+
+    // Prefetched blocks not yet accessed
+    logic [FILTER_NB    -1:0] filter_valid;
+    logic [AXI_ADDR_W   -1:0] filter_addr [FILTER_NB-1:0];
+    logic [FILTER_W     -1:0] filter_ptr;
+    logic [FILTER_NB    -1:0] filter_pf_hit;
+    logic [FILTER_NB    -1:0] filter_train_hit;
 
     // Tracer setup
     `ifdef TRACE_CACHE
@@ -106,6 +168,15 @@ module friscv_cache_prefetcher
     end
     `endif
 
+    ///////////////////////////////////////////////////////////////////////////
+    // Parameters setup checks
+    ///////////////////////////////////////////////////////////////////////////
+
+    initial begin
+        `CHECKER(((STRIDE_TABLE & (STRIDE_TABLE-1)) != 0), "STRIDE_TABLE must be 0 or a power of two");
+        `CHECKER((PREFETCH_DEGREE < 1), "PREFETCH_DEGREE must be greater than 0");
+    end
+
     ///////////////////////////////////////////////////////////////////////////
     // Buffering stage
     ///////////////////////////////////////////////////////////////////////////
@@ -127,9 +198,208 @@ module friscv_cache_prefetcher
             arprot_ffd <= cache_rprot;
         end
     end
-    
+
     assign addr_to_fetch = {araddr_ffd[AXI_ADDR_W-1:ADDR_LSB_W],{ADDR_LSB_W{1'b0}}};
 
+    // A miss is read by this stage, else by the fetcher's MSHRs
+    assign miss_fetch = cache_miss && MISS_FETCH;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Stride table, direct-mapped by the load PC. An entry stores the last
+    // address accessed by a load, the distance with the previous access and a
+    // 2 bits saturating confidence. The stride is replaced only when the
+    // confidence dropped, a single irregular access not breaking a stream.
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (STRIDE_TABLE > 0) begin: STRIDE_DETECTION
+
+        localparam IX_W = (STRIDE_TABLE>1) ? $clog2(STRIDE_TABLE) : 1;
+
+        logic [STRIDE_TABLE -1:0] st_valid;
+        logic [XLEN         -1:0] st_pc [STRIDE_TABLE-1:0];
+        logic [AXI_ADDR_W   -1:0] st_addr [STRIDE_TABLE-1:0];
+        logic [AXI_ADDR_W   -1:0] st_stride [STRIDE_TABLE-1:0];
+        logic [2            -1:0] st_conf [STRIDE_TABLE-1:0];
+
+        logic [IX_W         -1:0] ix;
+        logic                     st_hit;
+        logic [AXI_ADDR_W   -1:0] new_stride;
+        logic [AXI_ADDR_W   -1:0] stride_abs;
+        logic                     same_stride;
+
+        assign ix = (STRIDE_TABLE>1) ? train_pc[2+:IX_W] : {IX_W{1'b0}};
+
+        assign st_hit = st_valid[ix] && st_pc[ix]==train_pc;
+        assign new_stride = train_addr - st_addr[ix];
+        assign same_stride = new_stride==st_stride[ix] && new_stride!={AXI_ADDR_W{1'b0}};
+
+        // A stride shorter than a block moves to the next/previous block
+        assign stride_abs = (new_stride[AXI_ADDR_W-1]) ? ~new_stride + 1'b1 : new_stride;
+
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                st_valid <= '0;
+                stride_trig <= 1'b0;
+                stride_addr <= {AXI_ADDR_W{1'b0}};
+                stride_step <= {AXI_ADDR_W{1'b0}};
+            end else if (srst) begin
+                st_valid <= '0;
+                stride_trig <= 1'b0;
+                stride_addr <= {AXI_ADDR_W{1'b0}};
+                stride_step <= {AXI_ADDR_W{1'b0}};
+            end else begin
+
+                if (train_valid)
+                    st_valid[ix] <= 1'b1;
+
+                // A stream is detected once the same stride is seen twice
+                stride_trig <= train_valid && st_hit && same_stride;
+                stride_addr <= train_addr;
+
+                if (stride_abs < BLOCK_BYTES)
+                    stride_step <= (new_stride[AXI_ADDR_W-1]) ? -BLOCK_BYTES : BLOCK_BYTES;
+                else
+                    stride_step <= new_stride;
+            end
+        end
+
+        always @ (posedge aclk) begin
+
+            if (train_valid) begin
+
+                st_pc[ix] <= train_pc;
+                st_addr[ix] <= train_addr;
+
+                if (!st_hit) begin
+                    st_stride[ix] <= {AXI_ADDR_W{1'b0}};
+                    st_conf[ix] <= 2'h0;
+                end else if (same_stride) begin
+                    if (st_conf[ix]!=2'h3)
+                        st_conf[ix] <= st_conf[ix] + 1'b1;
+                end else begin
+                    if (st_conf[ix]!=2'h0)
+                        st_conf[ix] <= st_conf[ix] - 1'b1;
+                    if (st_conf[ix]<2'h2)
+                        st_stride[ix] <= new_stride;
+                end
+            end
+        end
+
+    end else begin: NO_STRIDE_DETECTION
+
+        assign stride_trig = 1'b0;
+        assign stride_addr = {AXI_ADDR_W{1'b0}};
+        assign stride_step = {AXI_ADDR_W{1'b0}};
+
+    end
+    endgenerate
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Prefetch generator, loaded by a stream detected or a miss, then issuing
+    // the blocks ahead one by one. The blocks already prefetched are skipped
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign pf_block = {pf_addr[AXI_ADDR_W-1:ADDR_LSB_W],{ADDR_LSB_W{1'b0}}};
+
+    assign pf_in_page = pf_addr[AXI_ADDR_W-1:PAGE_W]==pf_page[AXI_ADDR_W-1:PAGE_W];
+
+    assign pf_filtered = |filter_pf_hit;
+
+    // Issue a prefetch if the memory controller is free and not reading a miss
+    assign pf_issue = pf_valid && pf_in_page && !pf_filtered && loader==IDLE && !miss_fetch;
+
+    // Move to the next block once issued or skipped
+    assign pf_next = pf_issue || pf_valid && (pf_filtered || !pf_in_page);
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            pf_valid <= 1'b0;
+            pf_addr <= {AXI_ADDR_W{1'b0}};
+            pf_step <= {AXI_ADDR_W{1'b0}};
+            pf_page <= {AXI_ADDR_W{1'b0}};
+            pf_prot <= 3'b0;
+            pf_cnt <= '0;
+        end else if (srst) begin
+            pf_valid <= 1'b0;
+            pf_addr <= {AXI_ADDR_W{1'b0}};
+            pf_step <= {AXI_ADDR_W{1'b0}};
+            pf_page <= {AXI_ADDR_W{1'b0}};
+            pf_prot <= 3'b0;
+            pf_cnt <= '0;
+        end else begin
+
+            if (stride_trig) begin
+                pf_valid <= 1'b1;
+                pf_addr <= stride_addr + stride_step;
+                pf_step <= stride_step;
+                pf_page <= stride_addr;
+                pf_prot <= arprot_ffd;
+                pf_cnt <= PREFETCH_DEGREE;
+            end else if (cache_miss && CACHE_PREFETCH_EN) begin
+                pf_valid <= 1'b1;
+                pf_addr <= addr_to_fetch + BLOCK_BYTES;
+                pf_step <= BLOCK_BYTES;
+                pf_page <= addr_to_fetch;
+                pf_prot <= arprot_ffd;
+                pf_cnt <= PREFETCH_DEGREE;
+            end else if (pf_next) begin
+                pf_addr <= pf_addr + pf_step;
+                pf_cnt <= pf_cnt - 1'b1;
+                if (pf_cnt==1 || !pf_in_page)
+                    pf_valid <= 1'b0;
+            end
+        end
+    end
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Prefetch filter, recording the last blocks prefetched. A load accessing
+    // one of them releases the entry and is counted as a useful prefetch
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (genvar i=0;i<FILTER_NB;i=i+1) begin: FILTER
+
+        assign filter_pf_hit[i] = filter_valid[i] && filter_addr[i]==pf_block;
+
+        assign filter_train_hit[i] = filter_valid[i] &&
+                    filter_addr[i][AXI_ADDR_W-1:ADDR_LSB_W]==train_addr[AXI_ADDR_W-1:ADDR_LSB_W];
+    end
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            filter_valid <= '0;
+            filter_ptr <= '0;
+        end else if (srst) begin
+            filter_valid <= '0;
+            filter_ptr <= '0;
+        end else begin
+
+            if (pf_issue)
+                filter_ptr <= filter_ptr + 1'b1;
+
+            for (int i=0;i<FILTER_NB;i=i+1) begin
+                if (pf_issue && filter_ptr==i[FILTER_W-1:0])
+                    filter_valid[i] <= 1'b1;
+                else if (train_valid && filter_train_hit[i])
+                    filter_valid[i] <= 1'b0;
+            end
+        end
+    end
+
+    always @ (posedge aclk) begin
+        if (pf_issue)
+            filter_addr[filter_ptr] <= pf_block;
+    end
+
+    assign perf_pf_issue = pf_issue;
+    assign perf_pf_useful = train_valid && |filter_train_hit;
+
+
     ///////////////////////////////////////////////////////////////////////////
     // Memory controller management and prefetch stage
     ///////////////////////////////////////////////////////////////////////////
@@ -141,19 +411,15 @@ module friscv_cache_prefetcher
         if (!aresetn) begin
             memctrl_arvalid <= 1'b0;
             memctrl_araddr <= {AXI_ADDR_W{1'b0}};
-            next_addr <= {AXI_ADDR_W{1'b0}};
             memctrl_arid <= {AXI_ID_W{1'b0}};
             memctrl_arprot <= 3'b0;
-            fetch_next <= 1'b0;
             block_fill <= 1'b0;
             loader <= IDLE;
         end else if (srst) begin
             memctrl_arvalid <= 1'b0;
             memctrl_araddr <= {AXI_ADDR_W{1'b0}};
-            next_addr <= {AXI_ADDR_W{1'b0}};
             memctrl_arid <= {AXI_ID_W{1'b0}};
             memctrl_arprot <= 3'b0;
-            fetch_next <= 1'b0;
             block_fill <= 1'b0;
             loader <= IDLE;
         end else begin
@@ -162,27 +428,23 @@ module friscv_cache_prefetcher
 
                 // Wait for the address requests from the instruction fetcher
                 default: begin
-                    if (cache_miss) begin
+                    if (miss_fetch) begin
                         memctrl_arvalid <= 1'b1;
-                        // Always fetch a complete cache blocks
-                        // TODO: Adapt based on cache block vs axi data width
-                        memctrl_araddr <= addr_to_fetch;
+                        // Request the word missing, the memory controller
+                        // reading its whole block, starting from it with a
+                        // WRAP burst
+                        memctrl_araddr <= araddr_ffd;
                         memctrl_arid <= arid_ffd;
                         memctrl_arprot <= arprot_ffd;
-                        if (addr_to_fetch != next_addr) begin
-                            next_addr <= addr_to_fetch + CACHE_BLOCK_W/8;
-                        end else begin
-                            next_addr <= next_addr + CACHE_BLOCK_W/8;
-                        end 
-                        if (CACHE_PREFETCH_EN)
-                            fetch_next <= 1'b1;
-                        else
-                            fetch_next <= 1'b0;
                         loader <= LOAD;
-                    end else if (fetch_next) begin
+                    end else if (pf_issue) begin
+                        `ifdef TRACE_CACHE
+                        $fwrite(f, "@ %0t: Prefetch - Addr=0x%x\n", $realtime, pf_block);
+                        `endif
                         memctrl_arvalid <= 1'b1;
-                        memctrl_araddr <= next_addr;
-                        fetch_next <= 1'b0;
+                        memctrl_araddr <= pf_block;
+                        memctrl_arid <= PREFETCH_ID;
+                        memctrl_arprot <= pf_prot;
                         loader <= LOAD;
                     end else begin
                         memctrl_arvalid <= 1'b0;
@@ -201,21 +463,18 @@ module friscv_cache_prefetcher
                         memctrl_arvalid <= 1'b0;
                     end
 
-                    if (fetch_next) fetch_next <= 1'b0;
-                    if (!fetch_next && mem_cpl_wr) block_fill <= 1'b1;
-
                     // Go to read the cache lines once the memory controller
                     // wrote a new cache line, being the read completion
                     if (mem_cpl_wr) begin
                         `ifdef TRACE_CACHE
                         $fwrite(f, "@ %0t: Read completion received\n", $realtime);
                         `endif
+                        block_fill <= 1'b1;
                         loader <= FETCH;
                     end
-                end 
+                end
 
                 // Wait state, once write has been deasserted
-                // IF prefetch mode enabled, compute the next address
                 FETCH: begin
 
                     block_fill <= 1'b0;
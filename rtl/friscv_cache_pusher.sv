@@ -37,7 +37,15 @@ module friscv_cache_pusher
         ///////////////////////////////////////////////////////////////////////
 
         // Block width defining only the data payload, in bits
-        parameter CACHE_BLOCK_W = 128
+        parameter CACHE_BLOCK_W = 128,
+        // Write policy, 0 = write-through, 1 = write-back with write-allocate
+        parameter WRITE_BACK = 0,
+        // Merge the consecutive writes to a same block into a single request
+        parameter WRITE_COMBINE = 0,
+        // Number of idle cycles before writing a combined block
+        parameter WC_TIMEOUT = 16,
+        // ID used to refill a block on a store miss and by the combined writes
+        parameter OWN_ID = 'h28
     )(
         // Global interface
         input  wire                            aclk,
@@ -68,13 +76,31 @@ module friscv_cache_pusher
         output logic [AXI_ID_W           -1:0] memctrl_awid,
         output logic                           memctrl_wvalid,
         input  wire                            memctrl_wready,
-        output logic [XLEN               -1:0] memctrl_wdata,
-        output logic [XLEN/8             -1:0] memctrl_wstrb,
+        output logic [CACHE_BLOCK_W      -1:0] memctrl_wdata,
+        output logic [CACHE_BLOCK_W/8    -1:0] memctrl_wstrb,
         input  wire                            memctrl_bvalid,
         output logic                           memctrl_bready,
         input  wire  [AXI_ID_W           -1:0] memctrl_bid,
         input  wire  [2                  -1:0] memctrl_bresp, 
 
+        // Drain request of the combined writes (FENCE) and status
+        input  wire                            drain,
+        output logic                           drained,
+
+        // Block read hazard check, a block can't be read while its combined
+        // write is pending
+        input  wire                            rd_valid,
+        input  wire  [AXI_ADDR_W         -1:0] rd_addr,
+        output logic                           rd_hazard,
+
+        // Block refill on a store miss (write-back only)
+        output logic                           refill_arvalid,
+        input  wire                            refill_arready,
+        output logic [AXI_ADDR_W         -1:0] refill_araddr,
+        output logic [AXI_ID_W           -1:0] refill_arid,
+        input  wire                            block_fill,
+        input  wire  [AXI_ADDR_W         -1:0] block_addr,
+
         // Cache block interface
         output logic                           cache_ren,
         output logic [AXI_ADDR_W         -1:0] cache_raddr,
@@ -97,6 +123,19 @@ module friscv_cache_pusher
     parameter SCALE_W = $clog2(SCALE);
     parameter OSTDREQ_W = $clog2(OSTDREQ_NUM);
 
+    // Lowest part of the address replaced by 0 to access a complete block
+    localparam ADDR_LSB_W = $clog2(CACHE_BLOCK_W/8);
+
+    // Lookup replay and store miss servicing (write-back only)
+    typedef enum logic[1:0] {
+        IDLE = 0,
+        REFILL = 1,
+        FILL = 2,
+        REPLAY = 3
+    } miss_fsm;
+
+    miss_fsm mfsm;
+
     logic                       addr_fifo_empty;
     logic                       addr_fifo_full;
     logic                       addr_fifo_afull;
@@ -105,7 +144,6 @@ module friscv_cache_pusher
     logic                       data_fifo_afull;
     logic                       resp_fifo_full;
     logic                       resp_fifo_empty;
-    logic [XLEN/8         -1:0] wstrb;
 
     logic [AXI_ID_W       -1:0] cache_rid;
     logic [AXI_ID_W       -1:0] cpl_bid;
@@ -119,6 +157,19 @@ module friscv_cache_pusher
     logic                       to_cpl;
     logic                       awready;
     logic                       wready;
+    logic                       accept;
+    logic                       lookup;
+    logic                       lookup_stall;
+    logic                       wt_push;
+    logic                       cache_io;
+    // Requests to the address/data FIFOs
+    logic                       push_fifo;
+    logic [AXI_ADDR_W     -1:0] fifo_addr;
+    logic [AXI_ID_W       -1:0] fifo_id;
+    logic [CACHE_BLOCK_W     -1:0] fifo_data;
+    logic [CACHE_BLOCK_W/8   -1:0] fifo_strb;
+    logic                       posted_b;
+    logic                       posted_full;
 
     // Tracer setup
     `ifdef TRACE_CACHE
@@ -138,8 +189,15 @@ module friscv_cache_pusher
     //
     ///////////////////////////////////////////////////////////////////////////
 
+    assign accept = mst_awvalid && mst_awready && mst_wvalid && mst_wready;
+
+    // With write-back, only the IO requests are written to the memory, the
+    // cachable ones update the cache blocks
+    assign wt_push = !WRITE_BACK || mst_awcache[1];
+
     // Monitor the write requests and drive the cache block updater. Acts as a pipeline
-    // of the incoming write request to check if the data needs to be updated in a cache block
+    // of the incoming write request to check if the data needs to be updated in a cache block.
+    // The request is held while a store miss is serviced.
     always @ (posedge aclk or negedge aresetn) begin
 
         if (!aresetn) begin
@@ -148,33 +206,39 @@ module friscv_cache_pusher
             cache_wdata <= '0;
             cache_wstrb <= '0;
             push_addr_data <= '0;
-            wstrb <= '0;
+            cache_io <= '0;
+            lookup <= '0;
         end else if (srst) begin
             cache_waddr <= '0;
             cache_rid <= '0;
             cache_wdata <= '0;
             cache_wstrb <= '0;
             push_addr_data <= '0;
-            wstrb <= '0;
+            cache_io <= '0;
+            lookup <= '0;
         end else begin
 
-            push_addr_data <= mst_awvalid && awready && mst_wvalid && wready;
-            cache_waddr <= mst_awaddr;
-            cache_rid <= mst_awid;
-            cache_wdata <= {SCALE{mst_wdata}};
-            wstrb <= mst_wstrb;
-
-            for (int i=0;i<SCALE;i=i+1) begin
-                if (mst_awaddr[2+:SCALE_W]==i[SCALE_W-1:0])
-                    cache_wstrb[i*XLEN/8+:XLEN/8] <= mst_wstrb;
-                else
-                    cache_wstrb[i*XLEN/8+:XLEN/8] <= {XLEN/8{1'b0}};
+            push_addr_data <= accept && wt_push;
+            lookup <= cache_ren;
+
+            if (accept) begin
+                cache_waddr <= mst_awaddr;
+                cache_rid <= mst_awid;
+                cache_wdata <= {SCALE{mst_wdata}};
+                cache_io <= mst_awcache[1];
+
+                for (int i=0;i<SCALE;i=i+1) begin
+                    if (mst_awaddr[2+:SCALE_W]==i[SCALE_W-1:0])
+                        cache_wstrb[i*XLEN/8+:XLEN/8] <= mst_wstrb;
+                    else
+                        cache_wstrb[i*XLEN/8+:XLEN/8] <= {XLEN/8{1'b0}};
+                end
             end
         end
     end
 
-    assign cache_ren = mst_awvalid && mst_awready && mst_wvalid && mst_wready && !mst_awcache[1];
-    assign cache_raddr = mst_awaddr;
+    assign cache_ren = accept && !mst_awcache[1] || mfsm==REPLAY;
+    assign cache_raddr = (mfsm==REPLAY) ? cache_waddr : mst_awaddr;
     assign cache_wen = cache_hit;
 
     `ifdef TRACE_CACHE
@@ -189,11 +253,228 @@ module friscv_cache_pusher
     `endif
 
 
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // A lookup not serviced, the cache blocks port being used by the block
+    // fetcher, is replayed.
+    //
+    // Write-back policy: a store hit only updates the cache block, marked as
+    // dirty, and completes immediately. A store miss allocates the block, the
+    // request being held until the block is read from the memory. The store
+    // is then replayed as a hit.
+    //
+    // A new request can't be accepted until the lookup of the previous one
+    // completes.
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            refill_arvalid <= 1'b0;
+            refill_araddr <= '0;
+            mfsm <= IDLE;
+        end else if (srst) begin
+            refill_arvalid <= 1'b0;
+            refill_araddr <= '0;
+            mfsm <= IDLE;
+        end else begin
+
+            if (refill_arvalid && refill_arready)
+                refill_arvalid <= 1'b0;
+
+            case (mfsm)
+
+                // Wait for a lookup missing the cache or not serviced
+                default: begin
+                    if (lookup && cache_miss && WRITE_BACK) begin
+                        mfsm <= REFILL;
+                    end else if (lookup && !cache_hit && !cache_miss) begin
+                        mfsm <= REPLAY;
+                    end
+                end
+
+                // Read the missing block, once the previous refill
+                // has been issued
+                REFILL: begin
+                    if (!refill_arvalid || refill_arready) begin
+                        `ifdef TRACE_CACHE
+                        $fwrite(f, "@ %0t: Store miss, refill 0x%x\n", $realtime, cache_waddr);
+                        `endif
+                        refill_arvalid <= 1'b1;
+                        refill_araddr <= {cache_waddr[AXI_ADDR_W-1:ADDR_LSB_W], {ADDR_LSB_W{1'b0}}};
+                        mfsm <= FILL;
+                    end
+                end
+
+                // Wait for the block to be written in the cache, whoever
+                // requested it
+                FILL: begin
+                    if (block_fill && block_addr[AXI_ADDR_W-1:ADDR_LSB_W]==cache_waddr[AXI_ADDR_W-1:ADDR_LSB_W]) begin
+                        mfsm <= REPLAY;
+                    end
+                end
+
+                // Lookup again the cache, the store updating the block
+                // if hit
+                REPLAY: begin
+                    mfsm <= IDLE;
+                end
+            endcase
+        end
+    end
+
+    assign refill_arid = OWN_ID;
+
+    assign lookup_stall = (mfsm!=IDLE) ||
+                      lookup && !cache_hit && (cache_miss && WRITE_BACK || !cache_miss);
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Write combining: the cachable writes to a same block are merged in a
+    // buffer then issued as a single request, completed as soon as the
+    // cache lookup is done. The buffer is written to the memory once all
+    // the block's bytes are written, after WC_TIMEOUT idle cycles, when a
+    // write targets another block or an IO region, on a drain request or if
+    // the block needs to be read. An IO write goes through the buffer
+    // without being merged and completes with the memory response.
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (WRITE_COMBINE) begin: WRITE_COMBINING
+
+        localparam TIMER_W = $clog2(WC_TIMEOUT+1);
+        localparam POSTED_W = OSTDREQ_W + 2;
+
+        logic                       wc_valid;
+        logic                       wc_io;
+        logic [AXI_ADDR_W     -1:0] wc_addr;
+        logic [AXI_ID_W       -1:0] wc_id;
+        logic [CACHE_BLOCK_W     -1:0] wc_data;
+        logic [CACHE_BLOCK_W/8   -1:0] wc_strb;
+        logic [TIMER_W        -1:0] wc_timer;
+        logic                       wc_merge;
+        logic                       wc_rd_match;
+        logic                       wc_drain;
+        logic                       wc_push;
+        logic [POSTED_W       -1:0] posted_cnt;
+
+        assign wc_rd_match = rd_valid && wc_valid && !wc_io &&
+                             wc_addr[AXI_ADDR_W-1:ADDR_LSB_W]==rd_addr[AXI_ADDR_W-1:ADDR_LSB_W];
+
+        // Same block, both cachable. A block to drain for a FENCE or a read
+        // is not merged anymore to not be held by a continuous stores' flow
+        assign wc_merge = wc_valid && !wc_io && !cache_io && !drain && !wc_rd_match &&
+                          wc_addr[AXI_ADDR_W-1:ADDR_LSB_W]==cache_waddr[AXI_ADDR_W-1:ADDR_LSB_W];
+
+        assign wc_drain = wc_valid && (wc_io || (&wc_strb) || wc_timer==WC_TIMEOUT[TIMER_W-1:0] ||
+                                       drain || wc_rd_match);
+
+        // The buffer is written in the FIFOs when replaced by a new request
+        // (the FIFOs' space being checked on acceptance) or when drained
+        // while no new request comes in
+        assign wc_push = !push_addr_data && wc_drain && !addr_fifo_full && !data_fifo_full;
+
+        assign push_fifo = push_addr_data && wc_valid && !wc_merge || wc_push;
+
+        always @ (posedge aclk or negedge aresetn) begin
+
+            if (!aresetn) begin
+                wc_valid <= 1'b0;
+                wc_io <= 1'b0;
+                wc_addr <= '0;
+                wc_id <= '0;
+                wc_data <= '0;
+                wc_strb <= '0;
+                wc_timer <= '0;
+                posted_cnt <= '0;
+            end else if (srst) begin
+                wc_valid <= 1'b0;
+                wc_io <= 1'b0;
+                wc_addr <= '0;
+                wc_id <= '0;
+                wc_data <= '0;
+                wc_strb <= '0;
+                wc_timer <= '0;
+                posted_cnt <= '0;
+            end else begin
+
+                if (push_addr_data) begin
+                    wc_valid <= 1'b1;
+                    wc_timer <= '0;
+                    // Merge the bytes written in the block
+                    if (wc_merge) begin
+                        for (int i=0;i<CACHE_BLOCK_W/8;i=i+1)
+                            if (cache_wstrb[i]) wc_data[i*8+:8] <= cache_wdata[i*8+:8];
+                        wc_strb <= wc_strb | cache_wstrb;
+                    // Or start a new block
+                    end else begin
+                        wc_io <= cache_io;
+                        wc_addr <= cache_waddr;
+                        wc_id <= cache_rid;
+                        wc_data <= cache_wdata;
+                        wc_strb <= cache_wstrb;
+                    end
+                end else if (wc_push) begin
+                    wc_valid <= 1'b0;
+                end else if (wc_valid && !wc_drain) begin
+                    wc_timer <= wc_timer + 1'b1;
+                end
+
+                // Count the combined writes waiting for their response
+                if ((push_fifo && !wc_io) && !(memctrl_bvalid && memctrl_bready && posted_b))
+                    posted_cnt <= posted_cnt + 1'b1;
+                else if (!(push_fifo && !wc_io) && (memctrl_bvalid && memctrl_bready && posted_b))
+                    posted_cnt <= posted_cnt - 1'b1;
+            end
+        end
+
+        // An IO write keeps its address and ID, a combined write is
+        // block-aligned and issued with the pusher's own ID
+        assign fifo_addr = (wc_io) ? wc_addr : {wc_addr[AXI_ADDR_W-1:ADDR_LSB_W], {ADDR_LSB_W{1'b0}}};
+        assign fifo_id = (wc_io) ? wc_id : OWN_ID;
+        assign fifo_data = wc_data;
+        assign fifo_strb = wc_strb;
+
+        assign posted_b = (memctrl_bid==OWN_ID);
+
+        // A block read waits for the buffer and the combined writes to be
+        // written in the memory
+        assign rd_hazard = wc_rd_match || posted_cnt!={POSTED_W{1'b0}};
+        assign drained = !wc_valid && posted_cnt=={POSTED_W{1'b0}};
+        // Stop accepting while the posted writes counter could overflow
+        assign posted_full = posted_cnt[POSTED_W-1];
+
+        `ifdef TRACE_CACHE
+        always @ (posedge aclk) begin
+            if (aresetn && push_fifo && !wc_io)
+                $fwrite(f, "@ %0t: Combined write 0x%x, strb 0x%x\n", $realtime, fifo_addr, fifo_strb);
+        end
+        `endif
+
+    end else begin: NO_WRITE_COMBINING
+
+        assign push_fifo = push_addr_data;
+        assign fifo_addr = cache_waddr;
+        assign fifo_id = cache_rid;
+        assign fifo_data = cache_wdata;
+        assign fifo_strb = cache_wstrb;
+        assign posted_b = 1'b0;
+        assign posted_full = 1'b0;
+        assign rd_hazard = 1'b0;
+        assign drained = 1'b1;
+
+    end
+    endgenerate
+
+
     ///////////////////////////////////////////////////////////////////////////
     //
     // Address, data & resp FIFOs to manage outstanding requests to the memory
-    // controller. Apply a strict write-through policy, any access in cache
-    // blocks is transmitted to the main memory.
+    // controller. With write-through, any access in cache blocks is
+    // transmitted to the main memory.
     //
     ///////////////////////////////////////////////////////////////////////////
 
@@ -209,8 +490,8 @@ module friscv_cache_pusher
         .aresetn  (aresetn),
         .srst     (srst),
         .flush    (1'b0),
-        .data_in  ({cache_rid, cache_waddr}),
-        .push     (push_addr_data),
+        .data_in  ({fifo_id, fifo_addr}),
+        .push     (push_fifo),
         .full     (addr_fifo_full),
         .afull    (addr_fifo_afull),
         .data_out ({memctrl_awid, memctrl_awaddr}),
@@ -219,14 +500,15 @@ module friscv_cache_pusher
         .aempty   ()
     );
 
-    assign awready = !addr_fifo_full && !addr_fifo_afull;
+    assign awready = !addr_fifo_full && !addr_fifo_afull && !posted_full;
     assign memctrl_awvalid = !addr_fifo_empty;
 
+    // The data and strobes are placed in the block written to the memory
     friscv_scfifo
     #(
         .PASS_THRU  (0),
         .ADDR_WIDTH ($clog2(OSTDREQ_NUM)),
-        .DATA_WIDTH (XLEN + XLEN/8)
+        .DATA_WIDTH (CACHE_BLOCK_W + CACHE_BLOCK_W/8)
     )
     data_fifo
     (
@@ -234,8 +516,8 @@ module friscv_cache_pusher
         .aresetn  (aresetn),
         .srst     (srst),
         .flush    (1'b0),
-        .data_in  ({wstrb, cache_wdata[0+:XLEN]}),
-        .push     (push_addr_data),
+        .data_in  ({fifo_strb, fifo_data}),
+        .push     (push_fifo),
         .full     (data_fifo_full),
         .afull    (data_fifo_afull),
         .data_out ({memctrl_wstrb, memctrl_wdata}),
@@ -248,8 +530,8 @@ module friscv_cache_pusher
     assign memctrl_wvalid = !data_fifo_empty;
     assign memctrl_awprot = 3'b0;
     
-    assign mst_awready = awready & wready;
-    assign mst_wready = awready & wready;
+    assign mst_awready = awready & wready & !lookup_stall;
+    assign mst_wready = awready & wready & !lookup_stall;
 
     /////////////////////////////////////////////////////////////////////////////////
     //
@@ -290,7 +572,7 @@ module friscv_cache_pusher
     assign req_id_m = (cache_miss) ? cache_rid ^ AXI_ID_MASK : mst_awid ^ AXI_ID_MASK;
     // Used to check if the completion needs to be stored and then driven back
     assign cpl_id_m = memctrl_bid ^ AXI_ID_MASK;
-    assign to_cpl = id_ram[cpl_id_m[OSTDREQ_W-1:0]];
+    assign to_cpl = id_ram[cpl_id_m[OSTDREQ_W-1:0]] & !posted_b;
 
     // Track the outstanding request to drive back completion to the application
     // FIXME: can't track a cache miss and an IO req in the same cycle
@@ -302,11 +584,13 @@ module friscv_cache_pusher
             end else if (srst) begin
                 id_ram[i] <= '0;
             end else begin
-                if ((cache_miss || mst_awvalid && mst_awready && mst_wvalid && mst_wready && mst_awcache[1]) && 
+                if ((cache_miss && !WRITE_BACK && !WRITE_COMBINE || accept && mst_awcache[1]) && 
                     req_id_m[OSTDREQ_W-1:0]==i[OSTDREQ_W-1:0]) 
                 begin
                     id_ram[i] <= 1'b1;
-                end else if (memctrl_bvalid && memctrl_bready && cpl_id_m[OSTDREQ_W-1:0]==i[OSTDREQ_W-1:0]) begin
+                end else if (memctrl_bvalid && memctrl_bready && !posted_b &&
+                             cpl_id_m[OSTDREQ_W-1:0]==i[OSTDREQ_W-1:0])
+                begin
                     id_ram[i] <= 1'b0;
                 end
             end
@@ -316,7 +600,7 @@ module friscv_cache_pusher
     // TODO: manage back-pressure of completion channel readiness
     // Today OoO or memfy are always ready
     always @ (*) begin
-        if (cache_hit) begin
+        if (cache_hit || cache_miss && WRITE_COMBINE && !WRITE_BACK) begin
             mst_bvalid = 1'b1;
             mst_bresp = 2'b0;
             mst_bid = cache_rid;
@@ -0,0 +1,181 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Victim cache of the cache blocks
+//
+// - small fully-associative buffer storing the last blocks replaced in the
+//   cache blocks, catching the conflict misses
+// - looked up along the cache blocks, a hit being served in the same cycle
+// - a not-recently-used policy selects the entry to replace, an invalid one
+//   being used first
+// - the entries are never dirty, a dirty block being written back by the
+//   cache when replaced. A block written in the cache or updated by a store
+//   invalidates its copy
+//
+///////////////////////////////////////////////////////////////////////////////
+
+module friscv_cache_victim
+
+    #(
+        // Name used for tracer file name
+        parameter NAME = "victim",
+        // Block address width, the address without the offset part
+        parameter ADDR_W = 28,
+        // Block width defining only the data payload, in bits
+        parameter CACHE_BLOCK_W = 128,
+        // Number of entries
+        parameter DEPTH = 4
+    )(
+        input  wire                           aclk,
+        input  wire                           aresetn,
+        input  wire                           srst,
+        // Invalidate all the entries
+        input  wire                           flush,
+        // Block replaced in the cache blocks
+        input  wire                           push,
+        input  wire  [ADDR_W            -1:0] push_addr,
+        input  wire  [CACHE_BLOCK_W     -1:0] push_data,
+        // Block written in the cache blocks, invalidating its copy
+        input  wire                           wr_inval,
+        input  wire  [ADDR_W            -1:0] wr_addr,
+        // Lookup, served or invalidating the block found
+        input  wire  [ADDR_W            -1:0] rd_addr,
+        input  wire                           rd_use,
+        input  wire                           rd_inval,
+        output logic                          rd_hit,
+        output logic [CACHE_BLOCK_W     -1:0] rd_data
+    );
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Parameters and variables declarations
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    localparam PTR_W = (DEPTH>1) ? $clog2(DEPTH) : 1;
+
+    logic [ADDR_W         -1:0] addr [DEPTH-1:0];
+    logic [CACHE_BLOCK_W  -1:0] data [DEPTH-1:0];
+    logic [DEPTH          -1:0] valid;
+    logic [DEPTH          -1:0] used;
+    logic [DEPTH          -1:0] used_next;
+
+    logic [DEPTH          -1:0] rd_match;
+    logic [DEPTH          -1:0] wr_match;
+    logic [DEPTH          -1:0] free;
+    logic [PTR_W          -1:0] rd_ix;
+    logic [PTR_W          -1:0] push_ix;
+
+    // Tracer setup
+    `ifdef TRACE_CACHE
+    string fname;
+    integer f;
+    initial begin
+        $sformat(fname, "trace_%s.txt", NAME);
+        f = $fopen(fname, "w");
+    end
+    `endif
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Entries lookup and selection of the entry to replace
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (genvar i=0;i<DEPTH;i=i+1) begin: MATCH
+        assign rd_match[i] = valid[i] && addr[i]==rd_addr;
+        assign wr_match[i] = valid[i] && addr[i]==wr_addr;
+    end
+
+    // An entry invalidated by the block written can be reused on same cycle
+    assign free = ~valid | ((wr_inval) ? wr_match : {DEPTH{1'b0}});
+
+    always @ (*) begin
+
+        rd_ix = {PTR_W{1'b0}};
+        push_ix = {PTR_W{1'b0}};
+
+        for (int i=DEPTH-1;i>=0;i=i-1)
+            if (rd_match[i]) rd_ix = i[PTR_W-1:0];
+
+        // The first free entry, else the first not recently used one
+        for (int i=DEPTH-1;i>=0;i=i-1)
+            if (!used[i]) push_ix = i[PTR_W-1:0];
+
+        for (int i=DEPTH-1;i>=0;i=i-1)
+            if (free[i]) push_ix = i[PTR_W-1:0];
+    end
+
+    assign rd_hit = |rd_match;
+    assign rd_data = data[rd_ix];
+
+    // Mark the entry served or written, all the marks but the last one being
+    // cleared once all the entries are recently used
+    always @ (*) begin
+
+        used_next = used;
+
+        if (rd_use && rd_hit)
+            used_next[rd_ix] = 1'b1;
+
+        if (push)
+            used_next[push_ix] = 1'b1;
+
+        if (&used_next) begin
+            used_next = {DEPTH{1'b0}};
+            if (rd_use && rd_hit) used_next[rd_ix] = 1'b1;
+            if (push) used_next[push_ix] = 1'b1;
+        end
+    end
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Entries storage
+    ///////////////////////////////////////////////////////////////////////////
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            valid <= {DEPTH{1'b0}};
+            used <= {DEPTH{1'b0}};
+        end else if (srst) begin
+            valid <= {DEPTH{1'b0}};
+            used <= {DEPTH{1'b0}};
+        end else if (flush) begin
+            valid <= {DEPTH{1'b0}};
+            used <= {DEPTH{1'b0}};
+        end else begin
+
+            used <= used_next;
+
+            for (int i=0;i<DEPTH;i=i+1) begin
+                if (push && push_ix==i[PTR_W-1:0])
+                    valid[i] <= 1'b1;
+                else if (wr_inval && wr_match[i] || rd_inval && rd_match[i])
+                    valid[i] <= 1'b0;
+            end
+
+            `ifdef TRACE_CACHE
+            if (push)
+                $fwrite(f, "@ %0t: Push block 0x%x in entry %0d\n", $realtime, push_addr, push_ix);
+            if (rd_use && rd_hit)
+                $fwrite(f, "@ %0t: Hit block 0x%x in entry %0d\n", $realtime, rd_addr, rd_ix);
+            `endif
+        end
+    end
+
+    always @ (posedge aclk) begin
+        if (push) begin
+            addr[push_ix] <= push_addr;
+            data[push_ix] <= push_data;
+        end
+    end
+
+endmodule
+
+`resetall
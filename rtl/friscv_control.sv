@@ -44,7 +44,23 @@ module friscv_control
         // Primary address to boot to load the firmware
         parameter BOOT_ADDR = 0,
         // Timeout applied for WFI
-        parameter WFI_TW = 100
+        parameter WFI_TW = 100,
+        // Enable the dynamic branch predictor (BHT + BTB)
+        parameter BRANCH_PREDICTOR = 0,
+        // Number of entries in the branch history table
+        parameter BHT_DEPTH = 64,
+        // Number of entries in the branch target buffer
+        parameter BTB_DEPTH = 16,
+        // Number of entries in the return address stack, 0 to disable
+        parameter RAS_DEPTH = 4,
+        // Issue an ALU instruction along the current processing instruction
+        parameter DUAL_ISSUE = 0,
+        // Execute the common instruction pairs as a single operation
+        parameter MACRO_FUSION = 0,
+        // Support the compressed instructions (C extension)
+        parameter C_EXTENSION = 0,
+        // Support the atomic instructions (A extension)
+        parameter A_EXTENSION = 0
     )(
         // clock & reset
         input  wire                       aclk,
@@ -59,6 +75,9 @@ module friscv_control
         // Flush control to execute FENCE.i
         output logic                      flush_blocks,
         input  wire                       flush_ack,
+        // Clean control of the data cache, FENCE and FENCE.i
+        output logic                      clean_blocks,
+        input  wire                       clean_ack,
         // instruction memory interface
         output logic                      arvalid,
         input  wire                       arready,
@@ -74,9 +93,13 @@ module friscv_control
         output logic                      proc_valid,
         input  wire                       proc_ready,
         output logic [`INST_BUS_W   -1:0] proc_instbus,
+        output logic                      proc_dual,
+        output logic [`INST_BUS_W   -1:0] proc_instbus2,
         input  wire  [4             -1:0] proc_fenceinfo,
         input  wire  [`PROC_EXP_W   -1:0] proc_exceptions,
         input  wire                       proc_busy,
+        input  wire                       proc_wr_pending,
+        input  wire  [32            -1:0] proc_regs_sts,
         // interface to activate teh CSR management
         output logic                      csr_en,
         input  wire                       csr_ready,
@@ -96,7 +119,14 @@ module friscv_control
         input  wire  [4             -1:0] mpu_allow,
         // CSR shared bus
         input  wire  [`CSR_SB_W     -1:0] csr_sb,
-        output logic [`CTRL_SB_W    -1:0] ctrl_sb
+        output logic [`CTRL_SB_W    -1:0] ctrl_sb,
+        // Branch predictor performance events
+        output logic                      bpred_hit,
+        output logic                      bpred_miss,
+        // Dual-issue performance event
+        output logic                      dual_issued,
+        // Macro-op fusion performance event
+        output logic                      fused_pair
     );
 
 
@@ -106,8 +136,6 @@ module friscv_control
     //
     ///////////////////////////////////////////////////////////////////////////
 
-    localparam MAX_ID = AXI_ID_MASK + MAX_ID_RANGE - 1;
-
     // Decoded instructions
     logic [`OPCODE_W   -1:0] opcode;
     logic [`FUNCT3_W   -1:0] funct3;
@@ -135,6 +163,7 @@ module friscv_control
     logic             dec_error;
     logic             inst_dec_error;
     logic             inst_ready;
+    logic [`PDC_W-1:0] inst_flags;
 
     // Control fsm
     typedef enum logic[3:0] {
@@ -150,8 +179,11 @@ module friscv_control
     pc_fsm cfsm;
 
     // All program counter for the different instructions
-    logic        [XLEN-1:0] pc_plus4;
+    logic        [XLEN-1:0] pc_inc;
+    logic        [XLEN-1:0] inst_len;
+    logic        [XLEN-1:0] inst2_len;
     logic signed [XLEN-1:0] pc_auipc;
+    logic signed [XLEN-1:0] pc_auipc_lo;
     logic signed [XLEN-1:0] pc_jal;
     logic signed [XLEN-1:0] pc_jalr;
     logic signed [XLEN-1:0] pc_branching;
@@ -168,24 +200,69 @@ module friscv_control
     logic                   bgeu;
     logic                   goto_branch;
     logic                   jump_branch;
+    // Branch prediction
+    logic                   bp_taken;
+    logic        [XLEN-1:0] bp_target;
+    logic                   bp_half;
+    logic                   fetch_half;
+    logic        [XLEN-1:0] bp_next_pc;
+    logic                   br_restart;
+    logic                   jal_restart;
+    logic                   jalr_restart;
+    logic                   is_call;
+    logic                   is_ret;
+    logic                   fetch_restart;
     logic                   lui_auipc;
     // Two flags used intot the FSM to stall the process and control
     // the instruction storage
     logic                   cant_jump;
+    logic                   rs_hzd;
+    logic                   rd_hzd;
     logic                   cant_trap;
     logic                   cant_process;
     logic                   cant_lui_auipc;
     logic                   cant_sys;
+    logic                   cant_fence;
     logic                   regs_rsvd;
-    // FIFO signals
+    // Fetch stage signals
     logic [ILEN       -1:0] instruction;
     logic                   flush_pipe;
-    logic                   push_inst;
-    logic                   fifo_full;
     logic                   pull_inst;
-    logic                   fifo_empty;
+    logic                   fetch_jump;
+    logic                   fetch_new_id;
+    logic [AXI_ADDR_W -1:0] fetch_addr;
+    logic                   wfi_wakeup;
     logic [XLEN       -1:0] mtvec;
 
+    // Second instruction, issued along the first one in dual-issue mode
+    logic [ILEN       -1:0] instruction2;
+    logic                   inst2_ready;
+    logic [`PDC_W     -1:0] inst2_flags;
+    logic [`OPCODE_W  -1:0] opcode_2;
+    logic [`FUNCT3_W  -1:0] funct3_2;
+    logic [`FUNCT7_W  -1:0] funct7_2;
+    logic [`RS1_W     -1:0] rs1_2;
+    logic [`RS2_W     -1:0] rs2_2;
+    logic [`RD_W      -1:0] rd_2;
+    logic [`ZIMM_W    -1:0] zimm_2;
+    logic [`IMM12_W   -1:0] imm12_2;
+    logic [`IMM20_W   -1:0] imm20_2;
+    logic [`CSR_W     -1:0] csr_2;
+    logic [`SHAMT_W   -1:0] shamt_2;
+    logic                   alu_inst_2;
+    logic                   pair_hzd;
+    logic                   dual_issue;
+
+    // Macro-op fusion of the two oldest instructions
+    logic                   fuse_li;
+    logic                   fuse_pcrel;
+    logic                   fuse_call;
+    logic                   fuse_zext;
+    logic                   fuse_ld;
+    logic                   fused;
+    logic        [XLEN-1:0] fused_lo;
+    logic        [XLEN-1:0] pc_link;
+
     // Shared bus signals
     logic [XLEN       -1:0] sb_mepc;
     logic [XLEN       -1:0] sb_mtvec;
@@ -236,6 +313,8 @@ module friscv_control
 
     localparam PROC_EXP_FIFO_W = 4 + XLEN;
     localparam MAX_PROC_EXP = $clog2(4);
+    // Taken predictions in-flight, between the fetch stage and the execution
+    localparam PRED_OSTD_NUM = 4;
 
     logic [PROC_EXP_FIFO_W-1:0] proc_exp_i;
     logic [PROC_EXP_FIFO_W-1:0] proc_exp_o;
@@ -326,19 +405,6 @@ module friscv_control
     `endif
 
 
-    //////////////////////////////////////////////////////////////////////
-    // Return next ID for program counter increment during address jump
-    //////////////////////////////////////////////////////////////////////
-    function automatic logic [AXI_ID_W-1:0] next_id(
-        input logic  [AXI_ID_W-1:0] id,
-        input logic  [AXI_ID_W-1:0] max_id,
-        input logic  [AXI_ID_W-1:0] init_id
-    );
-        if (id==max_id) next_id = init_id;
-        else next_id = id + 1'b1;
-    endfunction
-
-
     ///////////////////////////////////////////////////////////////////////////
     // CSR Shared bus extraction
     ///////////////////////////////////////////////////////////////////////////
@@ -369,62 +435,79 @@ module friscv_control
     endgenerate
 
     ///////////////////////////////////////////////////////////////////////////
-    // Input stage
-    ///////////////////////////////////////////////////////////////////////////
-
-    assign push_inst = rvalid & (arid == rid);
-
-    generate
-    ///////////////////////////////////////////////////////////////////////////
-    // Load/Buffer Stage, a SC-FIFO storing the incoming instructions.
-    // This FIFO is controlled by the FSM issuing read request and can be
-    // flushed in case branching or jumping is required.
+    //
+    // Fetch stage: issues the read requests and buffers the incoming
+    // instructions, pre-decoded, independently of the execution. The FSM
+    // only redirects the fetch stream when jumping.
+    //
     ///////////////////////////////////////////////////////////////////////////
-    if (OSTDREQ_NUM > 0) begin: INST_FIFO
-
-        assign rready = !fifo_full;
 
-        friscv_scfifo
-        #(
-            .PASS_THRU  (0),
-            .ADDR_WIDTH ($clog2(OSTDREQ_NUM)),
-            .DATA_WIDTH (AXI_DATA_W)
-        )
-        inst_fifo
-        (
-            .aclk     (aclk),
-            .aresetn  (aresetn),
-            .srst     (srst),
-            .flush    (flush_pipe | flush_blocks),
-            .data_in  (rdata),
-            .push     (push_inst),
-            .full     (fifo_full),
-            .afull    (),
-            .data_out (instruction),
-            .pull     (pull_inst),
-            .empty    (fifo_empty),
-            .aempty   ()
-        );
+    friscv_fetch
+    #(
+        .ILEN         (ILEN),
+        .XLEN         (XLEN),
+        .AXI_ADDR_W   (AXI_ADDR_W),
+        .AXI_ID_W     (AXI_ID_W),
+        .MAX_ID_RANGE (MAX_ID_RANGE),
+        .AXI_ID_MASK  (AXI_ID_MASK),
+        .AXI_DATA_W   (AXI_DATA_W),
+        .DEPTH        (OSTDREQ_NUM),
+        .BOOT_ADDR    (BOOT_ADDR),
+        .C_EXTENSION  (C_EXTENSION),
+        .A_EXTENSION  (A_EXTENSION),
+        .PRED_OSTD_NUM(PRED_OSTD_NUM)
+    )
+    fetch
+    (
+        .aclk         (aclk),
+        .aresetn      (aresetn),
+        .srst         (srst),
+        .flush        (flush_pipe | flush_blocks),
+        .boot         (cfsm==BOOT),
+        .jump         (fetch_jump),
+        .jump_new_id  (fetch_new_id),
+        .jump_addr    (fetch_addr),
+        .pred_taken   (bp_taken),
+        .pred_target  (bp_target),
+        .pred_half    (bp_half),
+        .arvalid      (arvalid),
+        .arready      (arready),
+        .araddr       (araddr),
+        .arid         (arid),
+        .araddr_half  (fetch_half),
+        .rvalid       (rvalid),
+        .rready       (rready),
+        .rid          (rid),
+        .rdata        (rdata),
+        .inst_ready   (inst_ready),
+        .instruction  (instruction),
+        .inst_flags   (inst_flags),
+        .inst2_ready  (inst2_ready),
+        .instruction2 (instruction2),
+        .inst2_flags  (inst2_flags),
+        .pull         (pull_inst),
+        .pull2        (dual_issue | fused)
+    );
 
-        assign inst_ready = !fifo_empty & !flush_pipe;
+    // The fetch stream restarts on a jump, a trap or a FENCE.i, or when
+    // waking up from WFI
+    assign wfi_wakeup = (cfsm==WFI) && (sb_msip&sb_msie || sb_mtip&sb_mtie || sb_meip&sb_meie);
 
-    ///////////////////////////////////////////////////////////////////////////
-    // No input FIFO, the read data channel feeds directly the controller
-    ///////////////////////////////////////////////////////////////////////////
-    end else begin : INST_PATH
+    assign fetch_jump = (cfsm==FETCH) & fetch_restart | wfi_wakeup;
 
-        assign instruction = rdata;
-        assign inst_ready = push_inst;
-        assign rready = pull_inst;
+    // Resuming after a WFI without handling the interrupt continues the
+    // current batch
+    assign fetch_new_id = (cfsm==FETCH) | sb_mie;
 
-        assign fifo_full = 1'b0;
-        assign fifo_empty = 1'b0;
-
-    end
-    endgenerate
+    assign fetch_addr = (wfi_wakeup && sb_mie) ? mtvec :
+                        (wfi_wakeup)           ? pc :
+                        (trap_occuring)        ? mtvec :
+                        (sys[`IS_ECALL])       ? mtvec :
+                        (sys[`IS_MRET])        ? sb_mepc :
+                                                 pc;
 
     assign pull_inst = (!cant_jump && !cant_process && !cant_lui_auipc && !cant_sys &&
-                        (cfsm==FETCH) && !trap_occuring) ? 1'b1 : 1'b0;
+                        !cant_fence && (cfsm==FETCH) && !trap_occuring) ? 1'b1 : 1'b0;
 
     ///////////////////////////////////////////////////////////////////////////
     //
@@ -454,7 +537,8 @@ module friscv_control
 
     friscv_decoder
     #(
-        .XLEN   (XLEN)
+        .XLEN        (XLEN),
+        .A_EXTENSION (A_EXTENSION)
     )
     decoder
     (
@@ -470,19 +554,31 @@ module friscv_control
         .imm20       (imm20),
         .csr         (csr),
         .shamt       (shamt),
-        .fence       (fence),
-        .lui         (lui),
-        .auipc       (auipc),
-        .jal         (jal),
-        .jalr        (jalr),
-        .branching   (branching),
-        .sys         (sys),
-        .processing  (processing),
-        .dec_error   (dec_error),
+        .fence       (),
+        .lui         (),
+        .auipc       (),
+        .jal         (),
+        .jalr        (),
+        .branching   (),
+        .sys         (),
+        .processing  (),
+        .dec_error   (),
         .pred        (pred),
         .succ        (succ)
     );
 
+    // Flags pre-decoded by the fetch stage. A fused AUIPC + JALR executes
+    // as a JAL, a fused LUI + LOAD as a LOAD.
+    assign fence = inst_flags[`PDC_FENCE+:`PDC_FENCE_W];
+    assign lui = inst_flags[`PDC_LUI] & !fuse_ld;
+    assign auipc = inst_flags[`PDC_AUIPC] & !fuse_call;
+    assign jal = inst_flags[`PDC_JAL] | fuse_call;
+    assign jalr = inst_flags[`PDC_JALR];
+    assign branching = inst_flags[`PDC_BRANCH];
+    assign sys = inst_flags[`PDC_SYS+:`PDC_SYS_W];
+    assign processing = inst_flags[`PDC_PROC] | fuse_ld;
+    assign dec_error = inst_flags[`PDC_DECERR];
+
 
     ///////////////////////////////////////////////////////////////////////////
     //
@@ -495,40 +591,215 @@ module friscv_control
 
     assign csr_en = inst_ready && sys[`IS_CSR] & (cfsm==FETCH) & !proc_busy & !illegal_csr;
 
-    assign proc_instbus[`OPCODE   +: `OPCODE_W ] = opcode;
-    assign proc_instbus[`FUNCT3   +: `FUNCT3_W ] = funct3;
-    assign proc_instbus[`FUNCT7   +: `FUNCT7_W ] = funct7;
-    assign proc_instbus[`RS1      +: `RS1_W    ] = rs1   ;
+    // A fused LUI + LOAD is issued as the LOAD, using the LUI immediate as
+    // base address. The LUI is committed by the control unit, so the LOAD
+    // carries its own PC and reports it if it traps.
+    assign proc_instbus[`OPCODE   +: `OPCODE_W ] = (fuse_ld) ? opcode_2 : opcode;
+    assign proc_instbus[`FUNCT3   +: `FUNCT3_W ] = (fuse_ld) ? funct3_2 : funct3;
+    assign proc_instbus[`FUNCT7   +: `FUNCT7_W ] = (fuse_ld) ? funct7_2 : funct7;
+    assign proc_instbus[`RS1      +: `RS1_W    ] = (fuse_ld) ? 5'h0     : rs1   ;
     assign proc_instbus[`RS2      +: `RS2_W    ] = rs2   ;
     assign proc_instbus[`RD       +: `RD_W     ] = rd    ;
     assign proc_instbus[`ZIMM     +: `ZIMM_W   ] = zimm  ;
-    assign proc_instbus[`IMM12    +: `IMM12_W  ] = imm12 ;
+    assign proc_instbus[`IMM12    +: `IMM12_W  ] = (fuse_ld) ? imm12_2  : imm12 ;
     assign proc_instbus[`IMM20    +: `IMM20_W  ] = imm20 ;
     assign proc_instbus[`CSR      +: `CSR_W    ] = csr   ;
     assign proc_instbus[`SHAMT    +: `SHAMT_W  ] = shamt ;
-    assign proc_instbus[`INST     +: `INST_W   ] = instruction;
-    assign proc_instbus[`PC       +: `PC_W     ] = pc_reg;
+    assign proc_instbus[`INST     +: `INST_W   ] = (fuse_ld) ? instruction2 : instruction;
+    assign proc_instbus[`PC       +: `PC_W     ] = (fuse_ld) ? pc_inc : pc_reg;
     assign proc_instbus[`PRIV     +: `PRIV_W   ] = priv_mode;
     assign proc_instbus[`MPP      +: `PRIV_W   ] = mpp;
     assign proc_instbus[`MPRV                  ] = sb_mstatus[17];
+    assign proc_instbus[`FUSED                 ] = fuse_zext | fuse_ld;
 
     assign csr_instbus = proc_instbus;
 
 
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Second instruction decoding, used by the dual-issue and the macro-op
+    // fusion
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (DUAL_ISSUE || MACRO_FUSION) begin: DECODER_2_ON
+
+        friscv_decoder
+        #(
+            .XLEN        (XLEN),
+            .A_EXTENSION (A_EXTENSION)
+        )
+        decoder_2
+        (
+            .instruction (instruction2),
+            .opcode      (opcode_2),
+            .funct3      (funct3_2),
+            .funct7      (funct7_2),
+            .rs1         (rs1_2),
+            .rs2         (rs2_2),
+            .rd          (rd_2),
+            .zimm        (zimm_2),
+            .imm12       (imm12_2),
+            .imm20       (imm20_2),
+            .csr         (csr_2),
+            .shamt       (shamt_2),
+            .fence       (),
+            .lui         (),
+            .auipc       (),
+            .jal         (),
+            .jalr        (),
+            .branching   (),
+            .sys         (),
+            .processing  (),
+            .dec_error   (),
+            .pred        (),
+            .succ        ()
+        );
+
+    end else begin: DECODER_2_OFF
+
+        assign opcode_2 = {`OPCODE_W{1'b0}};
+        assign funct3_2 = {`FUNCT3_W{1'b0}};
+        assign funct7_2 = {`FUNCT7_W{1'b0}};
+        assign rs1_2 = {`RS1_W{1'b0}};
+        assign rs2_2 = {`RS2_W{1'b0}};
+        assign rd_2 = {`RD_W{1'b0}};
+        assign zimm_2 = {`ZIMM_W{1'b0}};
+        assign imm12_2 = {`IMM12_W{1'b0}};
+        assign imm20_2 = {`IMM20_W{1'b0}};
+        assign csr_2 = {`CSR_W{1'b0}};
+        assign shamt_2 = {`SHAMT_W{1'b0}};
+
+    end
+    endgenerate
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Dual-issue: the next instruction in the queue is issued along the
+    // current one if it's an ALU instruction not depending on the current one
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (DUAL_ISSUE) begin: DUAL_ISSUE_ON
+
+        assign alu_inst_2 = inst2_flags[`PDC_ALU];
+
+        // Read-after-write and write-after-write between the two instructions
+        assign pair_hzd = (rd!=5'h0) && (rs1_2==rd || rs2_2==rd || rd_2==rd);
+
+        assign dual_issue = inst_ready & inst2_ready & processing & alu_inst_2 & !pair_hzd & !fused;
+
+        assign proc_dual = dual_issue;
+
+        assign proc_instbus2[`OPCODE   +: `OPCODE_W ] = opcode_2;
+        assign proc_instbus2[`FUNCT3   +: `FUNCT3_W ] = funct3_2;
+        assign proc_instbus2[`FUNCT7   +: `FUNCT7_W ] = funct7_2;
+        assign proc_instbus2[`RS1      +: `RS1_W    ] = rs1_2   ;
+        assign proc_instbus2[`RS2      +: `RS2_W    ] = rs2_2   ;
+        assign proc_instbus2[`RD       +: `RD_W     ] = rd_2    ;
+        assign proc_instbus2[`ZIMM     +: `ZIMM_W   ] = zimm_2  ;
+        assign proc_instbus2[`IMM12    +: `IMM12_W  ] = imm12_2 ;
+        assign proc_instbus2[`IMM20    +: `IMM20_W  ] = imm20_2 ;
+        assign proc_instbus2[`CSR      +: `CSR_W    ] = csr_2   ;
+        assign proc_instbus2[`SHAMT    +: `SHAMT_W  ] = shamt_2 ;
+        assign proc_instbus2[`INST     +: `INST_W   ] = instruction2;
+        assign proc_instbus2[`PC       +: `PC_W     ] = pc_inc;
+        assign proc_instbus2[`PRIV     +: `PRIV_W   ] = priv_mode;
+        assign proc_instbus2[`MPP      +: `PRIV_W   ] = mpp;
+        assign proc_instbus2[`MPRV                  ] = sb_mstatus[17];
+        assign proc_instbus2[`FUSED                 ] = 1'b0;
+
+        assign dual_issued = proc_valid & proc_ready & dual_issue;
+
+    end else begin: DUAL_ISSUE_OFF
+
+        assign dual_issue = 1'b0;
+        assign proc_dual = 1'b0;
+        assign proc_instbus2 = {`INST_BUS_W{1'b0}};
+        assign dual_issued = 1'b0;
+
+    end
+    endgenerate
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Macro-op fusion: the two oldest instructions of the queue are executed
+    // as a single operation if they form a known idiom
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (MACRO_FUSION) begin: MACRO_FUSION_ON
+
+        friscv_fusion
+        #(
+            .ILEN         (ILEN)
+        )
+        fusion
+        (
+            .inst_ready   (inst_ready),
+            .instruction  (instruction),
+            .inst2_ready  (inst2_ready),
+            .instruction2 (instruction2),
+            .inst2_flags  (inst2_flags),
+            .fuse_li      (fuse_li),
+            .fuse_pcrel   (fuse_pcrel),
+            .fuse_call    (fuse_call),
+            .fuse_zext    (fuse_zext),
+            .fuse_ld      (fuse_ld)
+        );
+
+        assign fused = fuse_li | fuse_pcrel | fuse_call | fuse_zext | fuse_ld;
+
+        // ADDI immediate added to the LUI / AUIPC result
+        assign fused_lo = (fuse_li | fuse_pcrel) ? {{(XLEN-12){imm12_2[11]}}, imm12_2} :
+                                                   {XLEN{1'b0}};
+
+        assign fused_pair = pull_inst & inst_ready & fused;
+
+    end else begin: MACRO_FUSION_OFF
+
+        assign fuse_li = 1'b0;
+        assign fuse_pcrel = 1'b0;
+        assign fuse_call = 1'b0;
+        assign fuse_zext = 1'b0;
+        assign fuse_ld = 1'b0;
+        assign fused = 1'b0;
+        assign fused_lo = {XLEN{1'b0}};
+        assign fused_pair = 1'b0;
+
+    end
+    endgenerate
+
+
     ///////////////////////////////////////////////////////////////////////////
     //
     // Program counter computation
     //
     ///////////////////////////////////////////////////////////////////////////
 
-    // Increment counter by 4 because we index bytes
-    assign pc_plus4 = pc_reg + ILEN/8;
+    // Increment counter by 4 because we index bytes, 2 if compressed
+    assign inst_len = (inst_flags[`PDC_RVC]) ? 2 : ILEN/8;
+    assign inst2_len = (inst2_flags[`PDC_RVC]) ? 2 : ILEN/8;
+
+    assign pc_inc = pc_reg + inst_len;
 
     // AUIPC: Add Upper Immediate into Program Counter
     assign pc_auipc = $signed(pc_reg) + $signed({imm20,12'b0});
 
-    // JAL: current program counter + offset
-    assign pc_jal = $signed(pc_reg) + $signed({{11{imm20[19]}}, imm20, 1'b0});
+    // AUIPC + ADDI/JALR fused pair
+    assign pc_auipc_lo = $signed(pc_auipc) + $signed({{(XLEN-12){imm12_2[11]}}, imm12_2});
+
+    // JAL: current program counter + offset, or AUIPC + JALR offset if fused
+    assign pc_jal = (fuse_call) ? {pc_auipc_lo[XLEN-1:1], 1'b0} :
+                                  $signed(pc_reg) + $signed({{11{imm20[19]}}, imm20, 1'b0});
+
+    // Return address of JAL/JALR, after the JALR of a fused call
+    assign pc_link = (fuse_call) ? pc_inc + inst2_len : pc_inc;
 
     // JALR: program counter equals  rs1 + offset
     assign pc_jalr = $signed(ctrl_rs1_val) + $signed({{20{imm12[11]}}, imm12});
@@ -539,22 +810,22 @@ module friscv_control
     // Program counter switching logic
     assign pc = (cfsm==BOOT)                ? pc_reg :
                 // FENCE (0) or FENCE.I (1)
-                (|fence)                    ? pc_plus4 :
+                (|fence)                    ? pc_inc :
                 // System calls
-                (|sys)                      ? pc_plus4 :
+                (|sys)                      ? pc_inc :
                 // Load immediate
-                (lui)                       ? pc_plus4 :
+                (lui)                       ? pc_inc :
                 // Add upper immediate in PC
-                (auipc)                     ? pc_plus4 :
+                (auipc)                     ? pc_inc :
                 // Jumps
                 (jal)                       ? pc_jal :
                 (jalr)                      ? {pc_jalr[31:1],1'b0} :
                 // branching and comparaison is true
                 (branching && goto_branch)  ? pc_branching :
                 // branching and comparaison is false
-                (branching && ~goto_branch) ? pc_plus4 :
+                (branching && ~goto_branch) ? pc_inc :
                 // arithmetic processing
-                (processing)                ? pc_plus4 :
+                (processing)                ? pc_inc :
                                               pc_reg;
 
     ///////////////////////////////////////////////////////////////////////////
@@ -608,24 +879,20 @@ module friscv_control
         if (aresetn == 1'b0) begin
             cfsm <= BOOT;
             arvalid <= 1'b0;
-            araddr <= {AXI_ADDR_W{1'b0}};
             pc_reg <= {(XLEN){1'b0}};
             pc_jal_saved <= {(XLEN){1'b0}};
             pc_auipc_saved <= {(XLEN){1'b0}};
             status <= 5'b0;
-            arid <= {AXI_ID_W{1'b0}};
             flush_blocks <= 1'b0;
             flush_pipe <= 1'b0;
             priv_mode <= `MMODE;
         end else if (srst == 1'b1) begin
             cfsm <= BOOT;
             arvalid <= 1'b0;
-            araddr <= {AXI_ADDR_W{1'b0}};
             pc_reg <= {(XLEN){1'b0}};
             pc_jal_saved <= {(XLEN){1'b0}};
             pc_auipc_saved <= {(XLEN){1'b0}};
             status <= 5'b0;
-            arid <= {AXI_ID_W{1'b0}};
             flush_blocks <= 1'b0;
             flush_pipe <= 1'b0;
             priv_mode <= `MMODE;
@@ -639,8 +906,6 @@ module friscv_control
                 default: begin
 
                     priv_mode <= `MMODE;
-                    arid <= AXI_ID_MASK;
-                    araddr <= BOOT_ADDR;
                     pc_reg <= BOOT_ADDR;
 
                     // 2. Once flushed, boot the processor
@@ -658,67 +923,10 @@ module friscv_control
                 end
 
                 ///////////////////////////////////////////////////////////////
-                // Fetch instructions from the cache (or the memory)
+                // Execute the instructions delivered by the fetch stage
                 ///////////////////////////////////////////////////////////////
                 FETCH: begin
 
-                    ///////////////////////////////////////////////////////////
-                    // Manages read outstanding requests to fetch
-                    // new instruction from memory:
-                    ///////////////////////////////////////////////////////////
-
-                    //
-                    // Any trap handling, asynchronous and synchronous
-                    //
-                    if (trap_occuring) begin
-
-                        // Get a new ID for the new batch
-                        arid <= next_id(arid, MAX_ID, AXI_ID_MASK);
-                        // Jump to trap handler
-                        araddr <= mtvec;
-
-                    //
-                    //   - ECALL / MRET / JALR / Any branching
-                    //
-                    end else if (inst_ready && !proc_busy &&
-                        (jump_branch || sys[`IS_ECALL] || sys[`IS_MRET]))
-                    begin
-
-                        // Get a new ID for the new batch
-                        arid <= next_id(arid, MAX_ID, AXI_ID_MASK);
-
-                        // ECALL
-                        if (sys[`IS_ECALL]) araddr <= mtvec;
-                        // MRET
-                        else if (sys[`IS_MRET]) araddr <= sb_mepc;
-                        // jalr / branch
-                        else araddr <= pc;
-
-                    //
-                    // JAL
-                    //
-                    end else if (inst_ready && jal) begin
-
-                        // Get a new ID for the new batch
-                        arid <= next_id(arid, MAX_ID, AXI_ID_MASK);
-                        araddr <= pc;
-
-                    //
-                    //   - FENCE.i execution
-                    //
-                    end else if (inst_ready && fence[`IS_FENCEI]) begin
-                        // Get a new ID for the new batch
-                        arid <= next_id(arid, MAX_ID, AXI_ID_MASK);
-                        araddr <= pc;
-
-                    //
-                    //   - else continue to simply increment by ILEN
-                    //
-                    end else if (arready) begin
-                        araddr <= araddr + ILEN/8;
-                    end
-                    ///////////////////////////////////////////////////////////
-
                     flush_pipe <= 1'b0;
 
                     ///////////////////////////////////////////////////////////
@@ -743,8 +951,8 @@ module friscv_control
 
                         // Need to branch/process but ALU/memfy/CSR didn't finish
                         // to execute last instruction, so store PCs.
-                        if (cant_jump || cant_process || cant_lui_auipc || cant_sys) begin
-                            pc_jal_saved <= pc_plus4;
+                        if (cant_jump || cant_process || cant_lui_auipc || cant_sys || cant_fence) begin
+                            pc_jal_saved <= pc_link;
                             pc_auipc_saved <= pc_reg;
                         end
                         // Needs to jump or branch thus stop the pipeline
@@ -779,7 +987,7 @@ module friscv_control
                             print_instruction;
                             `endif
                             pc_reg <= pc;
-                            flush_pipe <= 1'b1;
+                            flush_pipe <= jal_restart;
 
                         // Any sys instruction:
                         // - ECALL (0) / EBREAK (1) / CSR (2) / MRET (3) / SRET (4) / WFI (5)
@@ -819,7 +1027,7 @@ module friscv_control
 
                             // Reach a FENCE.i instruction, need to flush the cache
                             // the instruction pipeline
-                            end else if (fence[`IS_FENCEI]) begin
+                            end else if (fence[`IS_FENCEI] && !cant_fence) begin
                                 `ifdef USE_SVL
                                 print_instruction;
                                 log.info("FENCE.i -> Start iCache flushing");
@@ -854,8 +1062,9 @@ module friscv_control
                                 flush_pipe <= 1'b0;
                                 pc_reg <= pc;
 
-                            // FENCE instruction (not supported)
-                            end else if (!proc_busy && csr_ready) begin
+                            // FENCE instruction, executed once the data cache
+                            // has been cleaned
+                            end else if (!proc_busy && csr_ready && !cant_fence) begin
                                 `ifdef USE_SVL
                                 print_instruction;
                                 `endif
@@ -869,7 +1078,9 @@ module friscv_control
                             print_instruction;
                             `endif
                             flush_pipe <= 1'b0;
-                            pc_reg <= pc;
+                            // Skip the ADDI if fused
+                            if (fused) pc_reg <= pc + inst2_len;
+                            else       pc_reg <= pc;
 
                         // All other instructions
                         end else if (processing) begin
@@ -879,7 +1090,10 @@ module friscv_control
                                 print_instruction;
                                 `endif
                                 flush_pipe <= 1'b0;
-                                pc_reg <= pc;
+                                // Skip the second instruction if dual-issued
+                                // or fused
+                                if (dual_issue || fused) pc_reg <= pc + inst2_len;
+                                else                     pc_reg <= pc;
                             end
                         end
                     end
@@ -909,7 +1123,7 @@ module friscv_control
                 // Wait for Interrupt (software, timer, external)
                 ///////////////////////////////////////////////////////////////
                 WFI: begin
-                    if (sb_msip&sb_msie || sb_mtip&sb_mtie || sb_meip&sb_meie) begin
+                    if (wfi_wakeup) begin
                         `ifdef USE_SVL
                         print_mcause("WFI -> MCAUSE=0x", mcause_code);
                         `endif
@@ -917,14 +1131,8 @@ module friscv_control
                         flush_pipe <= 1'b1;
                         if (USER_MODE && sb_mie) priv_mode <= `MMODE;
 
-                        if (sb_mie) begin
-                            arid <= next_id(arid, MAX_ID, AXI_ID_MASK);
-                            araddr <= mtvec;
-                            pc_reg <= mtvec;
-                        end else begin
-                            araddr <= pc;
-                            pc_reg <= pc;
-                        end
+                        if (sb_mie) pc_reg <= mtvec;
+                        else        pc_reg <= pc;
                         arvalid <= 1'b1;
                         cfsm <= FETCH;
                     end
@@ -1032,7 +1240,7 @@ module friscv_control
                         end else if (sys[`IS_WFI] && !proc_busy && csr_ready) begin
 
                             mepc_wr <= 1'b1;
-                            mepc <= pc_plus4;
+                            mepc <= pc_inc;
                             mtval_wr <= 1'b1;
                             mtval <= mtval_info;
 
@@ -1074,21 +1282,131 @@ module friscv_control
     assign arprot = {2'b10, priv_bit};
 
     // Needs to jump or branch, the request to cache/RAM needs to be restarted
-    assign jump_branch = (branching & goto_branch) | jalr;
+    assign jump_branch = (branching & br_restart) | (jalr & jalr_restart);
+
+    // A new fetch batch is started, all the in-flight instructions are dropped
+    assign fetch_restart = trap_occuring ||
+                           inst_ready && !cant_jump && jump_branch ||
+                           inst_ready && !proc_busy && (sys[`IS_ECALL] || sys[`IS_MRET]) ||
+                           inst_ready && jal && jal_restart ||
+                           inst_ready && fence[`IS_FENCEI] && !cant_fence;
 
     // LUI and AUIPC are executed internally, not in processing
     assign lui_auipc = lui | auipc;
 
-    assign cant_jump = (jalr | branching) && (proc_busy | !csr_ready);
+    // Jumps, branches, LUI and AUIPC only wait for the registers they use,
+    // still written or read by an instruction in the processing unit. The
+    // results are forwarded by the ISA registers as soon as written.
+    assign rs_hzd = !proc_regs_sts[rs1] | (branching & !proc_regs_sts[rs2]);
+    assign rd_hzd = !proc_regs_sts[rd];
+
+    assign cant_jump = (jalr | branching) && (rs_hzd | jalr & rd_hzd | !csr_ready);
 
     assign cant_process = processing & (!proc_ready | !csr_ready);
 
-    assign cant_lui_auipc = lui_auipc & (proc_busy | !csr_ready);
+    assign cant_lui_auipc = lui_auipc & (rd_hzd | !csr_ready);
 
     assign cant_sys = |sys & (proc_busy | !csr_ready);
 
     assign cant_trap = (proc_busy | !csr_ready);
 
+    // FENCE and FENCE.i wait for the memory accesses to complete, then for
+    // the dirty blocks of the data cache to be written back
+    assign cant_fence = |fence & (proc_busy | proc_wr_pending | !csr_ready | !clean_ack);
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Clean request of the data cache, kept high until acknowledged
+    ///////////////////////////////////////////////////////////////////////////
+
+    always @ (posedge aclk or negedge aresetn) begin
+        if (aresetn == 1'b0) begin
+            clean_blocks <= 1'b0;
+        end else if (srst == 1'b1) begin
+            clean_blocks <= 1'b0;
+        end else begin
+            if (clean_ack) begin
+                clean_blocks <= 1'b0;
+            end else if (cfsm==FETCH && inst_ready && |fence && !trap_occuring &&
+                         !proc_busy && !proc_wr_pending && csr_ready)
+            begin
+                clean_blocks <= 1'b1;
+            end
+        end
+    end
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Branch prediction: steers the fetch address on the predicted target
+    // and restarts a new batch only if the prediction was wrong
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Calls and returns, as hinted by the ISA specification (x1/x5 as link
+    // register). rd=rs1=link is a call only, rd!=rs1 both a return and a call
+    assign is_call = (jal | jalr) & (rd==5'h1 || rd==5'h5);
+    assign is_ret = jalr & (rs1==5'h1 || rs1==5'h5) & !(is_call && rd==rs1);
+
+    generate
+    if (BRANCH_PREDICTOR) begin: BRANCH_PREDICTION
+
+        friscv_bpred
+        #(
+            .XLEN          (XLEN),
+            .BHT_DEPTH     (BHT_DEPTH),
+            .BTB_DEPTH     (BTB_DEPTH),
+            .RAS_DEPTH     (RAS_DEPTH),
+            .PRED_OSTD_NUM (PRED_OSTD_NUM),
+            .C_EXTENSION   (C_EXTENSION)
+        )
+        bpred
+        (
+            .aclk          (aclk),
+            .aresetn       (aresetn),
+            .srst          (srst),
+            .flush_tables  (flush_blocks),
+            .flush_preds   ((cfsm!=FETCH) | fetch_restart),
+            .fetch_en      ((cfsm==FETCH) & arvalid & arready & !fetch_restart),
+            .fetch_addr    (araddr),
+            .fetch_half    (fetch_half),
+            .pred_taken    (bp_taken),
+            .pred_target   (bp_target),
+            .pred_half     (bp_half),
+            .exec_en       (pull_inst & inst_ready),
+            .exec_pc       ((fuse_call) ? pc_inc : pc_reg),
+            .exec_rvc      ((fuse_call) ? inst2_flags[`PDC_RVC] : inst_flags[`PDC_RVC]),
+            .exec_branch   (branching),
+            .exec_jump     (jal | jalr),
+            .exec_call     (is_call),
+            .exec_ret      (is_ret),
+            .exec_taken    (goto_branch | jal | jalr),
+            .exec_target   (pc),
+            .exec_pred_pc  (bp_next_pc),
+            .pred_hit      (bpred_hit),
+            .pred_miss     (bpred_miss)
+        );
+
+        // The instruction fetched after the branch isn't the right one
+        assign br_restart = (pc != bp_next_pc);
+        assign jal_restart = (pc != bp_next_pc);
+        assign jalr_restart = (pc != bp_next_pc);
+
+    end else begin: NO_BRANCH_PREDICTION
+
+        assign bp_taken = 1'b0;
+        assign bp_target = {XLEN{1'b0}};
+        assign bp_half = 1'b0;
+        assign bp_next_pc = pc_inc;
+        assign br_restart = goto_branch;
+        assign jal_restart = 1'b1;
+        assign jalr_restart = 1'b1;
+        assign bpred_hit = 1'b0;
+        assign bpred_miss = 1'b0;
+
+    end
+    endgenerate
+
 
     ///////////////////////////////////////////////////////////////////////////
     //
@@ -1110,16 +1428,16 @@ module friscv_control
             ctrl_rd_addr <= 5'b0;
             ctrl_rd_val <= {XLEN{1'b0}};
         end else begin
-            ctrl_rd_wr <=  (cfsm!=FETCH)                                              ? 1'b0 :
-                           (pull_inst && inst_ready && (auipc || jal || jalr || lui)) ? 1'b1 :
-                                                                                        1'b0 ;
+            ctrl_rd_wr <=  (cfsm!=FETCH)                                                         ? 1'b0 :
+                           (pull_inst && inst_ready && (auipc || jal || jalr || lui || fuse_ld)) ? 1'b1 :
+                                                                                                   1'b0 ;
             ctrl_rd_addr <= rd;
 
             ctrl_rd_val <= ((jal || jalr) && !pull_inst) ? pc_jal_saved :
-                           ((jal || jalr) &&  pull_inst) ? pc_plus4 :
-                           (lui)                         ? {imm20, 12'b0} :
+                           ((jal || jalr) &&  pull_inst) ? pc_link :
+                           (lui || fuse_ld)              ? {imm20, 12'b0} + fused_lo :
                            (auipc && !pull_inst)         ? pc_auipc_saved :
-                           (auipc &&  pull_inst)         ? pc_auipc :
+                           (auipc &&  pull_inst)         ? pc_auipc + fused_lo :
                                                            pc;
         end
     end
@@ -1136,7 +1454,9 @@ module friscv_control
         end else if (srst) begin
             instret <= {64{1'b0}};
         end else begin
-            if (inst_ready && pull_inst)
+            if (inst_ready && pull_inst && (dual_issue || fused))
+                instret <= instret + 2;
+            else if (inst_ready && pull_inst)
                 instret <= instret + 1;
         end
     end
@@ -1211,7 +1531,9 @@ module friscv_control
                        ) ? 1'b1 : 1'b0;
 
     // PC is not aligned with XLEN boundary
-    assign inst_addr_misaligned = (pc_reg[1:0]!=2'b0) ? inst_ready : 1'b0;
+    assign inst_addr_misaligned = (C_EXTENSION && pc_reg[0]) ? inst_ready :
+                                  (!C_EXTENSION && pc_reg[1:0]!=2'b0) ? inst_ready :
+                                                                        1'b0;
 
     //////////////////////////////////////////////////////////////////////
     // WFI timeout management
@@ -1323,6 +1645,8 @@ module friscv_control
                              (csr[11:0]=='hC01 && !sb_mcounteren[1]) ? inst_ready : // Time
                              (csr[11:0]=='hC02 && !sb_mcounteren[2]) ? inst_ready : // Instret
                              (csr[11:4]=='hFC)                       ? inst_ready : // Custom perf. registers
+                             (csr[11:4]=='hFD)                       ? inst_ready : // Custom event counters
+                             (csr[11:4]=='hFE)                       ? inst_ready : // Custom event counters
                              (csr[ 9:8]!=2'b00)                      ? inst_ready : // M-Mode only registers
                                                                        1'b0 ;
 
@@ -152,6 +152,19 @@ function automatic string get_inst_desc(
         $sformat(temp, "Imm12: %x", imm12);
         text = {temp, " / ", text};
     end
+    if (opcode==`AMO) begin
+        if (funct7[6:2]==`LR) text = "LR / R-type";
+        else if (funct7[6:2]==`SC) text = "SC / R-type";
+        else text = "AMO / R-type";
+        $sformat(temp, "Rd: %x", rd);
+        text = {temp, " / ", text};
+        $sformat(temp, "Rs1: %x", rs1);
+        text = {temp, " / ", text};
+        $sformat(temp, "Rs2: %x", rs2);
+        text = {temp, " / ", text};
+        $sformat(temp, "Funct7: %x", funct7);
+        text = {temp, " / ", text};
+    end
     if (opcode==`R_ARITH) begin
         if (funct7==7'b0000001) text = "MULDIV / R-type";
         else text = "ARITH / R-type";
@@ -11,6 +11,7 @@ module friscv_csr
     #(
         parameter PERF_REG_W  = 32,
         parameter PERF_NB_BUS = 3,
+        parameter PERF_NB_EVENT = `PERF_NB_EVENT,
         // Architecture selection:
         // 32 or 64 bits support
         parameter XLEN = 32,
@@ -18,6 +19,10 @@ module friscv_csr
         parameter F_EXTENSION = 0,
         // Multiply/Divide extension support
         parameter M_EXTENSION = 0,
+        // Atomic extension support
+        parameter A_EXTENSION = 0,
+        // Compressed instructions extension support
+        parameter C_EXTENSION = 0,
         // Support hypervisor mode
         parameter HYPERVISOR_MODE = 0,
         // Support supervisor mode
@@ -83,6 +88,8 @@ module friscv_csr
         output logic [XLEN       -1:0] rd_wr_val,
         // Performance registers bus
         input  wire  [PERF_REG_W*3*PERF_NB_BUS -1:0] perfs,
+        // Event counters bus
+        input  wire  [PERF_REG_W*PERF_NB_EVENT -1:0] evt_perfs,
         // CSR shared bus
         output logic [`CSR_SB_W  -1:0] csr_sb,
         input  wire  [`CTRL_SB_W -1:0] ctrl_sb
@@ -314,6 +321,24 @@ module friscv_csr
     localparam PROC_ACTIVE      = 12'hFC6;
     localparam PROC_SLEEP       = 12'hFC7;
     localparam PROC_STALL       = 12'hFC8;
+    localparam BPRED_HIT        = 12'hFD0;
+    localparam BPRED_MISS       = 12'hFD1;
+    localparam DUAL_ISSUED      = 12'hFD2;
+    localparam FUSED_PAIRS      = 12'hFD3;
+    localparam ICACHE_MISS      = 12'hFD4;
+    localparam ICACHE_HIT0      = 12'hFD5;
+    localparam ICACHE_HIT1      = 12'hFD6;
+    localparam ICACHE_HIT2      = 12'hFD7;
+    localparam ICACHE_HIT3      = 12'hFD8;
+    localparam DCACHE_MISS      = 12'hFD9;
+    localparam DCACHE_HIT0      = 12'hFDA;
+    localparam DCACHE_HIT1      = 12'hFDB;
+    localparam DCACHE_HIT2      = 12'hFDC;
+    localparam DCACHE_HIT3      = 12'hFDD;
+    localparam DCACHE_PF_ISSUE  = 12'hFDE;
+    localparam DCACHE_PF_USEFUL = 12'hFDF;
+    localparam ICACHE_VC_HIT    = 12'hFE0;
+    localparam DCACHE_VC_HIT    = 12'hFE1;
 
 
     // Machine Information Status
@@ -377,6 +402,26 @@ module friscv_csr
     logic [32  -1:0] proc_perf_sleep;
     logic [32  -1:0] proc_perf_stall;
 
+    // Custom register counting internal events
+    logic [32  -1:0] bpred_hit;
+    logic [32  -1:0] bpred_miss;
+    logic [32  -1:0] dual_issued;
+    logic [32  -1:0] fused_pairs;
+    logic [32  -1:0] icache_miss;
+    logic [32  -1:0] icache_hit0;
+    logic [32  -1:0] icache_hit1;
+    logic [32  -1:0] icache_hit2;
+    logic [32  -1:0] icache_hit3;
+    logic [32  -1:0] dcache_miss;
+    logic [32  -1:0] dcache_hit0;
+    logic [32  -1:0] dcache_hit1;
+    logic [32  -1:0] dcache_hit2;
+    logic [32  -1:0] dcache_hit3;
+    logic [32  -1:0] dcache_pf_issue;
+    logic [32  -1:0] dcache_pf_useful;
+    logic [32  -1:0] icache_vc_hit;
+    logic [32  -1:0] dcache_vc_hit;
+
     //////////////////////////////////////////////////////////////////////////
     // Supervisor-level CSRs:
     //////////////////////////////////////////////////////////////////////////
@@ -607,6 +652,24 @@ module friscv_csr
         else if (csr==PROC_ACTIVE)     oldval = proc_perf_active;
         else if (csr==PROC_SLEEP)      oldval = proc_perf_sleep;
         else if (csr==PROC_STALL)      oldval = proc_perf_stall;
+        else if (csr==BPRED_HIT)       oldval = bpred_hit;
+        else if (csr==BPRED_MISS)      oldval = bpred_miss;
+        else if (csr==DUAL_ISSUED)     oldval = dual_issued;
+        else if (csr==FUSED_PAIRS)     oldval = fused_pairs;
+        else if (csr==ICACHE_MISS)     oldval = icache_miss;
+        else if (csr==ICACHE_HIT0)     oldval = icache_hit0;
+        else if (csr==ICACHE_HIT1)     oldval = icache_hit1;
+        else if (csr==ICACHE_HIT2)     oldval = icache_hit2;
+        else if (csr==ICACHE_HIT3)     oldval = icache_hit3;
+        else if (csr==DCACHE_MISS)     oldval = dcache_miss;
+        else if (csr==DCACHE_HIT0)     oldval = dcache_hit0;
+        else if (csr==DCACHE_HIT1)     oldval = dcache_hit1;
+        else if (csr==DCACHE_HIT2)     oldval = dcache_hit2;
+        else if (csr==DCACHE_HIT3)     oldval = dcache_hit3;
+        else if (csr==DCACHE_PF_ISSUE) oldval = dcache_pf_issue;
+        else if (csr==DCACHE_PF_USEFUL) oldval = dcache_pf_useful;
+        else if (csr==ICACHE_VC_HIT) oldval = icache_vc_hit;
+        else if (csr==DCACHE_VC_HIT) oldval = dcache_vc_hit;
         else                           oldval = {XLEN{1'b0}};
     end
 
@@ -630,9 +693,9 @@ module friscv_csr
     ///////////////////////////////////////////////////////////////////////////
 
     // Supported extensions
-    assign misa[0]  = 1'b0;                            // A Atomic extension
+    assign misa[0]  = (A_EXTENSION) ? 1'b1 : 1'b0;     // A Atomic extension
     assign misa[1]  = 1'b0;                            // B Tentatively reserved for Bit-Manipulation extension
-    assign misa[2]  = 1'b0;                            // C Compressed extension
+    assign misa[2]  = (C_EXTENSION) ? 1'b1 : 1'b0;     // C Compressed extension
     assign misa[3]  = 1'b0;                            // D Double-precision floating-point extension
     assign misa[4]  = (RV32E) ? 1'b1 : 1'b0;           // E RV32E base ISA
     assign misa[5]  = (F_EXTENSION) ? 1'b1 : 1'b0;     // F Single-precision floating-point extension
@@ -1030,6 +1093,29 @@ module friscv_csr
     assign proc_perf_sleep     = perfs[7*32+:32];
     assign proc_perf_stall     = perfs[8*32+:32];
 
+    //////////////////////////////////////////////////////////////////////////
+    // Custom counters to track internal events
+    //////////////////////////////////////////////////////////////////////////
+
+    assign bpred_hit   = evt_perfs[`EVT_BPRED_HIT*32+:32];
+    assign bpred_miss  = evt_perfs[`EVT_BPRED_MISS*32+:32];
+    assign dual_issued = evt_perfs[`EVT_DUAL_ISSUE*32+:32];
+    assign fused_pairs = evt_perfs[`EVT_FUSED_PAIR*32+:32];
+    assign icache_miss = evt_perfs[`EVT_IC_MISS*32+:32];
+    assign icache_hit0 = evt_perfs[(`EVT_IC_HIT+0)*32+:32];
+    assign icache_hit1 = evt_perfs[(`EVT_IC_HIT+1)*32+:32];
+    assign icache_hit2 = evt_perfs[(`EVT_IC_HIT+2)*32+:32];
+    assign icache_hit3 = evt_perfs[(`EVT_IC_HIT+3)*32+:32];
+    assign dcache_miss = evt_perfs[`EVT_DC_MISS*32+:32];
+    assign dcache_hit0 = evt_perfs[(`EVT_DC_HIT+0)*32+:32];
+    assign dcache_hit1 = evt_perfs[(`EVT_DC_HIT+1)*32+:32];
+    assign dcache_hit2 = evt_perfs[(`EVT_DC_HIT+2)*32+:32];
+    assign dcache_hit3 = evt_perfs[(`EVT_DC_HIT+3)*32+:32];
+    assign dcache_pf_issue = evt_perfs[`EVT_DC_PF_ISSUE*32+:32];
+    assign dcache_pf_useful = evt_perfs[`EVT_DC_PF_USEFUL*32+:32];
+    assign icache_vc_hit = evt_perfs[`EVT_IC_VC_HIT*32+:32];
+    assign dcache_vc_hit = evt_perfs[`EVT_DC_VC_HIT*32+:32];
+
 
     //////////////////////////////////////////////////////////////////////////
     // CSR Shared bus, for registers used across the processor
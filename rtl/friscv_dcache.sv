@@ -11,10 +11,17 @@
 //
 // Data cache circuit
 //
-// - Direct-mapped (1-way) placement policy
-// - Write-through policy, updating central memory when updating cache blocks
+// - Direct-mapped or N-way set-associative placement policy, pseudo-LRU
+//   replacement
+// - Write-through policy, updating central memory when updating cache blocks,
+//   the stores to a same block being combined in a single write request,
+//   or write-back policy with write-allocate, the dirty blocks being written
+//   to the central memory when replaced or on clean request (FENCE/FENCE.i)
 // - Parametrizable cache depth
 // - Parametrizable cache line width
+// - Optional miss status holding registers, serving the hits and the misses
+//   to other blocks while a block is read from the memory
+// - Optional stride prefetcher, learning the stride of the loads per PC
 // - Transparent operation, no need of user management
 // - IO mapping for direct read/write access to GPIOs and IO peripherals
 // - Slave AXI4-lite interface to fetch instructions
@@ -50,6 +57,9 @@ module friscv_dcache
         parameter AXI_ID_MASK = 'h40,
         // AXI ID issued on slave interface is fixed, save some logic
         parameter AXI_ID_FIXED = 1,
+        // Read the blocks with WRAP bursts starting on the word requested,
+        // else with INCR bursts starting on the block's first beat
+        parameter AXI_WRAP = 0,
 
         ///////////////////////////////////////////////////////////////////////
         // Cache Setup
@@ -65,13 +75,35 @@ module friscv_dcache
         // Block width defining only the data payload, in bits
         parameter CACHE_BLOCK_W = 128,
         // Number of blocks in the cache
-        parameter CACHE_DEPTH = 512
+        parameter CACHE_DEPTH = 512,
+        // Number of ways, 1 (direct-mapped) or a power of two
+        parameter CACHE_WAYS = 1,
+        // Write policy, 0 = write-through, 1 = write-back with write-allocate
+        parameter WRITE_BACK = 0,
+        // Merge the consecutive stores to a same block into a single write
+        // request (write-through only)
+        parameter WRITE_COMBINE = 1,
+        // Number of idle cycles before writing a combined block
+        parameter WC_TIMEOUT = 16,
+        // Complete a missing load with the block read, without replaying it
+        parameter EARLY_RESTART = 0,
+        // Number of miss status holding registers, 0 blocks the reads on a miss
+        parameter MSHR_NUM = 0,
+        // Number of entries of the stride prefetcher's table, 0 disables it
+        parameter STRIDE_TABLE = 0,
+        // Number of blocks prefetched ahead of an access
+        parameter PREFETCH_DEGREE = 1,
+        // Number of entries of the victim cache, 0 disables it
+        parameter VICTIM_NB = 0
     )(
         // Global interface
         input  wire                       aclk,
         input  wire                       aresetn,
         input  wire                       srst,
         output logic                      cache_ready,
+        // Clean request, writing back the dirty blocks
+        input  wire                       clean_blocks,
+        output logic                      clean_ack,
 
         // memfy memory interface
         input  wire                       memfy_awvalid,
@@ -94,6 +126,7 @@ module friscv_dcache
         input  wire  [3             -1:0] memfy_arprot,
         input  wire  [4             -1:0] memfy_arcache,
         input  wire  [AXI_ID_W      -1:0] memfy_arid,
+        input  wire  [XLEN          -1:0] memfy_arpc,
         output logic                      memfy_rvalid,
         input  wire                       memfy_rready,
         output logic [AXI_ID_W      -1:0] memfy_rid,
@@ -141,10 +174,30 @@ module friscv_dcache
         input  wire  [AXI_ID_W      -1:0] dcache_rid,
         input  wire  [2             -1:0] dcache_rresp,
         input  wire  [AXI_DATA_W    -1:0] dcache_rdata,
-        input  wire                       dcache_rlast
+        input  wire                       dcache_rlast,
+        // Performance events, the hit per way and the misses
+        output logic [CACHE_WAYS    -1:0] perf_hits,
+        output logic                      perf_miss,
+        output logic                      perf_pf_issue,
+        output logic                      perf_pf_useful,
+        output logic                      perf_victim_hit
     );
 
 
+    // Blocks written back before being read again
+    localparam EVICT_DEPTH = 2;
+
+    // ID of the store miss refills and the write-back requests, above the
+    // outstanding requests' range
+    localparam [AXI_ID_W-1:0] WB_ID = AXI_ID_MASK ^ OSTDREQ_NUM;
+    // ID of the prefetches and the MSHRs' block reads, when using MSHRs
+    localparam [AXI_ID_W-1:0] PF_ID = AXI_ID_MASK ^ (OSTDREQ_NUM + 1);
+    localparam [AXI_ID_W-1:0] MSHR_ID = AXI_ID_MASK ^ (2 * OSTDREQ_NUM);
+
+    // The read completions need to be reordered if serving IO requests or
+    // if the missing requests complete after the next ones
+    localparam RD_OOO = (IO_MAP_NB > 0) || (MSHR_NUM > 0);
+
     // Signals driving the cache blocks
 
     logic                          fetcher_cache_ren;
@@ -203,8 +256,8 @@ module friscv_dcache
 
     logic                          memctrl_wvalid;
     logic                          memctrl_wready;
-    logic [XLEN              -1:0] memctrl_wdata;
-    logic [XLEN/8            -1:0] memctrl_wstrb;
+    logic [CACHE_BLOCK_W     -1:0] memctrl_wdata;
+    logic [CACHE_BLOCK_W/8   -1:0] memctrl_wstrb;
 
     logic                          memctrl_bvalid;
     logic                          memctrl_bready;
@@ -221,6 +274,8 @@ module friscv_dcache
     logic [2                 -1:0] memctrl_rresp;
     // flag to indicate a flush request is under execution
     logic                          flushing;
+    // blocks' epoch, never moving without invalidation requests
+    logic                          epoch;
     // mix of ready flags between fetchers and read completer
     logic                          memfy_arready_w;
     logic                          memfy_awready_w;
@@ -244,6 +299,52 @@ module friscv_dcache
     // flag from prefetch to indicate the cache-miss block is under Write
     logic                          block_fill;
 
+    // read requests to the memory controller, before the hazard check
+    logic                          memctrl_arvalid_w;
+    logic                          memctrl_arready_w;
+    logic                          io_rready;
+    // block written in the cache from the memory controller
+    logic                          fill;
+    logic                          fill_ready;
+    // pusher's write channels
+    logic                          pusher_awvalid;
+    logic                          pusher_awready;
+    logic [AXI_ADDR_W        -1:0] pusher_awaddr;
+    logic [3                 -1:0] pusher_awprot;
+    logic [AXI_ID_W          -1:0] pusher_awid;
+    logic                          pusher_wvalid;
+    logic                          pusher_wready;
+    logic [CACHE_BLOCK_W     -1:0] pusher_wdata;
+    logic [CACHE_BLOCK_W/8   -1:0] pusher_wstrb;
+    logic                          pusher_mc_bvalid;
+    logic                          pusher_mc_bready;
+    // block refill on a store miss
+    logic                          refill_arvalid;
+    logic                          refill_arready;
+    logic [AXI_ADDR_W        -1:0] refill_araddr;
+    logic [AXI_ID_W          -1:0] refill_arid;
+    // block reads of the MSHRs
+    logic                          miss_arvalid;
+    logic                          miss_arready;
+    logic [AXI_ADDR_W        -1:0] miss_araddr;
+    logic [3                 -1:0] miss_arprot;
+    logic [AXI_ID_W          -1:0] miss_arid;
+    // prefetcher's read completed
+    logic                          pf_cpl;
+    // dirty blocks eviction
+    logic                          evict_valid;
+    logic                          evict_ready;
+    logic [AXI_ADDR_W        -1:0] evict_addr;
+    logic [CACHE_BLOCK_W     -1:0] evict_data;
+    logic                          rd_hazard;
+    logic                          evict_hazard;
+    logic                          wc_hazard;
+    logic                          wc_drained;
+    logic                          drained;
+    logic                          cleaning;
+    logic                          flusher_stall;
+    logic                          clean_ack_wb;
+
 
     ///////////////////////////////////////////////////////////////////////////
     // Parameters setup checks
@@ -251,6 +352,8 @@ module friscv_dcache
 
     initial begin
         `CHECKER((OSTDREQ_NUM%2 != 0), "OSTDREQ_NUM must be a power of two");
+        `CHECKER((WRITE_COMBINE && WC_TIMEOUT < 1), "WC_TIMEOUT must be greater than 0");
+        `CHECKER((MSHR_NUM > OSTDREQ_NUM), "MSHR_NUM can't be greater than OSTDREQ_NUM");
     end
 
 
@@ -262,7 +365,7 @@ module friscv_dcache
     // property of the requets
 
     generate
-    if (IO_MAP_NB > 0) begin: ARCH_MEMFY_MUX
+    if (RD_OOO) begin: ARCH_MEMFY_MUX
 
         assign memfy_arvalid_io = (memfy_arcache[1]) ? memfy_arvalid & rtag_avlb : 1'b0;
         assign memfy_arvalid_blk = (!memfy_arcache[1]) ? memfy_arvalid & rtag_avlb : 1'b0;
@@ -281,6 +384,7 @@ module friscv_dcache
         assign memfy_rresp = blk_fetcher_rresp;
         assign memfy_rdata = blk_fetcher_rdata;
         assign blk_fetcher_rready = memfy_rready;
+        assign io_rready = 1'b0;
     end
     endgenerate
 
@@ -291,9 +395,13 @@ module friscv_dcache
         .XLEN                (XLEN),
         .OSTDREQ_NUM         (OSTDREQ_NUM),
         .NO_CPL_BACKPRESSURE (1),
+        .MSHR_NUM            (MSHR_NUM),
+        .MSHR_ID             (MSHR_ID),
+        .EARLY_RESTART       (EARLY_RESTART),
         .AXI_ADDR_W          (AXI_ADDR_W),
         .AXI_ID_W            (AXI_ID_W),
-        .AXI_DATA_W          (AXI_DATA_W)
+        // The memory controller completes whole blocks
+        .AXI_DATA_W          (CACHE_BLOCK_W)
     )
     block_fetcher
     (
@@ -315,15 +423,27 @@ module friscv_dcache
         .mst_rid         (blk_fetcher_rid),
         .mst_rresp       (blk_fetcher_rresp),
         .mst_rdata       (blk_fetcher_rdata),
-        // status flag of the memory controller
-        .block_fill      (memctrl_rvalid & !memctrl_rcache),
+        // status flag of the memory controller. A load restarts once its
+        // block is written, a store following it could else miss the
+        // block still in flight and be lost by the refill
+        .block_fill      (fill),
+        .block_word      (1'b0),
         .cache_ren       (fetcher_cache_ren),
         .cache_raddr     (fetcher_cache_raddr),
         .cache_rprot     (fetcher_cache_rprot),
         .cache_rid       (fetcher_cache_rid),
         .cache_rdata     (fetcher_cache_rdata),
         .cache_hit       (fetcher_cache_hit),
-        .cache_miss      (fetcher_cache_miss)
+        .cache_miss      (fetcher_cache_miss),
+        // block reads of the MSHRs
+        .block_addr      (memctrl_raddr),
+        .block_rid       (memctrl_rid),
+        .block_data      (memctrl_rdata_blk),
+        .miss_arvalid    (miss_arvalid),
+        .miss_arready    (miss_arready),
+        .miss_araddr     (miss_araddr),
+        .miss_arprot     (miss_arprot),
+        .miss_arid       (miss_arid)
     );
 
     friscv_cache_prefetcher
@@ -335,7 +455,11 @@ module friscv_dcache
         .AXI_ID_W          (AXI_ID_W),
         .AXI_DATA_W        (AXI_DATA_W),
         .CACHE_PREFETCH_EN (CACHE_PREFETCH_EN),
-        .CACHE_BLOCK_W     (CACHE_BLOCK_W)
+        .CACHE_BLOCK_W     (CACHE_BLOCK_W),
+        .MISS_FETCH        (MSHR_NUM == 0),
+        .PREFETCH_ID       (PF_ID),
+        .STRIDE_TABLE      (STRIDE_TABLE),
+        .PREFETCH_DEGREE   (PREFETCH_DEGREE)
     )
     prefetcher
     (
@@ -349,7 +473,7 @@ module friscv_dcache
         .memctrl_arprot  (blk_fetcher_arprot),
         .memctrl_arid    (blk_fetcher_arid),
         // status flag of the memory controller
-        .mem_cpl_wr      (memctrl_rvalid & !memctrl_rcache),
+        .mem_cpl_wr      (pf_cpl),
         .mem_cpl_rid     (memctrl_rid),
         .block_fill      (block_fill),
         .cache_ren       (fetcher_cache_ren),
@@ -358,7 +482,13 @@ module friscv_dcache
         .cache_rprot     (fetcher_cache_rprot),
         .cache_rdata     (fetcher_cache_rdata),
         .cache_hit       (fetcher_cache_hit),
-        .cache_miss      (fetcher_cache_miss)
+        .cache_miss      (fetcher_cache_miss),
+        // loads accepted, training the stride prefetch
+        .train_valid     (memfy_arvalid_blk & memfy_arready_blk),
+        .train_addr      (memfy_araddr),
+        .train_pc        (memfy_arpc),
+        .perf_pf_issue   (perf_pf_issue),
+        .perf_pf_useful  (perf_pf_useful)
     );
 
 
@@ -401,35 +531,73 @@ module friscv_dcache
     endgenerate
 
     ////////////////////////////////////////////////////////////////////////////////////
-    // Drive read requests to memory controller, IO requests being always serviced first
+    // Drive read requests to memory controller, IO requests being always serviced first,
+    // then the store miss refills, the MSHRs' reads and the prefetches. A block can't
+    // be read while being written back or while its combined write is pending.
     ////////////////////////////////////////////////////////////////////////////////////
 
     generate
     if (IO_MAP_NB > 0) begin: ARCH_MEMCTRL_MUX
 
-        assign memctrl_arvalid = io_fetcher_arvalid | blk_fetcher_arvalid;
-
-        assign io_fetcher_arready = (io_fetcher_arvalid) ? memctrl_arready : 1'b0;
-        assign blk_fetcher_arready = (io_fetcher_arvalid) ? 1'b0 : memctrl_arready;
-
-        assign memctrl_araddr = (io_fetcher_arvalid) ? io_fetcher_araddr : blk_fetcher_araddr;
-        assign memctrl_arid = (io_fetcher_arvalid) ? io_fetcher_arid : blk_fetcher_arid;
-        assign memctrl_arprot = (io_fetcher_arvalid) ? io_fetcher_arprot : blk_fetcher_arprot;
+        assign memctrl_arvalid_w = io_fetcher_arvalid | refill_arvalid | miss_arvalid | blk_fetcher_arvalid;
+
+        assign io_fetcher_arready = (io_fetcher_arvalid) ? memctrl_arready_w : 1'b0;
+        assign refill_arready = (io_fetcher_arvalid) ? 1'b0 : memctrl_arready_w;
+        assign miss_arready = (io_fetcher_arvalid || refill_arvalid) ? 1'b0 : memctrl_arready_w;
+        assign blk_fetcher_arready = (io_fetcher_arvalid || refill_arvalid || miss_arvalid) ? 1'b0 :
+                                                                                              memctrl_arready_w;
+
+        assign memctrl_araddr = (io_fetcher_arvalid) ? io_fetcher_araddr :
+                                (refill_arvalid)     ? refill_araddr :
+                                (miss_arvalid)       ? miss_araddr :
+                                                       blk_fetcher_araddr;
+        assign memctrl_arid = (io_fetcher_arvalid) ? io_fetcher_arid :
+                              (refill_arvalid)     ? refill_arid :
+                              (miss_arvalid)       ? miss_arid :
+                                                     blk_fetcher_arid;
+        assign memctrl_arprot = (io_fetcher_arvalid) ? io_fetcher_arprot :
+                                (refill_arvalid)     ? 3'b0 :
+                                (miss_arvalid)       ? miss_arprot :
+                                                       blk_fetcher_arprot;
         assign memctrl_arcache = (io_fetcher_arvalid) ? 4'b0010 : 4'b0000;
+        assign memctrl_rready = (memctrl_rcache) ? io_rready : fill_ready;
 
     end else begin: BLK_TO_MEMCTRL
 
-        assign memctrl_arvalid = blk_fetcher_arvalid;
-        assign blk_fetcher_arready = memctrl_arready;
-        assign memctrl_araddr = blk_fetcher_araddr;
-        assign memctrl_arid = blk_fetcher_arid;
-        assign memctrl_arprot = blk_fetcher_arprot;
+        assign memctrl_arvalid_w = refill_arvalid | miss_arvalid | blk_fetcher_arvalid;
+        assign refill_arready = memctrl_arready_w;
+        assign miss_arready = (refill_arvalid) ? 1'b0 : memctrl_arready_w;
+        assign blk_fetcher_arready = (refill_arvalid || miss_arvalid) ? 1'b0 : memctrl_arready_w;
+        assign memctrl_araddr = (refill_arvalid) ? refill_araddr :
+                                (miss_arvalid)   ? miss_araddr :
+                                                   blk_fetcher_araddr;
+        assign memctrl_arid = (refill_arvalid) ? refill_arid :
+                              (miss_arvalid)   ? miss_arid :
+                                                 blk_fetcher_arid;
+        assign memctrl_arprot = (refill_arvalid) ? 3'b0 :
+                                (miss_arvalid)   ? miss_arprot :
+                                                   blk_fetcher_arprot;
         assign memctrl_arcache = 4'b0000;
-        assign memctrl_rready = 1'b1;
+        assign memctrl_rready = fill_ready;
 
     end
     endgenerate
 
+    assign rd_hazard = evict_hazard | wc_hazard;
+
+    assign memctrl_arvalid = memctrl_arvalid_w & !(rd_hazard & !memctrl_arcache[1]);
+    assign memctrl_arready_w = memctrl_arready & !(rd_hazard & !memctrl_arcache[1]);
+
+    // A block is written in the cache once the eviction of the victim can be
+    // accepted and if not colliding with the flusher or a store updating the
+    // cache blocks
+    assign fill_ready = evict_ready & !cache_wren & !pusher_cache_ren & !pusher_cache_wen;
+    assign fill = memctrl_rvalid & !memctrl_rcache & fill_ready;
+
+    // With MSHRs, the prefetcher only waits for its own reads
+    assign pf_cpl = (MSHR_NUM > 0) ? fill & (memctrl_rid==PF_ID) :
+                                     fill & (memctrl_rid!=WB_ID || !WRITE_BACK);
+
 
     ///////////////////////////////////////////////////////////////////////////
     // Manage the read channels, distributing tags and routing read data completion
@@ -437,7 +605,7 @@ module friscv_dcache
     ///////////////////////////////////////////////////////////////////////////
 
 
-    if (IO_MAP_NB > 0) begin: RD_OOO_INSTANCE
+    if (RD_OOO) begin: RD_OOO_INSTANCE
 
     friscv_cache_ooo_mgt
     #(
@@ -474,7 +642,7 @@ module friscv_dcache
         .cpl1_data          (blk_fetcher_rdata),
         // read data completion from memory controller for IO R/W
         .cpl2_valid         (memctrl_rvalid & memctrl_rcache),
-        .cpl2_ready         (memctrl_rready),
+        .cpl2_ready         (io_rready),
         .cpl2_id            (memctrl_rid),
         .cpl2_resp          (memctrl_rresp),
         .cpl2_data          (memctrl_rdata),
@@ -501,13 +669,23 @@ module friscv_dcache
         .AXI_ID_W        (AXI_ID_W),
         .AXI_DATA_W      (AXI_DATA_W),
         .AXI_ID_MASK     (AXI_ID_MASK),
-        .CACHE_BLOCK_W   (CACHE_BLOCK_W)
+        .CACHE_BLOCK_W   (CACHE_BLOCK_W),
+        .WRITE_BACK      (WRITE_BACK),
+        .WRITE_COMBINE   (WRITE_COMBINE && !WRITE_BACK),
+        .WC_TIMEOUT      (WC_TIMEOUT),
+        .OWN_ID          (WB_ID)
     )
     pusher
     (
         .aclk            (aclk),
         .aresetn         (aresetn),
         .srst            (srst),
+        // combined writes drained on FENCE
+        .drain           (clean_blocks),
+        .drained         (wc_drained),
+        .rd_valid        (memctrl_arvalid_w & !memctrl_arcache[1]),
+        .rd_addr         (memctrl_araddr),
+        .rd_hazard       (wc_hazard),
         // write addess channels from application
         .mst_awvalid     (memfy_awvalid),
         .mst_awready     (memfy_awready_w),
@@ -524,19 +702,26 @@ module friscv_dcache
         .mst_bid         (pusher_bid),
         .mst_bresp       (pusher_bresp),
         // write interface to memory controller
-        .memctrl_awvalid (memctrl_awvalid),
-        .memctrl_awready (memctrl_awready),
-        .memctrl_awaddr  (memctrl_awaddr),
-        .memctrl_awprot  (memctrl_awprot),
-        .memctrl_awid    (memctrl_awid),
-        .memctrl_wvalid  (memctrl_wvalid),
-        .memctrl_wready  (memctrl_wready),
-        .memctrl_wdata   (memctrl_wdata),
-        .memctrl_wstrb   (memctrl_wstrb),
-        .memctrl_bvalid  (memctrl_bvalid),
-        .memctrl_bready  (memctrl_bready),
+        .memctrl_awvalid (pusher_awvalid),
+        .memctrl_awready (pusher_awready),
+        .memctrl_awaddr  (pusher_awaddr),
+        .memctrl_awprot  (pusher_awprot),
+        .memctrl_awid    (pusher_awid),
+        .memctrl_wvalid  (pusher_wvalid),
+        .memctrl_wready  (pusher_wready),
+        .memctrl_wdata   (pusher_wdata),
+        .memctrl_wstrb   (pusher_wstrb),
+        .memctrl_bvalid  (pusher_mc_bvalid),
+        .memctrl_bready  (pusher_mc_bready),
         .memctrl_bid     (memctrl_bid),
         .memctrl_bresp   (memctrl_bresp),
+        // block refill on a store miss
+        .refill_arvalid  (refill_arvalid),
+        .refill_arready  (refill_arready),
+        .refill_araddr   (refill_araddr),
+        .refill_arid     (refill_arid),
+        .block_fill      (fill),
+        .block_addr      (memctrl_raddr),
         // cache write interface to update a cache block
         .cache_ren       (pusher_cache_ren),
         .cache_raddr     (pusher_cache_raddr),
@@ -609,7 +794,11 @@ module friscv_dcache
         .WLEN          (XLEN),
         .ADDR_W        (AXI_ADDR_W),
         .CACHE_BLOCK_W (CACHE_BLOCK_W),
-        .CACHE_DEPTH   (CACHE_DEPTH)
+        .CACHE_DEPTH   (CACHE_DEPTH),
+        .CACHE_WAYS    (CACHE_WAYS),
+        .WRITE_BACK    (WRITE_BACK),
+        .VICTIM_NB     (VICTIM_NB),
+        .EPOCH_W       (1)
     )
     cache_blocks
     (
@@ -617,7 +806,9 @@ module friscv_dcache
         .aresetn    (aresetn),
         .srst       (srst),
         .flush      (flushing),
-        .p1_wen     (memctrl_rvalid & !memctrl_rcache | cache_wren),
+        .epoch      (epoch),
+        .clean      (cleaning),
+        .p1_wen     (fill | cache_wren),
         .p1_wstrb   ({CACHE_BLOCK_W/8{1'b1}}),
         .p1_waddr   ((cache_wren) ? cache_waddr : memctrl_raddr),
         .p1_wdata   ((cache_wren) ? cache_wdata : memctrl_rdata_blk),
@@ -634,16 +825,29 @@ module friscv_dcache
         .p2_raddr   (pusher_cache_raddr),
         .p2_rdata   (),
         .p2_hit     (pusher_cache_hit),
-        .p2_miss    (pusher_cache_miss)
+        .p2_miss    (pusher_cache_miss),
+        .way_hits   (perf_hits),
+        .victim_hit (perf_victim_hit),
+        .evict_valid(evict_valid),
+        .evict_addr (evict_addr),
+        .evict_data (evict_data)
     );
 
+    assign perf_miss = fetcher_cache_miss | pusher_cache_miss;
+
+
+    // A clean step waits for the eviction buffer and the stores
+    assign flusher_stall = !evict_ready | pusher_cache_ren | pusher_cache_wen;
 
     friscv_cache_flusher
     #(
         .NAME          ("dCache-Flusher"),
         .CACHE_BLOCK_W (CACHE_BLOCK_W),
         .CACHE_DEPTH   (CACHE_DEPTH),
-        .AXI_ADDR_W    (AXI_ADDR_W)
+        .CACHE_WAYS    (CACHE_WAYS),
+        .EPOCH_W       (1),
+        .AXI_ADDR_W    (AXI_ADDR_W),
+        .WRITE_BACK    (WRITE_BACK)
     )
     flusher
     (
@@ -651,15 +855,157 @@ module friscv_dcache
         .aresetn      (aresetn),
         .srst         (srst),
         .ready        (cache_ready),
-        .flush_blocks (1'b0),
-        .flush_ack    (),
+        .flush_blocks ((WRITE_BACK) ? clean_blocks : 1'b0),
+        .refilling    (1'b0),
+        .flush_ack    (clean_ack_wb),
         .flushing     (flushing),
+        .epoch        (epoch),
+        .cleaning     (cleaning),
+        .stall        (flusher_stall),
+        .drained      (drained),
         .cache_wren   (cache_wren),
         .cache_waddr  (cache_waddr),
         .cache_wdata  (cache_wdata)
     );
 
 
+    // With write-through, only the combined writes need to reach the memory
+    assign clean_ack = (WRITE_BACK) ? clean_ack_wb : clean_blocks & wc_drained;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Write-back buffer and write channels arbitration, the dirty blocks
+    // being written first. A source is selected until both its address and
+    // data are issued, the write responses being routed with the ID.
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (WRITE_BACK) begin: WB_BUFFER
+
+        logic                          evict_awvalid;
+        logic                          evict_awready;
+        logic [AXI_ADDR_W        -1:0] evict_awaddr;
+        logic [3                 -1:0] evict_awprot;
+        logic [AXI_ID_W          -1:0] evict_awid;
+        logic                          evict_wvalid;
+        logic                          evict_wready;
+        logic [CACHE_BLOCK_W     -1:0] evict_wdata;
+        logic [CACHE_BLOCK_W/8   -1:0] evict_wstrb;
+        logic                          evict_bready;
+        logic                          wr_busy;
+        logic                          wr_sel_r;
+        logic                          wr_sel;
+        logic                          aw_done;
+        logic                          w_done;
+        logic                          aw_hs;
+        logic                          w_hs;
+
+        friscv_cache_evict_buffer
+        #(
+            .NAME            ("dCache-evict-buffer"),
+            .DEPTH           (EVICT_DEPTH),
+            .AXI_ADDR_W      (AXI_ADDR_W),
+            .AXI_ID_W        (AXI_ID_W),
+            // The memory controller writes whole blocks
+            .AXI_DATA_W      (CACHE_BLOCK_W),
+            .EVICT_ID        (WB_ID)
+        )
+        evict_buffer
+        (
+            .aclk            (aclk),
+            .aresetn         (aresetn),
+            .srst            (srst),
+            .drained         (drained),
+            .evict_valid     (evict_valid),
+            .evict_ready     (evict_ready),
+            .evict_addr      (evict_addr),
+            .evict_data      (evict_data),
+            .rd_addr         (memctrl_araddr),
+            .rd_hazard       (evict_hazard),
+            .memctrl_awvalid (evict_awvalid),
+            .memctrl_awready (evict_awready),
+            .memctrl_awaddr  (evict_awaddr),
+            .memctrl_awprot  (evict_awprot),
+            .memctrl_awid    (evict_awid),
+            .memctrl_wvalid  (evict_wvalid),
+            .memctrl_wready  (evict_wready),
+            .memctrl_wdata   (evict_wdata),
+            .memctrl_wstrb   (evict_wstrb),
+            .memctrl_bvalid  (memctrl_bvalid & memctrl_bid==WB_ID),
+            .memctrl_bready  (evict_bready)
+        );
+
+        // 1 selects the eviction buffer, 0 the pusher
+        assign wr_sel = (wr_busy) ? wr_sel_r : evict_awvalid;
+
+        assign memctrl_awvalid = ((wr_sel) ? evict_awvalid : pusher_awvalid) & !aw_done;
+        assign memctrl_awaddr = (wr_sel) ? evict_awaddr : pusher_awaddr;
+        assign memctrl_awprot = (wr_sel) ? evict_awprot : pusher_awprot;
+        assign memctrl_awid = (wr_sel) ? evict_awid : pusher_awid;
+        assign memctrl_wvalid = ((wr_sel) ? evict_wvalid : pusher_wvalid) & !w_done;
+        assign memctrl_wdata = (wr_sel) ? evict_wdata : pusher_wdata;
+        assign memctrl_wstrb = (wr_sel) ? evict_wstrb : pusher_wstrb;
+
+        assign evict_awready = wr_sel & memctrl_awready & !aw_done;
+        assign pusher_awready = !wr_sel & memctrl_awready & !aw_done;
+        assign evict_wready = wr_sel & memctrl_wready & !w_done;
+        assign pusher_wready = !wr_sel & memctrl_wready & !w_done;
+
+        assign aw_hs = memctrl_awvalid & memctrl_awready;
+        assign w_hs = memctrl_wvalid & memctrl_wready;
+
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                wr_busy <= 1'b0;
+                wr_sel_r <= 1'b0;
+                aw_done <= 1'b0;
+                w_done <= 1'b0;
+            end else if (srst) begin
+                wr_busy <= 1'b0;
+                wr_sel_r <= 1'b0;
+                aw_done <= 1'b0;
+                w_done <= 1'b0;
+            end else begin
+                // Both channels issued, release the selection
+                if ((aw_done || aw_hs) && (w_done || w_hs)) begin
+                    wr_busy <= 1'b0;
+                    aw_done <= 1'b0;
+                    w_done <= 1'b0;
+                // Lock the source once started
+                end else if (aw_hs || w_hs) begin
+                    wr_busy <= 1'b1;
+                    wr_sel_r <= wr_sel;
+                    aw_done <= aw_done | aw_hs;
+                    w_done <= w_done | w_hs;
+                end
+            end
+        end
+
+        assign pusher_mc_bvalid = memctrl_bvalid & memctrl_bid!=WB_ID;
+        assign memctrl_bready = (memctrl_bid==WB_ID) ? evict_bready : pusher_mc_bready;
+
+    end else begin: WRITE_THROUGH
+
+        assign memctrl_awvalid = pusher_awvalid;
+        assign pusher_awready = memctrl_awready;
+        assign memctrl_awaddr = pusher_awaddr;
+        assign memctrl_awprot = pusher_awprot;
+        assign memctrl_awid = pusher_awid;
+        assign memctrl_wvalid = pusher_wvalid;
+        assign pusher_wready = memctrl_wready;
+        assign memctrl_wdata = pusher_wdata;
+        assign memctrl_wstrb = pusher_wstrb;
+        assign pusher_mc_bvalid = memctrl_bvalid;
+        assign memctrl_bready = pusher_mc_bready;
+
+        assign evict_ready = 1'b1;
+        assign evict_hazard = 1'b0;
+        assign drained = 1'b1;
+
+    end
+    endgenerate
+
+
     ///////////////////////////////////////////////////////////////////////////
     // AXI4 memory controller to read external memory
     ///////////////////////////////////////////////////////////////////////////
@@ -674,7 +1020,8 @@ module friscv_dcache
         .AXI_ID_W      (AXI_ID_W),
         .AXI_DATA_W    (AXI_DATA_W),
         .AXI_ID_MASK   (AXI_ID_MASK),
-        .AXI_IN_ORDER  (IO_MAP_NB==0),
+        .AXI_IN_ORDER  (IO_MAP_NB==0 && MSHR_NUM==0),
+        .AXI_WRAP      (AXI_WRAP),
         .CACHE_BLOCK_W (CACHE_BLOCK_W)
     )
     mem_ctrl
@@ -698,6 +1045,7 @@ module friscv_dcache
         .mst_rresp      (memctrl_rresp),
         .mst_rdata_blk  (memctrl_rdata_blk),
         .mst_rdata      (memctrl_rdata),
+        .mst_rword      (),
         // AXI4-lite write channels from pusher stage
         .mst_awvalid    (memctrl_awvalid),
         .mst_awready    (memctrl_awready),
@@ -4,10 +4,14 @@
 `timescale 1 ns / 1 ps
 `default_nettype none
 
+`include "friscv_h.sv"
+
 module friscv_decoder
 
     #(
-        parameter XLEN = 32
+        parameter XLEN = 32,
+        // Atomic extension support, else the atomics are illegal
+        parameter A_EXTENSION = 0
     )(
         input  wire  [XLEN -1:0] instruction,
         output logic [7    -1:0] opcode,
@@ -213,6 +217,35 @@ module friscv_decoder
                 imm20 = 20'b0;
             end
 
+            // Atomic (LR / SC / AMO), addressed by rs1 only. Only the word
+            // width is supported, LR expects rs2 to be x0
+            7'b0101111: begin
+                lui = 1'b0;
+                auipc = 1'b0;
+                jal = 1'b0;
+                jalr = 1'b0;
+                branching = 1'b0;
+                sys = 6'b0;
+                fence = 2'b0;
+                if (A_EXTENSION==0 || instruction[14:12]!=3'b010 ||
+                    instruction[27+:5]==`LR && instruction[24:20]!=5'b0 ||
+                    !(instruction[27+:5]==`LR      || instruction[27+:5]==`SC      ||
+                      instruction[27+:5]==`AMOSWAP || instruction[27+:5]==`AMOADD  ||
+                      instruction[27+:5]==`AMOXOR  || instruction[27+:5]==`AMOAND  ||
+                      instruction[27+:5]==`AMOOR   || instruction[27+:5]==`AMOMIN  ||
+                      instruction[27+:5]==`AMOMAX  || instruction[27+:5]==`AMOMINU ||
+                      instruction[27+:5]==`AMOMAXU))
+                begin
+                    processing = 1'b0;
+                    dec_error = 1'b1;
+                end else begin
+                    processing = 1'b1;
+                    dec_error = 1'b0;
+                end
+                imm12 = 12'b0;
+                imm20 = 20'b0;
+            end
+
             // Arithmetic
             7'b0010011: begin
                 lui = 1'b0;
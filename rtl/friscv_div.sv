@@ -3,17 +3,27 @@
 
 /////////////////////////////////////////////////////////////////////////////////
 //
-// Integer division, explanation from: 
+// Integer division, explanation from:
 //   - https://www.wikihow.com/Divide-Binary-Numbers
 //   - https://projectf.io/posts/division-in-verilog/
 //
-// AXI4-stream support, back-pressure, flag for division by zero to handle trap, 
+// AXI4-stream support, back-pressure, flag for division by zero to handle trap,
 // support signed division.
 //
-// TODO: Save bandwidth by avoiding moving back and forth IDLE/OP if valid is 
-// already asserted when division is finished
-// TODO: manage pow2 division with a simple mux
-// TODO: save computation time by check the first MSB to use different than 0
+// The division is a restoring one, operating on the absolute values, the signs
+// being applied on the results. The architecture is configurable:
+//
+// - RADIX: 2 retires one quotient bit per cycle, 4 retires two bits per cycle,
+//   comparing the partial remainder against 1, 2 and 3 times the divisor in
+//   parallel
+// - EARLY_TERM: skips the leading zeros of the dividend, the number of cycles
+//   depending on its magnitude, and completes immediately if the dividend is
+//   smaller than the divisor
+// - POW2: a power of two divisor is handled with a shift and a mask in a
+//   single cycle
+//
+// A new division can be accepted in the same cycle the previous result is
+// delivered.
 //
 /////////////////////////////////////////////////////////////////////////////////
 
@@ -24,7 +34,13 @@
 module friscv_div
 
     #(
-        parameter WIDTH  = 32
+        parameter WIDTH  = 32,
+        // Radix of the division, 2 or 4
+        parameter RADIX = 2,
+        // Skip the leading zeros of the dividend
+        parameter EARLY_TERM = 0,
+        // Single cycle division for power of two divisors
+        parameter POW2 = 0
     )(
         // clock & reset
         input  wire                       aclk,
@@ -50,17 +66,28 @@ module friscv_div
     // Parameters, variables and functions declaration
     ///////////////////////////////////////////////////////////////////////////
 
-    logic [WIDTH         -1:0] _divs;                   // divisor
-    logic [WIDTH         -1:0] quot_next;               // intermediate quotient
-    logic [WIDTH           :0] acc, acc_next, rem_sub;  // accumulator (1 bit wider)
-    logic                      computing;
-    logic [2*WIDTH         :0] acc_quot_w;
+    // Quotient bits retired per cycle
+    localparam                 STEP_W = (RADIX==4) ? 2 : 1;
+    localparam                 CWIDTH = $clog2(WIDTH+1);
 
-    localparam                 CWIDTH = $clog2(WIDTH);
-    logic [CWIDTH        -1:0] step_cnt;                   // iteration counter
+    logic [WIDTH         -1:0] _divd;                   // dividend, absolute value
+    logic [WIDTH         -1:0] _divs;                   // divisor, absolute value
+    logic [WIDTH         -1:0] divs_r;                  // divisor used along the division
+    logic [WIDTH         -1:0] acc, acc_next;           // partial remainder
+    logic [WIDTH         -1:0] quot_r, quot_next;       // dividend bits then quotient bits
+    logic                      computing;
+    logic [CWIDTH        -1:0] step_cnt;                // remaining iterations
     logic                      quot_sign;
     logic                      rem_sign;
 
+    logic [CWIDTH        -1:0] lzc;                     // dividend's leading zeros
+    logic [CWIDTH        -1:0] skip;                    // bits skipped
+    logic                      smaller;                 // dividend < divisor
+    logic                      divs_pow2;
+    logic [CWIDTH        -1:0] divs_log2;
+    logic                      start;
+    logic                      done;
+
     function automatic [WIDTH-1:0] inv_sign(
         input logic  [WIDTH-1:0] number
     );
@@ -68,138 +95,222 @@ module friscv_div
     endfunction
 
     ///////////////////////////////////////////////////////////////////////////
-    // Division
+    // Operands conditioning
     ///////////////////////////////////////////////////////////////////////////
 
-    // assign rem = acc[WIDTH-1:0];
+    assign _divd = (signed_div & divd[WIDTH-1]) ? inv_sign(divd) : divd;
+    assign _divs = (signed_div & divs[WIDTH-1]) ? inv_sign(divs) : divs;
+
+    // Leading zeros of the dividend
+    always @ (*) begin
+        lzc = WIDTH[CWIDTH-1:0];
+        for (int i=0;i<WIDTH;i=i+1)
+            if (_divd[i]) lzc = WIDTH - 1 - i;
+    end
+
+    generate
+    if (EARLY_TERM) begin: EARLY_TERM_ON
+        // Rounded to the bits retired per cycle, one iteration at least
+        assign skip = (lzc==WIDTH) ? WIDTH[CWIDTH-1:0] - STEP_W[CWIDTH-1:0] :
+                                     lzc / STEP_W * STEP_W;
+        assign smaller = (_divd < _divs);
+    end else begin: EARLY_TERM_OFF
+        assign skip = {CWIDTH{1'b0}};
+        assign smaller = 1'b0;
+    end
+    endgenerate
+
+    // A power of two divisor has a single bit set
+    generate
+    if (POW2) begin: POW2_ON
+        assign divs_pow2 = (_divs & (_divs - 1))=={WIDTH{1'b0}};
+        always @ (*) begin
+            divs_log2 = {CWIDTH{1'b0}};
+            for (int i=0;i<WIDTH;i=i+1)
+                if (_divs[i]) divs_log2 = i;
+        end
+    end else begin: POW2_OFF
+        assign divs_pow2 = 1'b0;
+        assign divs_log2 = {CWIDTH{1'b0}};
+    end
+    endgenerate
+
+    assign i_ready = !computing & (!o_valid | o_ready);
+
+    assign start = i_valid & i_ready;
+
+    assign done = computing & (step_cnt=={CWIDTH{1'b0}});
+
+    assign div_pending = computing | o_valid;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Division
+    ///////////////////////////////////////////////////////////////////////////
 
     always @ (posedge aclk or negedge aresetn) begin
         if (!aresetn) begin
             zero_div <= 1'b0;
             quot_sign <= 1'b0;
             rem_sign <= 1'b0;
-            _divs <= {WIDTH{1'b0}};
+            divs_r <= {WIDTH{1'b0}};
             quot <= {WIDTH{1'b0}};
             rem <= {WIDTH{1'b0}};
-            acc <= {WIDTH+1{1'b0}};
-            i_ready <= 1'b0;
+            acc <= {WIDTH{1'b0}};
+            quot_r <= {WIDTH{1'b0}};
             o_valid <= 1'b0;
             computing <= 1'b0;
             step_cnt <= {CWIDTH{1'b0}};
-            div_pending <= 1'b0;
         end else if (srst) begin
             zero_div <= 1'b0;
             quot_sign <= 1'b0;
             rem_sign <= 1'b0;
-            _divs <= {WIDTH{1'b0}};
+            divs_r <= {WIDTH{1'b0}};
             quot <= {WIDTH{1'b0}};
             rem <= {WIDTH{1'b0}};
-            acc <= {WIDTH+1{1'b0}};
-            i_ready <= 1'b0;
+            acc <= {WIDTH{1'b0}};
+            quot_r <= {WIDTH{1'b0}};
             o_valid <= 1'b0;
             computing <= 1'b0;
             step_cnt <= {CWIDTH{1'b0}};
-            div_pending <= 1'b0;
         end else begin
 
+            if (o_valid && o_ready) begin
+                o_valid <= 1'b0;
+            end
+
             /////////////////////////////////
             // Operating, division is ongoing
             /////////////////////////////////
             if (computing) begin
 
-                // Division is done
-                if (step_cnt==(WIDTH-1)) begin
+                acc <= acc_next;
+                quot_r <= quot_next;
 
+                // Division is done
+                if (done) begin
                     o_valid <= 1'b1;
+                    computing <= 1'b0;
                     if (quot_sign) quot <= inv_sign(quot_next);
                     else quot <= quot_next;
-                    if (rem_sign) rem <= inv_sign(acc_next[WIDTH:1]);
-                    else rem <= acc_next[WIDTH:1];
-                    // if slave is ready, move to the next operation from IDLE state
-                    if (o_ready) begin
-                        computing <= 1'b0;
-                        step_cnt <= {CWIDTH{1'b0}};
-                    end
-
+                    if (rem_sign) rem <= inv_sign(acc_next);
+                    else rem <= acc_next;
                 // Else continue the division
                 end else begin
-                    step_cnt <= step_cnt + 1;
-                    acc <= acc_next;
-                    quot <= quot_next;
+                    step_cnt <= step_cnt - 1;
                 end
 
             ////////////////////////////////
             // IDLE, wait for next operation
             ////////////////////////////////
-            end else if (i_valid) begin
+            end else if (start) begin
 
                 // Flag used to convert the quotient to negative if only
                 // division is supposed to be signed and quotient or divisor is negative
                 quot_sign <= signed_div & (divd[WIDTH-1] ^ divs[WIDTH-1]);
                 rem_sign <= signed_div & divd[WIDTH-1];
 
-                // Previous version commented because issue from verilator 5.016
-                // Convert dividend to positive
-                if (signed_div & divd[WIDTH-1]) begin
-                    // {acc, quot} <= {{WIDTH{1'b0}}, inv_sign(divd), 1'b0};
-                end else begin
-                    // {acc, quot} <= {{WIDTH{1'b0}}, divd, 1'b0};
-                end
-
-                // For Verilator 5.016
-                quot <= acc_quot_w[0+:WIDTH];
-                acc <= acc_quot_w[WIDTH+:(WIDTH+1)];
-
-                // Convert divisor to positive
-                if (signed_div & divs[WIDTH-1]) _divs <= inv_sign(divs);
-                else _divs <= divs;
-
-                o_valid <= 1'b0;
-                i_ready <= 1'b1;
-                step_cnt <= {CWIDTH{1'b0}};
+                divs_r <= _divs;
+                zero_div <= 1'b0;
 
                 // Complete ASAP if trying to divide by zero
                 if (divs=={WIDTH{1'b0}}) begin
                     zero_div <= 1'b1;
                     o_valid <= 1'b1;
-                    i_ready <= 1'b1;
                     quot <= {WIDTH{1'b1}};
                     rem <= divd;
-                    div_pending <= 1'b0;
-                // Move to compute the division
+
+                // Dividend smaller than the divisor, nothing to compute
+                end else if (smaller) begin
+                    o_valid <= 1'b1;
+                    quot <= {WIDTH{1'b0}};
+                    rem <= divd;
+
+                // Power of two divisor, shift the dividend and mask the
+                // remainder
+                end else if (divs_pow2) begin
+                    o_valid <= 1'b1;
+                    if (signed_div & (divd[WIDTH-1] ^ divs[WIDTH-1]))
+                        quot <= inv_sign(_divd >> divs_log2);
+                    else
+                        quot <= _divd >> divs_log2;
+                    if (signed_div & divd[WIDTH-1])
+                        rem <= inv_sign(_divd & (_divs - 1));
+                    else
+                        rem <= _divd & (_divs - 1);
+
+                // Move to compute the division, the leading zeros being
+                // already shifted out
                 end else begin
-                    zero_div <= 1'b0;
-                    o_valid <= 1'b0;
-                    i_ready <= 1'b0;
+                    acc <= {WIDTH{1'b0}};
+                    quot_r <= _divd << skip;
+                    step_cnt <= (WIDTH[CWIDTH-1:0] - skip) / STEP_W - 1;
                     computing <= 1'b1;
-                    div_pending <= 1'b1;
                 end
-
-            end else begin
-                i_ready <= 1'b1;
-                o_valid <= 1'b0;
-                div_pending <= 1'b0;
             end
         end
     end
 
-    // For Verilator 5.016
-    always @ (*) begin
-        if (signed_div & divd[WIDTH-1]) begin
-            acc_quot_w = {{WIDTH{1'b0}}, inv_sign(divd), 1'b0};
-        end else begin
-            acc_quot_w = {{WIDTH{1'b0}}, divd, 1'b0};
+    ///////////////////////////////////////////////////////////////////////////
+    // Iteration, the partial remainder is always smaller than the divisor
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (RADIX==4) begin: RADIX4
+
+        logic [WIDTH+2       -1:0] acc_sh;
+        logic [WIDTH+2       -1:0] divs_x1;
+        logic [WIDTH+2       -1:0] divs_x2;
+        logic [WIDTH+2       -1:0] divs_x3;
+        logic [WIDTH+2       -1:0] sub_x1;
+        logic [WIDTH+2       -1:0] sub_x2;
+        logic [WIDTH+2       -1:0] sub_x3;
+
+        assign acc_sh = {acc, quot_r[WIDTH-1-:2]};
+        assign divs_x1 = {2'b0, divs_r};
+        assign divs_x2 = {1'b0, divs_r, 1'b0};
+        assign divs_x3 = divs_x1 + divs_x2;
+
+        assign sub_x1 = acc_sh - divs_x1;
+        assign sub_x2 = acc_sh - divs_x2;
+        assign sub_x3 = acc_sh - divs_x3;
+
+        // Select the greatest multiple of the divisor to subtract
+        always @ (*) begin
+            if (acc_sh >= divs_x3) begin
+                acc_next = sub_x3[WIDTH-1:0];
+                quot_next = {quot_r[WIDTH-3:0], 2'h3};
+            end else if (acc_sh >= divs_x2) begin
+                acc_next = sub_x2[WIDTH-1:0];
+                quot_next = {quot_r[WIDTH-3:0], 2'h2};
+            end else if (acc_sh >= divs_x1) begin
+                acc_next = sub_x1[WIDTH-1:0];
+                quot_next = {quot_r[WIDTH-3:0], 2'h1};
+            end else begin
+                acc_next = acc_sh[WIDTH-1:0];
+                quot_next = {quot_r[WIDTH-3:0], 2'h0};
+            end
         end
-    end
 
-    always @ (*) begin
-        rem_sub = acc - _divs;
-        if (acc >= {1'b0,_divs}) begin
-            {acc_next, quot_next} = {rem_sub[WIDTH-1:0], quot, 1'b1};
-        end else begin
-            {acc_next, quot_next} = {acc, quot} << 1;
+    end else begin: RADIX2
+
+        logic [WIDTH+1       -1:0] acc_sh;
+        logic [WIDTH+1       -1:0] sub_x1;
+
+        assign acc_sh = {acc, quot_r[WIDTH-1]};
+        assign sub_x1 = acc_sh - {1'b0, divs_r};
+
+        always @ (*) begin
+            if (acc_sh >= {1'b0, divs_r}) begin
+                acc_next = sub_x1[WIDTH-1:0];
+                quot_next = {quot_r[WIDTH-2:0], 1'b1};
+            end else begin
+                acc_next = acc_sh[WIDTH-1:0];
+                quot_next = {quot_r[WIDTH-2:0], 1'b0};
+            end
         end
+
     end
+    endgenerate
 
 endmodule
 
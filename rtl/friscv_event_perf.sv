@@ -0,0 +1,42 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+/*
+* This module counts the occurrences of internal events (branch prediction,
+* cache hit/miss, ...) and returns one register per event. An event is a
+* one-cycle pulse, asserted as many cycles as the event occurred.
+*/
+
+module friscv_event_perf
+
+    #(
+        parameter REG_W    = 32,
+        parameter NB_EVENT = 1
+    )(
+        input  wire                        aclk,
+        input  wire                        aresetn,
+        input  wire                        srst,
+        input  wire  [NB_EVENT       -1:0] events,
+        output logic [NB_EVENT*REG_W -1:0] perfs
+    );
+
+    for (genvar i=0;i<NB_EVENT;i++) begin
+
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                perfs[i*REG_W+:REG_W] <= '0;
+            end else if (srst) begin
+                perfs[i*REG_W+:REG_W] <= '0;
+            end else begin
+                if (events[i])
+                    perfs[i*REG_W+:REG_W] <= perfs[i*REG_W+:REG_W] + 1;
+            end
+        end
+    end
+
+endmodule
+
+`resetall
@@ -0,0 +1,523 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+`include "friscv_h.sv"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Fetch stage of the control unit, decoupled from the execution FSM:
+//
+// - drives the instruction read address channel, incrementing the address
+//   or following the branch predictor as long the cache accepts requests.
+//   The control unit only redirects the stream on a jump, a trap or a
+//   FENCE.i, each new batch using a new AXI ID to discard the in-flight
+//   instructions of the previous one.
+// - stores the incoming instructions into a queue, filled whatever the
+//   execution stage is doing, so the cache keeps serving the next
+//   instructions while the control unit stalls on the processing, the CSRs
+//   or the data memory. The queue is bypassed when empty.
+// - pre-decodes the instructions before storing them, the control unit
+//   getting along the instruction the flags selecting its execution path
+//   (jumps, branches, system, ...).
+//
+// The queue exposes its two oldest instructions, one or two instructions
+// being pulled per cycle (dual-issue).
+//
+// With the compressed extension, the read requests are always word-aligned
+// and a realignment stage extracts the instructions from the halfwords
+// received, whatever their alignment. A 32 bits instruction can span two
+// words, so two cache blocks. The compressed instructions are expanded to
+// their 32 bits equivalent before being pre-decoded and stored, flagged as
+// compressed for the program counter increment.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+module friscv_fetch
+
+    #(
+        // Instruction length (always 32, whatever the architecture)
+        parameter ILEN = 32,
+        // Registers width, 32 bits for RV32i
+        parameter XLEN = 32,
+        // Address bus width
+        parameter AXI_ADDR_W = ILEN,
+        // AXI ID width
+        parameter AXI_ID_W = 8,
+        // Maximum range used when generating an AXI ID
+        parameter MAX_ID_RANGE = 8,
+        // ID used to identify the instruction bus in the infrastructure
+        parameter AXI_ID_MASK = 'h10,
+        // AXI4 data width
+        parameter AXI_DATA_W = XLEN,
+        // Number of instructions the queue can store, power of two,
+        // 0 to connect the read data channel directly to the control unit
+        parameter DEPTH = 4,
+        // Primary address to boot to load the firmware
+        parameter BOOT_ADDR = 0,
+        // Compressed extension support
+        parameter C_EXTENSION = 0,
+        // Atomic extension support, else the atomics are pre-decoded illegal
+        parameter A_EXTENSION = 0,
+        // Number of taken predictions in-flight (branch predictor)
+        parameter PRED_OSTD_NUM = 4
+    )(
+        // clock & reset
+        input  wire                       aclk,
+        input  wire                       aresetn,
+        input  wire                       srst,
+        // Drop the stored instructions
+        input  wire                       flush,
+        // Redirection of the fetch stream by the control unit
+        input  wire                       boot,
+        input  wire                       jump,
+        input  wire                       jump_new_id,
+        input  wire  [AXI_ADDR_W    -1:0] jump_addr,
+        // Next address predicted
+        input  wire                       pred_taken,
+        input  wire  [AXI_ADDR_W    -1:0] pred_target,
+        // Predicted instruction ends in the upper halfword (compressed)
+        input  wire                       pred_half,
+        // instruction memory interface
+        input  wire                       arvalid,
+        input  wire                       arready,
+        output logic [AXI_ADDR_W    -1:0] araddr,
+        output logic [AXI_ID_W      -1:0] arid,
+        // The word requested is entered at its upper halfword (compressed)
+        output logic                      araddr_half,
+        input  wire                       rvalid,
+        output logic                      rready,
+        input  wire  [AXI_ID_W      -1:0] rid,
+        input  wire  [AXI_DATA_W    -1:0] rdata,
+        // Instructions to execute and their pre-decoded flags
+        output logic                      inst_ready,
+        output logic [ILEN          -1:0] instruction,
+        output logic [`PDC_W        -1:0] inst_flags,
+        output logic                      inst2_ready,
+        output logic [ILEN          -1:0] instruction2,
+        output logic [`PDC_W        -1:0] inst2_flags,
+        input  wire                       pull,
+        input  wire                       pull2
+    );
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Parameters and variables declarations
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    localparam MAX_ID = AXI_ID_MASK + MAX_ID_RANGE - 1;
+
+    logic [`PDC_W     -1:0] flags;
+    logic [`OPCODE_W  -1:0] opcode;
+    logic [`FUNCT7_W  -1:0] funct7;
+    logic                   processing;
+    logic                   dec_error;
+    logic                   push;
+    logic                   push_ready;
+    logic [ILEN       -1:0] fe_inst;
+    logic                   fe_rvc;
+    logic [AXI_ADDR_W -1:0] jump_araddr;
+    logic [AXI_ADDR_W -1:0] pred_araddr;
+    logic [AXI_ADDR_W -1:0] boot_araddr;
+    logic                   ar_half;
+
+
+    //////////////////////////////////////////////////////////////////////
+    // Return next ID for program counter increment during address jump
+    //////////////////////////////////////////////////////////////////////
+    function automatic logic [AXI_ID_W-1:0] next_id(
+        input logic  [AXI_ID_W-1:0] id,
+        input logic  [AXI_ID_W-1:0] max_id,
+        input logic  [AXI_ID_W-1:0] init_id
+    );
+        if (id==max_id) next_id = init_id;
+        else next_id = id + 1'b1;
+    endfunction
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Address channel: the stream restarts from a new address when the
+    // control unit jumps, else follows the predictor or increments by ILEN
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Compressed instructions can be halfword-aligned, the realignment
+    // stage drops the lower halfword of the first word if needed
+    generate
+    if (C_EXTENSION) begin: WORD_ALIGNED
+        assign jump_araddr = {jump_addr[AXI_ADDR_W-1:2], 2'b0};
+        assign pred_araddr = {pred_target[AXI_ADDR_W-1:2], 2'b0};
+        assign boot_araddr = {BOOT_ADDR[AXI_ADDR_W-1:2], 2'b0};
+    end else begin: NOT_ALIGNED
+        assign jump_araddr = jump_addr;
+        assign pred_araddr = pred_target;
+        assign boot_araddr = BOOT_ADDR;
+    end
+    endgenerate
+
+    always @ (posedge aclk or negedge aresetn) begin
+        if (!aresetn) begin
+            araddr <= {AXI_ADDR_W{1'b0}};
+            arid <= {AXI_ID_W{1'b0}};
+            ar_half <= 1'b0;
+        end else if (srst) begin
+            araddr <= {AXI_ADDR_W{1'b0}};
+            arid <= {AXI_ID_W{1'b0}};
+            ar_half <= 1'b0;
+        end else begin
+            if (boot) begin
+                arid <= AXI_ID_MASK;
+                araddr <= boot_araddr;
+                ar_half <= BOOT_ADDR[1];
+            end else if (jump) begin
+                // Get a new ID for the new batch
+                if (jump_new_id) arid <= next_id(arid, MAX_ID, AXI_ID_MASK);
+                araddr <= jump_araddr;
+                ar_half <= jump_addr[1];
+            end else if (arvalid && arready) begin
+                if (pred_taken) begin
+                    araddr <= pred_araddr;
+                    ar_half <= pred_target[1];
+                end else begin
+                    araddr <= araddr + ILEN/8;
+                    ar_half <= 1'b0;
+                end
+            end
+        end
+    end
+
+    // The predictor can't use a prediction made for the lower halfword when
+    // the batch starts in the upper one, the instruction not being executed
+    assign araddr_half = (C_EXTENSION) ? ar_half : 1'b0;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Pre-decode stage, extracting the flags of the incoming instruction
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    friscv_decoder
+    #(
+        .XLEN        (XLEN),
+        .A_EXTENSION (A_EXTENSION)
+    )
+    predecoder
+    (
+        .instruction (fe_inst),
+        .opcode      (opcode),
+        .funct3      (),
+        .funct7      (funct7),
+        .rs1         (),
+        .rs2         (),
+        .rd          (),
+        .zimm        (),
+        .imm12       (),
+        .imm20       (),
+        .csr         (),
+        .shamt       (),
+        .fence       (flags[`PDC_FENCE+:`PDC_FENCE_W]),
+        .lui         (flags[`PDC_LUI]),
+        .auipc       (flags[`PDC_AUIPC]),
+        .jal         (flags[`PDC_JAL]),
+        .jalr        (flags[`PDC_JALR]),
+        .branching   (flags[`PDC_BRANCH]),
+        .sys         (flags[`PDC_SYS+:`PDC_SYS_W]),
+        .processing  (processing),
+        .dec_error   (dec_error),
+        .pred        (),
+        .succ        ()
+    );
+
+    assign flags[`PDC_PROC] = processing;
+    assign flags[`PDC_DECERR] = dec_error;
+    assign flags[`PDC_RVC] = fe_rvc;
+
+    // Integer computation executed in a single cycle by an ALU
+    assign flags[`PDC_ALU] = processing & !dec_error &
+                             ((opcode==`R_ARITH & (funct7==7'b0000000 | funct7==7'b0100000)) |
+                               opcode==`I_ARITH);
+
+
+    generate
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Realignment stage, storing up to three halfwords not yet consumed.
+    // The window scanned to extract the next instruction is made of these
+    // halfwords followed by the incoming word. An instruction is extracted
+    // per cycle, a new word is accepted only if at most one halfword
+    // remains stored.
+    //
+    // The taken predictions issued along the read requests are tracked to
+    // know where starts the next batch of instructions in a word (target in
+    // the upper halfword) and where the current one stops (predicted
+    // instruction ending in the lower halfword).
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    if (C_EXTENSION) begin: REALIGNMENT
+
+        logic [3*16       -1:0] hw;
+        logic [2          -1:0] hw_cnt;
+        logic [5*16       -1:0] window;
+        logic [3          -1:0] win_cnt;
+        logic [2*16       -1:0] word_in;
+        logic [2          -1:0] word_cnt;
+        logic [2          -1:0] pull_cnt;
+        logic [2          -1:0] hw_left;
+        logic [3*16       -1:0] hw_next;
+        logic                   word_en;
+        logic                   lo_en;
+        logic                   hi_en;
+        logic                   inst32;
+        logic [ILEN       -1:0] expanded;
+        logic [AXI_ADDR_W -1:0] raddr;
+        logic                   skip_lo;
+        // In-flight taken predictions
+        logic                   preds_push;
+        logic                   preds_pull;
+        logic                   preds_empty;
+        logic [AXI_ADDR_W -1:0] preds_addr;
+        logic [AXI_ADDR_W -1:0] preds_target;
+        logic                   preds_half;
+        logic                   preds_hit;
+
+        assign preds_push = arvalid & arready & pred_taken & !boot & !jump;
+
+        friscv_scfifo
+        #(
+            .PASS_THRU  (0),
+            .ADDR_WIDTH ($clog2(PRED_OSTD_NUM)),
+            .DATA_WIDTH (2*AXI_ADDR_W+1)
+        )
+        preds_fifo
+        (
+            .aclk     (aclk),
+            .aresetn  (aresetn),
+            .srst     (srst),
+            .flush    (boot | jump),
+            .data_in  ({pred_half, pred_target, araddr}),
+            .push     (preds_push),
+            .full     (),
+            .afull    (),
+            .data_out ({preds_half, preds_target, preds_addr}),
+            .pull     (preds_pull),
+            .empty    (preds_empty),
+            .aempty   ()
+        );
+
+        // Word of the current batch received
+        assign word_en = rvalid & rready & (arid == rid);
+
+        // The word contains a predicted taken instruction
+        assign preds_hit = !preds_empty && (preds_addr == raddr);
+
+        assign preds_pull = word_en & preds_hit;
+
+        // Halfwords to use in the incoming word
+        assign lo_en = !skip_lo;
+        assign hi_en = !(preds_hit && !preds_half);
+
+        // Only the halfwords used are inserted, the data channel being
+        // possibly driven while not valid or with a stale ID
+        assign word_in = (!word_en)       ? 32'h0 :
+                         (lo_en & hi_en)  ? rdata[0+:32] :
+                         (lo_en)          ? {16'h0, rdata[0+:16]} :
+                         (hi_en)          ? {16'h0, rdata[16+:16]} :
+                                            32'h0;
+
+        assign word_cnt = (!word_en)      ? 2'h0 :
+                          (lo_en & hi_en) ? 2'h2 :
+                          (lo_en | hi_en) ? 2'h1 :
+                                            2'h0;
+
+        assign window = {{2*16{1'b0}}, hw} | ({{3*16{1'b0}}, word_in} << (16*hw_cnt));
+        assign win_cnt = hw_cnt + word_cnt;
+
+        // An uncompressed instruction has its two LSBs set
+        assign inst32 = (window[1:0]==2'b11);
+
+        friscv_rvc_expander
+        rvc_expander
+        (
+            .cinst       (window[0+:16]),
+            .instruction (expanded)
+        );
+
+        assign push = (win_cnt!=3'h0) && (!inst32 || win_cnt>3'h1);
+        assign fe_inst = (inst32) ? window[0+:32] : expanded;
+        assign fe_rvc = !inst32;
+
+        assign pull_cnt = (!push || !push_ready) ? 2'h0 :
+                          (inst32)               ? 2'h2 :
+                                                   2'h1;
+
+        assign rready = (hw_cnt<2'h2);
+
+        // Halfwords remaining once the instruction is pulled, the ones
+        // above being cleared to insert the next word on top of them
+        assign hw_left = win_cnt - pull_cnt;
+
+        always @ (*) begin
+            hw_next = window[16*pull_cnt+:3*16];
+            for (int i=0;i<3;i=i+1) begin
+                if (i >= hw_left) begin
+                    hw_next[16*i+:16] = 16'h0;
+                end
+            end
+        end
+
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                hw <= '0;
+                hw_cnt <= '0;
+                raddr <= '0;
+                skip_lo <= 1'b0;
+            end else if (srst) begin
+                hw <= '0;
+                hw_cnt <= '0;
+                raddr <= '0;
+                skip_lo <= 1'b0;
+            end else begin
+
+                // A new batch starts, possibly in the upper halfword
+                if (boot) begin
+                    raddr <= boot_araddr;
+                    skip_lo <= BOOT_ADDR[1];
+                end else if (jump) begin
+                    raddr <= jump_araddr;
+                    skip_lo <= jump_addr[1];
+                end else if (word_en) begin
+                    if (preds_hit) begin
+                        raddr <= {preds_target[AXI_ADDR_W-1:2], 2'b0};
+                        skip_lo <= preds_target[1];
+                    end else begin
+                        raddr <= raddr + 4;
+                        skip_lo <= 1'b0;
+                    end
+                end
+
+                if (boot || jump || flush) begin
+                    hw <= '0;
+                    hw_cnt <= '0;
+                end else begin
+                    hw <= hw_next;
+                    hw_cnt <= hw_left;
+                end
+            end
+        end
+
+    ///////////////////////////////////////////////////////////////////////////
+    // No compressed instruction, the words received are the instructions
+    ///////////////////////////////////////////////////////////////////////////
+    end else begin: NO_REALIGNMENT
+
+        assign push = rvalid & (arid == rid);
+        assign fe_inst = rdata[ILEN-1:0];
+        assign fe_rvc = 1'b0;
+        assign rready = push_ready;
+
+    end
+    endgenerate
+
+
+    generate
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Fetch queue, storing the instructions along their flags. The
+    // instructions are accepted as long the queue is not full, not when
+    // the control unit consumes them, so the fetch runs ahead of the
+    // execution.
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    if (DEPTH > 0) begin: FETCH_QUEUE
+
+        localparam FQ_W = $clog2(DEPTH);
+
+        logic [ILEN       -1:0] fq_inst [DEPTH-1:0];
+        logic [`PDC_W     -1:0] fq_flags[DEPTH-1:0];
+        logic [FQ_W       -1:0] fq_wptr;
+        logic [FQ_W       -1:0] fq_rptr;
+        logic [FQ_W       -1:0] fq_rptr2;
+        logic [FQ_W         :0] fq_cnt;
+        logic                   fq_full;
+        logic                   fq_wr;
+        logic [2          -1:0] fq_pull;
+        logic [2          -1:0] fq_rd;
+        logic                   bypass;
+
+        assign fq_full = (fq_cnt==DEPTH);
+        assign fq_rptr2 = fq_rptr + 1'b1;
+
+        // Number of instructions consumed by the control unit
+        assign fq_pull = (pull && inst_ready && pull2 && inst2_ready) ? 2'h2 :
+                         (pull && inst_ready)                         ? 2'h1 :
+                                                                        2'h0;
+
+        // The incoming instruction is consumed directly by the control unit
+        assign bypass = push && (fq_pull > fq_cnt);
+
+        // Number of instructions read from the queue
+        assign fq_rd = fq_pull - bypass;
+
+        assign fq_wr = push & !fq_full & !bypass;
+
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                fq_wptr <= '0;
+                fq_rptr <= '0;
+                fq_cnt <= '0;
+            end else if (srst || flush) begin
+                fq_wptr <= '0;
+                fq_rptr <= '0;
+                fq_cnt <= '0;
+            end else begin
+                if (fq_wr) begin
+                    fq_wptr <= fq_wptr + 1'b1;
+                end
+                fq_rptr <= fq_rptr + fq_rd;
+                fq_cnt <= fq_cnt + fq_wr - fq_rd;
+            end
+        end
+
+        always @ (posedge aclk) begin
+            if (fq_wr) begin
+                fq_inst[fq_wptr] <= fe_inst;
+                fq_flags[fq_wptr] <= flags;
+            end
+        end
+
+        assign push_ready = !fq_full;
+
+        assign instruction = (fq_cnt=='0) ? fe_inst : fq_inst[fq_rptr];
+        assign inst_flags = (fq_cnt=='0) ? flags : fq_flags[fq_rptr];
+        assign inst_ready = ((fq_cnt!='0) | push) & !flush;
+
+        assign instruction2 = (fq_cnt==1) ? fe_inst : fq_inst[fq_rptr2];
+        assign inst2_flags = (fq_cnt==1) ? flags : fq_flags[fq_rptr2];
+        assign inst2_ready = ((fq_cnt>1) | (fq_cnt==1) & push) & !flush;
+
+    ///////////////////////////////////////////////////////////////////////////
+    // No queue, the read data channel feeds directly the control unit
+    ///////////////////////////////////////////////////////////////////////////
+    end else begin: FETCH_PATH
+
+        assign instruction = fe_inst;
+        assign inst_flags = flags;
+        assign inst_ready = push;
+        assign push_ready = pull;
+
+        assign instruction2 = {ILEN{1'b0}};
+        assign inst2_flags = {`PDC_W{1'b0}};
+        assign inst2_ready = 1'b0;
+
+    end
+    endgenerate
+
+endmodule
+
+`resetall
@@ -0,0 +1,105 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+`include "friscv_h.sv"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Macro-op fusion detector, spotting among the two oldest instructions of
+// the fetch queue the idioms the compilers emit to build constants,
+// addresses or to zero-extend. Each pair is executed as a single operation
+// by the control unit:
+//
+// - LUI rd + ADDI rd,rd      : load a 32 bits immediate, in control unit
+// - AUIPC rd + ADDI rd,rd    : PC-relative address, in control unit
+// - AUIPC rd + JALR rd,rd    : far call, executed like a JAL
+// - SLLI rd + SRLI rd,rd     : zero-extend, same shift amount, in an ALU
+// - LUI rd + LOAD rd,rd      : load from an absolute address, in memfy
+//
+// The second instruction always overwrites the destination of the first
+// one, so only one register is written by a fused pair. A fused load still
+// commits the LUI result first, the register holding it if the load traps.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+module friscv_fusion
+
+    #(
+        // Instruction length (always 32, whatever the architecture)
+        parameter ILEN = 32
+    )(
+        // The two instructions to fuse
+        input  wire                       inst_ready,
+        input  wire  [ILEN          -1:0] instruction,
+        input  wire                       inst2_ready,
+        input  wire  [ILEN          -1:0] instruction2,
+        input  wire  [`PDC_W        -1:0] inst2_flags,
+        // Fusion detected
+        output logic                      fuse_li,
+        output logic                      fuse_pcrel,
+        output logic                      fuse_call,
+        output logic                      fuse_zext,
+        output logic                      fuse_ld
+    );
+
+    logic                   pair;
+    logic [`OPCODE_W  -1:0] opcode;
+    logic [`FUNCT3_W  -1:0] funct3;
+    logic [`FUNCT7_W  -1:0] funct7;
+    logic [`RD_W      -1:0] rd;
+    logic [`SHAMT_W   -1:0] shamt;
+    logic [`OPCODE_W  -1:0] opcode_2;
+    logic [`FUNCT3_W  -1:0] funct3_2;
+    logic [`FUNCT7_W  -1:0] funct7_2;
+    logic [`RS1_W     -1:0] rs1_2;
+    logic [`RD_W      -1:0] rd_2;
+    logic [`SHAMT_W   -1:0] shamt_2;
+    logic                   lui;
+    logic                   auipc;
+    logic                   slli;
+    logic                   chained;
+
+    assign opcode = instruction[0+:7];
+    assign funct3 = instruction[12+:3];
+    assign funct7 = instruction[25+:7];
+    assign rd = instruction[7+:5];
+    assign shamt = instruction[20+:5];
+
+    assign opcode_2 = instruction2[0+:7];
+    assign funct3_2 = instruction2[12+:3];
+    assign funct7_2 = instruction2[25+:7];
+    assign rs1_2 = instruction2[15+:5];
+    assign rd_2 = instruction2[7+:5];
+    assign shamt_2 = instruction2[20+:5];
+
+    // Both instructions are available and the second one is legal
+    assign pair = inst_ready & inst2_ready & !inst2_flags[`PDC_DECERR];
+
+    assign lui = (opcode==`LUI);
+    assign auipc = (opcode==`AUIPC);
+    assign slli = (opcode==`I_ARITH && funct3==`SLLI && funct7==7'b0000000);
+
+    // The second instruction reads and overwrites the result of the first
+    assign chained = (rd!=5'h0) && (rs1_2==rd) && (rd_2==rd);
+
+    assign fuse_li = pair & chained & lui &
+                     (opcode_2==`I_ARITH && funct3_2==`ADDI);
+
+    assign fuse_pcrel = pair & chained & auipc &
+                        (opcode_2==`I_ARITH && funct3_2==`ADDI);
+
+    assign fuse_call = pair & chained & auipc &
+                       (opcode_2==`JALR && funct3_2==3'b000);
+
+    assign fuse_zext = pair & chained & slli &
+                       (opcode_2==`I_ARITH && funct3_2==`SRLI && funct7_2==7'b0000000) &
+                       (shamt_2==shamt);
+
+    assign fuse_ld = pair & chained & lui & (opcode_2==`LOAD);
+
+endmodule
+
+`resetall
@@ -25,6 +25,7 @@
 `define FENCEX  7'b0001111
 `define MULDIV  7'b0110011
 `define MULDIVW 7'b0111011
+`define AMO     7'b0101111
 
 
 //////////////////////////////////////////////////////////////////
@@ -98,6 +99,19 @@
 `define REMW    3'b110
 `define REMUW   3'b111
 
+// funct5 (funct7[6:2]) of the atomic instructions, funct7[1:0] being aq/rl
+`define LR      5'b00010
+`define SC      5'b00011
+`define AMOSWAP 5'b00001
+`define AMOADD  5'b00000
+`define AMOXOR  5'b00100
+`define AMOAND  5'b01100
+`define AMOOR   5'b01000
+`define AMOMIN  5'b10000
+`define AMOMAX  5'b10100
+`define AMOMINU 5'b11000
+`define AMOMAXU 5'b11100
+
 ///////////////////////////////////////////////////////////////////
 // env signal driven by decoder to indicate environment instruction
 ///////////////////////////////////////////////////////////////////
@@ -172,11 +186,34 @@
 `define PRIV        `INST +   `INST_W
 `define MPP         `PRIV +   `PRIV_W
 `define MPRV        `MPP +    `PRIV_W
+// Macro-op fused pair (zero-extend or load from an absolute address)
+`define FUSED       `MPRV +   1
 
 // total length of ALU instruction bus
 `define INST_BUS_W `OPCODE_W + `FUNCT3_W + `FUNCT7_W + `RS1_W + `RS2_W + \
                    `RD_W + `ZIMM_W + `IMM12_W + `IMM20_W + `CSR_W + `SHAMT_W + \
-                   `PC_W + `INST_W + 2*`PRIV_W + 1
+                   `PC_W + `INST_W + 2*`PRIV_W + 2
+
+//////////////////////////////////////////////////////////////////
+// Pre-decoded flags, from fetch stage to control unit
+//////////////////////////////////////////////////////////////////
+
+`define PDC_FENCE_W   2
+`define PDC_SYS_W     6
+
+`define PDC_FENCE     0
+`define PDC_LUI       `PDC_FENCE + `PDC_FENCE_W
+`define PDC_AUIPC     `PDC_LUI + 1
+`define PDC_JAL       `PDC_AUIPC + 1
+`define PDC_JALR      `PDC_JAL + 1
+`define PDC_BRANCH    `PDC_JALR + 1
+`define PDC_SYS       `PDC_BRANCH + 1
+`define PDC_PROC      `PDC_SYS + `PDC_SYS_W
+`define PDC_DECERR    `PDC_PROC + 1
+`define PDC_ALU       `PDC_DECERR + 1
+`define PDC_RVC       `PDC_ALU + 1
+
+`define PDC_W         `PDC_RVC + 1
 
 //////////////////////////////////////////////////////////////////
 // Excpetion bus fron Memfy to Control unit
@@ -255,6 +292,38 @@
 
 `define CTRL_SB_W `CTRL_INSTRET + `XLEN*2
 
+//////////////////////////////////////////////////////////////////
+// Custom event counters, readable from CSR 0xFD0
+//////////////////////////////////////////////////////////////////
+
+// Branch correctly predicted
+`define EVT_BPRED_HIT   0
+// Branch mispredicted, fetch restarted
+`define EVT_BPRED_MISS  1
+// Two instructions issued in the same cycle
+`define EVT_DUAL_ISSUE  2
+// Two instructions fused and executed as a single operation
+`define EVT_FUSED_PAIR  3
+// Instruction cache lookup missed
+`define EVT_IC_MISS     4
+// Instruction cache lookup hit, one counter per way (4 ways max)
+`define EVT_IC_HIT      5
+// Data cache lookup missed
+`define EVT_DC_MISS     9
+// Data cache lookup hit, one counter per way (4 ways max)
+`define EVT_DC_HIT      10
+// Data cache prefetch issued
+`define EVT_DC_PF_ISSUE 14
+// Data cache load accessing a prefetched block
+`define EVT_DC_PF_USEFUL 15
+// Instruction cache miss served by the victim cache
+`define EVT_IC_VC_HIT   16
+// Data cache miss served by the victim cache
+`define EVT_DC_VC_HIT   17
+
+// Number of event counters
+`define PERF_NB_EVENT   18
+
 //////////////////////////////////////////////////////////////////
 // execution mode
 //////////////////////////////////////////////////////////////////
@@ -10,7 +10,8 @@
 //
 // Instruction cache circuit
 //
-// - Direct-mapped (1-way) placement policy
+// - Direct-mapped or N-way set-associative placement policy, pseudo-LRU
+//   replacement
 // - Parametrizable cache depth
 // - Parametrizable cache line width (instruction per line)
 // - Transparent operation, no need of user management
@@ -49,6 +50,9 @@ module friscv_icache
         // ID Mask to apply to identify the instruction cache in the AXI4
         // infrastructure
         parameter AXI_ID_MASK = 'h10,
+        // Read the blocks with WRAP bursts starting on the word requested,
+        // else with INCR bursts starting on the block's first beat
+        parameter AXI_WRAP = 0,
 
         ///////////////////////////////////////////////////////////////////////
         // Cache Setup
@@ -59,7 +63,16 @@ module friscv_icache
         // Line width defining only the data payload, in bits
         parameter CACHE_BLOCK_W = 128,
         // Number of lines in the cache
-        parameter CACHE_DEPTH = 512
+        parameter CACHE_DEPTH = 512,
+        // Number of ways, 1 (direct-mapped) or a power of two
+        parameter CACHE_WAYS = 1,
+        // Complete a missing fetch with the block read, without replaying it
+        parameter EARLY_RESTART = 0,
+        // Width of the epoch stored along the tags. A flush moves to the next
+        // epoch in a single cycle, the sets being parsed only when it wraps
+        parameter EPOCH_W = 2,
+        // Number of entries of the victim cache, 0 disables it
+        parameter VICTIM_NB = 0
     )(
         // Clock / Reset
         input  wire                       aclk,
@@ -100,7 +113,11 @@ module friscv_icache
         input  wire  [AXI_ID_W      -1:0] icache_rid,
         input  wire  [2             -1:0] icache_rresp,
         input  wire  [AXI_DATA_W    -1:0] icache_rdata,
-        input  wire                       icache_rlast
+        input  wire                       icache_rlast,
+        // Performance events, the hit per way and the misses
+        output logic [CACHE_WAYS    -1:0] perf_hits,
+        output logic                      perf_miss,
+        output logic                      perf_victim_hit
     );
 
 
@@ -113,6 +130,7 @@ module friscv_icache
     logic [AXI_ID_W          -1:0] cache_rid;
     logic                          cache_hit;
     logic                          cache_miss;
+    logic                          block_fill;
     // Memory controller interface
     logic                          memctrl_arvalid;
     logic                          memctrl_arready;
@@ -124,19 +142,21 @@ module friscv_icache
     logic                          memctrl_rready;
     logic [AXI_ADDR_W        -1:0] memctrl_raddr;
     logic [CACHE_BLOCK_W     -1:0] memctrl_rdata_blk;
+    logic                          memctrl_rword;
     logic [AXI_ID_W          -1:0] memctrl_rid;
     logic [2                 -1:0] memctrl_rresp;
 
     // Signal to control the flush operation
     logic                         flushing;
+    logic [EPOCH_W          -1:0] epoch;
     logic                         flush_ack_fetcher;
     logic                         flush_ack_memctrl;
+    logic [$clog2(OSTDREQ_NUM)  :0] refill_ostd;
 
     // cache write interface
     logic                          cache_wren;
     logic [AXI_ADDR_W        -1:0] cache_waddr;
     logic [CACHE_BLOCK_W     -1:0] cache_wdata;
-    logic                          block_fill;
 
     ///////////////////////////////////////////////////////////////////////////
     // Cache sequencer
@@ -148,9 +168,11 @@ module friscv_icache
         .ILEN             (ILEN),
         .XLEN             (XLEN),
         .OSTDREQ_NUM      (OSTDREQ_NUM),
+        .EARLY_RESTART    (EARLY_RESTART),
         .AXI_ADDR_W       (AXI_ADDR_W),
         .AXI_ID_W         (AXI_ID_W),
-        .AXI_DATA_W       (AXI_DATA_W)
+        // The memory controller completes whole blocks
+        .AXI_DATA_W       (CACHE_BLOCK_W)
     )
     fetcher
     (
@@ -172,15 +194,27 @@ module friscv_icache
         .mst_rid         (ctrl_rid),
         .mst_rresp       (ctrl_rresp),
         .mst_rdata       (ctrl_rdata),
-        // status flag of the memory controller
-        .block_fill      (block_fill),
+        // block written by the memory controller, the early restart using
+        // the write itself, else the prefetcher's copy delayed by a cycle,
+        // and the beat holding the word missing
+        .block_fill      ((EARLY_RESTART) ? memctrl_rvalid & !memctrl_rcache : block_fill),
+        .block_word      (memctrl_rword & !memctrl_rcache),
         .cache_ren       (cache_ren),
         .cache_raddr     (cache_raddr),
         .cache_rid       (cache_rid),
         .cache_rprot     (cache_rprot),
         .cache_rdata     (cache_rdata),
         .cache_hit       (cache_hit),
-        .cache_miss      (cache_miss)
+        .cache_miss      (cache_miss),
+        // no MSHR, the misses are read by the prefetcher
+        .block_addr      (memctrl_raddr),
+        .block_rid       (memctrl_rid),
+        .block_data      (memctrl_rdata_blk),
+        .miss_arvalid    (),
+        .miss_arready    (1'b0),
+        .miss_araddr     (),
+        .miss_arprot     (),
+        .miss_arid       ()
     );
 
     friscv_cache_prefetcher
@@ -189,6 +223,8 @@ module friscv_icache
         .ILEN              (ILEN),
         .XLEN              (XLEN),
         .CACHE_PREFETCH_EN (CACHE_PREFETCH_EN),
+        .CACHE_BLOCK_W     (CACHE_BLOCK_W),
+        .PREFETCH_ID       (AXI_ID_MASK),
         .AXI_ADDR_W        (AXI_ADDR_W),
         .AXI_ID_W          (AXI_ID_W),
         .AXI_DATA_W        (AXI_DATA_W)
@@ -214,7 +250,13 @@ module friscv_icache
         .cache_rprot     (cache_rprot),
         .cache_rdata     (cache_rdata),
         .cache_hit       (cache_hit),
-        .cache_miss      (cache_miss)
+        .cache_miss      (cache_miss),
+        // no stride prefetch on the instruction stream
+        .train_valid     (1'b0),
+        .train_addr      ({AXI_ADDR_W{1'b0}}),
+        .train_pc        ({XLEN{1'b0}}),
+        .perf_pf_issue   (),
+        .perf_pf_useful  ()
     );
 
 
@@ -228,7 +270,10 @@ module friscv_icache
         .WLEN          (ILEN),
         .ADDR_W        (AXI_ADDR_W),
         .CACHE_BLOCK_W (CACHE_BLOCK_W),
-        .CACHE_DEPTH   (CACHE_DEPTH)
+        .CACHE_DEPTH   (CACHE_DEPTH),
+        .CACHE_WAYS    (CACHE_WAYS),
+        .VICTIM_NB     (VICTIM_NB),
+        .EPOCH_W       (EPOCH_W)
     )
     cache_blocks
     (
@@ -236,6 +281,8 @@ module friscv_icache
         .aresetn    (aresetn),
         .srst       (srst),
         .flush      (flushing),
+        .epoch      (epoch),
+        .clean      (1'b0),
         .p1_wen     (memctrl_rvalid & !memctrl_rcache | cache_wren),
         .p1_wstrb   ({CACHE_BLOCK_W/8{1'b1}}),
         .p1_waddr   ((cache_wren) ? cache_waddr : memctrl_raddr),
@@ -253,15 +300,24 @@ module friscv_icache
         .p2_raddr   ({AXI_ADDR_W{1'b0}}),
         .p2_rdata   (),
         .p2_hit     (),
-        .p2_miss    ()
+        .p2_miss    (),
+        .way_hits   (perf_hits),
+        .victim_hit (perf_victim_hit),
+        .evict_valid(),
+        .evict_addr (),
+        .evict_data ()
     );
 
+    assign perf_miss = cache_miss;
+
 
     friscv_cache_flusher 
     #(
         .NAME          ("iCache-Flusher"),
         .CACHE_BLOCK_W (CACHE_BLOCK_W),
         .CACHE_DEPTH   (CACHE_DEPTH),
+        .CACHE_WAYS    (CACHE_WAYS),
+        .EPOCH_W       (EPOCH_W),
         .AXI_ADDR_W    (AXI_ADDR_W)
     )
     flusher 
@@ -271,8 +327,13 @@ module friscv_icache
         .srst         (srst),
         .ready        (cache_ready),
         .flush_blocks (flush_blocks),
+        .refilling    (refill_ostd!='0),
         .flush_ack    (flush_ack),
         .flushing     (flushing),
+        .epoch        (epoch),
+        .cleaning     (),
+        .stall        (1'b0),
+        .drained      (1'b1),
         .cache_wren   (cache_wren),
         .cache_waddr  (cache_waddr),
         .cache_wdata  (cache_wdata)
@@ -285,6 +346,22 @@ module friscv_icache
 
     assign memctrl_rready = 1'b1;
 
+    // Number of blocks requested and not yet written in the cache, a flush
+    // waiting for them to invalidate their content along the older blocks
+    always @ (posedge aclk or negedge aresetn) begin
+        if (aresetn == 1'b0) begin
+            refill_ostd <= '0;
+        end else if (srst == 1'b1) begin
+            refill_ostd <= '0;
+        end else begin
+            if (memctrl_arvalid && memctrl_arready && !memctrl_rvalid) begin
+                refill_ostd <= refill_ostd + 1'b1;
+            end else if (!(memctrl_arvalid && memctrl_arready) && memctrl_rvalid) begin
+                refill_ostd <= refill_ostd - 1'b1;
+            end
+        end
+    end
+
     friscv_cache_memctrl
     #(
         .NAME          ("iCache-MemCtrl"),
@@ -295,6 +372,7 @@ module friscv_icache
         .AXI_DATA_W    (AXI_DATA_W),
         .AXI_ID_MASK   (AXI_ID_MASK),
         .AXI_IN_ORDER  (1),
+        .AXI_WRAP      (AXI_WRAP),
         .CACHE_BLOCK_W (CACHE_BLOCK_W)
     )
     mem_ctrl
@@ -318,6 +396,7 @@ module friscv_icache
         .mst_rresp      (memctrl_rresp),
         .mst_rdata_blk  (memctrl_rdata_blk),
         .mst_rdata      (),
+        .mst_rword      (memctrl_rword),
         // AXI4-lite write channels - Unused for instruction
         .mst_awvalid    (1'b0),
         .mst_awready    (),
@@ -327,8 +406,8 @@ module friscv_icache
         .mst_awid       ({AXI_ID_W{1'b0}}),
         .mst_wvalid     (1'b0),
         .mst_wready     (),
-        .mst_wdata      ({XLEN{1'b0}}),
-        .mst_wstrb      ({XLEN/8{1'b0}}),
+        .mst_wdata      ({CACHE_BLOCK_W{1'b0}}),
+        .mst_wstrb      ({CACHE_BLOCK_W/8{1'b0}}),
         .mst_bvalid     (),
         .mst_bready     (1'b0),
         .mst_bid        (),
@@ -0,0 +1,650 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+`include "friscv_checkers.sv"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Unified level 2 cache, shared by the instruction and data caches
+//
+// - AXI4-lite slave and master interfaces, a request carrying a complete
+//   block (the bus width)
+// - N-way set-associative placement, tree pseudo-LRU replacement, the sets
+//   being interleaved across banks on the block address' LSBs. A refill and
+//   a lookup proceed in the same cycle if targeting different banks
+// - write-through without write-allocate: a write updates the block if
+//   present then is always forwarded to the memory
+// - non-blocking: up to OSTDREQ_NUM reads in-flight, each miss being read
+//   from the memory with its own ID and the hits being served under the
+//   misses. The read completions are returned in-order
+// - a refill is not stored if a write to the same block is pending or has
+//   been received meanwhile, the read still being completed with it
+// - count its own performance events
+//
+///////////////////////////////////////////////////////////////////////////////
+
+module friscv_l2cache
+
+    #(
+        ///////////////////////////////////////////////////////////////////////
+        // General Setup
+        ///////////////////////////////////////////////////////////////////////
+
+        // Name used for tracer file name
+        parameter NAME = "L2",
+        // Number of outstanding reads and writes, a power of two
+        parameter OSTDREQ_NUM = 8,
+
+        ///////////////////////////////////////////////////////////////////////
+        // Interface Setup
+        ///////////////////////////////////////////////////////////////////////
+
+        // Address bus width defined for both control and AXI4 address signals
+        parameter AXI_ADDR_W = 32,
+        // AXI ID width, setup by default to 8 and unused
+        parameter AXI_ID_W = 8,
+        // AXI4 data width, setup to the cache block width
+        parameter AXI_DATA_W = 128,
+        // ID used by the requests issued to the memory, the read slot being
+        // carried by the LSBs
+        parameter [AXI_ID_W-1:0] AXI_ID_MASK = 'h40,
+
+        ///////////////////////////////////////////////////////////////////////
+        // Cache Setup
+        ///////////////////////////////////////////////////////////////////////
+
+        // Number of blocks in the cache, shared across the banks and ways
+        parameter CACHE_DEPTH = 4096,
+        // Number of ways, 1 (direct-mapped) or a power of two
+        parameter CACHE_WAYS = 4,
+        // Number of banks, a power of two
+        parameter CACHE_BANKS = 2
+    )(
+        // Global interface
+        input  wire                       aclk,
+        input  wire                       aresetn,
+        input  wire                       srst,
+        // Slave interface, from the interconnect
+        input  wire                       slv_awvalid,
+        output logic                      slv_awready,
+        input  wire  [AXI_ADDR_W    -1:0] slv_awaddr,
+        input  wire  [3             -1:0] slv_awprot,
+        input  wire  [AXI_ID_W      -1:0] slv_awid,
+        input  wire                       slv_wvalid,
+        output logic                      slv_wready,
+        input  wire  [AXI_DATA_W    -1:0] slv_wdata,
+        input  wire  [AXI_DATA_W/8  -1:0] slv_wstrb,
+        output logic                      slv_bvalid,
+        input  wire                       slv_bready,
+        output logic [AXI_ID_W      -1:0] slv_bid,
+        output logic [2             -1:0] slv_bresp,
+        input  wire                       slv_arvalid,
+        output logic                      slv_arready,
+        input  wire  [AXI_ADDR_W    -1:0] slv_araddr,
+        input  wire  [3             -1:0] slv_arprot,
+        input  wire  [AXI_ID_W      -1:0] slv_arid,
+        output logic                      slv_rvalid,
+        input  wire                       slv_rready,
+        output logic [AXI_ID_W      -1:0] slv_rid,
+        output logic [2             -1:0] slv_rresp,
+        output logic [AXI_DATA_W    -1:0] slv_rdata,
+        // Master interface, to the memory
+        output logic                      mst_awvalid,
+        input  wire                       mst_awready,
+        output logic [AXI_ADDR_W    -1:0] mst_awaddr,
+        output logic [3             -1:0] mst_awprot,
+        output logic [AXI_ID_W      -1:0] mst_awid,
+        output logic                      mst_wvalid,
+        input  wire                       mst_wready,
+        output logic [AXI_DATA_W    -1:0] mst_wdata,
+        output logic [AXI_DATA_W/8  -1:0] mst_wstrb,
+        input  wire                       mst_bvalid,
+        output logic                      mst_bready,
+        input  wire  [AXI_ID_W      -1:0] mst_bid,
+        input  wire  [2             -1:0] mst_bresp,
+        output logic                      mst_arvalid,
+        input  wire                       mst_arready,
+        output logic [AXI_ADDR_W    -1:0] mst_araddr,
+        output logic [3             -1:0] mst_arprot,
+        output logic [AXI_ID_W      -1:0] mst_arid,
+        input  wire                       mst_rvalid,
+        output logic                      mst_rready,
+        input  wire  [AXI_ID_W      -1:0] mst_rid,
+        input  wire  [2             -1:0] mst_rresp,
+        input  wire  [AXI_DATA_W    -1:0] mst_rdata,
+        // Performance counters, from the LSBs: read hits, read misses, write
+        // hits, write misses, refills stored and lookups stalled by a refill
+        output logic [6*32          -1:0] perfs
+    );
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Parameters and variables declarations
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Byte offset into the block
+    localparam OFFSET_W = $clog2(AXI_DATA_W/8);
+
+    // Bank part, the LSBs of the block address
+    localparam BANK_W = $clog2(CACHE_BANKS);
+    localparam BANK_IW = (CACHE_BANKS>1) ? BANK_W : 1;
+
+    // Index part, to parse the sets of a bank
+    localparam SET_NUM = CACHE_DEPTH / CACHE_WAYS / CACHE_BANKS;
+    localparam INDEX_IX = OFFSET_W + BANK_W;
+    localparam INDEX_W = $clog2(SET_NUM);
+
+    // Tag part, the remaining MSBs
+    localparam TAG_IX = INDEX_IX + INDEX_W;
+    localparam TAG_W = AXI_ADDR_W - TAG_IX;
+
+    // Way selection and pseudo-LRU tree, one bit per node
+    localparam WAY_W = (CACHE_WAYS>1) ? $clog2(CACHE_WAYS) : 1;
+    localparam PLRU_W = (CACHE_WAYS>1) ? CACHE_WAYS - 1 : 1;
+
+    // Read slots and write buffer entries
+    localparam SLOT_W = $clog2(OSTDREQ_NUM);
+
+    // Initialization, invalidating all the blocks after reset
+    logic                                          ready;
+    logic [INDEX_W                           -1:0] init_ix;
+
+    // Request selected for the lookup, a read or a write
+    logic                                          rd_req;
+    logic                                          wr_req;
+    logic                                          wr_last;
+    logic                                          sel_wr;
+    logic                                          conflict;
+    logic                                          lookup;
+    logic                                          rd_grant;
+    logic                                          wr_grant;
+    logic [AXI_ADDR_W                        -1:0] req_addr;
+    logic [BANK_IW                           -1:0] req_bank;
+    logic [INDEX_W                           -1:0] req_index;
+    logic [TAG_W                             -1:0] req_tag;
+    logic [CACHE_WAYS                        -1:0] req_hits;
+    logic                                          req_hit;
+    logic [WAY_W                             -1:0] req_way;
+    logic [AXI_DATA_W                        -1:0] req_data;
+
+    // Ways of all the banks, read on the lookup or the refill index
+    logic [CACHE_BANKS*CACHE_WAYS            -1:0] way_set;
+    logic [CACHE_BANKS*CACHE_WAYS*TAG_W      -1:0] way_tag;
+    logic [CACHE_BANKS*CACHE_WAYS*AXI_DATA_W -1:0] way_data;
+    logic [CACHE_BANKS                       -1:0] bank_refill;
+    logic [CACHE_BANKS                       -1:0] bank_refill_wr;
+    logic [CACHE_BANKS                       -1:0] bank_wr_hit;
+
+    // Refill of a read miss
+    logic [SLOT_W                            -1:0] refill_slot;
+    logic                                          refill_try;
+    logic                                          refill_wr;
+    logic [AXI_ADDR_W                        -1:0] refill_addr;
+    logic [BANK_IW                           -1:0] refill_bank;
+    logic [INDEX_W                           -1:0] refill_index;
+    logic [TAG_W                             -1:0] refill_tag;
+    logic [CACHE_WAYS                        -1:0] refill_set;
+    logic [CACHE_WAYS                        -1:0] refill_hits;
+    logic [WAY_W                             -1:0] refill_way;
+
+    logic [PLRU_W                            -1:0] plru [CACHE_BANKS*SET_NUM-1:0];
+
+    // Read slots, allocated in-order and completed by a hit or a refill
+    logic [SLOT_W                              :0] rob_wptr;
+    logic [SLOT_W                              :0] rob_rptr;
+    logic                                          rob_full;
+    logic [OSTDREQ_NUM                       -1:0] rob_done;
+    logic [AXI_ID_W                          -1:0] rob_id [OSTDREQ_NUM-1:0];
+    logic [2                                 -1:0] rob_resp [OSTDREQ_NUM-1:0];
+    logic [AXI_DATA_W                        -1:0] rob_data [OSTDREQ_NUM-1:0];
+    logic [OSTDREQ_NUM                       -1:0] miss_pend;
+    logic [OSTDREQ_NUM                       -1:0] miss_install;
+    logic [OSTDREQ_NUM                       -1:0] miss_match;
+    logic [AXI_ADDR_W                        -1:0] miss_addr [OSTDREQ_NUM-1:0];
+    logic [3                                 -1:0] miss_prot [OSTDREQ_NUM-1:0];
+    logic [SLOT_W                            -1:0] ar_slot;
+    logic                                          ar_empty;
+
+    // Write buffer, the push, address, data and response pointers' MSB
+    // flagging a wrap
+    logic [SLOT_W                              :0] wb_wptr;
+    logic [SLOT_W                              :0] wb_awptr;
+    logic [SLOT_W                              :0] wb_wdptr;
+    logic [SLOT_W                              :0] wb_bptr;
+    logic                                          wb_full;
+    logic [OSTDREQ_NUM                       -1:0] wb_pend;
+    logic [OSTDREQ_NUM                       -1:0] wb_match;
+    logic [AXI_ADDR_W                        -1:0] wb_addr [OSTDREQ_NUM-1:0];
+    logic [3                                 -1:0] wb_prot [OSTDREQ_NUM-1:0];
+    logic [AXI_ID_W                          -1:0] wb_id [OSTDREQ_NUM-1:0];
+    logic [AXI_DATA_W                        -1:0] wb_data [OSTDREQ_NUM-1:0];
+    logic [AXI_DATA_W/8                      -1:0] wb_strb [OSTDREQ_NUM-1:0];
+
+    genvar b;
+    genvar w;
+
+    // Pseudo-LRU tree functions, shared with the other caches
+    `include "friscv_cache_h.sv"
+
+    // Tracer setup
+    `ifdef TRACE_CACHE
+    string fname;
+    integer f;
+    initial begin
+        $sformat(fname, "trace_%s.txt", NAME);
+        f = $fopen(fname, "w");
+    end
+    `endif
+
+    initial begin
+        `CHECKER(((CACHE_WAYS & (CACHE_WAYS-1)) != 0), "CACHE_WAYS must be a power of two");
+        `CHECKER(((CACHE_BANKS & (CACHE_BANKS-1)) != 0), "CACHE_BANKS must be a power of two");
+        `CHECKER((SET_NUM < 2), "CACHE_DEPTH must provide at least two sets per bank and way");
+        `CHECKER((OSTDREQ_NUM < 2 || (OSTDREQ_NUM & (OSTDREQ_NUM-1)) != 0), "OSTDREQ_NUM must be a power of two, at least 2");
+        `CHECKER(((AXI_ID_MASK & (OSTDREQ_NUM-1)) != 0), "AXI_ID_MASK LSBs must be 0 to carry the read slots");
+    end
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Blocks invalidation after reset, no request being accepted meanwhile
+    ///////////////////////////////////////////////////////////////////////////
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            ready <= 1'b0;
+            init_ix <= {INDEX_W{1'b0}};
+        end else if (srst) begin
+            ready <= 1'b0;
+            init_ix <= {INDEX_W{1'b0}};
+        end else if (!ready) begin
+            init_ix <= init_ix + 1'b1;
+            if (&init_ix) ready <= 1'b1;
+        end
+    end
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Request selection, a read or a write looked up per cycle, alternating
+    // between them if both are pending. A refill stores its block in priority,
+    // a request targeting the same bank waits for the next cycle.
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign rd_req = slv_arvalid && !rob_full;
+    assign wr_req = slv_awvalid && slv_wvalid && !wb_full;
+
+    assign sel_wr = wr_req && (!rd_req || !wr_last);
+    assign req_addr = (sel_wr) ? slv_awaddr : slv_araddr;
+
+    assign req_bank = (CACHE_BANKS>1) ? req_addr[OFFSET_W+:BANK_IW] : {BANK_IW{1'b0}};
+    assign req_index = req_addr[INDEX_IX+:INDEX_W];
+    assign req_tag = req_addr[TAG_IX+:TAG_W];
+
+    assign conflict = refill_try && refill_bank==req_bank;
+    assign lookup = ready && (rd_req || wr_req) && !conflict;
+    assign rd_grant = lookup && !sel_wr;
+    assign wr_grant = lookup && sel_wr;
+
+    assign slv_arready = rd_grant;
+    assign slv_awready = wr_grant;
+    assign slv_wready = wr_grant;
+
+    always @ (posedge aclk or negedge aresetn) begin
+        if (!aresetn) begin
+            wr_last <= 1'b0;
+        end else if (srst) begin
+            wr_last <= 1'b0;
+        end else begin
+            if (rd_grant || wr_grant)
+                wr_last <= wr_grant;
+        end
+    end
+
+    always @ (*) begin
+
+        req_hits = {CACHE_WAYS{1'b0}};
+        req_way = {WAY_W{1'b0}};
+        req_data = {AXI_DATA_W{1'b0}};
+
+        for (int i=0;i<CACHE_WAYS;i=i+1) begin
+            if (way_set[req_bank*CACHE_WAYS+i] &&
+                way_tag[(req_bank*CACHE_WAYS+i)*TAG_W+:TAG_W]==req_tag)
+            begin
+                req_hits[i] = 1'b1;
+                req_way = i[WAY_W-1:0];
+                req_data = way_data[(req_bank*CACHE_WAYS+i)*AXI_DATA_W+:AXI_DATA_W];
+            end
+        end
+    end
+
+    assign req_hit = |req_hits;
+
+    // A pending read or write to the block requested prevents to store a
+    // refill, the memory possibly returning the block before the write
+    for (genvar i=0;i<OSTDREQ_NUM;i=i+1) begin: HAZARD
+        assign miss_match[i] = miss_pend[i] &&
+                               miss_addr[i][AXI_ADDR_W-1:OFFSET_W]==req_addr[AXI_ADDR_W-1:OFFSET_W];
+        assign wb_match[i] = wb_pend[i] &&
+                             wb_addr[i][AXI_ADDR_W-1:OFFSET_W]==req_addr[AXI_ADDR_W-1:OFFSET_W];
+    end
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Refill of a read miss, stored in the first invalid way or else in the
+    // pseudo-LRU victim, unless the block is already present
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign mst_rready = 1'b1;
+
+    assign refill_slot = mst_rid[SLOT_W-1:0];
+    assign refill_addr = miss_addr[refill_slot];
+    assign refill_try = mst_rvalid && miss_install[refill_slot] && mst_rresp==2'b00;
+
+    assign refill_bank = (CACHE_BANKS>1) ? refill_addr[OFFSET_W+:BANK_IW] : {BANK_IW{1'b0}};
+    assign refill_index = refill_addr[INDEX_IX+:INDEX_W];
+    assign refill_tag = refill_addr[TAG_IX+:TAG_W];
+
+    always @ (*) begin
+
+        for (int i=0;i<CACHE_WAYS;i=i+1) begin
+            refill_set[i] = way_set[refill_bank*CACHE_WAYS+i];
+            refill_hits[i] = refill_set[i] &&
+                             way_tag[(refill_bank*CACHE_WAYS+i)*TAG_W+:TAG_W]==refill_tag;
+        end
+
+        refill_way = (CACHE_WAYS>1) ? plru_victim(plru[refill_bank*SET_NUM+refill_index]) :
+                                      {WAY_W{1'b0}};
+
+        for (int i=CACHE_WAYS-1;i>=0;i=i-1)
+            if (!refill_set[i]) refill_way = i[WAY_W-1:0];
+    end
+
+    assign refill_wr = refill_try && !(|refill_hits);
+
+    // The tree is updated on a lookup hit and on a refill, the most recently
+    // used way being protected from the next replacement
+    always @ (posedge aclk or negedge aresetn) begin
+        if (!aresetn) begin
+            for (int s=0;s<CACHE_BANKS*SET_NUM;s=s+1)
+                plru[s] <= {PLRU_W{1'b0}};
+        end else if (srst) begin
+            for (int s=0;s<CACHE_BANKS*SET_NUM;s=s+1)
+                plru[s] <= {PLRU_W{1'b0}};
+        end else if (CACHE_WAYS>1) begin
+            if (lookup && req_hit)
+                plru[req_bank*SET_NUM+req_index] <= plru_update(plru[req_bank*SET_NUM+req_index], req_way);
+            if (refill_wr)
+                plru[refill_bank*SET_NUM+refill_index] <= plru_update(plru[refill_bank*SET_NUM+refill_index], refill_way);
+        end
+    end
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Banks storage, one tag and one data RAM per way. A bank is read and
+    // written either by the refill or by the lookup
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate
+    for (b=0;b<CACHE_BANKS;b=b+1) begin: BANKS
+
+        logic [INDEX_W-1:0] raddr;
+        logic [INDEX_W-1:0] waddr;
+
+        assign bank_refill[b] = refill_try && refill_bank==b;
+        assign bank_refill_wr[b] = refill_wr && refill_bank==b;
+        assign bank_wr_hit[b] = wr_grant && req_hit && req_bank==b;
+
+        assign raddr = (bank_refill[b]) ? refill_index : req_index;
+        assign waddr = (!ready)          ? init_ix      :
+                       (bank_refill[b]) ? refill_index :
+                                          req_index;
+
+        for (w=0;w<CACHE_WAYS;w=w+1) begin: WAYS
+
+            friscv_ram
+            #(
+                .ADDR_WIDTH (INDEX_W),
+                .DATA_WIDTH (TAG_W+1),
+                .FFD_EN     (0)
+            )
+            tag_ram
+            (
+                .aclk     (aclk),
+                .wr_en    (!ready || bank_refill_wr[b] && refill_way==w),
+                .addr_in  (waddr),
+                .data_in  ({ready, refill_tag}),
+                .addr_out (raddr),
+                .data_out ({way_set[b*CACHE_WAYS+w], way_tag[(b*CACHE_WAYS+w)*TAG_W+:TAG_W]})
+            );
+
+            friscv_rambe
+            #(
+                .ADDR_WIDTH (INDEX_W),
+                .DATA_WIDTH (AXI_DATA_W),
+                .FFD_EN     (0)
+            )
+            data_ram
+            (
+                .aclk     (aclk),
+                .wr_en    (bank_refill_wr[b] && refill_way==w || bank_wr_hit[b] && req_way==w),
+                .wr_be    ((bank_refill_wr[b]) ? {AXI_DATA_W/8{1'b1}} : slv_wstrb),
+                .addr_in  (waddr),
+                .data_in  ((bank_refill_wr[b]) ? mst_rdata : slv_wdata),
+                .addr_out (raddr),
+                .data_out (way_data[(b*CACHE_WAYS+w)*AXI_DATA_W+:AXI_DATA_W])
+            );
+        end
+    end
+    endgenerate
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Read slots, a hit completing its slot on the lookup, a miss on its
+    // refill. A write to the block of a pending miss cancels its refill
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign rob_full = (rob_wptr ^ rob_rptr) == {1'b1, {SLOT_W{1'b0}}};
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            rob_wptr <= '0;
+            rob_rptr <= '0;
+            rob_done <= '0;
+            miss_pend <= '0;
+            miss_install <= '0;
+        end else if (srst) begin
+            rob_wptr <= '0;
+            rob_rptr <= '0;
+            rob_done <= '0;
+            miss_pend <= '0;
+            miss_install <= '0;
+        end else begin
+
+            if (rd_grant)
+                rob_wptr <= rob_wptr + 1'b1;
+
+            if (slv_rvalid && slv_rready)
+                rob_rptr <= rob_rptr + 1'b1;
+
+            for (int i=0;i<OSTDREQ_NUM;i=i+1) begin
+                if (rd_grant && rob_wptr[SLOT_W-1:0]==i[SLOT_W-1:0]) begin
+                    rob_done[i] <= req_hit;
+                    miss_pend[i] <= !req_hit;
+                    miss_install[i] <= !req_hit && !(|miss_match) && !(|wb_match);
+                end else if (mst_rvalid && refill_slot==i[SLOT_W-1:0]) begin
+                    rob_done[i] <= 1'b1;
+                    miss_pend[i] <= 1'b0;
+                    miss_install[i] <= 1'b0;
+                end else begin
+                    if (slv_rvalid && slv_rready && rob_rptr[SLOT_W-1:0]==i[SLOT_W-1:0])
+                        rob_done[i] <= 1'b0;
+                    if (wr_grant && miss_match[i])
+                        miss_install[i] <= 1'b0;
+                end
+            end
+
+            `ifdef TRACE_CACHE
+            if (rd_grant)
+                $fwrite(f, "@ %0t: Read 0x%x %s\n", $realtime, slv_araddr, (req_hit) ? "hit" : "miss");
+            if (wr_grant)
+                $fwrite(f, "@ %0t: Write 0x%x %s\n", $realtime, slv_awaddr, (req_hit) ? "hit" : "miss");
+            if (refill_wr)
+                $fwrite(f, "@ %0t: Refill 0x%x in bank %0d way %0d\n", $realtime, refill_addr, refill_bank, refill_way);
+            `endif
+        end
+    end
+
+    always @ (posedge aclk) begin
+        if (rd_grant) begin
+            rob_id[rob_wptr[SLOT_W-1:0]] <= slv_arid;
+            rob_resp[rob_wptr[SLOT_W-1:0]] <= 2'b00;
+            rob_data[rob_wptr[SLOT_W-1:0]] <= req_data;
+            miss_addr[rob_wptr[SLOT_W-1:0]] <= slv_araddr;
+            miss_prot[rob_wptr[SLOT_W-1:0]] <= slv_arprot;
+        end
+        if (mst_rvalid) begin
+            rob_resp[refill_slot] <= mst_rresp;
+            rob_data[refill_slot] <= mst_rdata;
+        end
+    end
+
+    assign slv_rvalid = rob_done[rob_rptr[SLOT_W-1:0]];
+    assign slv_rid = rob_id[rob_rptr[SLOT_W-1:0]];
+    assign slv_rresp = rob_resp[rob_rptr[SLOT_W-1:0]];
+    assign slv_rdata = rob_data[rob_rptr[SLOT_W-1:0]];
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Misses read from the memory in-order, with their slot as ID
+    ///////////////////////////////////////////////////////////////////////////
+
+    friscv_scfifo
+    #(
+        .PASS_THRU  (0),
+        .ADDR_WIDTH (SLOT_W),
+        .DATA_WIDTH (SLOT_W)
+    )
+    miss_fifo
+    (
+        .aclk     (aclk),
+        .aresetn  (aresetn),
+        .srst     (srst),
+        .flush    (1'b0),
+        .data_in  (rob_wptr[SLOT_W-1:0]),
+        .push     (rd_grant & !req_hit),
+        .full     (),
+        .afull    (),
+        .data_out (ar_slot),
+        .pull     (mst_arvalid & mst_arready),
+        .empty    (ar_empty),
+        .aempty   ()
+    );
+
+    assign mst_arvalid = !ar_empty;
+    assign mst_araddr = miss_addr[ar_slot];
+    assign mst_arprot = miss_prot[ar_slot];
+    assign mst_arid = AXI_ID_MASK | ar_slot;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Write buffer forwarding the writes to the memory with a single ID, the
+    // responses being so received in-order and returned with the ID of the
+    // request
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign wb_full = (wb_wptr ^ wb_bptr) == {1'b1, {SLOT_W{1'b0}}};
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            wb_wptr <= '0;
+            wb_awptr <= '0;
+            wb_wdptr <= '0;
+            wb_bptr <= '0;
+            wb_pend <= '0;
+        end else if (srst) begin
+            wb_wptr <= '0;
+            wb_awptr <= '0;
+            wb_wdptr <= '0;
+            wb_bptr <= '0;
+            wb_pend <= '0;
+        end else begin
+
+            if (wr_grant)
+                wb_wptr <= wb_wptr + 1'b1;
+
+            if (mst_awvalid && mst_awready)
+                wb_awptr <= wb_awptr + 1'b1;
+
+            if (mst_wvalid && mst_wready)
+                wb_wdptr <= wb_wdptr + 1'b1;
+
+            if (mst_bvalid && mst_bready)
+                wb_bptr <= wb_bptr + 1'b1;
+
+            for (int i=0;i<OSTDREQ_NUM;i=i+1) begin
+                if (wr_grant && wb_wptr[SLOT_W-1:0]==i[SLOT_W-1:0])
+                    wb_pend[i] <= 1'b1;
+                else if (mst_bvalid && mst_bready && wb_bptr[SLOT_W-1:0]==i[SLOT_W-1:0])
+                    wb_pend[i] <= 1'b0;
+            end
+        end
+    end
+
+    always @ (posedge aclk) begin
+        if (wr_grant) begin
+            wb_addr[wb_wptr[SLOT_W-1:0]] <= slv_awaddr;
+            wb_prot[wb_wptr[SLOT_W-1:0]] <= slv_awprot;
+            wb_id[wb_wptr[SLOT_W-1:0]] <= slv_awid;
+            wb_data[wb_wptr[SLOT_W-1:0]] <= slv_wdata;
+            wb_strb[wb_wptr[SLOT_W-1:0]] <= slv_wstrb;
+        end
+    end
+
+    assign mst_awvalid = (wb_awptr != wb_wptr);
+    assign mst_awaddr = wb_addr[wb_awptr[SLOT_W-1:0]];
+    assign mst_awprot = wb_prot[wb_awptr[SLOT_W-1:0]];
+    assign mst_awid = AXI_ID_MASK;
+
+    assign mst_wvalid = (wb_wdptr != wb_wptr);
+    assign mst_wdata = wb_data[wb_wdptr[SLOT_W-1:0]];
+    assign mst_wstrb = wb_strb[wb_wdptr[SLOT_W-1:0]];
+
+    assign slv_bvalid = mst_bvalid;
+    assign mst_bready = slv_bready;
+    assign slv_bid = wb_id[wb_bptr[SLOT_W-1:0]];
+    assign slv_bresp = mst_bresp;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Performance counters
+    ///////////////////////////////////////////////////////////////////////////
+
+    friscv_event_perf
+    #(
+        .REG_W    (32),
+        .NB_EVENT (6)
+    )
+    event_perf
+    (
+        .aclk    (aclk),
+        .aresetn (aresetn),
+        .srst    (srst),
+        .events  ({ready && (rd_req || wr_req) && conflict,
+                   refill_wr,
+                   wr_grant & !req_hit,
+                   wr_grant & req_hit,
+                   rd_grant & !req_hit,
+                   rd_grant & req_hit}),
+        .perfs   (perfs)
+    );
+
+endmodule
+
+`resetall
@@ -12,7 +12,17 @@ module friscv_m_ext
         // Number of integer registers (RV32I = 32, RV32E = 16)
         parameter NB_INT_REG        = 32,
         // Architecture selection
-        parameter XLEN  = 32
+        parameter XLEN  = 32,
+        // Divider architecture
+        parameter DIV_RADIX = 2,
+        parameter DIV_EARLY_TERM = 0,
+        parameter DIV_POW2 = 0,
+        // Number of cycles to complete a multiplication, 1 for a
+        // combinational multiplier
+        parameter MUL_LATENCY = 1,
+        // Number of divisions queued ahead of the divider, power of two,
+        // 0 to block the divisions while the divider is busy
+        parameter DIV_OSTD_NUM = 0
     )(
         // clock & reset
         input  wire                       aclk,
@@ -66,6 +76,20 @@ module friscv_m_ext
     logic                    rd_wr_div;
     logic                    m_valid_div;
     logic                    signed_div;
+    logic                    div_ready;
+    logic                    div_valid;
+    logic                    divider_pending;
+    logic                    dq_valid;
+    logic                    dq_ready;
+    logic                    dq_pending;
+    logic [`FUNCT3_W   -1:0] dq_funct3;
+    logic [`RD_W       -1:0] dq_rd;
+    logic [XLEN        -1:0] dq_rs1_val;
+    logic [XLEN        -1:0] dq_rs2_val;
+    logic                    mul_issue;
+    logic                    mul_done;
+    logic [5           -1:0] mul_rd;
+    logic [XLEN        -1:0] mul_res;
 
     localparam MAX_OR   = 1;
     localparam MAX_OR_W = $clog2(MAX_OR) + 1;
@@ -113,47 +137,226 @@ module friscv_m_ext
         end
     end
 
+    // A register is released as soon as its last result is written into the
+    // ISA registers, the value being forwarded to the readers in the same cycle
     for (genvar i=0;i<NB_INT_REG;i++) begin
-        assign m_regs_sts[i] = regs_or[i] == '0;
+        assign m_regs_sts[i] = regs_or[i] == '0 ||
+                               (regs_or[i] == 1 && m_rd_wr && m_rd_addr==i[4:0]);
     end
 
 
     ///////////////////////////////////////////////////////////////////////////
     //
-    // Multiply / divide operations
+    // Multiply operations, pipelined over MUL_LATENCY cycles. A new
+    // multiplication can be issued every cycle, the scoreboard tracking the
+    // destination registers in-flight.
     //
     ///////////////////////////////////////////////////////////////////////////
 
+    // A multiplication is always accepted, the pipeline never stalls
+    assign mul_issue = m_valid & !funct3[2];
+
+    generate
+
+    if (MUL_LATENCY>1) begin: MUL_PIPELINE
+
+        localparam NB_STAGE = MUL_LATENCY - 1;
+
+        logic [XLEN         :0] op_a;
+        logic [XLEN         :0] op_b;
+        logic [`FUNCT3_W  -1:0] op_funct3;
+        logic [`OPCODE_W  -1:0] op_opcode;
+        logic [XLEN       -1:0] op_res;
+        logic [NB_STAGE   -1:0] stg_valid;
+        logic [5          -1:0] stg_rd  [NB_STAGE-1:0];
+
+        // First stage, the operands are registered, mapping to the input
+        // registers of the DSP blocks
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                op_a <= '0;
+                op_b <= '0;
+                op_funct3 <= '0;
+                op_opcode <= '0;
+            end else if (srst) begin
+                op_a <= '0;
+                op_b <= '0;
+                op_funct3 <= '0;
+                op_opcode <= '0;
+            end else if (mul_issue) begin
+                op_a <= {rs1_sign, m_rs1_val};
+                op_b <= {rs2_sign, m_rs2_val};
+                op_funct3 <= funct3;
+                op_opcode <= opcode;
+            end
+        end
+
+        assign mul = $signed(op_a) * $signed(op_b);
+
+        assign mul32 = (op_funct3==`MUL) ? mul[0 +:32] :
+                                           mul[32+:32] ;
+
+        if (XLEN==64) begin: l_MULDIV64_GEN
+            // 64 bits multiplication instruction
+            assign mulw = $signed(op_a[0+:32]) * $signed(op_b[0+:32]);
+            assign mul64 = {{32{mulw[31]}},mulw[31:0]};
+        end else begin: l_NO_MULDIV64_GEN
+            assign mul64 = {XLEN{1'b0}};
+        end
+
+        assign op_res = (op_opcode==`MULDIVW) ? mul64 : mul32;
+
+        // The valid and the destination follow the operands stage
+        always @ (posedge aclk or negedge aresetn) begin
+            if (!aresetn) begin
+                stg_valid <= '0;
+                for (int i=0;i<NB_STAGE;i++) begin
+                    stg_rd[i] <= '0;
+                end
+            end else if (srst) begin
+                stg_valid <= '0;
+                for (int i=0;i<NB_STAGE;i++) begin
+                    stg_rd[i] <= '0;
+                end
+            end else begin
+                stg_valid[0] <= mul_issue;
+                stg_rd[0] <= rd;
+                for (int i=1;i<NB_STAGE;i++) begin
+                    stg_valid[i] <= stg_valid[i-1];
+                    stg_rd[i] <= stg_rd[i-1];
+                end
+            end
+        end
+
+        assign mul_done = stg_valid[NB_STAGE-1];
+        assign mul_rd = stg_rd[NB_STAGE-1];
+
+        if (NB_STAGE>1) begin: MUL_RES_STAGES
+
+            logic [XLEN       -1:0] stg_res [NB_STAGE-2:0];
+
+            // Next stages carry the product, the registers being moved inside
+            // the multiplier by the synthesis (retiming)
+            always @ (posedge aclk or negedge aresetn) begin
+                if (!aresetn) begin
+                    for (int i=0;i<NB_STAGE-1;i++) begin
+                        stg_res[i] <= '0;
+                    end
+                end else if (srst) begin
+                    for (int i=0;i<NB_STAGE-1;i++) begin
+                        stg_res[i] <= '0;
+                    end
+                end else begin
+                    stg_res[0] <= op_res;
+                    for (int i=1;i<NB_STAGE-1;i++) begin
+                        stg_res[i] <= stg_res[i-1];
+                    end
+                end
+            end
+
+            assign mul_res = stg_res[NB_STAGE-2];
+
+        end else begin: MUL_RES_OPERANDS
+
+            // The product is computed from the operands stage
+            assign mul_res = op_res;
+
+        end
+
+    end else begin: MUL_COMBINATIONAL
+
+        assign mul = $signed({rs1_sign,m_rs1_val}) * $signed({rs2_sign, m_rs2_val});
+
+        assign mul32 = (funct3==`MUL) ? mul[0 +:32] :
+                                        mul[32+:32] ;
+
+        if (XLEN==64) begin: l_MULDIV64_GEN
+            // 64 bits multiplication instruction
+            assign mulw = $signed(m_rs1_val[0+:32]) * $signed(m_rs2_val[0+:32]);
+            assign mul64 = {{32{mulw[31]}},mulw[31:0]};
+        end else begin: l_NO_MULDIV64_GEN
+            assign mul64 = {XLEN{1'b0}};
+        end
+
+        assign mul_done = mul_issue;
+        assign mul_rd = rd;
+        assign mul_res = (opcode==`MULDIVW) ? mul64 : mul32;
+
+    end
+    endgenerate
 
     assign rs1_sign = m_rs1_val[31] & (funct3!=`MULHU);
     assign rs2_sign = m_rs2_val[31] & (funct3==`MUL || funct3==`MULH);
-    assign mul = $signed({rs1_sign,m_rs1_val}) * $signed({rs2_sign, m_rs2_val});
 
-    assign mul32 = (funct3==`MUL) ? mul[0 +:32] :
-                                    mul[32+:32] ;
 
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Divide operations
+    //
+    ///////////////////////////////////////////////////////////////////////////
 
     // 32 bits division
     assign quotu = {XLEN{1'b0}};
     assign remu = {XLEN{1'b0}};
 
-    generate
-
-    if (XLEN==64) begin: l_MULDIV64_GEN
-
-        // 64 bits multiplication instruction
-        assign mulw = $signed(m_rs1_val[0+:32]) * $signed(m_rs2_val[0+:32]);
+    assign m_valid_div = m_valid & funct3[2];
 
-        assign mul64 = {{32{mulw[31]}},mulw[31:0]};
+    generate
+    ///////////////////////////////////////////////////////////////////////////
+    // Divisions queued ahead of the divider, the operands being read when
+    // issued. The processing unit keeps issuing the next instructions while
+    // the divider computes, the results being written back in any order
+    // versus the multiplications.
+    ///////////////////////////////////////////////////////////////////////////
+    if (DIV_OSTD_NUM>0) begin: DIV_QUEUE
+
+        logic dq_full;
+        logic dq_empty;
+
+        friscv_scfifo
+        #(
+            .PASS_THRU  (1),
+            .ADDR_WIDTH ($clog2(DIV_OSTD_NUM)),
+            .DATA_WIDTH (`FUNCT3_W+5+2*XLEN)
+        )
+        div_queue
+        (
+            .aclk     (aclk),
+            .aresetn  (aresetn),
+            .srst     (srst),
+            .flush    (1'b0),
+            .data_in  ({funct3, rd, m_rs1_val, m_rs2_val}),
+            .push     (m_valid_div),
+            .full     (dq_full),
+            .afull    (),
+            .data_out ({dq_funct3, dq_rd, dq_rs1_val, dq_rs2_val}),
+            .pull     (dq_ready),
+            .empty    (dq_empty),
+            .aempty   ()
+        );
+
+        assign dq_valid = !dq_empty;
+        assign div_ready = !dq_full;
+        assign dq_pending = !dq_empty;
 
-    end else begin: l_NO_MULDIV64_GEN
+    ///////////////////////////////////////////////////////////////////////////
+    // No queue, the divider is fed directly and blocks the next division
+    ///////////////////////////////////////////////////////////////////////////
+    end else begin: NO_DIV_QUEUE
 
-        assign mul64 = {XLEN{1'b0}};
+        assign dq_valid = m_valid_div;
+        assign dq_funct3 = funct3;
+        assign dq_rd = rd;
+        assign dq_rs1_val = m_rs1_val;
+        assign dq_rs2_val = m_rs2_val;
+        assign div_ready = dq_ready;
+        assign dq_pending = 1'b0;
 
     end
     endgenerate
 
-
+    // Division under computation, its result being routed back with its
+    // destination register
     always @ (posedge aclk or negedge aresetn) begin
         if (!aresetn) begin
             funct3_r <= {`FUNCT3_W{1'b0}};
@@ -162,33 +365,44 @@ module friscv_m_ext
             funct3_r <= {`FUNCT3_W{1'b0}};
             rd_r <= 5'b0;
         end else begin
-            if (m_valid & m_ready) begin
-                funct3_r <= funct3;
-                rd_r <= rd;
+            if (dq_valid & dq_ready) begin
+                funct3_r <= dq_funct3;
+                rd_r <= dq_rd;
             end
         end
     end
 
-    assign m_valid_div = m_valid & funct3[2];
-    assign signed_div = (funct3==`DIV) | (funct3==`REM);
+    assign signed_div = (dq_funct3==`DIV) | (dq_funct3==`REM);
+
+    // Multiplications never wait, only a division waits for the divider
+    assign m_ready = (funct3[2]) ? div_ready : 1'b1;
+
+    // A multiplication completing has the priority on the registers write,
+    // the division result waits for the next cycle
+    assign rd_wr_div = div_valid & !mul_done;
+
+    assign div_pending = dq_pending | divider_pending;
 
     friscv_div
     #(
-        .WIDTH (XLEN)
+        .WIDTH      (XLEN),
+        .RADIX      (DIV_RADIX),
+        .EARLY_TERM (DIV_EARLY_TERM),
+        .POW2       (DIV_POW2)
     )
     div32
     (
         .aclk            (aclk),
         .aresetn         (aresetn),
         .srst            (srst),
-        .div_pending     (div_pending),
-        .i_valid         (m_valid_div),
-        .i_ready         (m_ready),
+        .div_pending     (divider_pending),
+        .i_valid         (dq_valid),
+        .i_ready         (dq_ready),
         .signed_div      (signed_div),
-        .divd            (m_rs1_val),
-        .divs            (m_rs2_val),
-        .o_valid         (rd_wr_div),
-        .o_ready         (1'b1),
+        .divd            (dq_rs1_val),
+        .divs            (dq_rs2_val),
+        .o_valid         (div_valid),
+        .o_ready         (!mul_done),
         .zero_div        (),
         .quot            (quot),
         .rem             (rem)
@@ -209,49 +423,22 @@ module friscv_m_ext
         if (aresetn == 1'b0) begin
             m_rd_wr <= 1'b0;
             m_rd_addr <= 5'b0;
+            m_rd_val <= {XLEN{1'b0}};
         end else if (srst) begin
             m_rd_wr <= 1'b0;
             m_rd_addr <= 5'b0;
+            m_rd_val <= {XLEN{1'b0}};
         end else begin
-            m_rd_wr <= (m_valid & !funct3[2]) | rd_wr_div;
-            m_rd_addr <= (rd_wr_div) ? rd_r : rd;
+            m_rd_wr <= mul_done | rd_wr_div;
+            m_rd_addr <= (rd_wr_div) ? rd_r : mul_rd;
+            m_rd_val <= (rd_wr_div && (funct3_r==`DIV || funct3_r==`DIVU)) ? quot :
+                        (rd_wr_div && (funct3_r==`REM || funct3_r==`REMU)) ? rem :
+                                                                             mul_res;
         end
     end
 
     assign m_rd_strb = {XLEN/8{1'b1}};
 
-    generate
-
-    if (XLEN==64) begin: l_MULDIV64_SUPPORT
-        always @ (posedge aclk or negedge aresetn) begin
-            if (aresetn == 1'b0) begin
-                m_rd_val <= {XLEN{1'b0}};
-            end else if (srst) begin
-                m_rd_val <= {XLEN{1'b0}};
-            end else begin
-                m_rd_val <= (rd_wr_div && (funct3_r==`DIV || funct3_r==`DIVU)) ? quot :
-                            (rd_wr_div && (funct3_r==`REM || funct3_r==`REMU)) ? rem :
-                            (opcode==`MULDIVW)                                 ? mul64 :
-                                                                                 mul32 ;
-            end
-        end
-
-    end else begin: l_NO_MULDIV64_SUPPORT
-
-        always @ (posedge aclk or negedge aresetn) begin
-            if (aresetn == 1'b0) begin
-                m_rd_val <= {XLEN{1'b0}};
-            end else if (srst) begin
-                m_rd_val <= {XLEN{1'b0}};
-            end else begin
-                m_rd_val <= (rd_wr_div && (funct3_r==`DIV || funct3_r==`DIVU)) ? quot :
-                            (rd_wr_div && (funct3_r==`REM || funct3_r==`REMU)) ? rem :
-                                                                                 mul32;
-            end
-       end
-    end
-    endgenerate
-
 endmodule
 
 `resetall
@@ -26,13 +26,31 @@
 //
 // '''
 //
-// The module uses a single AXI4-lite ID, setup with AXI_ID_MASK. The FSM handles outstanding
-// requests in both directions, read and write, and wait for a direction received all its
-// completions to serve requests in another direction. The module provides flags indicating
+// The module uses an AXI4-lite ID per direction, AXI_ID_MASK for the reads and AXI_ID_MASK+1 for
+// the writes, a direction being completed in-order. The FSM handles outstanding requests in both
+// directions, read and write, and tracks the block address of the requests waiting for their
+// completion. A request waits only for the completions of the other direction to its block, the
+// requests to different blocks being issued concurrently. An IO request keeps a strict ordering and
+// waits for all the completions of the other direction. The module provides flags indicating
 // pending read/write requests to sequence instructions into the processing module.
 //
+// Optionally, the stores are pushed in a store buffer, completing once buffered and written in
+// order to the memory once the outstanding reads to their block are completed. A load reading a
+// word fully written by a buffered store is completed with the store data, a load to a block with
+// a buffered store waits for its write completion, the others being issued along the pending
+// writes. An IO load waits for the buffer to be drained.
+//
 // This module doesn't handle unaligned transfer, it will serve them anyway but will forward an
-// exception to the central controller thru a dedicated bus.
+// exception to the central controller thru a dedicated bus. Optionally, the misaligned accesses
+// are served: an access fitting in a word is issued as a single request, an access crossing the
+// word boundary is split in two requests, the lower and the upper words, the load completions
+// being merged in RD with the byte strobes.
+//
+// Optionally, the atomic instructions are executed once the outstanding requests are completed. A
+// LR reads the memory and registers a reservation on the word, cleared by a SC or any write to the
+// word. A SC writes the memory only if the reservation is still valid, RD being written with the
+// status without any read. An AMO reads the memory, writes RD with the value read and writes back
+// the result of its operation, no other request being issued meanwhile.
 //
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -53,6 +71,15 @@ module friscv_memfy
         parameter AXI_ID_MASK       = 'h20,
         // Maximum outstanding request supported
         parameter MAX_OR = 8,
+        // Number of stores buffered, 0 to disable the store buffer
+        parameter STORE_BUFFER_NB = 0,
+        // Data cache block width, the granularity of the address checks
+        // ordering the reads and the writes
+        parameter CACHE_BLOCK_W = XLEN,
+        // Serve the misaligned accesses instead of raising an exception
+        parameter MISALIGNED_HW = 0,
+        // Atomic extension support, LR/SC and AMOs
+        parameter A_EXTENSION = 0,
         // Add pipeline on Rd write stage
         parameter SYNC_RD_WR = 0,
         // Support hypervisor mode
@@ -119,6 +146,8 @@ module friscv_memfy
         output logic [3               -1:0] arprot,
         output logic [4               -1:0] arcache,
         output logic [AXI_ID_W        -1:0] arid,
+        // PC of the load, training the data cache prefetcher
+        output logic [XLEN            -1:0] arpc,
         input  wire                         rvalid,
         output logic                        rready,
         input  wire  [AXI_ID_W        -1:0] rid,
@@ -145,6 +174,9 @@ module friscv_memfy
     logic        [`RS2_W      -1:0] rs2;
     logic        [`RD_W       -1:0] rd;
     logic        [`IMM12_W    -1:0] imm12;
+    logic        [`IMM20_W    -1:0] imm20;
+    logic                           fused;
+    logic        [XLEN        -1:0] base;
     logic        [`OPCODE_W   -1:0] opcode_r;
     logic        [`FUNCT3_W   -1:0] funct3_r;
     logic        [`RD_W       -1:0] rd_r;
@@ -158,9 +190,12 @@ module friscv_memfy
 
     // read response channel
     logic                           push_rd_or;
+    logic        [12          -1:0] rd_or_in;
     logic                           rd_or_full;
     logic                           rd_or_empty;
     logic        [2           -1:0] offset;
+    logic                           hi_r;
+    logic                           split_r;
 
     // IO request management
     logic        [IO_MAP_NB   -1:0] io_map_hit;
@@ -193,11 +228,93 @@ module friscv_memfy
     // Central FSM
     logic                           memfy_ready_fsm;
     logic                           stall_bus;
-
-    typedef enum logic[1:0] {
+    logic                           load_wait;
+    logic                           store_wait;
+
+    // Block address of the outstanding requests
+    logic                           push_rd_trk;
+    logic        [AXI_ADDR_W  -1:0] rd_trk_addr;
+    logic                           rd_trk_match;
+    logic                           rd_trk_pending;
+    logic                           push_wr_trk;
+    logic        [AXI_ADDR_W  -1:0] wr_trk_addr;
+    logic                           wr_trk_match;
+    logic                           wr_trk_pending;
+    logic                           wr_trk_full;
+    logic                           trk_io;
+    logic        [AXI_ADDR_W  -1:0] trk_push_addr;
+
+    // Misaligned access crossing a word, split in two requests
+    logic                           crossing;
+    logic                           split_pending;
+    logic        [AXI_ADDR_W  -1:0] split_addr;
+    logic        [`RD_W       -1:0] split_rd;
+    logic        [`FUNCT3_W   -1:0] split_funct3;
+    logic        [2           -1:0] split_offset;
+    logic        [AXI_DATA_W/8-1:0] split_strb;
+    logic        [AXI_DATA_W/8-1:0] ld_strb;
+    logic                           split_wait;
+    logic                           split_ld_issue;
+    logic                           split_st_issue;
+
+    // Atomic instructions
+    logic        [5           -1:0] funct5;
+    logic                           amo_inst;
+    logic                           lr_inst;
+    logic                           sc_inst;
+    logic                           amo_rmw;
+    logic                           amo_misaligned;
+    logic                           amo_allowed;
+    logic                           amo_wait;
+    logic                           amo_rd_issue;
+    logic                           amo_st_issue;
+    logic        [5           -1:0] amo_funct5;
+    logic        [XLEN        -1:0] amo_rs2;
+    logic                           rsv_valid;
+    logic        [AXI_ADDR_W-2-1:0] rsv_addr;
+    logic                           sc_hit;
+    logic                           sc_cpl;
+
+    // Write requests issued by the FSM
+    logic                           st_awvalid;
+    logic                           st_awready;
+    logic        [AXI_ADDR_W  -1:0] st_awaddr;
+    logic        [3           -1:0] st_awprot;
+    logic        [4           -1:0] st_awcache;
+    logic                           st_wvalid;
+    logic                           st_wready;
+    logic        [AXI_DATA_W  -1:0] st_wdata;
+    logic        [AXI_DATA_W/8-1:0] st_wstrb;
+
+    // Store buffer lookup and load forwarding
+    logic                           sb_fwd;
+    logic        [AXI_DATA_W  -1:0] sb_data;
+    logic                           sb_hazard;
+    logic                           sb_stall;
+    logic                           fwd_load;
+    logic                           fwd_valid;
+    logic        [`RD_W       -1:0] fwd_rd;
+    logic        [`FUNCT3_W   -1:0] fwd_funct3;
+    logic        [2           -1:0] fwd_offset;
+    logic        [AXI_DATA_W  -1:0] fwd_data;
+
+    // Read completion, from the memory or forwarded from the store buffer
+    logic                           rd_cpl;
+    logic        [`RD_W       -1:0] cpl_rd;
+    logic        [`FUNCT3_W   -1:0] cpl_funct3;
+    logic        [2           -1:0] cpl_offset;
+    logic        [AXI_DATA_W  -1:0] cpl_data;
+    logic                           cpl_hi;
+    logic                           cpl_split;
+    logic                           rd_cpl_last;
+    logic                           rd_wr_last;
+
+    typedef enum logic[2:0] {
         IDLE = 0,
         WAIT = 1,
-        SERVE = 2
+        SERVE = 2,
+        SPLIT = 3,
+        AMO = 4
     } seq_fsm;
 
     seq_fsm state;
@@ -214,12 +331,16 @@ module friscv_memfy
     assign rs2    = memfy_instbus[`RS2      +: `RS2_W     ];
     assign rd     = memfy_instbus[`RD       +: `RD_W      ];
     assign imm12  = memfy_instbus[`IMM12    +: `IMM12_W   ];
+    assign imm20  = memfy_instbus[`IMM20    +: `IMM20_W   ];
+    assign fused  = memfy_instbus[`FUSED                  ];
     assign pc     = memfy_instbus[`PC       +: `PC_W      ];
     assign inst   = memfy_instbus[`INST     +: `INST_W    ];
     assign priv   = memfy_instbus[`PRIV     +: `PRIV_W    ];
     assign mpp    = memfy_instbus[`MPP      +: `PRIV_W    ];
     assign mprv   = memfy_instbus[`MPRV                   ];
 
+    assign funct5 = memfy_instbus[`FUNCT7+2 +: 5           ];
+
 
     ///////////////////////////////////////////////////////////////////////////
     //
@@ -230,32 +351,50 @@ module friscv_memfy
     always @ (posedge aclk or negedge aresetn) begin
 
         if (aresetn == 1'b0) begin
-            awaddr <= {AXI_ADDR_W{1'b0}};
-            awcache <= 4'b0;
-            awvalid <= 1'b0;
-            awprot <= '0;
+            st_awaddr <= {AXI_ADDR_W{1'b0}};
+            st_awcache <= 4'b0;
+            st_awvalid <= 1'b0;
+            st_awprot <= '0;
             arprot <= '0;
-            wvalid <= 1'b0;
-            wdata <= {XLEN{1'b0}};
-            wstrb <= {XLEN/8{1'b0}};
+            st_wvalid <= 1'b0;
+            st_wdata <= {XLEN{1'b0}};
+            st_wstrb <= {XLEN/8{1'b0}};
             araddr <= {AXI_ADDR_W{1'b0}};
+            arpc <= {XLEN{1'b0}};
             arvalid <= 1'b0;
             arcache <= 4'b0;
             opcode_r <= 7'b0;
+            split_pending <= 1'b0;
+            split_addr <= {AXI_ADDR_W{1'b0}};
+            split_rd <= {`RD_W{1'b0}};
+            split_funct3 <= {`FUNCT3_W{1'b0}};
+            split_offset <= 2'b0;
+            split_strb <= {XLEN/8{1'b0}};
+            amo_funct5 <= 5'b0;
+            amo_rs2 <= {XLEN{1'b0}};
             state <= IDLE;
             memfy_ready_fsm <= 1'b0;
         end else if (srst == 1'b1) begin
-            awaddr <= {AXI_ADDR_W{1'b0}};
-            awvalid <= 1'b0;
-            awprot <= '0;
+            st_awaddr <= {AXI_ADDR_W{1'b0}};
+            st_awvalid <= 1'b0;
+            st_awprot <= '0;
             arprot <= '0;
-            wvalid <= 1'b0;
-            wdata <= {XLEN{1'b0}};
-            wstrb <= {XLEN/8{1'b0}};
+            st_wvalid <= 1'b0;
+            st_wdata <= {XLEN{1'b0}};
+            st_wstrb <= {XLEN/8{1'b0}};
             araddr <= {AXI_ADDR_W{1'b0}};
+            arpc <= {XLEN{1'b0}};
             arvalid <= 1'b0;
             arcache <= 4'b0;
             opcode_r <= 7'b0;
+            split_pending <= 1'b0;
+            split_addr <= {AXI_ADDR_W{1'b0}};
+            split_rd <= {`RD_W{1'b0}};
+            split_funct3 <= {`FUNCT3_W{1'b0}};
+            split_offset <= 2'b0;
+            split_strb <= {XLEN/8{1'b0}};
+            amo_funct5 <= 5'b0;
+            amo_rs2 <= {XLEN{1'b0}};
             state <= IDLE;
             memfy_ready_fsm <= 1'b0;
         end else begin
@@ -278,13 +417,13 @@ module friscv_memfy
                     // For read, only the address channel could have fail, we
                     // do nothing. FSM is not ready anymore and we move to SERVE
                     if ((arvalid && !arready) ||
-                        (awvalid && !awready) || (wvalid && !wready))
+                        (st_awvalid && !st_awready) || (st_wvalid && !st_wready))
                     begin
 
                         // If address handshaked, release the request
-                        if (awready) awvalid <= 1'b0;
+                        if (st_awready) st_awvalid <= 1'b0;
                         // If data handshaked, stop to issue it
-                        if (wready) wvalid <= 1'b0;
+                        if (st_wready) st_wvalid <= 1'b0;
 
                         state <= SERVE;
                         memfy_ready_fsm <= 1'b0;
@@ -292,71 +431,122 @@ module friscv_memfy
                     // IDLE.READY state:
                     // -----------------
                     // Will forward a R/W transaction if the instruction is loaded
-                    end else if (memfy_valid) begin
+                    // and accepted, a load being held on the instruction bus by a
+                    // store buffer hazard or a store by the write tracker
+                    end else if (memfy_valid && memfy_ready) begin
 
-                        awaddr <= addr;
+                        st_awaddr <= addr;
                         araddr <= addr;
-                        awcache <= acache;
+                        arpc <= pc;
+                        st_awcache <= acache;
                         arcache <= acache;
-                        awprot <= aprot;
+                        st_awprot <= aprot;
                         arprot <= aprot;
 
                         opcode_r <= opcode;
 
+                        // Second request of an access crossing a word
+                        split_addr <= {addr[AXI_ADDR_W-1:2] + 1'b1, 2'b0};
+                        split_rd <= rd;
+                        split_funct3 <= funct3;
+                        split_offset <= addr[1:0];
+                        split_strb <= get_axi_strb_hi(funct3, addr[1:0]);
+
                         // STORE
                         if (opcode==`STORE && write_allowed) begin
 
-                            if (waiting_rd_cpl || arvalid) begin
+                            split_pending <= crossing;
+
+                            if (store_wait) begin
                                 state <= WAIT;
-                                awvalid <= 1'b0;
-                                wvalid <= 1'b0;
+                                st_awvalid <= 1'b0;
+                                st_wvalid <= 1'b0;
                                 memfy_ready_fsm <= 1'b0;
 
-                            end else if (!awready || !wready) begin
+                            end else if (!st_awready || !st_wready || crossing) begin
                                 state <= SERVE;
-                                awvalid <= 1'b1;
-                                wvalid <= 1'b1;
+                                st_awvalid <= 1'b1;
+                                st_wvalid <= 1'b1;
                                 memfy_ready_fsm <= 1'b0;
 
                             end else begin
-                                awvalid <= 1'b1;
-                                wvalid <= 1'b1;
+                                st_awvalid <= 1'b1;
+                                st_wvalid <= 1'b1;
                             end
 
-                            wdata <= get_axi_data(memfy_rs2_val, addr[1:0]);
-                            wstrb <= get_axi_strb(funct3, addr[1:0]);
+                            st_wdata <= get_axi_data(memfy_rs2_val, addr[1:0]);
+                            st_wstrb <= get_axi_strb(funct3, addr[1:0]);
 
                             arvalid <= 1'b0;
 
                         // LOAD
                         end else if (opcode==`LOAD && read_allowed) begin
-                            if (waiting_wr_cpl || awvalid) begin
+
+                            split_pending <= crossing;
+
+                            // Completed with a buffered store, no read issued
+                            if (sb_fwd) begin
+                                arvalid <= 1'b0;
+                                memfy_ready_fsm <= 1'b1;
+                            end else if (load_wait) begin
                                 state <= WAIT;
                                 arvalid <= 1'b0;
                                 memfy_ready_fsm <= 1'b0;
+                            end else if (crossing) begin
+                                state <= SERVE;
+                                arvalid <= 1'b1;
+                                memfy_ready_fsm <= 1'b0;
                             end else begin
                                 arvalid <= 1'b1;
                                 memfy_ready_fsm <= 1'b1;
                             end
-                            awvalid <= 1'b0;
-                            wvalid <= 1'b0;
-                            wstrb <= {XLEN/8{1'b0}};
+                            st_awvalid <= 1'b0;
+                            st_wvalid <= 1'b0;
+                            st_wstrb <= {XLEN/8{1'b0}};
+
+                        // LR / SC / AMO, accepted once the outstanding requests are completed
+                        end else if (amo_inst && amo_allowed) begin
+
+                            amo_funct5 <= funct5;
+                            amo_rs2 <= memfy_rs2_val;
+                            st_wdata <= memfy_rs2_val;
+                            st_wstrb <= {XLEN/8{1'b1}};
+
+                            // SC writes only if the reservation is still valid, RD being
+                            // written with the status on next cycle
+                            if (sc_inst) begin
+                                if (sc_hit) begin
+                                    state <= SERVE;
+                                    memfy_ready_fsm <= 1'b0;
+                                end
+                                st_awvalid <= sc_hit;
+                                st_wvalid <= sc_hit;
+                                arvalid <= 1'b0;
 
-                        // LOAD / STORE misaligned or not allowed
+                            // LR and AMO read the memory first
+                            end else begin
+                                state <= AMO;
+                                arvalid <= 1'b1;
+                                st_awvalid <= 1'b0;
+                                st_wvalid <= 1'b0;
+                                memfy_ready_fsm <= 1'b0;
+                            end
+
+                        // LOAD / STORE / atomic misaligned or not allowed
                         end else begin
                             memfy_ready_fsm <= 1'b1;
-                            awvalid <= 1'b0;
-                            wvalid <= 1'b0;
-                            wstrb <= {XLEN/8{1'b0}};
+                            st_awvalid <= 1'b0;
+                            st_wvalid <= 1'b0;
+                            st_wstrb <= {XLEN/8{1'b0}};
                             arvalid <= 1'b0;
                         end
 
                     // Wait for an instruction
                     end else begin
                         memfy_ready_fsm <= 1'b1;
-                        awvalid <= 1'b0;
-                        wvalid <= 1'b0;
-                        wstrb <= {XLEN/8{1'b0}};
+                        st_awvalid <= 1'b0;
+                        st_wvalid <= 1'b0;
+                        st_wstrb <= {XLEN/8{1'b0}};
                         arvalid <= 1'b0;
                     end
                 end
@@ -368,37 +558,78 @@ module friscv_memfy
                     if (opcode_r==`LOAD) begin
                         // Stop the request once accepted
                         if (arready) arvalid <= 1'b0;
-                        state <= IDLE;
-                        memfy_ready_fsm <= 1'b1;
+                        state <= (split_pending) ? SPLIT : IDLE;
+                        memfy_ready_fsm <= !split_pending;
                     // STORE
                     end else begin
 
                         // Stop the request once accepted
-                        if (awready) awvalid <= 1'b0;
-                        if (wready) wvalid <= 1'b0;
+                        if (st_awready) st_awvalid <= 1'b0;
+                        if (st_wready) st_wvalid <= 1'b0;
 
                         // Wait until addr and data have been acknowledged
-                        if (awready && wready  ||   // addr & data channel acked on same cycle
-                            !awvalid && wready ||   // addr has been acked before data
-                            awready && !wvalid      // addr is acked and data has been acked before
+                        if (st_awready && st_wready  ||   // addr & data channel acked on same cycle
+                            !st_awvalid && st_wready ||   // addr has been acked before data
+                            st_awready && !st_wvalid      // addr is acked and data has been acked before
                         ) begin
-                            memfy_ready_fsm <= 1'b1;
-                            state <= IDLE;
+                            memfy_ready_fsm <= !split_pending;
+                            state <= (split_pending) ? SPLIT : IDLE;
                         end
                     end
 
                 end
 
-                // WAIT: Wait for all write completion have been received before moving to LOAD
+                // WAIT: Wait for the completions of the other direction to the block before serving
                 WAIT: begin
 
-                    if (opcode_r==`LOAD && !waiting_wr_cpl) begin
+                    if (opcode_r==`LOAD && !load_wait) begin
                         state <= SERVE;
                         arvalid <= 1'b1;
-                    end else if (opcode_r==`STORE && !waiting_rd_cpl) begin
+                    end else if (opcode_r==`STORE && !store_wait) begin
+                        state <= SERVE;
+                        st_awvalid <= 1'b1;
+                        st_wvalid <= 1'b1;
+                    end
+                end
+
+                // SPLIT: Issue the upper word of an access crossing a word, once the lower word
+                // has been acknowledged, then complete the instruction in SERVE
+                SPLIT: begin
+
+                    if (opcode_r==`LOAD) begin
+                        if (arready) arvalid <= 1'b0;
+                        if (split_ld_issue) begin
+                            state <= SERVE;
+                            split_pending <= 1'b0;
+                            araddr <= split_addr;
+                            arvalid <= 1'b1;
+                        end
+                    end else if (split_st_issue) begin
                         state <= SERVE;
-                        awvalid <= 1'b1;
-                        wvalid <= 1'b1;
+                        split_pending <= 1'b0;
+                        st_awaddr <= split_addr;
+                        st_wstrb <= split_strb;
+                        st_awvalid <= 1'b1;
+                        st_wvalid <= 1'b1;
+                    end
+                end
+
+                // AMO: Wait for the read completion of a LR or an AMO, the AMO then writing back
+                // the result of its operation, completed in SERVE
+                AMO: begin
+
+                    if (arready) arvalid <= 1'b0;
+
+                    if (rvalid && rready) begin
+                        if (amo_funct5==`LR) begin
+                            state <= IDLE;
+                            memfy_ready_fsm <= 1'b1;
+                        end else begin
+                            state <= SERVE;
+                            st_wdata <= get_amo_val(amo_funct5, rdata, amo_rs2);
+                            st_awvalid <= 1'b1;
+                            st_wvalid <= 1'b1;
+                        end
                     end
                 end
 
@@ -408,11 +639,266 @@ module friscv_memfy
 
     // Block any further requests if IDLE is IDLE.STALL, last request issued
     // has not been yet acknowledged
-    assign stall_bus = (state==IDLE) & ((arvalid & !arready) | (awvalid & !awready) | (wvalid & !wready));
+    assign stall_bus = (state==IDLE) & ((arvalid & !arready) | (st_awvalid & !st_awready) | (st_wvalid & !st_wready));
+
+    // The upper word waits for the other direction like any request, and for a free slot
+    // to track its completion
+    assign split_wait = (opcode_r==`LOAD) ? load_wait | sb_hazard | sb_fwd | rd_or_full :
+                                            store_wait | wr_trk_full;
+
+    assign split_ld_issue = (state==SPLIT) & (opcode_r==`LOAD) & (!arvalid | arready) & !split_wait;
+    assign split_st_issue = (state==SPLIT) & (opcode_r==`STORE) & !split_wait;
 
     // Continue to accept if IDLE.READY and didn't reach yet maximum of
     // outstanding requests available
-    assign memfy_ready = memfy_ready_fsm & !rd_or_full & !stall_bus;
+    assign memfy_ready = memfy_ready_fsm & !rd_or_full & !stall_bus & !sb_stall &
+                         !(memfy_valid & (opcode==`STORE) & wr_trk_full) &
+                         !(memfy_valid & amo_inst & amo_wait);
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Atomic instructions
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign amo_inst = (A_EXTENSION!=0) & (opcode==`AMO);
+    assign lr_inst = amo_inst & (funct5==`LR);
+    assign sc_inst = amo_inst & (funct5==`SC);
+    assign amo_rmw = amo_inst & !lr_inst & !sc_inst;
+
+    // An atomic instruction is served alone, no read or write being outstanding, which
+    // provides the acquire and release semantics whatever the aq/rl bits
+    assign amo_wait = waiting_rd_cpl | waiting_wr_cpl;
+
+    // The read of a LR or an AMO, issued along the instruction
+    assign amo_rd_issue = memfy_valid & memfy_ready & amo_inst & amo_allowed & !sc_inst;
+
+    // The write of a successful SC, issued along the instruction, or of an AMO, issued
+    // once its read is completed
+    assign amo_st_issue = memfy_valid & memfy_ready & sc_inst & amo_allowed & sc_hit |
+                          (state==AMO) & rvalid & rready & (amo_funct5!=`LR);
+
+    // SC status written in RD: 0 if succeeded, 1 if failed
+    assign sc_cpl = memfy_valid & memfy_ready & sc_inst & amo_allowed;
+
+    assign sc_hit = rsv_valid & (rsv_addr==addr[AXI_ADDR_W-1:2]);
+
+    // Reservation set registered by a LR, cleared by a SC, succeeded or not, or by any write
+    // to the reserved word
+    always @ (posedge aclk or negedge aresetn) begin
+        if (!aresetn) begin
+            rsv_valid <= 1'b0;
+            rsv_addr <= {AXI_ADDR_W-2{1'b0}};
+        end else if (srst) begin
+            rsv_valid <= 1'b0;
+            rsv_addr <= {AXI_ADDR_W-2{1'b0}};
+        end else begin
+            if (memfy_valid && memfy_ready && lr_inst && amo_allowed) begin
+                rsv_valid <= 1'b1;
+                rsv_addr <= addr[AXI_ADDR_W-1:2];
+            end else if (memfy_valid && memfy_ready && sc_inst ||
+                         st_awvalid && st_awready && st_awaddr[AXI_ADDR_W-1:2]==rsv_addr)
+            begin
+                rsv_valid <= 1'b0;
+            end
+        end
+    end
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Ordering of the reads and the writes
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // The request checked is the one on the instruction bus, or the one held in WAIT or SPLIT
+    assign trk_io = (state==WAIT || state==SPLIT) ? ((opcode_r==`LOAD) ? arcache[1] : st_awcache[1]) :
+                                                    is_io_req;
+
+    assign trk_push_addr = (state==SPLIT) ? split_addr :
+                           (state==AMO)   ? st_awaddr  : addr;
+
+    // Bytes read, the upper word of a split load only covering its last ones
+    assign ld_strb = (state==SPLIT) ? get_axi_strb_hi({1'b0, split_funct3[1:0]}, split_offset) :
+                                      get_axi_strb({1'b0, funct3[1:0]}, addr[1:0]);
+
+    // Block address of the reads waiting for their completion, the loads
+    // completed by the store buffer not issuing any read
+    assign push_rd_trk = memfy_valid & memfy_ready & (opcode==`LOAD) & read_allowed & !fwd_load |
+                         split_ld_issue | amo_rd_issue;
+
+    friscv_addr_tracker
+    #(
+        .DEPTH      (MAX_OR),
+        .AXI_ADDR_W (AXI_ADDR_W),
+        .BLOCK_W    (CACHE_BLOCK_W)
+    )
+    rd_tracker
+    (
+        .aclk      (aclk),
+        .aresetn   (aresetn),
+        .srst      (srst),
+        .push      (push_rd_trk),
+        .push_addr (trk_push_addr),
+        .full      (),
+        .pop       (rvalid & rready),
+        .addr      (rd_trk_addr),
+        .match     (rd_trk_match),
+        .pending   (rd_trk_pending)
+    );
+
+    // Without store buffer, a request waits for the completions of the other direction to its
+    // block, or all of them for an IO request. With the buffer, the stores are ordered after the
+    // reads by the buffer itself and a load is held on the instruction bus while hitting a
+    // buffered store it can't be completed with, or while reads are outstanding for a load to
+    // forward, the completions sharing the RD write path.
+    generate if (STORE_BUFFER_NB > 0) begin: SB_ORDERING
+
+        assign rd_trk_addr = awaddr;
+
+        assign push_wr_trk = 1'b0;
+        assign wr_trk_addr = {AXI_ADDR_W{1'b0}};
+        assign wr_trk_match = 1'b0;
+        assign wr_trk_pending = 1'b0;
+        assign wr_trk_full = 1'b0;
+
+        assign store_wait = 1'b0;
+        assign load_wait = 1'b0;
+        assign sb_stall = memfy_valid & (opcode==`LOAD) &
+                          (sb_hazard | sb_fwd & (crossing | waiting_rd_cpl | arvalid));
+
+    end else begin: ADDR_ORDERING
+
+        assign rd_trk_addr = (state==WAIT)  ? st_awaddr :
+                             (state==SPLIT) ? split_addr : addr;
+        assign wr_trk_addr = (state==WAIT)  ? araddr :
+                             (state==SPLIT) ? split_addr : addr;
+
+        assign push_wr_trk = memfy_valid & memfy_ready & (opcode==`STORE) & write_allowed |
+                             split_st_issue | amo_st_issue;
+
+        friscv_addr_tracker
+        #(
+            .DEPTH      (MAX_OR),
+            .AXI_ADDR_W (AXI_ADDR_W),
+            .BLOCK_W    (CACHE_BLOCK_W)
+        )
+        wr_tracker
+        (
+            .aclk      (aclk),
+            .aresetn   (aresetn),
+            .srst      (srst),
+            .push      (push_wr_trk),
+            .push_addr (trk_push_addr),
+            .full      (wr_trk_full),
+            .pop       (bvalid & bready),
+            .addr      (wr_trk_addr),
+            .match     (wr_trk_match),
+            .pending   (wr_trk_pending)
+        );
+
+        assign store_wait = rd_trk_match | trk_io & rd_trk_pending;
+        assign load_wait = wr_trk_match | trk_io & wr_trk_pending;
+        assign sb_stall = 1'b0;
+
+    end
+    endgenerate
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Store buffer, driving the write channels
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate if (STORE_BUFFER_NB > 0) begin: STORE_BUFFER
+
+        friscv_store_buffer
+        #(
+            .DEPTH      (STORE_BUFFER_NB),
+            .AXI_ADDR_W (AXI_ADDR_W),
+            .AXI_DATA_W (AXI_DATA_W),
+            .BLOCK_W    (CACHE_BLOCK_W)
+        )
+        store_buffer
+        (
+            .aclk       (aclk),
+            .aresetn    (aresetn),
+            .srst       (srst),
+            .empty      (),
+            .rd_pending (rd_trk_match | awcache[1] & rd_trk_pending),
+            .st_awvalid (st_awvalid),
+            .st_awready (st_awready),
+            .st_awaddr  (st_awaddr),
+            .st_awprot  (st_awprot),
+            .st_awcache (st_awcache),
+            .st_wvalid  (st_wvalid),
+            .st_wready  (st_wready),
+            .st_wdata   (st_wdata),
+            .st_wstrb   (st_wstrb),
+            .ld_addr    (trk_push_addr),
+            .ld_strb    (ld_strb),
+            .ld_io      (trk_io),
+            .ld_fwd     (sb_fwd),
+            .ld_data    (sb_data),
+            .ld_hazard  (sb_hazard),
+            .awvalid    (awvalid),
+            .awready    (awready),
+            .awaddr     (awaddr),
+            .awprot     (awprot),
+            .awcache    (awcache),
+            .wvalid     (wvalid),
+            .wready     (wready),
+            .wdata      (wdata),
+            .wstrb      (wstrb),
+            .bvalid     (bvalid),
+            .bready     (bready)
+        );
+
+        // Load completed with the data of a buffered store
+        assign fwd_load = memfy_valid & memfy_ready & (opcode==`LOAD) & read_allowed & sb_fwd;
+
+    end else begin: NO_STORE_BUFFER
+
+        assign awvalid = st_awvalid;
+        assign st_awready = awready;
+        assign awaddr = st_awaddr;
+        assign awprot = st_awprot;
+        assign awcache = st_awcache;
+        assign wvalid = st_wvalid;
+        assign st_wready = wready;
+        assign wdata = st_wdata;
+        assign wstrb = st_wstrb;
+
+        assign sb_fwd = 1'b0;
+        assign sb_data = {AXI_DATA_W{1'b0}};
+        assign sb_hazard = 1'b0;
+        assign fwd_load = 1'b0;
+
+    end
+    endgenerate
+
+    // A forwarded load or a SC status is written into RD on next cycle, both
+    // waiting for the outstanding reads thus never colliding with a read completion
+    always @ (posedge aclk or negedge aresetn) begin
+        if (!aresetn) begin
+            fwd_valid <= 1'b0;
+        end else if (srst) begin
+            fwd_valid <= 1'b0;
+        end else begin
+            fwd_valid <= fwd_load | sc_cpl;
+        end
+    end
+
+    always @ (posedge aclk) begin
+        if (fwd_load || sc_cpl) begin
+            fwd_rd <= rd;
+            fwd_funct3 <= funct3;
+            fwd_offset <= addr[1:0];
+            fwd_data <= (sc_cpl) ? {{AXI_DATA_W-1{1'b0}}, !sc_hit} : sb_data;
+        end
+    end
 
 
     ///////////////////////////////////////////////////////////////////////////
@@ -421,13 +907,19 @@ module friscv_memfy
     //
     ///////////////////////////////////////////////////////////////////////////
 
-    assign push_rd_or = memfy_valid & memfy_ready & (opcode==`LOAD) & !load_misaligned;
+    assign push_rd_or = memfy_valid & memfy_ready & (opcode==`LOAD) & !load_misaligned & !fwd_load |
+                        split_ld_issue | amo_rd_issue;
+
+    // The lower word of a split load doesn't release RD, the upper word's
+    // completion being merged
+    assign rd_or_in = (state==SPLIT) ? {split_rd, split_funct3, split_offset, 1'b1, 1'b0} :
+                                       {rd, funct3, addr[1:0], 1'b0, crossing};
 
     friscv_scfifo
     #(
         .PASS_THRU  (0),
         .ADDR_WIDTH ($clog2(MAX_OR)),
-        .DATA_WIDTH (10)
+        .DATA_WIDTH (12)
     )
     rd_or_fifo
     (
@@ -435,11 +927,11 @@ module friscv_memfy
         .aresetn  (aresetn),
         .srst     (srst),
         .flush    (1'b0),
-        .data_in  ({rd, funct3, addr[1:0]}),
+        .data_in  (rd_or_in),
         .push     (push_rd_or),
         .full     (rd_or_full),
         .afull    (),
-        .data_out ({rd_r, funct3_r, offset}),
+        .data_out ({rd_r, funct3_r, offset, hi_r, split_r}),
         .pull     (rvalid & rready),
         .empty    (rd_or_empty),
         .aempty   ()
@@ -470,6 +962,16 @@ module friscv_memfy
         end
     end
 
+    // A read completion comes from the memory or from the store buffer
+    assign rd_cpl = rvalid & rready | fwd_valid;
+    assign cpl_rd = (fwd_valid) ? fwd_rd : rd_r;
+    assign cpl_funct3 = (fwd_valid) ? fwd_funct3 : funct3_r;
+    assign cpl_offset = (fwd_valid) ? fwd_offset : offset;
+    assign cpl_data = (fwd_valid) ? fwd_data : rdata;
+    assign cpl_hi = hi_r & !fwd_valid;
+    assign cpl_split = split_r & !fwd_valid;
+    assign rd_cpl_last = rd_cpl & !cpl_split;
+
     for (genvar i=1;i<NB_INT_REG;i++) begin
         always @ (posedge aclk or negedge aresetn) begin
             if (!aresetn) begin
@@ -477,13 +979,14 @@ module friscv_memfy
             end else if (srst) begin
                 regs_or[i] <= '0;
             end else begin
-                if ((memfy_valid && memfy_ready && opcode==`LOAD && !max_rd_or && rd == i[4:0] && mpu_allow[`ALW_R] && !load_misaligned) &&
-                   !(rvalid & rready && rd_r==i[4:0]))
+                if ((memfy_valid && memfy_ready && !max_rd_or && rd == i[4:0] &&
+                    (opcode==`LOAD && mpu_allow[`ALW_R] && !load_misaligned || amo_inst && amo_allowed)) &&
+                   !(rd_cpl_last && cpl_rd==i[4:0]))
                begin
                     regs_or[i] <= regs_or[i] + 1;
 
-                end else if (!(memfy_valid && memfy_ready && opcode==`LOAD && !max_rd_or && rd == i[4:0]) &&
-                              (rvalid & rready && rd_r==i[4:0]))
+                end else if (!(memfy_valid && memfy_ready && (opcode==`LOAD || amo_inst) && !max_rd_or && rd == i[4:0]) &&
+                              (rd_cpl_last && cpl_rd==i[4:0]))
                 begin
                     regs_or[i] <= regs_or[i] - 1;
                 end
@@ -491,8 +994,17 @@ module friscv_memfy
         end
     end
 
+    // A register is released as soon as its last read completion is written
+    // into the ISA registers, the value being already readable by the next
+    // instruction in the same cycle (not the case if RD write is registered,
+    // the counter being already released when the write occurs)
     for (genvar i=0;i<NB_INT_REG;i++) begin
-        assign memfy_regs_sts[i] = regs_or[i] == '0;
+        if (SYNC_RD_WR) begin: REGS_STS_FFD
+            assign memfy_regs_sts[i] = regs_or[i] == '0;
+        end else begin: REGS_STS_FWD
+            assign memfy_regs_sts[i] = regs_or[i] == '0 ||
+                                       (regs_or[i] == 1 && rd_cpl_last && cpl_rd==i[4:0]);
+        end
     end
 
 
@@ -515,16 +1027,16 @@ module friscv_memfy
         end else begin
 
             // Write xfers tracker
-            if (memfy_valid && memfy_ready && opcode==`STORE && !bvalid && !max_wr_or && write_allowed) begin
+            if ((memfy_valid && memfy_ready && opcode==`STORE && write_allowed || split_st_issue || amo_st_issue) && !bvalid && !max_wr_or) begin
                 wr_or_cnt <= wr_or_cnt + 1'b1;
-            end else if (!(memfy_valid && memfy_ready && opcode==`STORE) && bvalid && bready && wr_or_cnt!={MAX_OR_W{1'b0}}) begin
+            end else if (!(memfy_valid && memfy_ready && opcode==`STORE) && !split_st_issue && !amo_st_issue && bvalid && bready && wr_or_cnt!={MAX_OR_W{1'b0}}) begin
                 wr_or_cnt <= wr_or_cnt - 1'b1;
             end
 
             // Read xfers tracker
-            if (memfy_valid && memfy_ready && opcode==`LOAD && !memfy_rd_wr && !max_rd_or && read_allowed) begin
+            if (memfy_valid && memfy_ready && (opcode==`LOAD && read_allowed || amo_inst && amo_allowed) && !rd_wr_last && !max_rd_or) begin
                 rd_or_cnt <= rd_or_cnt + 1'b1;
-            end else if (!(memfy_valid && memfy_ready && opcode==`LOAD) && memfy_rd_wr && rd_or_cnt!={MAX_OR_W{1'b0}}) begin
+            end else if (!(memfy_valid && memfy_ready && (opcode==`LOAD || amo_inst)) && rd_wr_last && rd_or_cnt!={MAX_OR_W{1'b0}}) begin
                 rd_or_cnt <= rd_or_cnt - 1'b1;
             end
 
@@ -552,11 +1064,11 @@ module friscv_memfy
     assign max_rd_or = (rd_or_cnt==MAX_OR[MAX_OR_W-1:0]) ? 1'b1 : 1'b0;
 
     assign waiting_wr_cpl = (wr_or_cnt!={MAX_OR_W{1'b0}} && !(wr_or_cnt=={{(MAX_OR_W-1){1'b0}}, 1'b1} & bvalid)) ? 1'b1 : 1'b0;
-    assign waiting_rd_cpl = (rd_or_cnt!={MAX_OR_W{1'b0}} && !(rd_or_cnt=={{(MAX_OR_W-1){1'b0}}, 1'b1} & rvalid)) ? 1'b1 : 1'b0;
+    assign waiting_rd_cpl = (rd_or_cnt!={MAX_OR_W{1'b0}} && !(rd_or_cnt=={{(MAX_OR_W-1){1'b0}}, 1'b1} & rd_cpl_last)) ? 1'b1 : 1'b0;
 
     // Flags for externals
     assign memfy_pending_read = waiting_rd_cpl;
-    assign memfy_pending_write = waiting_wr_cpl;
+    assign memfy_pending_write = waiting_wr_cpl | split_pending & (opcode_r==`STORE);
 
 
     ////////////////////////////////////////////////////////////////////////
@@ -570,29 +1082,37 @@ module friscv_memfy
     always @ (posedge aclk or negedge aresetn) begin
         if (!aresetn) begin
             memfy_rd_wr <= 1'b0;
+            rd_wr_last <= 1'b0;
             memfy_rd_addr <= 5'b0;
             memfy_rd_strb <= {XLEN/8{1'b0}};
             memfy_rd_val <= {XLEN{1'b0}};
         end else if (srst) begin
             memfy_rd_wr <= 1'b0;
+            rd_wr_last <= 1'b0;
             memfy_rd_addr <= 5'b0;
             memfy_rd_strb <= {XLEN/8{1'b0}};
             memfy_rd_val <= {XLEN{1'b0}};
         end else begin
             // Write into RD once the read data channel handshakes
-            memfy_rd_wr <= rvalid & rready;
-            memfy_rd_addr <= rd_r;
-            memfy_rd_strb <= get_rd_strb(funct3_r, offset);
-            memfy_rd_val <= get_rd_val(funct3_r, rdata, offset);
+            memfy_rd_wr <= rd_cpl;
+            rd_wr_last <= rd_cpl_last;
+            memfy_rd_addr <= cpl_rd;
+            memfy_rd_strb <= (cpl_hi) ? ~get_rd_strb(cpl_funct3, cpl_offset) :
+                                         get_rd_strb(cpl_funct3, cpl_offset);
+            memfy_rd_val <= (cpl_hi) ? get_rd_val_hi(cpl_funct3, cpl_data, cpl_offset) :
+                                       get_rd_val(cpl_funct3, cpl_data, cpl_offset);
         end
     end
 
     end else begin : RD_WR_COMB
 
-        assign memfy_rd_wr = rvalid & rready;
-        assign memfy_rd_addr = rd_r;
-        assign memfy_rd_strb = get_rd_strb(funct3_r, offset);
-        assign memfy_rd_val = get_rd_val(funct3_r, rdata, offset);
+        assign memfy_rd_wr = rd_cpl;
+        assign rd_wr_last = rd_cpl_last;
+        assign memfy_rd_addr = cpl_rd;
+        assign memfy_rd_strb = (cpl_hi) ? ~get_rd_strb(cpl_funct3, cpl_offset) :
+                                          get_rd_strb(cpl_funct3, cpl_offset);
+        assign memfy_rd_val = (cpl_hi) ? get_rd_val_hi(cpl_funct3, cpl_data, cpl_offset) :
+                                         get_rd_val(cpl_funct3, cpl_data, cpl_offset);
 
     end
     endgenerate
@@ -607,8 +1127,11 @@ module friscv_memfy
     //
     ////////////////////////////////////////////////////////////////////////
 
+    // LUI + LOAD fused pair: the base address is the LUI immediate
+    assign base = (fused) ? {imm20, 12'b0} : memfy_rs1_val;
+
     // The address to access during a LOAD or a STORE
-    assign addr = $signed({{(XLEN-12){imm12[11]}}, imm12}) + $signed(memfy_rs1_val);
+    assign addr = $signed({{(XLEN-12){imm12[11]}}, imm12}) + $signed(base);
 
     // Unused: information forwarded to control unit for FENCE execution:
     // bit 0: memory write
@@ -687,8 +1210,8 @@ module friscv_memfy
     // Constant AXI4-lite signals
     //////////////////////////////////////////////////////////////////////////
 
-    // Always use the same IDs to ensure in-order execution / completion
-    assign awid = AXI_ID_MASK;
+    // Use an ID per direction, each one completed in-order
+    assign awid = AXI_ID_MASK + 1;
     assign arid = AXI_ID_MASK;
 
     // Access permissions
@@ -727,6 +1250,12 @@ module friscv_memfy
 
     assign read_allowed = mpu_allow[`ALW_R] & !load_misaligned & check_access;
 
+    // A LR needs the read permission, a SC the write one and an AMO both
+    assign amo_allowed = !amo_misaligned & check_access &
+                         ((lr_inst) ? mpu_allow[`ALW_R] :
+                          (sc_inst) ? mpu_allow[`ALW_W] :
+                                      mpu_allow[`ALW_R] & mpu_allow[`ALW_W]);
+
 
     //////////////////////////////////////////////////////////////////////////
     //
@@ -736,23 +1265,49 @@ module friscv_memfy
 
     assign active_access = memfy_valid & memfy_ready;
 
+    // The atomic accesses must be naturally aligned, whatever MISALIGNED_HW
+    assign amo_misaligned = amo_inst & (addr[1:0]!=2'b0);
+
+    generate if (MISALIGNED_HW) begin: MISALIGNED_SUPPORT
+
+    // The misaligned accesses are served, the ones crossing a word being split
+    assign load_misaligned = (lr_inst && amo_misaligned) ? active_access : 1'b0;
+    assign store_misaligned = (!lr_inst && amo_misaligned) ? active_access : 1'b0;
+
+    assign crossing = ((opcode==`LOAD && (funct3==`LH || funct3==`LHU)) ||
+                       (opcode==`STORE && funct3==`SH))                  ? addr[1:0]==2'h3 :
+                      ((opcode==`LOAD && funct3==`LW) ||
+                       (opcode==`STORE && funct3==`SW))                  ? addr[1:0]!=2'h0 :
+                                                                           1'b0;
+
+    end else begin: MISALIGNED_EXCEPTION
+
     // LOAD is not XLEN-boundary aligned
     assign load_misaligned = (opcode==`LOAD && (funct3==`LH || funct3==`LHU) &&
                                 (addr[1:0]==2'h3 || addr[1:0]==2'h1))           ? active_access :
                              (opcode==`LOAD && funct3==`LW  && addr[1:0]!=2'b0) ? active_access :
+                             (lr_inst && amo_misaligned)                        ? active_access :
                                                                                   1'b0 ;
 
     // STORE is not XLEN-boundary aligned
     assign store_misaligned = (opcode==`STORE && funct3==`SH &&
                                 (addr[1:0]==2'h3 || addr[1:0]==2'h1))            ? active_access :
                               (opcode==`STORE && funct3==`SW && addr[1:0]!=2'b0) ? active_access :
+                              (!lr_inst && amo_misaligned)                       ? active_access :
                                                                                    1'b0 ;
 
+    assign crossing = 1'b0;
+
+    end
+    endgenerate
+
     // Load access outside an allowed region
-    assign load_access_fault = (opcode==`LOAD) & !mpu_allow[`ALW_R] & check_access & active_access;
+    assign load_access_fault = (opcode==`LOAD | lr_inst) & !mpu_allow[`ALW_R] & check_access & active_access;
 
-    // Store access outside an allowed region
-    assign store_access_fault = (opcode==`STORE) & !mpu_allow[`ALW_W] & check_access & active_access;
+    // Store / AMO access outside an allowed region, an AMO needing both permissions
+    assign store_access_fault = ((opcode==`STORE | sc_inst) & !mpu_allow[`ALW_W] |
+                                 amo_rmw & !(mpu_allow[`ALW_R] & mpu_allow[`ALW_W])) &
+                                check_access & active_access;
 
 
     // Shared bus routing back to control unit
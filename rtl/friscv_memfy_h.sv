@@ -71,6 +71,27 @@
 
     endfunction
 
+    ///////////////////////////////////////////////////////////////////////////
+    // Create the strobe vector to apply on the upper word of a STORE crossing
+    // a word boundary, the data being the one of the lower word
+    // Args:
+    //      - funct3: opcode's funct3 identifier
+    //      - offset: the shift to apply, ADDR's LSBs
+    // Returns:
+    //      - the ready to use strobes
+    ///////////////////////////////////////////////////////////////////////////
+    function automatic logic [XLEN/8-1:0] get_axi_strb_hi(
+
+        input logic  [2:0] funct3,
+        input logic  [1:0] offset
+    );
+        get_axi_strb_hi = {(XLEN/8){1'b0}};
+
+        if (funct3==`SH && offset==2'h3) get_axi_strb_hi = {{(XLEN/8-1){1'b0}},1'b1};
+        if (funct3==`SW && offset!=2'h0) get_axi_strb_hi = ~get_axi_strb(funct3, offset);
+
+    endfunction
+
 
     ///////////////////////////////////////////////////////////////////////////
     //
@@ -126,6 +147,34 @@
 
     endfunction
 
+    ///////////////////////////////////////////////////////////////////////////
+    // Align the upper word read by a LOAD crossing a word boundary, its first
+    // bytes completing RD above the bytes of the lower word. The strobes to
+    // apply are the inverse of the lower word's ones
+    // Args:
+    //      - funct3: opcode's funct3 identifier
+    //      - data: the upper word read
+    //      - offset: ADDR's LSBs of the LOAD
+    // Returns:
+    //      - the upper part of RD
+    ///////////////////////////////////////////////////////////////////////////
+    function automatic logic [XLEN-1:0] get_rd_val_hi(
+
+        input logic  [3   -1:0] funct3,
+        input logic  [XLEN-1:0] data,
+        input logic  [2   -1:0] offset
+    );
+        logic [XLEN-1:0] data_aligned;
+
+        data_aligned = get_axi_data(data, 2'b00 - offset);
+
+        get_rd_val_hi = data_aligned;
+
+        if  (funct3==`LH)  get_rd_val_hi = {{16{data_aligned[15]}}, data_aligned[15:0]};
+        if  (funct3==`LHU) get_rd_val_hi = {{16{1'b0}}, data_aligned[15:0]};
+
+    endfunction
+
     ///////////////////////////////////////////////////////////////////////////
     // Create the strobe vector to apply during a RD write
     // Args:
@@ -163,4 +212,42 @@
 
     endfunction
 
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Atomic Functions
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Compute the value an AMO writes back to the memory
+    // Args:
+    //      - funct5: the AMO operation, funct7[6:2]
+    //      - data: the word read from the memory
+    //      - rs2: the register source 2 value
+    // Returns:
+    //      - the word to write back
+    ///////////////////////////////////////////////////////////////////////////
+    function automatic logic [XLEN-1:0] get_amo_val(
+
+        input logic  [5     -1:0] funct5,
+        input logic  [XLEN  -1:0] data,
+        input logic  [XLEN  -1:0] rs2
+    );
+        case (funct5)
+            `AMOADD:  get_amo_val = data + rs2;
+            `AMOXOR:  get_amo_val = data ^ rs2;
+            `AMOAND:  get_amo_val = data & rs2;
+            `AMOOR:   get_amo_val = data | rs2;
+            `AMOMIN:  get_amo_val = ($signed(data) < $signed(rs2)) ? data : rs2;
+            `AMOMAX:  get_amo_val = ($signed(data) > $signed(rs2)) ? data : rs2;
+            `AMOMINU: get_amo_val = (data < rs2) ? data : rs2;
+            `AMOMAXU: get_amo_val = (data > rs2) ? data : rs2;
+            `AMOSWAP: get_amo_val = rs2;
+            // Reserved encodings, rejected by the decoder
+            default:  get_amo_val = data;
+        endcase
+
+    endfunction
+
 `endif
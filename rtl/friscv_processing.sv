@@ -16,6 +16,17 @@ module friscv_processing
         parameter F_EXTENSION       = 0,
         // Multiply/Divide extension support
         parameter M_EXTENSION       = 0,
+        // Atomic extension support
+        parameter A_EXTENSION       = 0,
+        // Divider architecture: radix (2 or 4), leading zeros skipping and
+        // power of two divisors shortcut
+        parameter DIV_RADIX         = 2,
+        parameter DIV_EARLY_TERM    = 0,
+        parameter DIV_POW2          = 0,
+        // Number of cycles to complete a multiplication
+        parameter MUL_LATENCY       = 1,
+        // Number of divisions queued ahead of the divider
+        parameter DIV_OSTD_NUM      = 0,
         // Reduced RV32 arch
         parameter RV32E             = 0,
         // Address bus width defined for both control and AXI4 address signals
@@ -31,8 +42,16 @@ module friscv_processing
         parameter MAX_UNIT          = 4,
         // Insert a pipeline on instruction bus coming from the controller
         parameter INST_BUS_PIPELINE = 0,
+        // Second ALU executing the instruction dual-issued by the controller
+        parameter DUAL_ISSUE = 0,
         // Number of outstanding requests used by the LOAD/STORE unit
         parameter DATA_OSTDREQ_NUM  = 8,
+        // Number of stores buffered by the LOAD/STORE unit, 0 to disable
+        parameter STORE_BUFFER_NB   = 0,
+        // Data cache block width, or XLEN without cache
+        parameter CACHE_BLOCK_W     = XLEN,
+        // Serve the misaligned LOAD/STORE instead of raising an exception
+        parameter MISALIGNED_HW     = 0,
         // Add pipeline on Rd write stage
         parameter SYNC_RD_WR = 0,
         // Support hypervisor mode
@@ -59,8 +78,12 @@ module friscv_processing
         input  wire                         proc_valid,
         output logic                        proc_ready,
         input  wire  [`INST_BUS_W     -1:0] proc_instbus,
+        input  wire                         proc_dual,
+        input  wire  [`INST_BUS_W     -1:0] proc_instbus2,
         output logic [4               -1:0] proc_fenceinfo,
         output logic                        proc_busy,
+        output logic                        proc_wr_pending,
+        output logic [32              -1:0] proc_regs_sts,
         output logic [`PROC_EXP_W     -1:0] proc_exceptions,
         // ISA registers interface
         output logic [NB_UNIT*5       -1:0] proc_rs1_addr,
@@ -95,6 +118,7 @@ module friscv_processing
         output logic [3               -1:0] arprot,
         output logic [4               -1:0] arcache,
         output logic [AXI_ID_W        -1:0] arid,
+        output logic [XLEN            -1:0] arpc,
         input  wire                         rvalid,
         output logic                        rready,
         input  wire  [AXI_ID_W        -1:0] rid,
@@ -111,6 +135,8 @@ module friscv_processing
 
     // Assignment of M extension on integer registers' interface
     localparam M_IX = 2;
+    // Assignment of the second ALU on integer registers' interface
+    localparam ALU2_IX = 2 + M_EXTENSION;
 
     // Number of integer registers really used based on RV32E arch
     localparam NB_INT_REG = (RV32E) ? 16 : 32;
@@ -120,6 +146,9 @@ module friscv_processing
     logic [`RS1_W          -1:0] rs1;
     logic [`RS2_W          -1:0] rs2;
     logic [`RD_W           -1:0] rd;
+    logic [`RS1_W          -1:0] rs1_2;
+    logic [`RS2_W          -1:0] rs2_2;
+    logic [`RD_W           -1:0] rd_2;
 
     logic                        alu_valid;
     logic                        alu_ready;
@@ -127,6 +156,9 @@ module friscv_processing
     logic                        memfy_hzd_free;
     logic                        m_hzd_free;
     logic                        hzd_free;
+    logic                        dual_hzd_free;
+    logic                        alu2_valid;
+    logic [NB_INT_REG      -1:0] pipe_regs_sts;
 
     logic                        m_valid;
     logic                        m_ready;
@@ -144,6 +176,8 @@ module friscv_processing
     logic                        proc_valid_p;
     logic                        proc_ready_p;
     logic [`INST_BUS_W     -1:0] proc_instbus_p;
+    logic                        proc_dual_p;
+    logic [`INST_BUS_W     -1:0] proc_instbus2_p;
     logic                          proc_busy_r;
 
     logic [`PROC_EXP_W     -1:0] memfy_exceptions;
@@ -161,7 +195,7 @@ module friscv_processing
 
         friscv_pipeline
         #(
-            .DATA_BUS_W  (`INST_BUS_W),
+            .DATA_BUS_W  (2*(`INST_BUS_W)+1),
             .NB_PIPELINE (1)
         )
         inst_bus_pipeline
@@ -171,10 +205,10 @@ module friscv_processing
             .srst    (srst),
             .i_valid (proc_valid),
             .i_ready (proc_ready),
-            .i_data  (proc_instbus),
+            .i_data  ({proc_dual, proc_instbus2, proc_instbus}),
             .o_valid (proc_valid_p),
             .o_ready (proc_ready_p),
-            .o_data  (proc_instbus_p)
+            .o_data  ({proc_dual_p, proc_instbus2_p, proc_instbus_p})
         );
 
         always @ (posedge aclk or negedge aresetn) begin
@@ -196,6 +230,8 @@ module friscv_processing
     end else begin: INPUT_PIPELINE_OFF
 
         assign proc_instbus_p = proc_instbus;
+        assign proc_dual_p = proc_dual;
+        assign proc_instbus2_p = proc_instbus2;
         assign proc_valid_p = proc_valid;
         assign proc_ready = proc_ready_p;
 
@@ -205,6 +241,9 @@ module friscv_processing
     end
     endgenerate
 
+    // Stores waiting for their completion, checked by the fences
+    assign proc_wr_pending = memfy_pending_write;
+
 
     assign opcode = proc_instbus_p[`OPCODE +: `OPCODE_W];
     assign funct7 = proc_instbus_p[`FUNCT7 +: `FUNCT7_W];
@@ -212,6 +251,10 @@ module friscv_processing
     assign rs2    = proc_instbus_p[`RS2    +: `RS2_W   ];
     assign rd     = proc_instbus_p[`RD     +: `RD_W    ];
 
+    assign rs1_2  = proc_instbus2_p[`RS1   +: `RS1_W   ];
+    assign rs2_2  = proc_instbus2_p[`RS2   +: `RS2_W   ];
+    assign rd_2   = proc_instbus2_p[`RD    +: `RD_W    ];
+
 
     // Hazard free flags: ensure the memfy and m extension are not 
     // processing instruction which the rd outputs are not sources for
@@ -227,7 +270,43 @@ module friscv_processing
     // instruction and corrupt the expected value of the user.
     assign memfy_hzd_free = memfy_regs_sts[rs1] & memfy_regs_sts[rs2] & memfy_regs_sts[rd];
     assign m_hzd_free = m_regs_sts[rs1] & m_regs_sts[rs2] & m_regs_sts[rd];
-    assign hzd_free = m_hzd_free & memfy_hzd_free;
+    // The second instruction, if any, is checked the same way, both being
+    // issued together
+    assign dual_hzd_free = !proc_dual_p |
+                           (memfy_regs_sts[rs1_2] & memfy_regs_sts[rs2_2] & memfy_regs_sts[rd_2] &
+                            m_regs_sts[rs1_2] & m_regs_sts[rs2_2] & m_regs_sts[rd_2]);
+    assign hzd_free = m_hzd_free & memfy_hzd_free & dual_hzd_free;
+
+    // Registers the control unit can read or write without waiting for the
+    // processing to be idle (jumps, branches, LUI, AUIPC). The registers used
+    // by the instruction waiting in the input pipeline are reserved, then the
+    // ones still written by an outstanding load or division. The ALU writes
+    // its results the cycle after the execution, thus forwarded by the ISA
+    // registers to the readers.
+    generate
+    if (INST_BUS_PIPELINE) begin: PIPE_REGS_STS
+
+        for (genvar i=0;i<NB_INT_REG;i++) begin
+            assign pipe_regs_sts[i] = !(proc_valid_p && (rs1==i[4:0] ||
+                                                         rs2==i[4:0] ||
+                                                         rd==i[4:0])) &&
+                                      !(proc_valid_p && proc_dual_p && (rs1_2==i[4:0] ||
+                                                                        rs2_2==i[4:0] ||
+                                                                        rd_2==i[4:0]));
+        end
+
+    end else begin: NO_PIPE_REGS_STS
+
+        assign pipe_regs_sts = '1;
+
+    end
+    endgenerate
+
+    always @ (*) begin
+        proc_regs_sts = '1;
+        for (int i=1;i<NB_INT_REG;i++)
+            proc_regs_sts[i] = pipe_regs_sts[i] & memfy_regs_sts[i] & m_regs_sts[i];
+    end
 
 
     ///////////////////////////////////////////////////////////////////////////
@@ -239,7 +318,8 @@ module friscv_processing
     assign i_inst = ((opcode==`R_ARITH & (funct7==7'b0000000 | funct7==7'b0100000)) |
                       opcode==`I_ARITH);
 
-    assign ls_inst = opcode==`LOAD | opcode==`STORE;
+    // The atomic instructions are executed by the load/store unit
+    assign ls_inst = opcode==`LOAD | opcode==`STORE | (A_EXTENSION!=0) & opcode==`AMO;
 
     assign m_inst = opcode==`MULDIV & funct7==7'b0000001;
 
@@ -314,11 +394,52 @@ module friscv_processing
     );
 
 
+    generate
+
+    if (DUAL_ISSUE) begin: DUAL_ISSUE_ALU
+
+    // Executes the second instruction, issued only along the first one
+    assign alu2_valid = proc_valid_p & proc_ready_p & proc_dual_p;
+
+    friscv_alu
+    #(
+        .XLEN (XLEN)
+    )
+    alu2
+    (
+        .aclk          (aclk),
+        .aresetn       (aresetn),
+        .srst          (srst),
+        .alu_valid     (alu2_valid),
+        .alu_ready     (),
+        .alu_instbus   (proc_instbus2_p),
+        .alu_rs1_addr  (proc_rs1_addr[ALU2_IX*5+:5]),
+        .alu_rs1_val   (proc_rs1_val[ALU2_IX*XLEN+:XLEN]),
+        .alu_rs2_addr  (proc_rs2_addr[ALU2_IX*5+:5]),
+        .alu_rs2_val   (proc_rs2_val[ALU2_IX*XLEN+:XLEN]),
+        .alu_rd_wr     (proc_rd_wr[ALU2_IX]),
+        .alu_rd_addr   (proc_rd_addr[ALU2_IX*5+:5]),
+        .alu_rd_val    (proc_rd_val[ALU2_IX*XLEN+:XLEN]),
+        .alu_rd_strb   (proc_rd_strb[ALU2_IX*XLEN/8+:XLEN/8])
+    );
+
+    end else begin: NO_DUAL_ISSUE_ALU
+
+        assign alu2_valid = 1'b0;
+
+    end
+    endgenerate
+
+
     friscv_memfy
     #(
         .XLEN              (XLEN),
         .NB_INT_REG        (NB_INT_REG),
         .MAX_OR            (DATA_OSTDREQ_NUM),
+        .STORE_BUFFER_NB   (STORE_BUFFER_NB),
+        .CACHE_BLOCK_W     (CACHE_BLOCK_W),
+        .MISALIGNED_HW     (MISALIGNED_HW),
+        .A_EXTENSION       (A_EXTENSION),
         .AXI_ADDR_W        (AXI_ADDR_W),
         .AXI_ID_W          (AXI_ID_W),
         .AXI_DATA_W        (AXI_DATA_W),
@@ -374,6 +495,7 @@ module friscv_processing
         .arprot              (arprot),
         .arcache             (arcache),
         .arid                (arid),
+        .arpc                (arpc),
         .rvalid              (rvalid),
         .rready              (rready),
         .rid                 (rid),
@@ -387,7 +509,12 @@ module friscv_processing
 
     friscv_m_ext
     #(
-        .XLEN (XLEN)
+        .XLEN           (XLEN),
+        .DIV_RADIX      (DIV_RADIX),
+        .DIV_EARLY_TERM (DIV_EARLY_TERM),
+        .DIV_POW2       (DIV_POW2),
+        .MUL_LATENCY    (MUL_LATENCY),
+        .DIV_OSTD_NUM   (DIV_OSTD_NUM)
     )
     m_ext
     (
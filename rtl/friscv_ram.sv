@@ -8,6 +8,7 @@ module friscv_ram
 
     #(
         parameter INIT = 0,
+        parameter INIT_FILE = "",
         parameter ADDR_WIDTH = 8,
         parameter DATA_WIDTH = 8,
         parameter FFD_EN = 0
@@ -28,6 +29,9 @@ module friscv_ram
                 ram[i] = {DATA_WIDTH{1'b0}};
             end
         end
+        if (INIT_FILE != "") begin
+            $readmemh(INIT_FILE, ram);
+        end
     end
 
     always @ (posedge aclk) begin
@@ -8,6 +8,7 @@ module friscv_rambe
 
     #(
         parameter INIT = 0,
+        parameter INIT_FILE = "",
         parameter ADDR_WIDTH = 8,
         parameter DATA_WIDTH = 8,
         parameter FFD_EN = 0
@@ -29,6 +30,9 @@ module friscv_rambe
                 ram[i] = {DATA_WIDTH{1'b0}};
             end
         end
+        if (INIT_FILE != "") begin
+            $readmemh(INIT_FILE, ram);
+        end
     end
 
     always @ (posedge aclk) begin
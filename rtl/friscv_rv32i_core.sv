@@ -28,10 +28,19 @@ module friscv_rv32i_core
         parameter XLEN              = 32,
         // Boot address used by the control unit
         parameter BOOT_ADDR         = 0,
-        // Number of outstanding requests used by the control unit and icache
+        // Number of outstanding requests used by the icache, and depth of the
+        // fetch queue of the control unit
         parameter INST_OSTDREQ_NUM  = 8,
         // Number of outstanding requests used by the LOAD/STORE unit and dcache
         parameter DATA_OSTDREQ_NUM  = 8,
+        // Number of stores buffered by the LOAD/STORE unit, the loads not
+        // waiting anymore for the write completions (power of two, 0 to
+        // disable)
+        parameter STORE_BUFFER_NB   = 0,
+        // Serve the misaligned LOAD/STORE in hardware, an access crossing a
+        // word boundary being split in two requests, instead of raising an
+        // exception
+        parameter MISALIGNED_HW     = 0,
         // Core Hart ID
         parameter HART_ID           = 0,
         // RV32E architecture, limits integer registers to 16, else 32 available
@@ -40,6 +49,10 @@ module friscv_rv32i_core
         parameter F_EXTENSION       = 0,
         // Multiply/Divide extension support
         parameter M_EXTENSION       = 0,
+        // Atomic extension support (LR/SC and AMOs)
+        parameter A_EXTENSION       = 0,
+        // Compressed instructions extension support
+        parameter C_EXTENSION       = 0,
         // Support hypervisor mode
         parameter HYPERVISOR_MODE   = 0,
         // Support supervisor mode
@@ -51,6 +64,56 @@ module friscv_rv32i_core
         // Timeout applied for WFI 
         parameter WFI_TW = 100,
 
+        ////////////////////////////////////////////////////////////////////////
+        // Branch prediction
+        ////////////////////////////////////////////////////////////////////////
+
+        // Enable the dynamic branch predictor in the control unit
+        parameter BRANCH_PREDICTOR = 0,
+        // Number of entries in the branch history table (power of two)
+        parameter BHT_DEPTH = 64,
+        // Number of entries in the branch target buffer (power of two)
+        parameter BTB_DEPTH = 16,
+        // Number of entries in the return address stack (power of two, 0
+        // to disable)
+        parameter RAS_DEPTH = 4,
+
+        ////////////////////////////////////////////////////////////////////////
+        // Dual-issue
+        ////////////////////////////////////////////////////////////////////////
+
+        // Issue an ALU instruction along the current processing instruction,
+        // executed by a second ALU. Requires a fetch queue storing at least
+        // two instructions, sized with INST_OSTDREQ_NUM
+        parameter DUAL_ISSUE = 0,
+
+        ////////////////////////////////////////////////////////////////////////
+        // Macro-op fusion
+        ////////////////////////////////////////////////////////////////////////
+
+        // Execute as a single operation the common instruction pairs (LUI/AUIPC
+        // + ADDI, AUIPC + JALR, SLLI + SRLI, LUI + LOAD). Requires a fetch
+        // queue storing at least two instructions, sized with INST_OSTDREQ_NUM
+        parameter MACRO_FUSION = 0,
+
+        ////////////////////////////////////////////////////////////////////////
+        // Integer divider & multiplier
+        ////////////////////////////////////////////////////////////////////////
+
+        // Radix of the divider, 2 (1 bit per cycle) or 4 (2 bits per cycle)
+        parameter DIV_RADIX = 2,
+        // Skip the leading zeros of the dividend to terminate earlier
+        parameter DIV_EARLY_TERM = 0,
+        // Divide by a power of two in a single cycle
+        parameter DIV_POW2 = 0,
+        // Number of cycles to complete a multiplication, 1 for a
+        // combinational multiplier, more to pipeline it and reach a higher
+        // frequency
+        parameter MUL_LATENCY = 1,
+        // Number of divisions queued ahead of the divider, letting the next
+        // instructions issue while dividing (power of two, 0 to disable)
+        parameter DIV_OSTD_NUM = 0,
+
         ////////////////////////////////////////////////////////////////////////
         // Physical Memory Protection & Attributes
         // Virtual Memory
@@ -111,6 +174,9 @@ module friscv_rv32i_core
         // ID used by instruction and data buses
         parameter AXI_IMEM_MASK     = 'h10,
         parameter AXI_DMEM_MASK     = 'h20,
+        // Read the cache blocks with WRAP bursts starting on the word
+        // requested, else with INCR bursts starting on the block's first beat
+        parameter AXI_WRAP          = 0,
 
         ////////////////////////////////////////////////////////////////////////
         // Caches setup
@@ -126,6 +192,13 @@ module friscv_rv32i_core
         parameter ICACHE_BLOCK_W     = ILEN*4,
         // Number of blocks in the cache
         parameter ICACHE_DEPTH       = 512,
+        // Number of ways, 1 (direct-mapped), 2 or 4
+        parameter ICACHE_WAYS        = 1,
+        // Number of entries of the victim cache, 0 disables it
+        parameter ICACHE_VICTIM_NB   = 0,
+        // Complete a missing fetch with the block read, or with the beat
+        // holding its instruction, without replaying it
+        parameter ICACHE_EARLY_RESTART = 0,
 
         // Enable cache block prefetch
         parameter DCACHE_PREFETCH_EN = 0,
@@ -133,7 +206,44 @@ module friscv_rv32i_core
         // integer multiple of XLEN (power of two)
         parameter DCACHE_BLOCK_W     = XLEN*4,
         // Number of blocks in the cache
-        parameter DCACHE_DEPTH       = 512
+        parameter DCACHE_DEPTH       = 512,
+        // Number of ways, 1 (direct-mapped), 2 or 4
+        parameter DCACHE_WAYS        = 1,
+        // Write policy, 0 = write-through, 1 = write-back with write-allocate
+        parameter DCACHE_WRITE_BACK  = 0,
+        // Number of miss status holding registers, 0 blocks the loads on a miss
+        parameter DCACHE_MSHR_NUM    = 0,
+        // Number of entries of the stride prefetcher, indexed by the load PC,
+        // 0 disables it. A power of two
+        parameter DCACHE_STRIDE_TABLE = 0,
+        // Number of blocks prefetched ahead of an access
+        parameter DCACHE_PREFETCH_DEGREE = 1,
+        // Number of entries of the victim cache, 0 disables it
+        parameter DCACHE_VICTIM_NB   = 0,
+        // Complete a missing load with the block read, without replaying it.
+        // Without MSHR only
+        parameter DCACHE_EARLY_RESTART = 0,
+
+        ////////////////////////////////////////////////////////////////////////
+        // Tightly-coupled memories
+        ////////////////////////////////////////////////////////////////////////
+
+        // Enable the instruction TCM, serving the fetches in its range in
+        // front of the instruction cache
+        parameter ITCM_EN            = 0,
+        // Base address, aligned on the size, and size in bytes (power of two)
+        parameter ITCM_BASE          = 32'h0,
+        parameter ITCM_SIZE          = 16384,
+        // File loaded in the memory, one XLEN word per line
+        parameter ITCM_INIT_FILE     = "",
+        // Enable the data TCM, serving the LOAD/STORE in its range in
+        // front of the data cache
+        parameter DTCM_EN            = 0,
+        // Base address, aligned on the size, and size in bytes (power of two)
+        parameter DTCM_BASE          = 32'h10000,
+        parameter DTCM_SIZE          = 16384,
+        // File loaded in the memory, one XLEN word per line
+        parameter DTCM_INIT_FILE     = ""
     )(
         // Clock/reset interface
         input  wire                       aclk,
@@ -152,21 +262,29 @@ module friscv_rv32i_core
         output logic [AXI_ADDR_W    -1:0] imem_araddr,
         output logic [3             -1:0] imem_arprot,
         output logic [AXI_ID_W      -1:0] imem_arid,
+        output logic [8             -1:0] imem_arlen,
+        output logic [3             -1:0] imem_arsize,
+        output logic [2             -1:0] imem_arburst,
         input  wire                       imem_rvalid,
         output logic                      imem_rready,
         input  wire  [AXI_ID_W      -1:0] imem_rid,
         input  wire  [2             -1:0] imem_rresp,
         input  wire  [AXI_IMEM_W    -1:0] imem_rdata,
+        input  wire                       imem_rlast,
         // Data memory interface
         output logic                      dmem_awvalid,
         input  wire                       dmem_awready,
         output logic [AXI_ADDR_W    -1:0] dmem_awaddr,
         output logic [3             -1:0] dmem_awprot,
         output logic [AXI_ID_W      -1:0] dmem_awid,
+        output logic [8             -1:0] dmem_awlen,
+        output logic [3             -1:0] dmem_awsize,
+        output logic [2             -1:0] dmem_awburst,
         output logic                      dmem_wvalid,
         input  wire                       dmem_wready,
         output logic [AXI_DMEM_W    -1:0] dmem_wdata,
         output logic [AXI_DMEM_W/8  -1:0] dmem_wstrb,
+        output logic                      dmem_wlast,
         input  wire                       dmem_bvalid,
         output logic                      dmem_bready,
         input  wire  [AXI_ID_W      -1:0] dmem_bid,
@@ -176,11 +294,15 @@ module friscv_rv32i_core
         output logic [AXI_ADDR_W    -1:0] dmem_araddr,
         output logic [3             -1:0] dmem_arprot,
         output logic [AXI_ID_W      -1:0] dmem_arid,
+        output logic [8             -1:0] dmem_arlen,
+        output logic [3             -1:0] dmem_arsize,
+        output logic [2             -1:0] dmem_arburst,
         input  wire                       dmem_rvalid,
         output logic                      dmem_rready,
         input  wire  [AXI_ID_W      -1:0] dmem_rid,
         input  wire  [2             -1:0] dmem_rresp,
-        input  wire  [AXI_DMEM_W    -1:0] dmem_rdata
+        input  wire  [AXI_DMEM_W    -1:0] dmem_rdata,
+        input  wire                       dmem_rlast
     );
 
 
@@ -188,13 +310,16 @@ module friscv_rv32i_core
     // Parameters and signals
     //////////////////////////////////////////////////////////////////////////
 
-    localparam NB_ALU_UNIT = 2 + M_EXTENSION + F_EXTENSION;
+    localparam NB_ALU_UNIT = 2 + M_EXTENSION + F_EXTENSION + DUAL_ISSUE;
     localparam MAX_ALU_UNIT = 4;
 
     parameter PERF_REG_W  = 32;
     parameter PERF_NB_BUS = 3;
+    parameter PERF_NB_EVENT = `PERF_NB_EVENT;
 
     logic [PERF_NB_BUS*PERF_REG_W*3 -1:0] perfs;
+    logic [PERF_NB_EVENT            -1:0] events;
+    logic [PERF_NB_EVENT*PERF_REG_W -1:0] evt_perfs;
 
     logic [5                   -1:0] ctrl_rs1_addr;
     logic [XLEN                -1:0] ctrl_rs1_val;
@@ -224,6 +349,8 @@ module friscv_rv32i_core
     logic [`INST_BUS_W         -1:0] proc_instbus;
     logic                            proc_ready;
     logic                            proc_busy;
+    logic                            proc_wr_pending;
+    logic [32                  -1:0] proc_regs_sts;
     logic [4                   -1:0] proc_fenceinfo;
     logic [`PROC_EXP_W         -1:0] proc_exceptions;
 
@@ -242,6 +369,17 @@ module friscv_rv32i_core
     logic [2                   -1:0] inst_rresp_s;
     logic [ILEN                -1:0] inst_rdata_s;
 
+    logic                            inst_arvalid_c;
+    logic                            inst_arready_c;
+    logic [AXI_ADDR_W          -1:0] inst_araddr_c;
+    logic [3                   -1:0] inst_arprot_c;
+    logic [AXI_ID_W            -1:0] inst_arid_c;
+    logic                            inst_rvalid_c;
+    logic                            inst_rready_c;
+    logic [AXI_ID_W            -1:0] inst_rid_c;
+    logic [2                   -1:0] inst_rresp_c;
+    logic [ILEN                -1:0] inst_rdata_c;
+
     logic                            memfy_awvalid;
     logic                            memfy_awready;
     logic [AXI_ADDR_W          -1:0] memfy_awaddr;
@@ -262,20 +400,64 @@ module friscv_rv32i_core
     logic [3                   -1:0] memfy_arprot;
     logic [4                   -1:0] memfy_arcache;
     logic [AXI_ID_W            -1:0] memfy_arid;
+    logic [XLEN                -1:0] memfy_arpc;
     logic                            memfy_rvalid;
     logic                            memfy_rready;
     logic [AXI_ID_W            -1:0] memfy_rid;
     logic [2                   -1:0] memfy_rresp;
     logic [XLEN                -1:0] memfy_rdata;
 
+    logic                            memfy_awvalid_c;
+    logic                            memfy_awready_c;
+    logic [AXI_ADDR_W          -1:0] memfy_awaddr_c;
+    logic [3                   -1:0] memfy_awprot_c;
+    logic [4                   -1:0] memfy_awcache_c;
+    logic [AXI_ID_W            -1:0] memfy_awid_c;
+    logic                            memfy_wvalid_c;
+    logic                            memfy_wready_c;
+    logic [XLEN                -1:0] memfy_wdata_c;
+    logic [XLEN/8              -1:0] memfy_wstrb_c;
+    logic                            memfy_bvalid_c;
+    logic                            memfy_bready_c;
+    logic [AXI_ID_W            -1:0] memfy_bid_c;
+    logic [2                   -1:0] memfy_bresp_c;
+    logic                            memfy_arvalid_c;
+    logic                            memfy_arready_c;
+    logic [AXI_ADDR_W          -1:0] memfy_araddr_c;
+    logic [3                   -1:0] memfy_arprot_c;
+    logic [4                   -1:0] memfy_arcache_c;
+    logic [AXI_ID_W            -1:0] memfy_arid_c;
+    logic                            memfy_rvalid_c;
+    logic                            memfy_rready_c;
+    logic [AXI_ID_W            -1:0] memfy_rid_c;
+    logic [2                   -1:0] memfy_rresp_c;
+    logic [XLEN                -1:0] memfy_rdata_c;
+
     logic                            flush_reqs;
     logic                            flush_blocks;
     logic                            flush_ack;
+    logic                            clean_blocks;
+    logic                            clean_ack;
     logic                            icache_ready;
     logic                            dcache_ready;
+    logic [4                   -1:0] icache_hits;
+    logic                            icache_miss;
+    logic                            icache_vc_hit;
+    logic [4                   -1:0] dcache_hits;
+    logic                            dcache_miss;
+    logic                            dcache_pf_issue;
+    logic                            dcache_pf_useful;
+    logic                            dcache_vc_hit;
 
     logic [5                   -1:0] ctrl_status;
 
+    logic                            bpred_hit;
+    logic                            bpred_miss;
+    logic                            dual_issued;
+    logic                            fused_pair;
+    logic                            proc_dual;
+    logic [`INST_BUS_W         -1:0] proc_instbus2;
+
     logic [`CSR_SB_W           -1:0] csr_sb;
     logic [`CTRL_SB_W          -1:0] ctrl_sb;
 
@@ -302,17 +484,23 @@ module friscv_rv32i_core
         `CHECKER((RV32E!=0 && RV32E!=1),
             "RV32E can be only equal to 0 or 1");
 
+        `CHECKER((A_EXTENSION!=0 && A_EXTENSION!=1),
+            "A_EXTENSION can be only equal to 0 or 1");
+
         `CHECKER((CACHE_EN==0 && AXI_IMEM_W != XLEN),
             "If cache is disable, AXI_IMEM_W must be XLEN");
 
         `CHECKER((CACHE_EN==0 && AXI_DMEM_W != XLEN),
             "If cache is disable, AXI_DMEM_W must be XLEN");
 
-        `CHECKER((CACHE_EN==1 && AXI_IMEM_W != ICACHE_BLOCK_W),
-           "Only AXI_IMEM_W = ICACHE_BLOCK_W is supported for the moment");
+        `CHECKER((CACHE_EN==1 && (AXI_IMEM_W < ILEN || ICACHE_BLOCK_W % AXI_IMEM_W != 0)),
+           "ICACHE_BLOCK_W must be a multiple of AXI_IMEM_W, itself at least ILEN");
+
+        `CHECKER((CACHE_EN==1 && (AXI_DMEM_W < XLEN || DCACHE_BLOCK_W % AXI_DMEM_W != 0)),
+            "DCACHE_BLOCK_W must be a multiple of AXI_DMEM_W, itself at least XLEN");
 
-        `CHECKER((CACHE_EN==1 && AXI_DMEM_W != DCACHE_BLOCK_W),
-            "Only AXI_DMEM_W = DCACHE_BLOCK_W is supported for the moment");
+        `CHECKER((CACHE_EN==1 && AXI_WRAP && (ICACHE_BLOCK_W/AXI_IMEM_W>16 || DCACHE_BLOCK_W/AXI_DMEM_W>16)),
+            "AXI_WRAP supports up to 16 beats per cache block");
 
         `CHECKER((CACHE_EN==1 && (ICACHE_BLOCK_W/ILEN)!=4),
             "Only a ratio = 4 between instruction bus and cache block width is supported");
@@ -320,6 +508,33 @@ module friscv_rv32i_core
         `CHECKER((CACHE_EN==1 && (DCACHE_BLOCK_W/XLEN)!=4),
             "Only a ratio = 4 between data bus and cache block width is supported");
 
+        `CHECKER((CACHE_EN==1 && ICACHE_WAYS!=1 && ICACHE_WAYS!=2 && ICACHE_WAYS!=4),
+            "ICACHE_WAYS can be only equal to 1, 2 or 4");
+
+        `CHECKER((CACHE_EN==1 && DCACHE_WAYS!=1 && DCACHE_WAYS!=2 && DCACHE_WAYS!=4),
+            "DCACHE_WAYS can be only equal to 1, 2 or 4");
+
+        `CHECKER((CACHE_EN==1 && DCACHE_MSHR_NUM > DATA_OSTDREQ_NUM),
+            "DCACHE_MSHR_NUM can't be greater than DATA_OSTDREQ_NUM");
+
+        `CHECKER((CACHE_EN==1 && (DCACHE_STRIDE_TABLE & (DCACHE_STRIDE_TABLE-1))!=0),
+            "DCACHE_STRIDE_TABLE must be 0 or a power of two");
+
+        `CHECKER((CACHE_EN==1 && DCACHE_PREFETCH_DEGREE < 1),
+            "DCACHE_PREFETCH_DEGREE must be greater than 0");
+
+        `CHECKER((CACHE_EN==1 && ICACHE_VICTIM_NB > 16),
+            "ICACHE_VICTIM_NB can't be greater than 16");
+
+        `CHECKER((CACHE_EN==1 && DCACHE_VICTIM_NB > 16),
+            "DCACHE_VICTIM_NB can't be greater than 16");
+
+        `CHECKER(((STORE_BUFFER_NB & (STORE_BUFFER_NB-1))!=0),
+            "STORE_BUFFER_NB must be 0 or a power of two");
+
+        `CHECKER((STORE_BUFFER_NB > DATA_OSTDREQ_NUM),
+            "STORE_BUFFER_NB can't be greater than DATA_OSTDREQ_NUM");
+
         `CHECKER((NB_PMP_REGION > MAX_PMP_REGION),
             "Wrong PMP configuration, NB_PMP_REGION > MAX_PMP_REGION");
 
@@ -337,6 +552,45 @@ module friscv_rv32i_core
 
         `CHECKER((MMU_SUPPORT),
             "MMU not supported");
+
+        `CHECKER((BRANCH_PREDICTOR && (BHT_DEPTH & (BHT_DEPTH-1))!=0),
+            "BHT_DEPTH must be a power of two");
+
+        `CHECKER((BRANCH_PREDICTOR && (BTB_DEPTH & (BTB_DEPTH-1))!=0),
+            "BTB_DEPTH must be a power of two");
+
+        `CHECKER((BRANCH_PREDICTOR && (RAS_DEPTH==1 || (RAS_DEPTH & (RAS_DEPTH-1))!=0)),
+            "RAS_DEPTH must be 0 or a power of two greater than 1");
+
+        `CHECKER(((INST_OSTDREQ_NUM & (INST_OSTDREQ_NUM-1))!=0),
+            "INST_OSTDREQ_NUM must be 0 or a power of two");
+
+        `CHECKER((DUAL_ISSUE && (INST_OSTDREQ_NUM<2 || (INST_OSTDREQ_NUM & (INST_OSTDREQ_NUM-1))!=0)),
+            "DUAL_ISSUE requires INST_OSTDREQ_NUM to be a power of two greater than 1");
+
+        `CHECKER((MACRO_FUSION && INST_OSTDREQ_NUM<2),
+            "MACRO_FUSION requires INST_OSTDREQ_NUM to be greater than 1");
+
+        `CHECKER((DIV_RADIX!=2 && DIV_RADIX!=4),
+            "DIV_RADIX must be 2 or 4");
+
+        `CHECKER((MUL_LATENCY<1),
+            "MUL_LATENCY must be greater than 0");
+
+        `CHECKER(((DIV_OSTD_NUM & (DIV_OSTD_NUM-1))!=0),
+            "DIV_OSTD_NUM must be 0 or a power of two");
+
+        `CHECKER((ITCM_EN && (ITCM_SIZE<XLEN/8 || (ITCM_SIZE & (ITCM_SIZE-1))!=0)),
+            "ITCM_SIZE must be a power of two, at least XLEN/8");
+
+        `CHECKER((ITCM_EN && (ITCM_BASE & (ITCM_SIZE-1))!=0),
+            "ITCM_BASE must be aligned on ITCM_SIZE");
+
+        `CHECKER((DTCM_EN && (DTCM_SIZE<XLEN/8 || (DTCM_SIZE & (DTCM_SIZE-1))!=0)),
+            "DTCM_SIZE must be a power of two, at least XLEN/8");
+
+        `CHECKER((DTCM_EN && (DTCM_BASE & (DTCM_SIZE-1))!=0),
+            "DTCM_BASE must be aligned on DTCM_SIZE");
     end
 
     //////////////////////////////////////////////////////////////////////////
@@ -432,11 +686,18 @@ module friscv_rv32i_core
         .AXI_ID_W        (AXI_ID_W),
         .AXI_ID_MASK     (AXI_IMEM_MASK),
         .AXI_DATA_W      (XLEN),
-        // No OR in control, so no internal FIFO, reducing latency
-        .OSTDREQ_NUM     (0),
-        // .OSTDREQ_NUM    (INST_OSTDREQ_NUM),
+        // Depth of the fetch queue, bypassed when empty
+        .OSTDREQ_NUM     (INST_OSTDREQ_NUM),
         .BOOT_ADDR       (BOOT_ADDR),
-        .WFI_TW          (WFI_TW)
+        .WFI_TW          (WFI_TW),
+        .BRANCH_PREDICTOR (BRANCH_PREDICTOR),
+        .BHT_DEPTH       (BHT_DEPTH),
+        .BTB_DEPTH       (BTB_DEPTH),
+        .RAS_DEPTH       (RAS_DEPTH),
+        .DUAL_ISSUE      (DUAL_ISSUE),
+        .MACRO_FUSION    (MACRO_FUSION),
+        .C_EXTENSION     (C_EXTENSION),
+        .A_EXTENSION     (A_EXTENSION)
     )
     control
     (
@@ -449,6 +710,8 @@ module friscv_rv32i_core
         .flush_reqs         (flush_reqs),
         .flush_blocks       (flush_blocks),
         .flush_ack          (flush_ack),
+        .clean_blocks       (clean_blocks),
+        .clean_ack          (clean_ack),
         .arvalid            (inst_arvalid_s),
         .arready            (inst_arready_s),
         .araddr             (inst_araddr_s),
@@ -464,7 +727,11 @@ module friscv_rv32i_core
         .proc_fenceinfo     (proc_fenceinfo),
         .proc_exceptions    (proc_exceptions),
         .proc_instbus       (proc_instbus),
+        .proc_dual          (proc_dual),
+        .proc_instbus2      (proc_instbus2),
         .proc_busy          (proc_busy),
+        .proc_wr_pending    (proc_wr_pending),
+        .proc_regs_sts      (proc_regs_sts),
         .csr_en             (csr_en),
         .csr_ready          (csr_ready),
         .csr_instbus        (csr_instbus),
@@ -478,10 +745,106 @@ module friscv_rv32i_core
         .mpu_addr           (mpu_imem_addr),
         .mpu_allow          (mpu_imem_allow),
         .csr_sb             (csr_sb),
-        .ctrl_sb            (ctrl_sb)
+        .ctrl_sb            (ctrl_sb),
+        .bpred_hit          (bpred_hit),
+        .bpred_miss         (bpred_miss),
+        .dual_issued        (dual_issued),
+        .fused_pair         (fused_pair)
     );
 
 
+    //////////////////////////////////////////////////////////////////////////
+    // Instruction TCM, serving the fetches in its range ahead the cache
+    //////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (ITCM_EN) begin : USE_ITCM
+
+    friscv_tcm
+    #(
+        .XLEN        (XLEN),
+        .AXI_ADDR_W  (AXI_ADDR_W),
+        .AXI_ID_W    (AXI_ID_W),
+        .TCM_BASE    (ITCM_BASE),
+        .TCM_SIZE    (ITCM_SIZE),
+        .INIT_FILE   (ITCM_INIT_FILE)
+    )
+    itcm
+    (
+        .aclk        (aclk),
+        .aresetn     (aresetn),
+        .srst        (srst),
+        // The instruction cache drops the fetches it accepted on a flush
+        .flush       ((CACHE_EN) ? flush_reqs : 1'b0),
+        .s_awvalid   (1'b0),
+        .s_awready   (),
+        .s_awaddr    ({AXI_ADDR_W{1'b0}}),
+        .s_awprot    (3'b0),
+        .s_awcache   (4'b0),
+        .s_awid      ({AXI_ID_W{1'b0}}),
+        .s_wvalid    (1'b0),
+        .s_wready    (),
+        .s_wdata     ({XLEN{1'b0}}),
+        .s_wstrb     ({XLEN/8{1'b0}}),
+        .s_bvalid    (),
+        .s_bready    (1'b1),
+        .s_bid       (),
+        .s_bresp     (),
+        .s_arvalid   (inst_arvalid_s),
+        .s_arready   (inst_arready_s),
+        .s_araddr    (inst_araddr_s),
+        .s_arprot    (inst_arprot_s),
+        .s_arcache   (4'b0),
+        .s_arid      (inst_arid_s),
+        .s_rvalid    (inst_rvalid_s),
+        .s_rready    (inst_rready_s),
+        .s_rid       (inst_rid_s),
+        .s_rresp     (inst_rresp_s),
+        .s_rdata     (inst_rdata_s),
+        .m_awvalid   (),
+        .m_awready   (1'b1),
+        .m_awaddr    (),
+        .m_awprot    (),
+        .m_awcache   (),
+        .m_awid      (),
+        .m_wvalid    (),
+        .m_wready    (1'b1),
+        .m_wdata     (),
+        .m_wstrb     (),
+        .m_bvalid    (1'b0),
+        .m_bready    (),
+        .m_bid       ({AXI_ID_W{1'b0}}),
+        .m_bresp     (2'b0),
+        .m_arvalid   (inst_arvalid_c),
+        .m_arready   (inst_arready_c),
+        .m_araddr    (inst_araddr_c),
+        .m_arprot    (inst_arprot_c),
+        .m_arcache   (),
+        .m_arid      (inst_arid_c),
+        .m_rvalid    (inst_rvalid_c),
+        .m_rready    (inst_rready_c),
+        .m_rid       (inst_rid_c),
+        .m_rresp     (inst_rresp_c),
+        .m_rdata     (inst_rdata_c)
+    );
+
+    end else begin : NO_ITCM
+
+    assign inst_arvalid_c = inst_arvalid_s;
+    assign inst_arready_s = inst_arready_c;
+    assign inst_araddr_c = inst_araddr_s;
+    assign inst_arprot_c = inst_arprot_s;
+    assign inst_arid_c = inst_arid_s;
+    assign inst_rvalid_s = inst_rvalid_c;
+    assign inst_rready_c = inst_rready_s;
+    assign inst_rid_s = inst_rid_c;
+    assign inst_rresp_s = inst_rresp_c;
+    assign inst_rdata_s = inst_rdata_c;
+
+    end
+    endgenerate
+
+
     //////////////////////////////////////////////////////////////////////////
     // Instruction cache stage
     //////////////////////////////////////////////////////////////////////////
@@ -498,9 +861,13 @@ module friscv_rv32i_core
         .AXI_ID_W          (AXI_ID_W),
         .AXI_ID_MASK       (AXI_IMEM_MASK),
         .AXI_DATA_W        (AXI_IMEM_W),
+        .AXI_WRAP          (AXI_WRAP),
         .CACHE_PREFETCH_EN (ICACHE_PREFETCH_EN),
         .CACHE_BLOCK_W     (ICACHE_BLOCK_W),
-        .CACHE_DEPTH       (ICACHE_DEPTH)
+        .CACHE_DEPTH       (ICACHE_DEPTH),
+        .CACHE_WAYS        (ICACHE_WAYS),
+        .VICTIM_NB         (ICACHE_VICTIM_NB),
+        .EARLY_RESTART     (ICACHE_EARLY_RESTART)
     )
     icache
     (
@@ -511,22 +878,22 @@ module friscv_rv32i_core
         .flush_reqs        (flush_reqs),
         .flush_blocks      (flush_blocks),
         .flush_ack         (flush_ack),
-        .ctrl_arvalid      (inst_arvalid_s),
-        .ctrl_arready      (inst_arready_s),
-        .ctrl_araddr       (inst_araddr_s),
-        .ctrl_arprot       (inst_arprot_s),
-        .ctrl_arid         (inst_arid_s),
-        .ctrl_rvalid       (inst_rvalid_s),
-        .ctrl_rready       (inst_rready_s),
-        .ctrl_rid          (inst_rid_s),
-        .ctrl_rresp        (inst_rresp_s),
-        .ctrl_rdata        (inst_rdata_s),
+        .ctrl_arvalid      (inst_arvalid_c),
+        .ctrl_arready      (inst_arready_c),
+        .ctrl_araddr       (inst_araddr_c),
+        .ctrl_arprot       (inst_arprot_c),
+        .ctrl_arid         (inst_arid_c),
+        .ctrl_rvalid       (inst_rvalid_c),
+        .ctrl_rready       (inst_rready_c),
+        .ctrl_rid          (inst_rid_c),
+        .ctrl_rresp        (inst_rresp_c),
+        .ctrl_rdata        (inst_rdata_c),
         .icache_arvalid    (imem_arvalid),
         .icache_arready    (imem_arready),
         .icache_araddr     (imem_araddr),
-        .icache_arlen      (),
-        .icache_arsize     (),
-        .icache_arburst    (),
+        .icache_arlen      (imem_arlen),
+        .icache_arsize     (imem_arsize),
+        .icache_arburst    (imem_arburst),
         .icache_arlock     (),
         .icache_arcache    (),
         .icache_arqos      (),
@@ -538,22 +905,32 @@ module friscv_rv32i_core
         .icache_rid        (imem_rid),
         .icache_rresp      (imem_rresp),
         .icache_rdata      (imem_rdata),
-        .icache_rlast      (1'b1)
+        .icache_rlast      (imem_rlast),
+        .perf_hits         (icache_hits[ICACHE_WAYS-1:0]),
+        .perf_miss         (icache_miss),
+        .perf_victim_hit   (icache_vc_hit)
     );
 
+    if (ICACHE_WAYS<4) begin : ICACHE_HITS_PAD
+        assign icache_hits[3:ICACHE_WAYS] = '0;
+    end
+
     end else begin : NO_ICACHE
 
     // Connect controller directly to top interface
-    assign imem_arvalid = inst_arvalid_s;
-    assign inst_arready_s = imem_arready;
-    assign imem_araddr = inst_araddr_s;
-    assign imem_arprot = inst_arprot_s;
-    assign imem_arid = inst_arid_s;
-    assign inst_rvalid_s = imem_rvalid;
-    assign imem_rready = inst_rready_s;
-    assign inst_rid_s = imem_rid;
-    assign inst_rresp_s = imem_rresp;
-    assign inst_rdata_s = imem_rdata;
+    assign imem_arvalid = inst_arvalid_c;
+    assign inst_arready_c = imem_arready;
+    assign imem_araddr = inst_araddr_c;
+    assign imem_arprot = inst_arprot_c;
+    assign imem_arid = inst_arid_c;
+    assign imem_arlen = 8'b0;
+    assign imem_arsize = (XLEN==64) ? 3'b011 : 3'b010;
+    assign imem_arburst = 2'b01;
+    assign inst_rvalid_c = imem_rvalid;
+    assign imem_rready = inst_rready_c;
+    assign inst_rid_c = imem_rid;
+    assign inst_rresp_c = imem_rresp;
+    assign inst_rdata_c = imem_rdata;
 
     // Always assert ack if requesting a cache flush to avoid deadlock
     assign flush_ack = 1'b1;
@@ -561,6 +938,10 @@ module friscv_rv32i_core
     // Cache readiness, used to inform the internal init is over
     assign icache_ready = 1'b1;
 
+    assign icache_hits = 4'b0;
+    assign icache_miss = 1'b0;
+    assign icache_vc_hit = 1'b0;
+
     end
     endgenerate
 
@@ -573,11 +954,14 @@ module friscv_rv32i_core
     #(
         .PERF_REG_W      (PERF_REG_W),
         .PERF_NB_BUS     (PERF_NB_BUS),
+        .PERF_NB_EVENT   (PERF_NB_EVENT),
         .RV32E           (RV32E),
         .HART_ID         (HART_ID),
         .XLEN            (XLEN),
         .F_EXTENSION     (F_EXTENSION),
         .M_EXTENSION     (M_EXTENSION),
+        .A_EXTENSION     (A_EXTENSION),
+        .C_EXTENSION     (C_EXTENSION),
         .HYPERVISOR_MODE (HYPERVISOR_MODE),
         .SUPERVISOR_MODE (SUPERVISOR_MODE),
         .USER_MODE       (USER_MODE),
@@ -624,6 +1008,7 @@ module friscv_rv32i_core
         .rd_wr_addr      (csr_rd_addr),
         .rd_wr_val       (csr_rd_val),
         .perfs           (perfs),
+        .evt_perfs       (evt_perfs),
         .csr_sb          (csr_sb),
         .ctrl_sb         (ctrl_sb)
     );
@@ -647,6 +1032,33 @@ module friscv_rv32i_core
         .perfs   (perfs)
     );
 
+    assign events[`EVT_BPRED_HIT] = bpred_hit;
+    assign events[`EVT_BPRED_MISS] = bpred_miss;
+    assign events[`EVT_DUAL_ISSUE] = dual_issued;
+    assign events[`EVT_FUSED_PAIR] = fused_pair;
+    assign events[`EVT_IC_MISS] = icache_miss;
+    assign events[`EVT_IC_HIT+:4] = icache_hits;
+    assign events[`EVT_DC_MISS] = dcache_miss;
+    assign events[`EVT_DC_HIT+:4] = dcache_hits;
+    assign events[`EVT_DC_PF_ISSUE] = dcache_pf_issue;
+    assign events[`EVT_DC_PF_USEFUL] = dcache_pf_useful;
+    assign events[`EVT_IC_VC_HIT] = icache_vc_hit;
+    assign events[`EVT_DC_VC_HIT] = dcache_vc_hit;
+
+    friscv_event_perf
+    #(
+        .REG_W    (PERF_REG_W),
+        .NB_EVENT (PERF_NB_EVENT)
+    )
+    event_perf
+    (
+        .aclk    (aclk),
+        .aresetn (aresetn),
+        .srst    (srst),
+        .events  (events),
+        .perfs   (evt_perfs)
+    );
+
     ///////////////////////////////////////
     // MPU, PMP + PMA CSRs
     ///////////////////////////////////////
@@ -686,6 +1098,7 @@ module friscv_rv32i_core
         .XLEN              (XLEN),
         .F_EXTENSION       (F_EXTENSION),
         .M_EXTENSION       (M_EXTENSION),
+        .A_EXTENSION       (A_EXTENSION),
         .RV32E             (RV32E),
         .AXI_ADDR_W        (AXI_ADDR_W),
         .AXI_ID_W          (AXI_ID_W),
@@ -694,7 +1107,16 @@ module friscv_rv32i_core
         .NB_UNIT           (NB_ALU_UNIT),
         .MAX_UNIT          (MAX_ALU_UNIT),
         .DATA_OSTDREQ_NUM  (DATA_OSTDREQ_NUM),
+        .STORE_BUFFER_NB   (STORE_BUFFER_NB),
+        .CACHE_BLOCK_W     ((CACHE_EN) ? DCACHE_BLOCK_W : XLEN),
+        .MISALIGNED_HW     (MISALIGNED_HW),
         .INST_BUS_PIPELINE (PROCESSING_BUS_PIPELINE),
+        .DUAL_ISSUE        (DUAL_ISSUE),
+        .DIV_RADIX         (DIV_RADIX),
+        .DIV_EARLY_TERM    (DIV_EARLY_TERM),
+        .DIV_POW2          (DIV_POW2),
+        .MUL_LATENCY       (MUL_LATENCY),
+        .DIV_OSTD_NUM      (DIV_OSTD_NUM),
         .HYPERVISOR_MODE   (HYPERVISOR_MODE),
         .SUPERVISOR_MODE   (SUPERVISOR_MODE),
         .MPU_SUPPORT       (MPU_SUPPORT),
@@ -712,7 +1134,11 @@ module friscv_rv32i_core
         .proc_fenceinfo     (proc_fenceinfo),
         .proc_exceptions    (proc_exceptions),
         .proc_instbus       (proc_instbus),
+        .proc_dual          (proc_dual),
+        .proc_instbus2      (proc_instbus2),
         .proc_busy          (proc_busy),
+        .proc_wr_pending    (proc_wr_pending),
+        .proc_regs_sts      (proc_regs_sts),
         .proc_rs1_addr      (proc_rs1_addr),
         .proc_rs1_val       (proc_rs1_val),
         .proc_rs2_addr      (proc_rs2_addr),
@@ -743,6 +1169,7 @@ module friscv_rv32i_core
         .arprot             (memfy_arprot),
         .arcache            (memfy_arcache),
         .arid               (memfy_arid),
+        .arpc               (memfy_arpc),
         .rvalid             (memfy_rvalid),
         .rready             (memfy_rready),
         .rid                (memfy_rid),
@@ -750,6 +1177,116 @@ module friscv_rv32i_core
         .rdata              (memfy_rdata)
     );
 
+    //////////////////////////////////////////////////////////////////////////
+    // Data TCM, serving the LOAD/STORE in its range ahead the cache
+    //////////////////////////////////////////////////////////////////////////
+
+    generate
+
+    if (DTCM_EN) begin: USE_DTCM
+
+        friscv_tcm
+        #(
+            .XLEN        (XLEN),
+            .AXI_ADDR_W  (AXI_ADDR_W),
+            .AXI_ID_W    (AXI_ID_W),
+            .TCM_BASE    (DTCM_BASE),
+            .TCM_SIZE    (DTCM_SIZE),
+            .INIT_FILE   (DTCM_INIT_FILE)
+        )
+        dtcm
+        (
+            .aclk        (aclk),
+            .aresetn     (aresetn),
+            .srst        (srst),
+            .flush       (1'b0),
+            .s_awvalid   (memfy_awvalid),
+            .s_awready   (memfy_awready),
+            .s_awaddr    (memfy_awaddr),
+            .s_awprot    (memfy_awprot),
+            .s_awcache   (memfy_awcache),
+            .s_awid      (memfy_awid),
+            .s_wvalid    (memfy_wvalid),
+            .s_wready    (memfy_wready),
+            .s_wdata     (memfy_wdata),
+            .s_wstrb     (memfy_wstrb),
+            .s_bvalid    (memfy_bvalid),
+            .s_bready    (memfy_bready),
+            .s_bid       (memfy_bid),
+            .s_bresp     (memfy_bresp),
+            .s_arvalid   (memfy_arvalid),
+            .s_arready   (memfy_arready),
+            .s_araddr    (memfy_araddr),
+            .s_arprot    (memfy_arprot),
+            .s_arcache   (memfy_arcache),
+            .s_arid      (memfy_arid),
+            .s_rvalid    (memfy_rvalid),
+            .s_rready    (memfy_rready),
+            .s_rid       (memfy_rid),
+            .s_rresp     (memfy_rresp),
+            .s_rdata     (memfy_rdata),
+            .m_awvalid   (memfy_awvalid_c),
+            .m_awready   (memfy_awready_c),
+            .m_awaddr    (memfy_awaddr_c),
+            .m_awprot    (memfy_awprot_c),
+            .m_awcache   (memfy_awcache_c),
+            .m_awid      (memfy_awid_c),
+            .m_wvalid    (memfy_wvalid_c),
+            .m_wready    (memfy_wready_c),
+            .m_wdata     (memfy_wdata_c),
+            .m_wstrb     (memfy_wstrb_c),
+            .m_bvalid    (memfy_bvalid_c),
+            .m_bready    (memfy_bready_c),
+            .m_bid       (memfy_bid_c),
+            .m_bresp     (memfy_bresp_c),
+            .m_arvalid   (memfy_arvalid_c),
+            .m_arready   (memfy_arready_c),
+            .m_araddr    (memfy_araddr_c),
+            .m_arprot    (memfy_arprot_c),
+            .m_arcache   (memfy_arcache_c),
+            .m_arid      (memfy_arid_c),
+            .m_rvalid    (memfy_rvalid_c),
+            .m_rready    (memfy_rready_c),
+            .m_rid       (memfy_rid_c),
+            .m_rresp     (memfy_rresp_c),
+            .m_rdata     (memfy_rdata_c)
+        );
+
+    end else begin: NO_DTCM
+
+        assign memfy_awvalid_c = memfy_awvalid;
+        assign memfy_awready = memfy_awready_c;
+        assign memfy_awaddr_c = memfy_awaddr;
+        assign memfy_awprot_c = memfy_awprot;
+        assign memfy_awcache_c = memfy_awcache;
+        assign memfy_awid_c = memfy_awid;
+
+        assign memfy_wvalid_c = memfy_wvalid;
+        assign memfy_wready = memfy_wready_c;
+        assign memfy_wdata_c = memfy_wdata;
+        assign memfy_wstrb_c = memfy_wstrb;
+
+        assign memfy_bvalid = memfy_bvalid_c;
+        assign memfy_bready_c = memfy_bready;
+        assign memfy_bid = memfy_bid_c;
+        assign memfy_bresp = memfy_bresp_c;
+
+        assign memfy_arvalid_c = memfy_arvalid;
+        assign memfy_arready = memfy_arready_c;
+        assign memfy_araddr_c = memfy_araddr;
+        assign memfy_arprot_c = memfy_arprot;
+        assign memfy_arcache_c = memfy_arcache;
+        assign memfy_arid_c = memfy_arid;
+
+        assign memfy_rvalid = memfy_rvalid_c;
+        assign memfy_rready_c = memfy_rready;
+        assign memfy_rid = memfy_rid_c;
+        assign memfy_rresp = memfy_rresp_c;
+        assign memfy_rdata = memfy_rdata_c;
+
+    end
+    endgenerate
+
     //////////////////////////////////////////////////////////////////////////
     // Data cache stage
     //////////////////////////////////////////////////////////////////////////
@@ -767,10 +1304,18 @@ module friscv_rv32i_core
             .AXI_ID_W          (AXI_ID_W),
             .AXI_DATA_W        (AXI_DMEM_W),
             .AXI_ID_MASK       (AXI_DMEM_MASK),
+            .AXI_WRAP          (AXI_WRAP),
             .IO_MAP_NB         (IO_MAP_NB),
             .CACHE_PREFETCH_EN (DCACHE_PREFETCH_EN),
             .CACHE_BLOCK_W     (DCACHE_BLOCK_W),
-            .CACHE_DEPTH       (DCACHE_DEPTH)
+            .CACHE_DEPTH       (DCACHE_DEPTH),
+            .CACHE_WAYS        (DCACHE_WAYS),
+            .WRITE_BACK        (DCACHE_WRITE_BACK),
+            .MSHR_NUM          (DCACHE_MSHR_NUM),
+            .STRIDE_TABLE      (DCACHE_STRIDE_TABLE),
+            .PREFETCH_DEGREE   (DCACHE_PREFETCH_DEGREE),
+            .VICTIM_NB         (DCACHE_VICTIM_NB),
+            .EARLY_RESTART     (DCACHE_EARLY_RESTART)
         )
         dcache
         (
@@ -778,37 +1323,40 @@ module friscv_rv32i_core
             .aresetn         (aresetn),
             .srst            (srst),
             .cache_ready     (dcache_ready),
-            .memfy_awvalid   (memfy_awvalid),
-            .memfy_awready   (memfy_awready),
-            .memfy_awaddr    (memfy_awaddr),
-            .memfy_awprot    (memfy_awprot),
-            .memfy_awcache   (memfy_awcache),
-            .memfy_awid      (memfy_awid),
-            .memfy_wvalid    (memfy_wvalid),
-            .memfy_wready    (memfy_wready),
-            .memfy_wdata     (memfy_wdata),
-            .memfy_wstrb     (memfy_wstrb),
-            .memfy_bvalid    (memfy_bvalid),
-            .memfy_bready    (memfy_bready),
-            .memfy_bid       (memfy_bid),
-            .memfy_bresp     (memfy_bresp),
-            .memfy_arvalid   (memfy_arvalid),
-            .memfy_arready   (memfy_arready),
-            .memfy_araddr    (memfy_araddr),
-            .memfy_arprot    (memfy_arprot),
-            .memfy_arcache   (memfy_arcache),
-            .memfy_arid      (memfy_arid),
-            .memfy_rvalid    (memfy_rvalid),
-            .memfy_rready    (memfy_rready),
-            .memfy_rid       (memfy_rid),
-            .memfy_rresp     (memfy_rresp),
-            .memfy_rdata     (memfy_rdata),
+            .clean_blocks    (clean_blocks),
+            .clean_ack       (clean_ack),
+            .memfy_awvalid   (memfy_awvalid_c),
+            .memfy_awready   (memfy_awready_c),
+            .memfy_awaddr    (memfy_awaddr_c),
+            .memfy_awprot    (memfy_awprot_c),
+            .memfy_awcache   (memfy_awcache_c),
+            .memfy_awid      (memfy_awid_c),
+            .memfy_wvalid    (memfy_wvalid_c),
+            .memfy_wready    (memfy_wready_c),
+            .memfy_wdata     (memfy_wdata_c),
+            .memfy_wstrb     (memfy_wstrb_c),
+            .memfy_bvalid    (memfy_bvalid_c),
+            .memfy_bready    (memfy_bready_c),
+            .memfy_bid       (memfy_bid_c),
+            .memfy_bresp     (memfy_bresp_c),
+            .memfy_arvalid   (memfy_arvalid_c),
+            .memfy_arready   (memfy_arready_c),
+            .memfy_araddr    (memfy_araddr_c),
+            .memfy_arprot    (memfy_arprot_c),
+            .memfy_arcache   (memfy_arcache_c),
+            .memfy_arid      (memfy_arid_c),
+            .memfy_arpc      (memfy_arpc),
+            .memfy_rvalid    (memfy_rvalid_c),
+            .memfy_rready    (memfy_rready_c),
+            .memfy_rid       (memfy_rid_c),
+            .memfy_rresp     (memfy_rresp_c),
+            .memfy_rdata     (memfy_rdata_c),
             .dcache_awvalid  (dmem_awvalid),
             .dcache_awready  (dmem_awready),
             .dcache_awaddr   (dmem_awaddr),
-            .dcache_awlen    (),
-            .dcache_awsize   (),
-            .dcache_awburst  (),
+            .dcache_awlen    (dmem_awlen),
+            .dcache_awsize   (dmem_awsize),
+            .dcache_awburst  (dmem_awburst),
             .dcache_awlock   (),
             .dcache_awcache  (),
             .dcache_awprot   (dmem_awprot),
@@ -817,7 +1365,7 @@ module friscv_rv32i_core
             .dcache_awid     (dmem_awid),
             .dcache_wvalid   (dmem_wvalid),
             .dcache_wready   (dmem_wready),
-            .dcache_wlast    (),
+            .dcache_wlast    (dmem_wlast),
             .dcache_wdata    (dmem_wdata),
             .dcache_wstrb    (dmem_wstrb),
             .dcache_bvalid   (dmem_bvalid),
@@ -827,9 +1375,9 @@ module friscv_rv32i_core
             .dcache_arvalid  (dmem_arvalid),
             .dcache_arready  (dmem_arready),
             .dcache_araddr   (dmem_araddr),
-            .dcache_arlen    (),
-            .dcache_arsize   (),
-            .dcache_arburst  (),
+            .dcache_arlen    (dmem_arlen),
+            .dcache_arsize   (dmem_arsize),
+            .dcache_arburst  (dmem_arburst),
             .dcache_arlock   (),
             .dcache_arcache  (),
             .dcache_arprot   (dmem_arprot),
@@ -841,40 +1389,63 @@ module friscv_rv32i_core
             .dcache_rid      (dmem_rid),
             .dcache_rresp    (dmem_rresp),
             .dcache_rdata    (dmem_rdata),
-            .dcache_rlast    (1'b1)
+            .dcache_rlast    (dmem_rlast),
+            .perf_hits       (dcache_hits[DCACHE_WAYS-1:0]),
+            .perf_miss       (dcache_miss),
+            .perf_pf_issue   (dcache_pf_issue),
+            .perf_pf_useful  (dcache_pf_useful),
+            .perf_victim_hit (dcache_vc_hit)
         );
 
+        if (DCACHE_WAYS<4) begin : DCACHE_HITS_PAD
+            assign dcache_hits[3:DCACHE_WAYS] = '0;
+        end
+
     end else begin: DCACHE_OFF
 
-        assign dmem_awvalid = memfy_awvalid;
-        assign memfy_awready = dmem_awready;
-        assign dmem_awaddr = memfy_awaddr;
-        assign dmem_awprot = memfy_awprot;
-        assign dmem_awid = memfy_awid;
-
-        assign dmem_wvalid = memfy_wvalid;
-        assign memfy_wready = dmem_wready;
-        assign dmem_wdata = memfy_wdata;
-        assign dmem_wstrb = memfy_wstrb;
-
-        assign memfy_bvalid = dmem_bvalid;
-        assign dmem_bready = memfy_bready;
-        assign memfy_bid = dmem_bid;
-        assign memfy_bresp = dmem_bresp;
-
-        assign dmem_arvalid = memfy_arvalid;
-        assign memfy_arready = dmem_arready;
-        assign dmem_araddr = memfy_araddr;
-        assign dmem_arprot = memfy_arprot;
-        assign dmem_arid = memfy_arid;
-
-        assign memfy_rvalid = dmem_rvalid;
-        assign dmem_rready = memfy_rready;
-        assign memfy_rid = dmem_rid;
-        assign memfy_rresp = dmem_rresp;
-        assign memfy_rdata = dmem_rdata;
+        assign dmem_awvalid = memfy_awvalid_c;
+        assign memfy_awready_c = dmem_awready;
+        assign dmem_awaddr = memfy_awaddr_c;
+        assign dmem_awprot = memfy_awprot_c;
+        assign dmem_awid = memfy_awid_c;
+        assign dmem_awlen = 8'b0;
+        assign dmem_awsize = (XLEN==64) ? 3'b011 : 3'b010;
+        assign dmem_awburst = 2'b01;
+
+        assign dmem_wvalid = memfy_wvalid_c;
+        assign memfy_wready_c = dmem_wready;
+        assign dmem_wdata = memfy_wdata_c;
+        assign dmem_wstrb = memfy_wstrb_c;
+        assign dmem_wlast = 1'b1;
+
+        assign memfy_bvalid_c = dmem_bvalid;
+        assign dmem_bready = memfy_bready_c;
+        assign memfy_bid_c = dmem_bid;
+        assign memfy_bresp_c = dmem_bresp;
+
+        assign dmem_arvalid = memfy_arvalid_c;
+        assign memfy_arready_c = dmem_arready;
+        assign dmem_araddr = memfy_araddr_c;
+        assign dmem_arprot = memfy_arprot_c;
+        assign dmem_arid = memfy_arid_c;
+        assign dmem_arlen = 8'b0;
+        assign dmem_arsize = (XLEN==64) ? 3'b011 : 3'b010;
+        assign dmem_arburst = 2'b01;
+
+        assign memfy_rvalid_c = dmem_rvalid;
+        assign dmem_rready = memfy_rready_c;
+        assign memfy_rid_c = dmem_rid;
+        assign memfy_rresp_c = dmem_rresp;
+        assign memfy_rdata_c = dmem_rdata;
 
         assign dcache_ready = 1'b1;
+        assign clean_ack = clean_blocks;
+
+        assign dcache_hits = 4'b0;
+        assign dcache_miss = 1'b0;
+        assign dcache_pf_issue = 1'b0;
+        assign dcache_pf_useful = 1'b0;
+        assign dcache_vc_hit = 1'b0;
 
     end
     endgenerate
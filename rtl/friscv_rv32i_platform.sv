@@ -33,6 +33,10 @@ module friscv_rv32i_platform
         parameter INST_OSTDREQ_NUM  = 8,
         // Number of outstanding requests used by the LOAD/STORE unit and dcache
         parameter DATA_OSTDREQ_NUM  = 8,
+        // Number of stores buffered by the LOAD/STORE unit, 0 to disable
+        parameter STORE_BUFFER_NB   = 0,
+        // Serve the misaligned LOAD/STORE instead of raising an exception
+        parameter MISALIGNED_HW     = 0,
         // Core Hart ID
         parameter HART_ID           = 0,
         // RV32E architecture, limits integer registers to 16, else 32 available
@@ -41,6 +45,10 @@ module friscv_rv32i_platform
         parameter F_EXTENSION       = 0,
         // Multiply/Divide extension support
         parameter M_EXTENSION       = 0,
+        // Atomic extension support (LR/SC and AMOs)
+        parameter A_EXTENSION       = 0,
+        // Compressed instructions extension support
+        parameter C_EXTENSION       = 0,
         // Support hypervisor mode
         parameter HYPERVISOR_MODE   = 0,
         // Support supervisor mode
@@ -52,6 +60,34 @@ module friscv_rv32i_platform
         // Timeout applied for WFI 
         parameter WFI_TW = 100,
 
+        ////////////////////////////////////////////////////////////////////////
+        // Branch prediction
+        ////////////////////////////////////////////////////////////////////////
+
+        // Enable the dynamic branch predictor in the control unit
+        parameter BRANCH_PREDICTOR = 0,
+        // Number of entries in the branch history table (power of two)
+        parameter BHT_DEPTH = 64,
+        // Number of entries in the branch target buffer (power of two)
+        parameter BTB_DEPTH = 16,
+        // Number of entries in the return address stack (power of two, 0
+        // to disable)
+        parameter RAS_DEPTH = 4,
+        // Issue an ALU instruction along the current processing instruction
+        parameter DUAL_ISSUE = 0,
+        // Execute the common instruction pairs as a single operation
+        parameter MACRO_FUSION = 0,
+        // Radix of the divider, 2 or 4
+        parameter DIV_RADIX = 2,
+        // Skip the leading zeros of the dividend to terminate earlier
+        parameter DIV_EARLY_TERM = 0,
+        // Divide by a power of two in a single cycle
+        parameter DIV_POW2 = 0,
+        // Number of cycles to complete a multiplication
+        parameter MUL_LATENCY = 1,
+        // Number of divisions queued ahead of the divider
+        parameter DIV_OSTD_NUM = 0,
+
         ////////////////////////////////////////////////////////////////////////
         // Physical Memory Protection & Attributes
         // Virtual Memory
@@ -103,6 +139,9 @@ module friscv_rv32i_platform
         // ID used by instruction and data buses
         parameter AXI_IMEM_MASK     = 'h80,
         parameter AXI_DMEM_MASK     = 'h10,
+        // Read the cache blocks with WRAP bursts starting on the word
+        // requested, else with INCR bursts starting on the block's first beat
+        parameter AXI_WRAP          = 0,
 
         ////////////////////////////////////////////////////////////////////////
         // Cache setup
@@ -118,6 +157,13 @@ module friscv_rv32i_platform
         parameter ICACHE_BLOCK_W     = AXI_DATA_W,
         // Number of blocks in the cache
         parameter ICACHE_DEPTH       = 512,
+        // Number of ways, 1 (direct-mapped), 2 or 4
+        parameter ICACHE_WAYS        = 1,
+        // Number of entries of the victim cache, 0 disables it
+        parameter ICACHE_VICTIM_NB   = 0,
+        // Complete a missing fetch with the block read, or with the beat
+        // holding its instruction, without replaying it
+        parameter ICACHE_EARLY_RESTART = 0,
 
         // Enable cache block prefetch
         parameter DCACHE_PREFETCH_EN = 0,
@@ -125,7 +171,54 @@ module friscv_rv32i_platform
         // integer multiple of XLEN (power of two)
         parameter DCACHE_BLOCK_W     = AXI_DATA_W,
         // Number of blocks in the cache
-        parameter DCACHE_DEPTH       = 512
+        parameter DCACHE_DEPTH       = 512,
+        // Number of ways, 1 (direct-mapped), 2 or 4
+        parameter DCACHE_WAYS        = 1,
+        // Write policy, 0 = write-through, 1 = write-back with write-allocate
+        parameter DCACHE_WRITE_BACK  = 0,
+        // Number of miss status holding registers, 0 blocks the loads on a miss
+        parameter DCACHE_MSHR_NUM    = 0,
+        // Number of entries of the stride prefetcher, 0 disables it
+        parameter DCACHE_STRIDE_TABLE = 0,
+        // Number of blocks prefetched ahead of an access
+        parameter DCACHE_PREFETCH_DEGREE = 1,
+        // Number of entries of the victim cache, 0 disables it
+        parameter DCACHE_VICTIM_NB   = 0,
+        // Complete a missing load with the block read, without replaying it.
+        // Without MSHR only
+        parameter DCACHE_EARLY_RESTART = 0,
+
+        ////////////////////////////////////////////////////////////////////////
+        // Tightly-coupled memories
+        ////////////////////////////////////////////////////////////////////////
+
+        // Enable the instruction TCM, its base address and size in bytes
+        parameter ITCM_EN            = 0,
+        parameter ITCM_BASE          = 32'h0,
+        parameter ITCM_SIZE          = 16384,
+        // File loaded in the instruction TCM
+        parameter ITCM_INIT_FILE     = "",
+        // Enable the data TCM, its base address and size in bytes
+        parameter DTCM_EN            = 0,
+        parameter DTCM_BASE          = 32'h10000,
+        parameter DTCM_SIZE          = 16384,
+        // File loaded in the data TCM
+        parameter DTCM_INIT_FILE     = "",
+
+        ////////////////////////////////////////////////////////////////////////
+        // L2 cache setup
+        ////////////////////////////////////////////////////////////////////////
+
+        // Enable the unified L2 cache between the crossbar and the RAM
+        parameter L2_EN              = 0,
+        // Number of blocks in the cache, shared across the banks and ways
+        parameter L2_DEPTH           = 4096,
+        // Number of ways, 1 (direct-mapped) or a power of two
+        parameter L2_WAYS            = 4,
+        // Number of banks, a power of two
+        parameter L2_BANKS           = 2,
+        // Number of outstanding reads and writes, a power of two
+        parameter L2_OSTDREQ_NUM     = 8
 
     )(
         // Clock/reset interface
@@ -261,6 +354,41 @@ module friscv_rv32i_platform
 
     logic                      timer_irq;
 
+    ///////////////////////////////////////////////////////////////////////////
+    // RAM port of the crossbar, connected to the memory through the L2
+    ///////////////////////////////////////////////////////////////////////////
+
+    // ID of the requests issued by the L2 to the memory
+    parameter [AXI_ID_W-1:0] L2_ID_MASK = 'h40;
+
+    logic                      ram_awvalid;
+    logic                      ram_awready;
+    logic [AXI_ADDR_W    -1:0] ram_awaddr;
+    logic [3             -1:0] ram_awprot;
+    logic [AXI_ID_W      -1:0] ram_awid;
+    logic                      ram_wvalid;
+    logic                      ram_wready;
+    logic [AXI_DATA_W    -1:0] ram_wdata;
+    logic [AXI_DATA_W/8  -1:0] ram_wstrb;
+    logic                      ram_bvalid;
+    logic                      ram_bready;
+    logic [AXI_ID_W      -1:0] ram_bid;
+    logic [2             -1:0] ram_bresp;
+    logic                      ram_arvalid;
+    logic                      ram_arready;
+    logic [AXI_ADDR_W    -1:0] ram_araddr;
+    logic [3             -1:0] ram_arprot;
+    logic [AXI_ID_W      -1:0] ram_arid;
+    logic                      ram_rvalid;
+    logic                      ram_rready;
+    logic [AXI_ID_W      -1:0] ram_rid;
+    logic [2             -1:0] ram_rresp;
+    logic [AXI_DATA_W    -1:0] ram_rdata;
+
+    // L2 performance counters: read hits, read misses, write hits, write
+    // misses, refills and bank conflicts
+    logic [6*32          -1:0] l2_perfs;
+
     ///////////////////////////////////////////////////////////////////////////
     // AXI4-lite Crossbar parameters and signals
     ///////////////////////////////////////////////////////////////////////////
@@ -362,15 +490,30 @@ module friscv_rv32i_platform
         .ILEN                       (ILEN),
         .XLEN                       (XLEN),
         .M_EXTENSION                (M_EXTENSION),
+        .A_EXTENSION                (A_EXTENSION),
+        .C_EXTENSION                (C_EXTENSION),
         .F_EXTENSION                (F_EXTENSION),
         .HYPERVISOR_MODE            (HYPERVISOR_MODE),
         .SUPERVISOR_MODE            (SUPERVISOR_MODE),
         .USER_MODE                  (USER_MODE),
         .PROCESSING_BUS_PIPELINE    (PROCESSING_BUS_PIPELINE),
         .WFI_TW                     (WFI_TW), 
+        .BRANCH_PREDICTOR           (BRANCH_PREDICTOR),
+        .BHT_DEPTH                  (BHT_DEPTH),
+        .BTB_DEPTH                  (BTB_DEPTH),
+        .RAS_DEPTH                  (RAS_DEPTH),
+        .DUAL_ISSUE                 (DUAL_ISSUE),
+        .MACRO_FUSION               (MACRO_FUSION),
+        .DIV_RADIX                  (DIV_RADIX),
+        .DIV_EARLY_TERM             (DIV_EARLY_TERM),
+        .DIV_POW2                   (DIV_POW2),
+        .MUL_LATENCY                (MUL_LATENCY),
+        .DIV_OSTD_NUM               (DIV_OSTD_NUM),
         .BOOT_ADDR                  (BOOT_ADDR),
         .INST_OSTDREQ_NUM           (INST_OSTDREQ_NUM),
         .DATA_OSTDREQ_NUM           (DATA_OSTDREQ_NUM),
+        .STORE_BUFFER_NB            (STORE_BUFFER_NB),
+        .MISALIGNED_HW              (MISALIGNED_HW),
         .HART_ID                    (HART_ID),
         .RV32E                      (RV32E),
         .AXI_ADDR_W                 (AXI_ADDR_W),
@@ -379,15 +522,34 @@ module friscv_rv32i_platform
         .AXI_DMEM_W                 (AXI_DMEM_W),
         .AXI_IMEM_MASK              (AXI_IMEM_MASK),
         .AXI_DMEM_MASK              (AXI_DMEM_MASK),
+        .AXI_WRAP                   (AXI_WRAP),
         .CACHE_EN                   (CACHE_EN),
         .ICACHE_PREFETCH_EN         (ICACHE_PREFETCH_EN),
         .ICACHE_BLOCK_W             (ICACHE_BLOCK_W),
         .ICACHE_DEPTH               (ICACHE_DEPTH),
+        .ICACHE_WAYS                (ICACHE_WAYS),
+        .ICACHE_VICTIM_NB           (ICACHE_VICTIM_NB),
+        .ICACHE_EARLY_RESTART       (ICACHE_EARLY_RESTART),
         .IO_MAP_NB                  (IO_MAP_NB),
         .IO_MAP                     (IO_MAP),
         .DCACHE_PREFETCH_EN         (DCACHE_PREFETCH_EN),
         .DCACHE_BLOCK_W             (DCACHE_BLOCK_W),
         .DCACHE_DEPTH               (DCACHE_DEPTH),
+        .DCACHE_WAYS                (DCACHE_WAYS),
+        .DCACHE_WRITE_BACK          (DCACHE_WRITE_BACK),
+        .DCACHE_MSHR_NUM            (DCACHE_MSHR_NUM),
+        .DCACHE_STRIDE_TABLE        (DCACHE_STRIDE_TABLE),
+        .DCACHE_PREFETCH_DEGREE     (DCACHE_PREFETCH_DEGREE),
+        .DCACHE_VICTIM_NB           (DCACHE_VICTIM_NB),
+        .DCACHE_EARLY_RESTART       (DCACHE_EARLY_RESTART),
+        .ITCM_EN                    (ITCM_EN),
+        .ITCM_BASE                  (ITCM_BASE),
+        .ITCM_SIZE                  (ITCM_SIZE),
+        .ITCM_INIT_FILE             (ITCM_INIT_FILE),
+        .DTCM_EN                    (DTCM_EN),
+        .DTCM_BASE                  (DTCM_BASE),
+        .DTCM_SIZE                  (DTCM_SIZE),
+        .DTCM_INIT_FILE             (DTCM_INIT_FILE),
         .MPU_SUPPORT                (MPU_SUPPORT),
         .PMPCFG0_INIT               (PMPCFG0_INIT),
         .PMPCFG1_INIT               (PMPCFG1_INIT),
@@ -425,20 +587,28 @@ module friscv_rv32i_platform
         .imem_araddr  (imem_araddr),
         .imem_arprot  (imem_arprot),
         .imem_arid    (imem_arid),
+        .imem_arlen   (),
+        .imem_arsize  (),
+        .imem_arburst (),
         .imem_rvalid  (imem_rvalid),
         .imem_rready  (imem_rready),
         .imem_rid     (imem_rid),
         .imem_rresp   (imem_rresp),
         .imem_rdata   (imem_rdata),
+        .imem_rlast   (1'b1),
         .dmem_awvalid (dmem_awvalid),
         .dmem_awready (dmem_awready),
         .dmem_awaddr  (dmem_awaddr),
         .dmem_awprot  (dmem_awprot),
         .dmem_awid    (dmem_awid),
+        .dmem_awlen   (),
+        .dmem_awsize  (),
+        .dmem_awburst (),
         .dmem_wvalid  (dmem_wvalid),
         .dmem_wready  (dmem_wready),
         .dmem_wdata   (dmem_wdata),
         .dmem_wstrb   (dmem_wstrb),
+        .dmem_wlast   (),
         .dmem_bvalid  (dmem_bvalid),
         .dmem_bready  (dmem_bready),
         .dmem_bid     (dmem_bid),
@@ -448,11 +618,15 @@ module friscv_rv32i_platform
         .dmem_araddr  (dmem_araddr),
         .dmem_arprot  (dmem_arprot),
         .dmem_arid    (dmem_arid),
+        .dmem_arlen   (),
+        .dmem_arsize  (),
+        .dmem_arburst (),
         .dmem_rvalid  (dmem_rvalid),
         .dmem_rready  (dmem_rready),
         .dmem_rid     (dmem_rid),
         .dmem_rresp   (dmem_rresp),
-        .dmem_rdata   (dmem_rdata)
+        .dmem_rdata   (dmem_rdata),
+        .dmem_rlast   (1'b1)
     );
 
 
@@ -650,33 +824,33 @@ module friscv_rv32i_platform
         .mst0_aclk    (aclk),
         .mst0_aresetn (aresetn),
         .mst0_srst    (srst),
-        .mst0_awvalid (mem_awvalid),
-        .mst0_awready (mem_awready),
-        .mst0_awaddr  (mem_awaddr),
-        .mst0_awprot  (mem_awprot),
-        .mst0_awid    (mem_awid),
+        .mst0_awvalid (ram_awvalid),
+        .mst0_awready (ram_awready),
+        .mst0_awaddr  (ram_awaddr),
+        .mst0_awprot  (ram_awprot),
+        .mst0_awid    (ram_awid),
         .mst0_awuser  (),
-        .mst0_wvalid  (mem_wvalid),
-        .mst0_wready  (mem_wready),
-        .mst0_wdata   (mem_wdata),
-        .mst0_wstrb   (mem_wstrb),
+        .mst0_wvalid  (ram_wvalid),
+        .mst0_wready  (ram_wready),
+        .mst0_wdata   (ram_wdata),
+        .mst0_wstrb   (ram_wstrb),
         .mst0_wuser   (),
-        .mst0_bvalid  (mem_bvalid),
-        .mst0_bready  (mem_bready),
-        .mst0_bid     (mem_bid),
-        .mst0_bresp   (mem_bresp),
+        .mst0_bvalid  (ram_bvalid),
+        .mst0_bready  (ram_bready),
+        .mst0_bid     (ram_bid),
+        .mst0_bresp   (ram_bresp),
         .mst0_buser   (1'b0),
-        .mst0_arvalid (mem_arvalid),
-        .mst0_arready (mem_arready),
-        .mst0_araddr  (mem_araddr),
-        .mst0_arprot  (mem_arprot),
-        .mst0_arid    (mem_arid),
+        .mst0_arvalid (ram_arvalid),
+        .mst0_arready (ram_arready),
+        .mst0_araddr  (ram_araddr),
+        .mst0_arprot  (ram_arprot),
+        .mst0_arid    (ram_arid),
         .mst0_aruser  (),
-        .mst0_rvalid  (mem_rvalid),
-        .mst0_rready  (mem_rready),
-        .mst0_rid     (mem_rid),
-        .mst0_rresp   (mem_rresp),
-        .mst0_rdata   (mem_rdata),
+        .mst0_rvalid  (ram_rvalid),
+        .mst0_rready  (ram_rready),
+        .mst0_rid     (ram_rid),
+        .mst0_rresp   (ram_rresp),
+        .mst0_rdata   (ram_rdata),
         .mst0_ruser   (1'b0),
         .mst1_aclk    (aclk),
         .mst1_aresetn (aresetn),
@@ -773,6 +947,111 @@ module friscv_rv32i_platform
         .mst3_ruser   (1'h0)
     );
 
+    ///////////////////////////////////////////////////////////////////////////
+    // Unified L2 cache on the RAM port of the crossbar, shared by the
+    // instruction and data caches, the IOs bypassing it
+    ///////////////////////////////////////////////////////////////////////////
+
+    generate
+    if (L2_EN) begin: USE_L2
+
+        friscv_l2cache
+        #(
+            .NAME        ("L2"),
+            .OSTDREQ_NUM (L2_OSTDREQ_NUM),
+            .AXI_ADDR_W  (AXI_ADDR_W),
+            .AXI_ID_W    (AXI_ID_W),
+            .AXI_DATA_W  (AXI_DATA_W),
+            .AXI_ID_MASK (L2_ID_MASK),
+            .CACHE_DEPTH (L2_DEPTH),
+            .CACHE_WAYS  (L2_WAYS),
+            .CACHE_BANKS (L2_BANKS)
+        )
+        l2cache
+        (
+            .aclk        (aclk),
+            .aresetn     (aresetn),
+            .srst        (srst),
+            .slv_awvalid (ram_awvalid),
+            .slv_awready (ram_awready),
+            .slv_awaddr  (ram_awaddr),
+            .slv_awprot  (ram_awprot),
+            .slv_awid    (ram_awid),
+            .slv_wvalid  (ram_wvalid),
+            .slv_wready  (ram_wready),
+            .slv_wdata   (ram_wdata),
+            .slv_wstrb   (ram_wstrb),
+            .slv_bvalid  (ram_bvalid),
+            .slv_bready  (ram_bready),
+            .slv_bid     (ram_bid),
+            .slv_bresp   (ram_bresp),
+            .slv_arvalid (ram_arvalid),
+            .slv_arready (ram_arready),
+            .slv_araddr  (ram_araddr),
+            .slv_arprot  (ram_arprot),
+            .slv_arid    (ram_arid),
+            .slv_rvalid  (ram_rvalid),
+            .slv_rready  (ram_rready),
+            .slv_rid     (ram_rid),
+            .slv_rresp   (ram_rresp),
+            .slv_rdata   (ram_rdata),
+            .mst_awvalid (mem_awvalid),
+            .mst_awready (mem_awready),
+            .mst_awaddr  (mem_awaddr),
+            .mst_awprot  (mem_awprot),
+            .mst_awid    (mem_awid),
+            .mst_wvalid  (mem_wvalid),
+            .mst_wready  (mem_wready),
+            .mst_wdata   (mem_wdata),
+            .mst_wstrb   (mem_wstrb),
+            .mst_bvalid  (mem_bvalid),
+            .mst_bready  (mem_bready),
+            .mst_bid     (mem_bid),
+            .mst_bresp   (mem_bresp),
+            .mst_arvalid (mem_arvalid),
+            .mst_arready (mem_arready),
+            .mst_araddr  (mem_araddr),
+            .mst_arprot  (mem_arprot),
+            .mst_arid    (mem_arid),
+            .mst_rvalid  (mem_rvalid),
+            .mst_rready  (mem_rready),
+            .mst_rid     (mem_rid),
+            .mst_rresp   (mem_rresp),
+            .mst_rdata   (mem_rdata),
+            .perfs       (l2_perfs)
+        );
+
+    end else begin: NO_L2
+
+        assign mem_awvalid = ram_awvalid;
+        assign ram_awready = mem_awready;
+        assign mem_awaddr = ram_awaddr;
+        assign mem_awprot = ram_awprot;
+        assign mem_awid = ram_awid;
+        assign mem_wvalid = ram_wvalid;
+        assign ram_wready = mem_wready;
+        assign mem_wdata = ram_wdata;
+        assign mem_wstrb = ram_wstrb;
+        assign ram_bvalid = mem_bvalid;
+        assign mem_bready = ram_bready;
+        assign ram_bid = mem_bid;
+        assign ram_bresp = mem_bresp;
+        assign mem_arvalid = ram_arvalid;
+        assign ram_arready = mem_arready;
+        assign mem_araddr = ram_araddr;
+        assign mem_arprot = ram_arprot;
+        assign mem_arid = ram_arid;
+        assign ram_rvalid = mem_rvalid;
+        assign mem_rready = ram_rready;
+        assign ram_rid = mem_rid;
+        assign ram_rresp = mem_rresp;
+        assign ram_rdata = mem_rdata;
+
+        assign l2_perfs = '0;
+
+    end
+    endgenerate
+
     friscv_io_subsystem
     #(
         .ADDRW           (AXI_ADDR_W),
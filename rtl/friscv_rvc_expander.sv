@@ -0,0 +1,204 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+`include "friscv_h.sv"
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// RV32C expander, translating a 16 bits compressed instruction into its
+// 32 bits equivalent, placed ahead of the decoder. The floating-point
+// load/store instructions, the reserved and the illegal encodings are
+// translated into 0x0, an illegal instruction for the decoder.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+module friscv_rvc_expander
+
+    (
+        input  wire  [16   -1:0] cinst,
+        output logic [32   -1:0] instruction
+    );
+
+    // Registers of the 3 bits fields (x8 -> x15)
+    logic [5 -1:0] rd_p;
+    logic [5 -1:0] rs1_p;
+    logic [5 -1:0] rs2_p;
+    // Full registers fields
+    logic [5 -1:0] rd;
+    logic [5 -1:0] rs2;
+    // Immediates
+    logic [12-1:0] imm6;
+    logic [12-1:0] addi4spn;
+    logic [12-1:0] addi16sp;
+    logic [12-1:0] lw_off;
+    logic [12-1:0] lwsp_off;
+    logic [12-1:0] swsp_off;
+    logic [21-1:0] j_off;
+    logic [13-1:0] b_off;
+
+    assign rd_p = {2'b01, cinst[4:2]};
+    assign rs1_p = {2'b01, cinst[9:7]};
+    assign rs2_p = {2'b01, cinst[4:2]};
+
+    assign rd = cinst[11:7];
+    assign rs2 = cinst[6:2];
+
+    assign imm6 = {{6{cinst[12]}}, cinst[12], cinst[6:2]};
+    assign addi4spn = {2'b0, cinst[10:7], cinst[12:11], cinst[5], cinst[6], 2'b0};
+    assign addi16sp = {{2{cinst[12]}}, cinst[12], cinst[4:3], cinst[5], cinst[2], cinst[6], 4'b0};
+    assign lw_off = {5'b0, cinst[5], cinst[12:10], cinst[6], 2'b0};
+    assign lwsp_off = {4'b0, cinst[3:2], cinst[12], cinst[6:4], 2'b0};
+    assign swsp_off = {4'b0, cinst[8:7], cinst[12:9], 2'b0};
+    assign j_off = {{10{cinst[12]}}, cinst[8], cinst[10:9], cinst[6], cinst[7],
+                    cinst[2], cinst[11], cinst[5:3], 1'b0};
+    assign b_off = {{5{cinst[12]}}, cinst[6:5], cinst[2], cinst[11:10], cinst[4:3], 1'b0};
+
+    always @ (*) begin
+
+        instruction = 32'h0;
+
+        case ({cinst[15:13], cinst[1:0]})
+
+            // C.ADDI4SPN -> addi rd', x2, nzuimm
+            5'b000_00: begin
+                if (addi4spn!=12'h0)
+                    instruction = {addi4spn, 5'h2, `ADDI, rd_p, `I_ARITH};
+            end
+
+            // C.LW -> lw rd', offset(rs1')
+            5'b010_00: begin
+                instruction = {lw_off, rs1_p, `LW, rd_p, `LOAD};
+            end
+
+            // C.SW -> sw rs2', offset(rs1')
+            5'b110_00: begin
+                instruction = {lw_off[11:5], rs2_p, rs1_p, `SW, lw_off[4:0], `STORE};
+            end
+
+            // C.ADDI / C.NOP -> addi rd, rd, imm
+            5'b000_01: begin
+                instruction = {imm6, rd, `ADDI, rd, `I_ARITH};
+            end
+
+            // C.JAL -> jal x1, offset
+            5'b001_01: begin
+                instruction = {j_off[20], j_off[10:1], j_off[11], j_off[19:12], 5'h1, `JAL};
+            end
+
+            // C.LI -> addi rd, x0, imm
+            5'b010_01: begin
+                instruction = {imm6, 5'h0, `ADDI, rd, `I_ARITH};
+            end
+
+            // C.ADDI16SP -> addi x2, x2, nzimm
+            // C.LUI -> lui rd, nzimm
+            5'b011_01: begin
+                if (rd==5'h2) begin
+                    if (addi16sp!=12'h0)
+                        instruction = {addi16sp, 5'h2, `ADDI, 5'h2, `I_ARITH};
+                end else if (imm6!=12'h0) begin
+                    instruction = {{8{imm6[11]}}, imm6, rd, `LUI};
+                end
+            end
+
+            // Arithmetic on rd'
+            5'b100_01: begin
+                case (cinst[11:10])
+                    // C.SRLI -> srli rd', rd', shamt
+                    2'b00: begin
+                        if (!cinst[12])
+                            instruction = {7'b0000000, cinst[6:2], rs1_p, `SRLI, rs1_p, `I_ARITH};
+                    end
+                    // C.SRAI -> srai rd', rd', shamt
+                    2'b01: begin
+                        if (!cinst[12])
+                            instruction = {7'b0100000, cinst[6:2], rs1_p, `SRAI, rs1_p, `I_ARITH};
+                    end
+                    // C.ANDI -> andi rd', rd', imm
+                    2'b10: begin
+                        instruction = {imm6, rs1_p, `ANDI, rs1_p, `I_ARITH};
+                    end
+                    // C.SUB / C.XOR / C.OR / C.AND -> op rd', rd', rs2'
+                    default: begin
+                        if (!cinst[12]) begin
+                            case (cinst[6:5])
+                                2'b00: instruction = {7'b0100000, rs2_p, rs1_p, `SUB, rs1_p, `R_ARITH};
+                                2'b01: instruction = {7'b0000000, rs2_p, rs1_p, `XOR, rs1_p, `R_ARITH};
+                                2'b10: instruction = {7'b0000000, rs2_p, rs1_p, `OR,  rs1_p, `R_ARITH};
+                                default: instruction = {7'b0000000, rs2_p, rs1_p, `AND, rs1_p, `R_ARITH};
+                            endcase
+                        end
+                    end
+                endcase
+            end
+
+            // C.J -> jal x0, offset
+            5'b101_01: begin
+                instruction = {j_off[20], j_off[10:1], j_off[11], j_off[19:12], 5'h0, `JAL};
+            end
+
+            // C.BEQZ -> beq rs1', x0, offset
+            5'b110_01: begin
+                instruction = {b_off[12], b_off[10:5], 5'h0, rs1_p, `BEQ, b_off[4:1], b_off[11], `BRANCH};
+            end
+
+            // C.BNEZ -> bne rs1', x0, offset
+            5'b111_01: begin
+                instruction = {b_off[12], b_off[10:5], 5'h0, rs1_p, `BNE, b_off[4:1], b_off[11], `BRANCH};
+            end
+
+            // C.SLLI -> slli rd, rd, shamt
+            5'b000_10: begin
+                if (!cinst[12])
+                    instruction = {7'b0000000, cinst[6:2], rd, `SLLI, rd, `I_ARITH};
+            end
+
+            // C.LWSP -> lw rd, offset(x2)
+            5'b010_10: begin
+                if (rd!=5'h0)
+                    instruction = {lwsp_off, 5'h2, `LW, rd, `LOAD};
+            end
+
+            // C.JR / C.MV / C.EBREAK / C.JALR / C.ADD
+            5'b100_10: begin
+                if (!cinst[12]) begin
+                    // C.JR -> jalr x0, 0(rs1)
+                    if (rs2==5'h0) begin
+                        if (rd!=5'h0)
+                            instruction = {12'h0, rd, 3'b000, 5'h0, `JALR};
+                    // C.MV -> add rd, x0, rs2
+                    end else begin
+                        instruction = {7'b0000000, rs2, 5'h0, `ADD, rd, `R_ARITH};
+                    end
+                end else begin
+                    // C.EBREAK
+                    if (rd==5'h0 && rs2==5'h0)
+                        instruction = {12'h001, 5'h0, 3'b000, 5'h0, `SYS};
+                    // C.JALR -> jalr x1, 0(rs1)
+                    else if (rs2==5'h0)
+                        instruction = {12'h0, rd, 3'b000, 5'h1, `JALR};
+                    // C.ADD -> add rd, rd, rs2
+                    else
+                        instruction = {7'b0000000, rs2, rd, `ADD, rd, `R_ARITH};
+                end
+            end
+
+            // C.SWSP -> sw rs2, offset(x2)
+            5'b110_10: begin
+                instruction = {swsp_off[11:5], rs2, 5'h2, `SW, swsp_off[4:0], `STORE};
+            end
+
+            // Floating-point load/store and reserved encodings
+            default: begin
+                instruction = 32'h0;
+            end
+
+        endcase
+    end
+
+endmodule
+
+`resetall
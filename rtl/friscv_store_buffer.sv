@@ -0,0 +1,247 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Store buffer of the LOAD/STORE unit
+//
+// - store the write requests issued by the memfy FSM, a STORE completing
+//   once pushed in the buffer
+// - write them in-order to the memory, a write being issued only once the
+//   outstanding reads to its block have been completed
+// - an entry is released once its write response has been received
+// - look up the LOAD address against the pending stores: a load reading a
+//   word fully written by the youngest store to this word is completed with
+//   the store data, a load to a block with a pending store waits for its
+//   release, the other loads bypass the buffer. An IO load waits for the
+//   buffer to be drained
+//
+///////////////////////////////////////////////////////////////////////////////
+
+module friscv_store_buffer
+
+    #(
+        // Number of stores buffered, a power of two
+        parameter DEPTH = 4,
+        // Address bus width defined for both control and AXI4 address signals
+        parameter AXI_ADDR_W = 32,
+        // AXI4 data width
+        parameter AXI_DATA_W = 32,
+        // Width of the block a load is ordered against, the data cache block
+        // or the data width if no cache is used
+        parameter BLOCK_W = 128
+    )(
+        // Global interface
+        input  wire                            aclk,
+        input  wire                            aresetn,
+        input  wire                            srst,
+        // No store pending
+        output logic                           empty,
+        // Reads waiting for their completion, holding the next write
+        input  wire                            rd_pending,
+
+        // Write requests from the memfy FSM
+        input  wire                            st_awvalid,
+        output logic                           st_awready,
+        input  wire  [AXI_ADDR_W         -1:0] st_awaddr,
+        input  wire  [3                  -1:0] st_awprot,
+        input  wire  [4                  -1:0] st_awcache,
+        input  wire                            st_wvalid,
+        output logic                           st_wready,
+        input  wire  [AXI_DATA_W         -1:0] st_wdata,
+        input  wire  [AXI_DATA_W/8       -1:0] st_wstrb,
+
+        // Load lookup
+        input  wire  [AXI_ADDR_W         -1:0] ld_addr,
+        input  wire  [AXI_DATA_W/8       -1:0] ld_strb,
+        input  wire                            ld_io,
+        output logic                           ld_fwd,
+        output logic [AXI_DATA_W         -1:0] ld_data,
+        output logic                           ld_hazard,
+
+        // Data memory interface
+        output logic                           awvalid,
+        input  wire                            awready,
+        output logic [AXI_ADDR_W         -1:0] awaddr,
+        output logic [3                  -1:0] awprot,
+        output logic [4                  -1:0] awcache,
+        output logic                           wvalid,
+        input  wire                            wready,
+        output logic [AXI_DATA_W         -1:0] wdata,
+        output logic [AXI_DATA_W/8       -1:0] wstrb,
+        input  wire                            bvalid,
+        input  wire                            bready
+    );
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Parameters and variables declarations
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    localparam PTR_W = (DEPTH>1) ? $clog2(DEPTH) : 1;
+
+    // Lowest part of the address selecting a byte in a word or a block
+    localparam WORD_LSB_W = $clog2(AXI_DATA_W/8);
+    localparam BLOCK_LSB_W = $clog2(BLOCK_W/8);
+
+    logic [AXI_ADDR_W     -1:0] addr [DEPTH-1:0];
+    logic [3              -1:0] prot [DEPTH-1:0];
+    logic [4              -1:0] cache [DEPTH-1:0];
+    logic [AXI_DATA_W     -1:0] data [DEPTH-1:0];
+    logic [AXI_DATA_W/8   -1:0] strb [DEPTH-1:0];
+    logic [DEPTH          -1:0] pending;
+
+    // Push, address, data and response pointers, the MSB flagging a wrap
+    logic [PTR_W            :0] wr_ptr;
+    logic [PTR_W            :0] aw_ptr;
+    logic [PTR_W            :0] w_ptr;
+    logic [PTR_W            :0] b_ptr;
+
+    logic                       push;
+    logic                       aw_hold;
+    logic                       w_ahead;
+
+    logic [DEPTH          -1:0] blk_match;
+    logic [DEPTH          -1:0] word_match;
+    logic                       st_blk_match;
+    logic                       st_word_match;
+    logic                       fwd_match;
+    logic [AXI_DATA_W     -1:0] fwd_data;
+    logic [AXI_DATA_W/8   -1:0] fwd_strb;
+    logic [PTR_W          -1:0] fwd_ix;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Stores storage, the address and data being pushed together
+    ///////////////////////////////////////////////////////////////////////////
+
+    // The FSM issues the address and the data together, both acknowledged
+    // while the buffer is not full
+    assign push = st_awvalid & st_wvalid & st_awready;
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            wr_ptr <= '0;
+            aw_ptr <= '0;
+            w_ptr <= '0;
+            b_ptr <= '0;
+            pending <= '0;
+            aw_hold <= 1'b0;
+            w_ahead <= 1'b0;
+        end else if (srst) begin
+            wr_ptr <= '0;
+            aw_ptr <= '0;
+            w_ptr <= '0;
+            b_ptr <= '0;
+            pending <= '0;
+            aw_hold <= 1'b0;
+            w_ahead <= 1'b0;
+        end else begin
+
+            if (push)
+                wr_ptr <= wr_ptr + 1'b1;
+
+            if (awvalid && awready)
+                aw_ptr <= aw_ptr + 1'b1;
+
+            if (wvalid && wready)
+                w_ptr <= w_ptr + 1'b1;
+
+            if (bvalid && bready)
+                b_ptr <= b_ptr + 1'b1;
+
+            aw_hold <= awvalid & !awready;
+
+            // Data acknowledged before its address
+            if (awvalid && awready)
+                w_ahead <= 1'b0;
+            else if (wvalid && wready && w_ptr==aw_ptr)
+                w_ahead <= 1'b1;
+
+            for (int i=0;i<DEPTH;i=i+1) begin
+                if (push && wr_ptr[PTR_W-1:0]==i[PTR_W-1:0])
+                    pending[i] <= 1'b1;
+                else if (bvalid && bready && b_ptr[PTR_W-1:0]==i[PTR_W-1:0])
+                    pending[i] <= 1'b0;
+            end
+        end
+    end
+
+    always @ (posedge aclk) begin
+        if (push) begin
+            addr[wr_ptr[PTR_W-1:0]] <= st_awaddr;
+            prot[wr_ptr[PTR_W-1:0]] <= st_awprot;
+            cache[wr_ptr[PTR_W-1:0]] <= st_awcache;
+            data[wr_ptr[PTR_W-1:0]] <= st_wdata;
+            strb[wr_ptr[PTR_W-1:0]] <= st_wstrb;
+        end
+    end
+
+    assign st_awready = (wr_ptr ^ b_ptr) != {1'b1, {PTR_W{1'b0}}};
+    assign st_wready = st_awready;
+
+    assign empty = (wr_ptr == b_ptr);
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Load lookup against the pending stores and the one being pushed, the
+    // youngest store writing the word providing the data to forward
+    ///////////////////////////////////////////////////////////////////////////
+
+    for (genvar i=0;i<DEPTH;i=i+1) begin: MATCH
+        assign blk_match[i] = pending[i] &&
+                              addr[i][AXI_ADDR_W-1:BLOCK_LSB_W]==ld_addr[AXI_ADDR_W-1:BLOCK_LSB_W];
+        assign word_match[i] = pending[i] &&
+                               addr[i][AXI_ADDR_W-1:WORD_LSB_W]==ld_addr[AXI_ADDR_W-1:WORD_LSB_W];
+    end
+
+    assign st_blk_match = st_awvalid && st_wvalid &&
+                          st_awaddr[AXI_ADDR_W-1:BLOCK_LSB_W]==ld_addr[AXI_ADDR_W-1:BLOCK_LSB_W];
+    assign st_word_match = st_awvalid && st_wvalid &&
+                           st_awaddr[AXI_ADDR_W-1:WORD_LSB_W]==ld_addr[AXI_ADDR_W-1:WORD_LSB_W];
+
+    // Parse the entries from the oldest to the youngest one
+    always @ (*) begin
+
+        fwd_ix = {PTR_W{1'b0}};
+
+        for (int i=0;i<DEPTH;i=i+1)
+            if (word_match[b_ptr[PTR_W-1:0]+i[PTR_W-1:0]])
+                fwd_ix = b_ptr[PTR_W-1:0] + i[PTR_W-1:0];
+    end
+
+    assign fwd_match = st_word_match || |word_match;
+    assign fwd_data = (st_word_match) ? st_wdata : data[fwd_ix];
+    assign fwd_strb = (st_word_match) ? st_wstrb : strb[fwd_ix];
+
+    assign ld_fwd = fwd_match && !ld_io && ((fwd_strb & ld_strb) == ld_strb);
+    assign ld_data = fwd_data;
+
+    assign ld_hazard = (ld_io) ? !empty || st_awvalid :
+                                 (st_blk_match || |blk_match) && !ld_fwd;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Write requests, issued once the conflicting reads are completed. An
+    // address request already issued is kept until acknowledged, the data
+    // channel never going ahead the address channel
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign awvalid = (aw_ptr != wr_ptr) & (!rd_pending | aw_hold);
+    assign awaddr = addr[aw_ptr[PTR_W-1:0]];
+    assign awprot = prot[aw_ptr[PTR_W-1:0]];
+    assign awcache = cache[aw_ptr[PTR_W-1:0]];
+
+    assign wvalid = !w_ahead & ((w_ptr != aw_ptr) | awvalid);
+    assign wdata = data[w_ptr[PTR_W-1:0]];
+    assign wstrb = strb[w_ptr[PTR_W-1:0]];
+
+endmodule
+
+`resetall
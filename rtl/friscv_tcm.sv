@@ -0,0 +1,339 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Tightly-coupled memory
+//
+// - a RAM mapped at [TCM_BASE, TCM_BASE+TCM_SIZE[, placed between a core
+//   unit (control or memfy) and its cache stage
+// - the requests hitting the range are served by the RAM, the read data
+//   being returned the cycle after the address, a write being completed the
+//   cycle after its address and data have been received together. The
+//   others are passed as is to the master interface
+// - the responses are returned in-order: the target switches from one side
+//   to the other only once the requests issued to the previous one have been
+//   completed
+// - a flush drops the outstanding reads, along the cache stage dropping the
+//   ones it accepted
+// - the RAM can be loaded with a hex file for FPGA init or simulation
+//
+///////////////////////////////////////////////////////////////////////////////
+
+module friscv_tcm
+
+    #(
+        // RISCV Architecture, the RAM width
+        parameter XLEN = 32,
+        // Address bus width defined for both control and AXI4 address signals
+        parameter AXI_ADDR_W = 32,
+        // AXI ID width, setup by default to 8 and unused
+        parameter AXI_ID_W = 8,
+        // Base address of the memory, aligned on its size
+        parameter TCM_BASE = 0,
+        // Size of the memory in bytes, a power of two
+        parameter TCM_SIZE = 16384,
+        // File to init the memory with, one XLEN word per line
+        parameter INIT_FILE = ""
+    )(
+        // Global interface
+        input  wire                       aclk,
+        input  wire                       aresetn,
+        input  wire                       srst,
+        // Drop the outstanding reads, no read being accepted meanwhile
+        input  wire                       flush,
+
+        // Slave interface from the core unit
+        input  wire                       s_awvalid,
+        output logic                      s_awready,
+        input  wire  [AXI_ADDR_W    -1:0] s_awaddr,
+        input  wire  [3             -1:0] s_awprot,
+        input  wire  [4             -1:0] s_awcache,
+        input  wire  [AXI_ID_W      -1:0] s_awid,
+        input  wire                       s_wvalid,
+        output logic                      s_wready,
+        input  wire  [XLEN          -1:0] s_wdata,
+        input  wire  [XLEN/8        -1:0] s_wstrb,
+        output logic                      s_bvalid,
+        input  wire                       s_bready,
+        output logic [AXI_ID_W      -1:0] s_bid,
+        output logic [2             -1:0] s_bresp,
+        input  wire                       s_arvalid,
+        output logic                      s_arready,
+        input  wire  [AXI_ADDR_W    -1:0] s_araddr,
+        input  wire  [3             -1:0] s_arprot,
+        input  wire  [4             -1:0] s_arcache,
+        input  wire  [AXI_ID_W      -1:0] s_arid,
+        output logic                      s_rvalid,
+        input  wire                       s_rready,
+        output logic [AXI_ID_W      -1:0] s_rid,
+        output logic [2             -1:0] s_rresp,
+        output logic [XLEN          -1:0] s_rdata,
+
+        // Master interface to the cache stage
+        output logic                      m_awvalid,
+        input  wire                       m_awready,
+        output logic [AXI_ADDR_W    -1:0] m_awaddr,
+        output logic [3             -1:0] m_awprot,
+        output logic [4             -1:0] m_awcache,
+        output logic [AXI_ID_W      -1:0] m_awid,
+        output logic                      m_wvalid,
+        input  wire                       m_wready,
+        output logic [XLEN          -1:0] m_wdata,
+        output logic [XLEN/8        -1:0] m_wstrb,
+        input  wire                       m_bvalid,
+        output logic                      m_bready,
+        input  wire  [AXI_ID_W      -1:0] m_bid,
+        input  wire  [2             -1:0] m_bresp,
+        output logic                      m_arvalid,
+        input  wire                       m_arready,
+        output logic [AXI_ADDR_W    -1:0] m_araddr,
+        output logic [3             -1:0] m_arprot,
+        output logic [4             -1:0] m_arcache,
+        output logic [AXI_ID_W      -1:0] m_arid,
+        input  wire                       m_rvalid,
+        output logic                      m_rready,
+        input  wire  [AXI_ID_W      -1:0] m_rid,
+        input  wire  [2             -1:0] m_rresp,
+        input  wire  [XLEN          -1:0] m_rdata
+    );
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    // Parameters and variables declarations
+    //
+    ///////////////////////////////////////////////////////////////////////////
+
+    // Lowest part of the address selecting a byte in a word
+    localparam WORD_LSB_W = $clog2(XLEN/8);
+    // Address part selecting a word in the memory, and base of the range
+    localparam TCM_MSB = $clog2(TCM_SIZE);
+    localparam RAM_ADDR_W = TCM_MSB - WORD_LSB_W;
+    localparam [AXI_ADDR_W-1:0] TCM_BASE_A = TCM_BASE;
+
+    // Width of the outstanding requests counters
+    localparam OSTD_W = 8;
+
+    // Current target of the read and write channels, 1 = TCM
+    logic                       rd_tgt;
+    logic                       wr_tgt;
+    logic [OSTD_W         -1:0] r_ostd;
+    logic [OSTD_W         -1:0] b_ostd;
+    // Write addresses passed to the master minus write data passed, negative
+    // if the data has been passed before its address
+    logic signed [OSTD_W  -1:0] aw_w_bal;
+
+    logic                       ar_hit;
+    logic                       aw_hit;
+    logic                       ar_ok;
+    logic                       wr_ok;
+    logic                       w_to_mst;
+
+    logic                       tcm_rd;
+    logic                       tcm_wr;
+    logic                       tcm_rvalid;
+    logic                       tcm_rfresh;
+    logic [AXI_ID_W       -1:0] tcm_rid;
+    logic [XLEN           -1:0] tcm_rdata;
+    logic [XLEN           -1:0] tcm_rdata_q;
+    logic                       tcm_bvalid;
+    logic [AXI_ID_W       -1:0] tcm_bid;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Read channels
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign ar_hit = s_araddr[AXI_ADDR_W-1:TCM_MSB] == TCM_BASE_A[AXI_ADDR_W-1:TCM_MSB];
+
+    // A request to the other target waits for the current one to be drained
+    assign ar_ok = (ar_hit == rd_tgt) || (r_ostd == '0);
+
+    // The memory accepts a new read while its response slot is free or
+    // being released
+    assign tcm_rd = s_arvalid & ar_hit & ar_ok & (!tcm_rvalid | s_rready) & !flush;
+
+    assign s_arready = (flush)  ? 1'b0 :
+                       (ar_hit) ? ar_ok & (!tcm_rvalid | s_rready) :
+                                  ar_ok & m_arready;
+
+    assign m_arvalid = s_arvalid & !ar_hit & ar_ok & !flush;
+    assign m_araddr = s_araddr;
+    assign m_arprot = s_arprot;
+    assign m_arcache = s_arcache;
+    assign m_arid = s_arid;
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            rd_tgt <= 1'b0;
+            r_ostd <= '0;
+            tcm_rvalid <= 1'b0;
+            tcm_rfresh <= 1'b0;
+            tcm_rid <= '0;
+            tcm_rdata_q <= '0;
+        end else if (srst) begin
+            rd_tgt <= 1'b0;
+            r_ostd <= '0;
+            tcm_rvalid <= 1'b0;
+            tcm_rfresh <= 1'b0;
+            tcm_rid <= '0;
+            tcm_rdata_q <= '0;
+        end else if (flush) begin
+            rd_tgt <= 1'b0;
+            r_ostd <= '0;
+            tcm_rvalid <= 1'b0;
+            tcm_rfresh <= 1'b0;
+        end else begin
+
+            if (s_arvalid && ar_ok) begin
+                rd_tgt <= ar_hit;
+            end
+
+            // A completion of a read dropped by a flush isn't counted
+            if ((s_arvalid && s_arready) && !(s_rvalid && s_rready)) begin
+                r_ostd <= r_ostd + 1'b1;
+            end else if (!(s_arvalid && s_arready) && (s_rvalid && s_rready) &&
+                         r_ostd != '0) begin
+                r_ostd <= r_ostd - 1'b1;
+            end
+
+            if (tcm_rd) begin
+                tcm_rvalid <= 1'b1;
+                tcm_rid <= s_arid;
+            end else if (s_rready) begin
+                tcm_rvalid <= 1'b0;
+            end
+
+            // The RAM output is valid the cycle after the read, then kept
+            // aside while the response is not accepted
+            tcm_rfresh <= tcm_rd;
+
+            if (tcm_rfresh) begin
+                tcm_rdata_q <= tcm_rdata;
+            end
+        end
+    end
+
+    assign s_rvalid = (rd_tgt) ? tcm_rvalid : m_rvalid;
+    assign s_rid = (rd_tgt) ? tcm_rid : m_rid;
+    assign s_rresp = (rd_tgt) ? 2'b00 : m_rresp;
+    assign s_rdata = (!rd_tgt) ? m_rdata :
+                     (tcm_rfresh) ? tcm_rdata : tcm_rdata_q;
+
+    assign m_rready = s_rready & !rd_tgt;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Write channels
+    ///////////////////////////////////////////////////////////////////////////
+
+    assign aw_hit = s_awaddr[AXI_ADDR_W-1:TCM_MSB] == TCM_BASE_A[AXI_ADDR_W-1:TCM_MSB];
+
+    // A request to the other target waits for the current one to be drained
+    assign wr_ok = (aw_hit == wr_tgt) || (b_ostd == '0 && aw_w_bal == '0);
+
+    // The data goes to the master if owed to an address already passed, or
+    // along the address presented if targeting the master
+    assign w_to_mst = (aw_w_bal > 0) ||
+                      (aw_w_bal == '0 && s_awvalid && !aw_hit && wr_ok);
+
+    // The memory writes the address and the data together, while the
+    // response slot is free or being released
+    assign tcm_wr = s_awvalid & aw_hit & wr_ok & s_wvalid & (aw_w_bal == '0) &
+                    (!tcm_bvalid | s_bready);
+
+    assign s_awready = (aw_hit) ? wr_ok & s_wvalid & (aw_w_bal == '0) &
+                                  (!tcm_bvalid | s_bready) :
+                                  wr_ok & m_awready;
+
+    assign s_wready = (w_to_mst) ? m_wready : tcm_wr;
+
+    assign m_awvalid = s_awvalid & !aw_hit & wr_ok;
+    assign m_awaddr = s_awaddr;
+    assign m_awprot = s_awprot;
+    assign m_awcache = s_awcache;
+    assign m_awid = s_awid;
+
+    assign m_wvalid = s_wvalid & w_to_mst;
+    assign m_wdata = s_wdata;
+    assign m_wstrb = s_wstrb;
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (!aresetn) begin
+            wr_tgt <= 1'b0;
+            b_ostd <= '0;
+            aw_w_bal <= '0;
+            tcm_bvalid <= 1'b0;
+            tcm_bid <= '0;
+        end else if (srst) begin
+            wr_tgt <= 1'b0;
+            b_ostd <= '0;
+            aw_w_bal <= '0;
+            tcm_bvalid <= 1'b0;
+            tcm_bid <= '0;
+        end else begin
+
+            if (s_awvalid && wr_ok) begin
+                wr_tgt <= aw_hit;
+            end
+
+            if ((s_awvalid && s_awready) && !(s_bvalid && s_bready)) begin
+                b_ostd <= b_ostd + 1'b1;
+            end else if (!(s_awvalid && s_awready) && (s_bvalid && s_bready)) begin
+                b_ostd <= b_ostd - 1'b1;
+            end
+
+            if ((m_awvalid && m_awready) && !(m_wvalid && m_wready)) begin
+                aw_w_bal <= aw_w_bal + 1'b1;
+            end else if (!(m_awvalid && m_awready) && (m_wvalid && m_wready)) begin
+                aw_w_bal <= aw_w_bal - 1'b1;
+            end
+
+            if (tcm_wr) begin
+                tcm_bvalid <= 1'b1;
+                tcm_bid <= s_awid;
+            end else if (s_bready) begin
+                tcm_bvalid <= 1'b0;
+            end
+        end
+    end
+
+    assign s_bvalid = (wr_tgt) ? tcm_bvalid : m_bvalid;
+    assign s_bid = (wr_tgt) ? tcm_bid : m_bid;
+    assign s_bresp = (wr_tgt) ? 2'b00 : m_bresp;
+
+    assign m_bready = s_bready & !wr_tgt;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Memory
+    ///////////////////////////////////////////////////////////////////////////
+
+    friscv_rambe
+    #(
+        .INIT       (0),
+        .INIT_FILE  (INIT_FILE),
+        .ADDR_WIDTH (RAM_ADDR_W),
+        .DATA_WIDTH (XLEN),
+        .FFD_EN     (1)
+    )
+    ram
+    (
+        .aclk     (aclk),
+        .wr_en    (tcm_wr),
+        .wr_be    (s_wstrb),
+        .addr_in  (s_awaddr[WORD_LSB_W+:RAM_ADDR_W]),
+        .data_in  (s_wdata),
+        .addr_out (s_araddr[WORD_LSB_W+:RAM_ADDR_W]),
+        .data_out (tcm_rdata)
+    );
+
+endmodule
+
+`resetall
@@ -20,10 +20,18 @@ read_verilog -sv "$friscv_dir/friscv_csr.sv"
 read_verilog -sv "$friscv_dir/friscv_registers.sv"
 read_verilog -sv "$friscv_dir/friscv_alu.sv"
 read_verilog -sv "$friscv_dir/friscv_control.sv"
+read_verilog -sv "$friscv_dir/friscv_fetch.sv"
+read_verilog -sv "$friscv_dir/friscv_fusion.sv"
+read_verilog -sv "$friscv_dir/friscv_rvc_expander.sv"
+read_verilog -sv "$friscv_dir/friscv_bpred.sv"
 read_verilog -sv "$friscv_dir/friscv_decoder.sv"
 read_verilog -sv "$friscv_dir/friscv_memfy.sv"
+read_verilog -sv "$friscv_dir/friscv_store_buffer.sv"
+read_verilog -sv "$friscv_dir/friscv_tcm.sv"
+read_verilog -sv "$friscv_dir/friscv_addr_tracker.sv"
 read_verilog -sv "$friscv_dir/friscv_processing.sv"
 read_verilog -sv "$friscv_dir/friscv_bus_perf.sv"
+read_verilog -sv "$friscv_dir/friscv_event_perf.sv"
 read_verilog -sv "$friscv_dir/friscv_scfifo.sv"
 read_verilog -sv "$friscv_dir/friscv_ram.sv"
 read_verilog -sv "$friscv_dir/friscv_rambe.sv"
@@ -34,8 +42,10 @@ read_verilog -sv "$friscv_dir/friscv_cache_block_fetcher.sv"
 read_verilog -sv "$friscv_dir/friscv_cache_prefetcher.sv"
 read_verilog -sv "$friscv_dir/friscv_cache_ooo_mgt.sv"
 read_verilog -sv "$friscv_dir/friscv_cache_pusher.sv"
+read_verilog -sv "$friscv_dir/friscv_cache_evict_buffer.sv"
 read_verilog -sv "$friscv_dir/friscv_cache_flusher.sv"
 read_verilog -sv "$friscv_dir/friscv_cache_blocks.sv"
+read_verilog -sv "$friscv_dir/friscv_cache_victim.sv"
 read_verilog -sv "$friscv_dir/friscv_cache_memctrl.sv"
 read_verilog -sv "$friscv_dir/friscv_bit_sync.sv"
 read_verilog -sv "$friscv_dir/friscv_checkers.sv"
@@ -48,6 +58,7 @@ read_verilog -sv "$friscv_dir/friscv_pmp_region.sv"
 read_verilog -sv "$friscv_dir/friscv_pulser.sv"
 read_verilog -sv "$friscv_dir/friscv_rv32i_core.sv"
 read_verilog -sv "$friscv_dir/friscv_rv32i_platform.sv"
+read_verilog -sv "$friscv_dir/friscv_l2cache.sv"
 read_verilog -sv "$friscv_dir/friscv_apb_interconnect.sv"
 read_verilog -sv "$friscv_dir/friscv_clint.sv"
 read_verilog -sv "$friscv_dir/friscv_gpios.sv"
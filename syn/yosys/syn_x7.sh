@@ -9,10 +9,18 @@ SRCS="\
 ../../rtl/friscv_registers.sv \
 ../../rtl/friscv_alu.sv \
 ../../rtl/friscv_control.sv \
+../../rtl/friscv_fetch.sv \
+../../rtl/friscv_fusion.sv \
+../../rtl/friscv_rvc_expander.sv \
+../../rtl/friscv_bpred.sv \
 ../../rtl/friscv_decoder.sv \
 ../../rtl/friscv_memfy.sv \
+../../rtl/friscv_store_buffer.sv \
+../../rtl/friscv_tcm.sv \
+../../rtl/friscv_addr_tracker.sv \
 ../../rtl/friscv_processing.sv \
 ../../rtl/friscv_bus_perf.sv \
+../../rtl/friscv_event_perf.sv \
 ../../rtl/friscv_scfifo.sv \
 ../../rtl/friscv_ram.sv \
 ../../rtl/friscv_rambe.sv \
@@ -23,8 +31,10 @@ SRCS="\
 ../../rtl/friscv_cache_block_fetcher.sv \
 ../../rtl/friscv_cache_ooo_mgt.sv \
 ../../rtl/friscv_cache_pusher.sv \
+../../rtl/friscv_cache_evict_buffer.sv \
 ../../rtl/friscv_cache_flusher.sv \
 ../../rtl/friscv_cache_blocks.sv \
+../../rtl/friscv_cache_victim.sv \
 ../../rtl/friscv_cache_memctrl.sv \
 ../../rtl/friscv_bit_sync.sv \
 ../../rtl/friscv_checkers.sv \
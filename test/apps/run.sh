@@ -12,6 +12,8 @@ set -e
 # Variables and setup
 #------------------------------------------------------------------------------
 
+# Default configuration, config_features.cfg enabling the optional features
+# of the core and the L2 cache (use --cfg config_features.cfg)
 cfg_file="config.cfg"
 
 # Disable runtime timeout check for this testbench
@@ -90,10 +92,11 @@ main() {
 
     # Build all applications
     echo "INFO: Compile applications"
+    get_march "$cfg_file"
     for dir in tests/*/; do
         if [ "$dir" != "tests/common/" ]; then
-            echo "INFO: Compile $dir"
-            make -C "$dir" all;
+            echo "INFO: Compile $dir for $MARCH"
+            make -C "$dir" all MARCH="$MARCH";
         fi
     done
 
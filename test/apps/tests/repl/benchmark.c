@@ -17,6 +17,8 @@ int matrix_bench(int max_iterations);
 int printf_bench(int max_iterations);
 int xoshi_bench(int max_iterations);
 int pool_arena_bench(int max_iterations);
+int depchain_bench(int max_iterations);
+int div_bench(int max_iterations);
 
 struct perf {
 	int active_start;
@@ -27,6 +29,11 @@ struct perf {
 	int stall_end;
 };
 
+struct event {
+	int start;
+	int end;
+};
+
 struct meter {
     int cycle_start;
     int cycle_end;
@@ -37,6 +44,18 @@ struct meter {
 	struct perf instreq_perf;
 	struct perf instcpl_perf;
 	struct perf proc_perf;
+	struct event bpred_hit;
+	struct event bpred_miss;
+	struct event dual_issue;
+	struct event fused_pair;
+	struct event icache_miss;
+	struct event icache_hit[4];
+	struct event dcache_miss;
+	struct event dcache_hit[4];
+	struct event dcache_pf_issue;
+	struct event dcache_pf_useful;
+	struct event icache_vc_hit;
+	struct event dcache_vc_hit;
 };
 
 struct meter bench;
@@ -45,10 +64,19 @@ struct meter matrix;
 struct meter print;
 struct meter xoshi;
 struct meter arena;
+struct meter depchain;
+struct meter div_full;
+struct meter div_small;
+struct meter div_pow2;
+struct meter div_overlap;
 
 #define ARENA_SIZE 1024
 #define MAX_CHUNK  8
 
+#define DEPCHAIN_LENGTH 256
+
+#define DIV_OPERANDS 8
+
 // -----------------------------------------------------------------------------------------------
 // Chacha20 global variables
 // -----------------------------------------------------------------------------------------------
@@ -101,6 +129,23 @@ int mtxd[3][3] = {{4,4,4}, {4,4,4}, {4,4,4}};
 
 int c_mult_d[3][3] = {{12,12,12}, {12,12,12}, {12,12,12}};
 
+// -----------------------------------------------------------------------------------------------
+// Division global variables
+// -----------------------------------------------------------------------------------------------
+
+// Full-width dividends, divided by small odd divisors
+int div_full_n[DIV_OPERANDS] = {2147483647, -2147483647, 1999999999, -1234567890,
+                                 987654321, 0x7FFF0001, -0x55555555, 0x12345678};
+int div_full_d[DIV_OPERANDS] = {3, 7, -11, 13, 10, -3, 5, 9};
+
+// Small dividends, like the digits extraction of printf
+int div_small_n[DIV_OPERANDS] = {9, 47, -234, 234, 9876, 65535, -100, 1023};
+int div_small_d[DIV_OPERANDS] = {10, 10, 10, 10, 10, 10, 7, 10};
+
+// Power of two divisors, like the size computation of the pool arena
+int div_pow2_n[DIV_OPERANDS] = {1024, 1000, -1000, 2147483647, 0x12345678, 7, -7, 65536};
+int div_pow2_d[DIV_OPERANDS] = {8, 16, 4, 2, 256, 1, 2, -64};
+
 
 /*  Benchmark function to measure the performance of the core
  *
@@ -136,6 +181,26 @@ int benchmark(int argc, char *argv[]) {
     asm volatile("csrr %0, 0xFC7" : "=r"(bench.proc_perf.sleep_start));
     asm volatile("csrr %0, 0xFC8" : "=r"(bench.proc_perf.stall_start));
 
+    asm volatile("csrr %0, 0xFD0" : "=r"(bench.bpred_hit.start));
+    asm volatile("csrr %0, 0xFD1" : "=r"(bench.bpred_miss.start));
+    asm volatile("csrr %0, 0xFD2" : "=r"(bench.dual_issue.start));
+    asm volatile("csrr %0, 0xFD3" : "=r"(bench.fused_pair.start));
+
+    asm volatile("csrr %0, 0xFD4" : "=r"(bench.icache_miss.start));
+    asm volatile("csrr %0, 0xFD5" : "=r"(bench.icache_hit[0].start));
+    asm volatile("csrr %0, 0xFD6" : "=r"(bench.icache_hit[1].start));
+    asm volatile("csrr %0, 0xFD7" : "=r"(bench.icache_hit[2].start));
+    asm volatile("csrr %0, 0xFD8" : "=r"(bench.icache_hit[3].start));
+    asm volatile("csrr %0, 0xFD9" : "=r"(bench.dcache_miss.start));
+    asm volatile("csrr %0, 0xFDA" : "=r"(bench.dcache_hit[0].start));
+    asm volatile("csrr %0, 0xFDB" : "=r"(bench.dcache_hit[1].start));
+    asm volatile("csrr %0, 0xFDC" : "=r"(bench.dcache_hit[2].start));
+    asm volatile("csrr %0, 0xFDD" : "=r"(bench.dcache_hit[3].start));
+    asm volatile("csrr %0, 0xFDE" : "=r"(bench.dcache_pf_issue.start));
+    asm volatile("csrr %0, 0xFDF" : "=r"(bench.dcache_pf_useful.start));
+    asm volatile("csrr %0, 0xFE0" : "=r"(bench.icache_vc_hit.start));
+    asm volatile("csrr %0, 0xFE1" : "=r"(bench.dcache_vc_hit.start));
+
     // -----------------------------------------------------------------
     // Execute benchmarks
     // -----------------------------------------------------------------
@@ -165,6 +230,16 @@ int benchmark(int argc, char *argv[]) {
         printf("Pool Arena computation failed\n");
     }
 
+    if (depchain_bench(nb_iterations)) {
+        ret += 1;
+        printf("Dependency chains computation failed\n");
+    }
+
+    if (div_bench(nb_iterations)) {
+        ret += 1;
+        printf("Division computation failed\n");
+    }
+
     asm volatile("csrr %0, 0xC00" : "=r"(bench.cycle_end));
     asm volatile("csrr %0, 0xC02" : "=r"(bench.instret_end));
 
@@ -180,6 +255,26 @@ int benchmark(int argc, char *argv[]) {
     asm volatile("csrr %0, 0xFC7" : "=r"(bench.proc_perf.sleep_end));
     asm volatile("csrr %0, 0xFC8" : "=r"(bench.proc_perf.stall_end));
 
+    asm volatile("csrr %0, 0xFD0" : "=r"(bench.bpred_hit.end));
+    asm volatile("csrr %0, 0xFD1" : "=r"(bench.bpred_miss.end));
+    asm volatile("csrr %0, 0xFD2" : "=r"(bench.dual_issue.end));
+    asm volatile("csrr %0, 0xFD3" : "=r"(bench.fused_pair.end));
+
+    asm volatile("csrr %0, 0xFD4" : "=r"(bench.icache_miss.end));
+    asm volatile("csrr %0, 0xFD5" : "=r"(bench.icache_hit[0].end));
+    asm volatile("csrr %0, 0xFD6" : "=r"(bench.icache_hit[1].end));
+    asm volatile("csrr %0, 0xFD7" : "=r"(bench.icache_hit[2].end));
+    asm volatile("csrr %0, 0xFD8" : "=r"(bench.icache_hit[3].end));
+    asm volatile("csrr %0, 0xFD9" : "=r"(bench.dcache_miss.end));
+    asm volatile("csrr %0, 0xFDA" : "=r"(bench.dcache_hit[0].end));
+    asm volatile("csrr %0, 0xFDB" : "=r"(bench.dcache_hit[1].end));
+    asm volatile("csrr %0, 0xFDC" : "=r"(bench.dcache_hit[2].end));
+    asm volatile("csrr %0, 0xFDD" : "=r"(bench.dcache_hit[3].end));
+    asm volatile("csrr %0, 0xFDE" : "=r"(bench.dcache_pf_issue.end));
+    asm volatile("csrr %0, 0xFDF" : "=r"(bench.dcache_pf_useful.end));
+    asm volatile("csrr %0, 0xFE0" : "=r"(bench.icache_vc_hit.end));
+    asm volatile("csrr %0, 0xFE1" : "=r"(bench.dcache_vc_hit.end));
+
 
     bench.cycles = bench.cycle_end - bench.cycle_start;
     bench.instret = bench.instret_end - bench.instret_start;
@@ -197,6 +292,8 @@ int benchmark(int argc, char *argv[]) {
     printf("  - Instret start: %d\n", bench.instret_start);
     printf("  - Instret end: %d\n", bench.instret_end);
     printf("  - Retired instructions: %d\n", bench.instret);
+    if (bench.instret)
+        printf("  - CPI (x100): %d\n", (bench.cycles * 100) / bench.instret);
 
 	printf("\nInstruction Bus Request:\n");
 	printf("  - active cycles: %d\n", bench.instreq_perf.active_end - bench.instreq_perf.active_start);
@@ -213,12 +310,49 @@ int benchmark(int argc, char *argv[]) {
 	printf("  - sleep cycles: %d\n", bench.proc_perf.sleep_end - bench.proc_perf.sleep_start);
 	printf("  - stall cycles: %d\n", bench.proc_perf.stall_end - bench.proc_perf.stall_start);
 
+	printf("\nBranch Prediction:\n");
+	printf("  - hits: %d\n", bench.bpred_hit.end - bench.bpred_hit.start);
+	printf("  - misses: %d\n", bench.bpred_miss.end - bench.bpred_miss.start);
+
+	printf("\nDual-Issue:\n");
+	printf("  - paired instructions: %d\n", bench.dual_issue.end - bench.dual_issue.start);
+
+	printf("\nMacro-Op Fusion:\n");
+	printf("  - fused pairs: %d\n", bench.fused_pair.end - bench.fused_pair.start);
+
+	printf("\nInstruction Cache:\n");
+	printf("  - misses: %d\n", bench.icache_miss.end - bench.icache_miss.start);
+	for (int i=0; i<4; i++)
+		printf("  - hits way %d: %d\n", i, bench.icache_hit[i].end - bench.icache_hit[i].start);
+	printf("  - victim hits: %d\n", bench.icache_vc_hit.end - bench.icache_vc_hit.start);
+
+	printf("\nData Cache:\n");
+	printf("  - misses: %d\n", bench.dcache_miss.end - bench.dcache_miss.start);
+	for (int i=0; i<4; i++)
+		printf("  - hits way %d: %d\n", i, bench.dcache_hit[i].end - bench.dcache_hit[i].start);
+	printf("  - victim hits: %d\n", bench.dcache_vc_hit.end - bench.dcache_vc_hit.start);
+
+	int pf_issue = bench.dcache_pf_issue.end - bench.dcache_pf_issue.start;
+	int pf_useful = bench.dcache_pf_useful.end - bench.dcache_pf_useful.start;
+	int dc_miss = bench.dcache_miss.end - bench.dcache_miss.start;
+	printf("  - prefetches issued: %d\n", pf_issue);
+	printf("  - prefetches useful: %d\n", pf_useful);
+	if (pf_issue)
+		printf("  - prefetch accuracy (x100): %d\n", (pf_useful * 100) / pf_issue);
+	if (pf_useful + dc_miss)
+		printf("  - prefetch coverage (x100): %d\n", (pf_useful * 100) / (pf_useful + dc_miss));
+
 	printf("\nAlgorithms:\n");
     printf("- Chacha20 execution: %d cycles\n", chacha20.cycles);
     printf("- Matrix execution: %d cycles\n", matrix.cycles);
     printf("- Printf execution: %d cycles\n", print.cycles);
     printf("- Xoshiro128++ execution: %d cycles\n", xoshi.cycles);
     printf("- Pool Arena execution: %d cycles\n", arena.cycles);
+    printf("- Dependency chains execution: %d cycles\n", depchain.cycles);
+    printf("- Division, full-width dividends: %d cycles\n", div_full.cycles);
+    printf("- Division, small dividends: %d cycles\n", div_small.cycles);
+    printf("- Division, power of two divisors: %d cycles\n", div_pow2.cycles);
+    printf("- Division, overlapped with ALU work: %d cycles\n", div_overlap.cycles);
 
     if (ret)
         ERROR("Benchmark failed\n");
@@ -541,3 +675,143 @@ int pool_arena_bench(int max_iterations) {
 
 	return 0;
 }
+
+
+// Back-to-back dependent instructions, each result being the source of the
+// next instruction, a jump or a branch. Measures the latency between the
+// processing units and the control unit.
+int depchain_bench(int max_iterations) {
+
+    int nb_loop = 0;
+    int ret = 0;
+    int cnt;
+    int one = 1;
+    int data;
+
+    depchain.cycle_start = 0;
+    depchain.cycle_end = 0;
+    depchain.cycles = 0;
+
+    asm volatile("csrr %0, 0xC00" : "=r"(depchain.cycle_start));
+
+    while (nb_loop<max_iterations) {
+
+        // ALU -> branch
+        cnt = DEPCHAIN_LENGTH;
+        asm volatile(
+            "1:\n"
+            "addi %0, %0, -1\n"
+            "bnez %0, 1b\n"
+            : "+r"(cnt));
+        if (cnt)
+            ret += 1;
+
+        // Load -> ALU -> branch
+        data = DEPCHAIN_LENGTH;
+        asm volatile(
+            "1:\n"
+            "lw %0, 0(%1)\n"
+            "addi %0, %0, -1\n"
+            "sw %0, 0(%1)\n"
+            "bnez %0, 1b\n"
+            : "=&r"(cnt) : "r"(&data) : "memory");
+        if (cnt || data)
+            ret += 1;
+
+        // Multiply -> ALU -> branch
+        cnt = DEPCHAIN_LENGTH;
+        asm volatile(
+            "1:\n"
+            "mul %0, %0, %1\n"
+            "addi %0, %0, -1\n"
+            "bnez %0, 1b\n"
+            : "+r"(cnt) : "r"(one));
+        if (cnt)
+            ret += 1;
+
+        nb_loop += 1;
+    }
+
+    asm volatile("csrr %0, 0xC00" : "=r"(depchain.cycle_end));
+
+    depchain.cycles = depchain.cycle_end - depchain.cycle_start;
+
+    return ret;
+}
+
+
+// Divide and compute the remainder of a set of operands, checking the results
+// with a multiplication. The cycles are measured only around the divisions.
+int div_operands(struct meter * m, int * n, int * d, int max_iterations) {
+
+    int ret = 0;
+    int q[DIV_OPERANDS];
+    int r[DIV_OPERANDS];
+    int start;
+    int end;
+
+    m->cycles = 0;
+
+    for (int l=0;l<max_iterations;l++) {
+
+        for (int i=0;i<DIV_OPERANDS;i++) {
+            asm volatile("csrr %0, 0xC00" : "=r"(start));
+            asm volatile(
+                "div %0, %2, %3\n"
+                "rem %1, %2, %3\n"
+                : "=&r"(q[i]), "=&r"(r[i]) : "r"(n[i]), "r"(d[i]));
+            asm volatile("csrr %0, 0xC00" : "=r"(end));
+            m->cycles += end - start;
+        }
+
+        for (int i=0;i<DIV_OPERANDS;i++)
+            if (q[i] * d[i] + r[i] != n[i])
+                ret += 1;
+    }
+
+    return ret;
+}
+
+
+// Integer divisions with different operands profiles, to measure the divider
+// architecture (radix, early termination, power of two shortcut)
+int div_bench(int max_iterations) {
+
+    int ret = 0;
+
+    ret += div_operands(&div_full, div_full_n, div_full_d, max_iterations);
+    ret += div_operands(&div_small, div_small_n, div_small_d, max_iterations);
+    ret += div_operands(&div_pow2, div_pow2_n, div_pow2_d, max_iterations);
+
+    // Divisions followed by independent instructions, hidden by the divider
+    // running in the background if the M extension doesn't block
+    div_overlap.cycles = 0;
+    for (int l=0;l<max_iterations;l++) {
+        for (int i=0;i<DIV_OPERANDS;i++) {
+            int q;
+            int r;
+            int acc = 0;
+            int start;
+            int end;
+            asm volatile("csrr %0, 0xC00" : "=r"(start));
+            asm volatile(
+                "div %0, %3, %4\n"
+                "rem %1, %3, %4\n"
+                "addi %2, %2, 1\n"
+                "addi %2, %2, 2\n"
+                "xori %2, %2, 3\n"
+                "slli %2, %2, 1\n"
+                "addi %2, %2, 4\n"
+                "srli %2, %2, 1\n"
+                "addi %2, %2, 5\n"
+                "andi %2, %2, 255\n"
+                : "=&r"(q), "=&r"(r), "+r"(acc) : "r"(div_full_n[i]), "r"(div_full_d[i]));
+            asm volatile("csrr %0, 0xC00" : "=r"(end));
+            div_overlap.cycles += end - start;
+            if (q * div_full_d[i] + r != div_full_n[i])
+                ret += 1;
+        }
+    }
+
+    return ret;
+}
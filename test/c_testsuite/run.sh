@@ -21,6 +21,24 @@ MIN_PC=65692
 source ../common/functions.sh
 
 
+#------------------------------------------------------------------------------
+# Compile the applications for the architecture a configuration selects
+#------------------------------------------------------------------------------
+compile_tests() {
+
+    echo "INFO: C tests"
+    get_march "$1"
+    set -e
+    for dir in tests/*/; do
+        if [ "$dir" != "tests/common/" ]; then
+            echo "INFO: Compile $dir for $MARCH"
+            make -C "$dir" MARCH="$MARCH";
+        fi
+    done
+    set +e
+}
+
+
 #------------------------------------------------------------------------------
 # Main
 #------------------------------------------------------------------------------
@@ -46,15 +64,7 @@ main() {
 
     # Build all applications
     if [ "$NO_COMPILE" -eq 0 ]; then
-        echo "INFO: C tests"
-        set -e
-        for dir in tests/*/; do
-            if [ "$dir" != "tests/common/" ]; then
-                echo "INFO: Compile $dir"
-                make -C "$dir";
-            fi
-        done
-        set +e
+        compile_tests "$cfg_file"
     fi
 
     # If user specified a testcase, or a testsuite, use it
@@ -64,6 +74,15 @@ main() {
     else
         # Execute the testsuites
         run_testsuite "./tests/*.v" "$cfg_file"
+        # Run again with the compressed extension, the programs being rebuilt
+        # for rv32imc. Force to recompile the testbench with the new setup
+        if [ "$cfg_file" != "config_rvc.cfg" ]; then
+            if [ "$NO_COMPILE" -eq 0 ]; then
+                compile_tests "config_rvc.cfg"
+            fi
+            rm -f rtl.md5
+            run_testsuite "./tests/*.v" "config_rvc.cfg"
+        fi
     fi
 }
 
@@ -0,0 +1,519 @@
+// distributed under the mit license
+// https://opensource.org/licenses/mit-license.php
+
+`timescale 1 ns / 1 ps
+`default_nettype none
+
+///////////////////////////////////////////////////////////////////////////////
+// A simple AXI4 RAM model supporting the bursts, simulation only. Dual port,
+// the first one being read-only, both using the same data width, narrower
+// than a line of the memory.
+//
+// - the reads support the INCR and WRAP bursts, completed with RLAST
+// - the writes support the INCR bursts, the write response being sent once
+//   the beat with WLAST has been written
+// - the transfers always use the full data width, AxSIZE is not parsed
+// - a line of the memory, thus of the init file, is MEM_W bits wide
+///////////////////////////////////////////////////////////////////////////////
+
+module axi4_ram
+
+    #(
+        parameter INIT  = "init.v",
+
+        // Performance or Compliance mode
+        //  - compliance: throttle the read data and write data channels to
+        //    ensure proper back-pressure support
+        //  - performance: complete ASAP a read or write request
+        parameter MODE = "compliance",
+
+        // Seeds used in LSFR, per channel and port
+        parameter P1_RD_DATA_SEED = 32'h986A23CC,
+        parameter P2_RD_DATA_SEED = 32'h4567CCA0,
+        parameter P2_WR_DATA_SEED = 32'h12349876,
+
+        // Address bus width defined for both control and AXI4 address signals
+        parameter AXI_ADDR_W = 8,
+        // AXI ID width, setup by default to 8 and unused
+        parameter AXI_ID_W = 8,
+        // AXI4 data width, shared by both ports
+        parameter AXI_DATA_W = 32,
+        // Width of a memory line, a multiple of AXI_DATA_W
+        parameter MEM_W = 128,
+        // Number of outstanding requests supported
+        parameter OSTDREQ_NUM = 4
+    )(
+        // Global signals
+        input  logic                      aclk,
+        input  logic                      aresetn,
+        input  logic                      srst,
+        // AXI4 read channels interface
+        input  logic                      p1_arvalid,
+        output logic                      p1_arready,
+        input  logic [AXI_ADDR_W    -1:0] p1_araddr,
+        input  logic [8             -1:0] p1_arlen,
+        input  logic [2             -1:0] p1_arburst,
+        input  logic [3             -1:0] p1_arprot,
+        input  logic [AXI_ID_W      -1:0] p1_arid,
+        output logic                      p1_rvalid,
+        input  logic                      p1_rready,
+        output logic [AXI_ID_W      -1:0] p1_rid,
+        output logic [2             -1:0] p1_rresp,
+        output logic [AXI_DATA_W    -1:0] p1_rdata,
+        output logic                      p1_rlast,
+        // AXI4 write channels interface
+        input  logic                      p2_awvalid,
+        output logic                      p2_awready,
+        input  logic [AXI_ADDR_W    -1:0] p2_awaddr,
+        input  logic [8             -1:0] p2_awlen,
+        input  logic [2             -1:0] p2_awburst,
+        input  logic [3             -1:0] p2_awprot,
+        input  logic [AXI_ID_W      -1:0] p2_awid,
+        input  logic                      p2_wvalid,
+        output logic                      p2_wready,
+        input  logic [AXI_DATA_W    -1:0] p2_wdata,
+        input  logic [AXI_DATA_W/8  -1:0] p2_wstrb,
+        input  logic                      p2_wlast,
+        output logic [AXI_ID_W      -1:0] p2_bid,
+        output logic [2             -1:0] p2_bresp,
+        output logic                      p2_bvalid,
+        input  logic                      p2_bready,
+        // AXI4 read channels interface
+        input  logic                      p2_arvalid,
+        output logic                      p2_arready,
+        input  logic [AXI_ADDR_W    -1:0] p2_araddr,
+        input  logic [8             -1:0] p2_arlen,
+        input  logic [2             -1:0] p2_arburst,
+        input  logic [3             -1:0] p2_arprot,
+        input  logic [AXI_ID_W      -1:0] p2_arid,
+        output logic                      p2_rvalid,
+        input  logic                      p2_rready,
+        output logic [AXI_ID_W      -1:0] p2_rid,
+        output logic [2             -1:0] p2_rresp,
+        output logic [AXI_DATA_W    -1:0] p2_rdata,
+        output logic                      p2_rlast
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Parameters and signals declarations
+    ///////////////////////////////////////////////////////////////////////////
+
+    parameter ADDR_LSB_W = $clog2(MEM_W/8);
+    parameter ADDRW = AXI_ADDR_W-ADDR_LSB_W;
+    parameter BEAT_LSB_W = $clog2(AXI_DATA_W/8);
+
+    logic [MEM_W-1:0] mem [2**ADDRW-1:0];
+    integer f;
+
+    initial $readmemh(INIT, mem, 0, 2**ADDRW-1);
+
+    `ifdef TRACE_TB_RAM
+    initial f = $fopen("trace_tb_ram.txt","w");
+    `endif
+
+    logic [AXI_ADDR_W   -1:0] p1_araddr_s;
+    logic [8            -1:0] p1_arlen_s;
+    logic [2            -1:0] p1_arburst_s;
+    logic [AXI_ID_W     -1:0] p1_arid_s;
+    logic                     p1_raddr_full;
+    logic                     p1_raddr_pull;
+    logic                     p1_raddr_empty;
+    logic [8            -1:0] p1_rbeat;
+    logic [AXI_ADDR_W   -1:0] p1_raddr;
+    logic [16           -1:0] p1_rd_position;
+
+    logic [AXI_ADDR_W   -1:0] p2_araddr_s;
+    logic [8            -1:0] p2_arlen_s;
+    logic [2            -1:0] p2_arburst_s;
+    logic [AXI_ID_W     -1:0] p2_arid_s;
+    logic                     p2_raddr_full;
+    logic                     p2_raddr_pull;
+    logic                     p2_raddr_empty;
+    logic [8            -1:0] p2_rbeat;
+    logic [AXI_ADDR_W   -1:0] p2_raddr;
+    logic [16           -1:0] p2_rd_position;
+
+    logic [AXI_ADDR_W   -1:0] p2_awaddr_s;
+    logic [8            -1:0] p2_awlen_s;
+    logic [2            -1:0] p2_awburst_s;
+    logic [AXI_ID_W     -1:0] p2_awid_s;
+    logic                     p2_awaddr_full;
+    logic                     p2_awaddr_empty;
+    logic [AXI_DATA_W   -1:0] p2_wdata_s;
+    logic [AXI_DATA_W/8 -1:0] p2_wstrb_s;
+    logic                     p2_wlast_s;
+    logic                     p2_wdata_full;
+    logic                     p2_wdata_empty;
+    logic                     p2_wbeat_en;
+    logic [8            -1:0] p2_wbeat;
+    logic [AXI_ADDR_W   -1:0] p2_waddr;
+    logic [16           -1:0] p2_wr_position;
+
+    logic [32           -1:0] p1_r_lfsr;
+    logic [32           -1:0] p1_rvalid_lfsr;
+    logic [32           -1:0] p2_r_lfsr;
+    logic [32           -1:0] p2_rvalid_lfsr;
+    logic [32           -1:0] p2_w_lfsr;
+    logic [32           -1:0] p2_wready_lfsr;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Address of a beat of a burst:
+    //  - INCR: the start address aligned on the data width, incremented by
+    //    the data width on each beat
+    //  - WRAP: same than INCR, but wrapping on the boundary of the burst's
+    //    size (the number of beats being 2, 4, 8 or 16)
+    ///////////////////////////////////////////////////////////////////////////
+
+    function automatic logic [AXI_ADDR_W-1:0] beat_addr(
+        input logic [AXI_ADDR_W-1:0] addr,
+        input logic [8         -1:0] len,
+        input logic [2         -1:0] burst,
+        input logic [8         -1:0] beat
+    );
+        logic [AXI_ADDR_W-1:0] start;
+        logic [AXI_ADDR_W-1:0] next;
+        logic [AXI_ADDR_W-1:0] wrap_mask;
+
+        start = {addr[AXI_ADDR_W-1:BEAT_LSB_W], {BEAT_LSB_W{1'b0}}};
+        next = start + (beat << BEAT_LSB_W);
+        wrap_mask = ((len + 1) << BEAT_LSB_W) - 1;
+
+        if (burst==2'b10)
+            beat_addr = (start & ~wrap_mask) | (next & wrap_mask);
+        else
+            beat_addr = next;
+    endfunction
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Read channels Port 1
+    ///////////////////////////////////////////////////////////////////////////
+
+    friscv_scfifo
+    #(
+        .ADDR_WIDTH ($clog2(OSTDREQ_NUM)),
+        .DATA_WIDTH (AXI_ID_W+2+8+AXI_ADDR_W)
+    )
+    p1_archannel_fifo
+    (
+        .aclk     (aclk),
+        .aresetn  (aresetn),
+        .srst     (srst),
+        .flush    (1'b0),
+        .data_in  ({p1_arid, p1_arburst, p1_arlen, p1_araddr}),
+        .push     (p1_arvalid & p1_arready),
+        .full     (p1_raddr_full),
+        .data_out ({p1_arid_s, p1_arburst_s, p1_arlen_s, p1_araddr_s}),
+        .pull     (p1_raddr_pull),
+        .empty    (p1_raddr_empty)
+    );
+
+    assign p1_arready = ~p1_raddr_full;
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (~aresetn) begin
+            p1_rvalid_lfsr <= 32'b0;
+            p1_rbeat <= 8'b0;
+        end else if (srst) begin
+            p1_rvalid_lfsr <= 32'b0;
+            p1_rbeat <= 8'b0;
+        end else begin
+            // At startup init with LFSR default value
+            if (p1_rvalid_lfsr==32'b0) begin
+                p1_rvalid_lfsr <= p1_r_lfsr;
+            // Use to randomly assert rvalid
+            end else if (~p1_rvalid) begin
+                p1_rvalid_lfsr <= p1_rvalid_lfsr >> 1;
+            end else if (p1_rready) begin
+                p1_rvalid_lfsr <= p1_r_lfsr;
+                `ifdef TRACE_TB_RAM
+                $fwrite(f, "(@ %0t) Port 1 - Read  Addr=%x Data=%x Last=%x\n", $realtime, p1_raddr, p1_rdata, p1_rlast);
+                `endif
+            end
+
+            if (p1_rvalid && p1_rready) begin
+                if (p1_rlast) p1_rbeat <= 8'b0;
+                else          p1_rbeat <= p1_rbeat + 1'b1;
+            end
+        end
+    end
+
+    generate if (MODE=="compliance") begin
+
+        lfsr32
+        #(
+            .KEY (P1_RD_DATA_SEED)
+        )
+        p1_rch_lfsr
+        (
+            .aclk    (aclk),
+            .aresetn (aresetn),
+            .srst    (srst),
+            .en      (p1_rvalid & p1_rready),
+            .lfsr    (p1_r_lfsr)
+        );
+
+        assign p1_rvalid = p1_rvalid_lfsr[0] & ~p1_raddr_empty;
+
+    // Performance Mode
+    end else begin
+
+        assign p1_r_lfsr = 32'b0;
+        assign p1_rvalid = ~p1_raddr_empty;
+
+    end
+    endgenerate
+
+    assign p1_raddr = beat_addr(p1_araddr_s, p1_arlen_s, p1_arburst_s, p1_rbeat);
+    assign p1_raddr_pull = p1_rvalid & p1_rready & p1_rlast;
+
+    // Get the position of the beat in the RAM line in bits
+    assign p1_rd_position = (p1_raddr[0+:ADDR_LSB_W]/(AXI_DATA_W/8))*AXI_DATA_W;
+
+    assign p1_rdata = mem[p1_raddr[ADDR_LSB_W+:ADDRW]][p1_rd_position+:AXI_DATA_W];
+    assign p1_rlast = p1_rbeat==p1_arlen_s;
+    assign p1_rid = p1_arid_s;
+    assign p1_rresp = 2'b0;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Read channels Port 2
+    ///////////////////////////////////////////////////////////////////////////
+
+    friscv_scfifo
+    #(
+        .ADDR_WIDTH ($clog2(OSTDREQ_NUM)),
+        .DATA_WIDTH (AXI_ID_W+2+8+AXI_ADDR_W)
+    )
+    p2_archannel_fifo
+    (
+        .aclk     (aclk),
+        .aresetn  (aresetn),
+        .srst     (srst),
+        .flush    (1'b0),
+        .data_in  ({p2_arid, p2_arburst, p2_arlen, p2_araddr}),
+        .push     (p2_arvalid & p2_arready),
+        .full     (p2_raddr_full),
+        .data_out ({p2_arid_s, p2_arburst_s, p2_arlen_s, p2_araddr_s}),
+        .pull     (p2_raddr_pull),
+        .empty    (p2_raddr_empty)
+    );
+
+    assign p2_arready = ~p2_raddr_full;
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (~aresetn) begin
+            p2_rvalid_lfsr <= 32'b0;
+            p2_rbeat <= 8'b0;
+        end else if (srst) begin
+            p2_rvalid_lfsr <= 32'b0;
+            p2_rbeat <= 8'b0;
+        end else begin
+            // At startup init with LFSR default value
+            if (p2_rvalid_lfsr==32'b0) begin
+                p2_rvalid_lfsr <= p2_r_lfsr;
+            // Use to randomly assert rvalid
+            end else if (~p2_rvalid) begin
+                p2_rvalid_lfsr <= p2_rvalid_lfsr >> 1;
+            end else if (p2_rready) begin
+                p2_rvalid_lfsr <= p2_r_lfsr;
+                `ifdef TRACE_TB_RAM
+                $fwrite(f, "(@ %0t) Port 2 - Read  Addr=%x Data=%x Last=%x\n", $realtime, p2_raddr, p2_rdata, p2_rlast);
+                `endif
+            end
+
+            if (p2_rvalid && p2_rready) begin
+                if (p2_rlast) p2_rbeat <= 8'b0;
+                else          p2_rbeat <= p2_rbeat + 1'b1;
+            end
+        end
+    end
+
+    generate if (MODE=="compliance") begin
+
+        lfsr32
+        #(
+            .KEY (P2_RD_DATA_SEED)
+        )
+        p2_rch_lfsr
+        (
+            .aclk    (aclk),
+            .aresetn (aresetn),
+            .srst    (srst),
+            .en      (p2_rvalid & p2_rready),
+            .lfsr    (p2_r_lfsr)
+        );
+
+        assign p2_rvalid = p2_rvalid_lfsr[0] & ~p2_raddr_empty;
+
+    // Performance Mode
+    end else begin
+
+        assign p2_r_lfsr = 32'b0;
+        assign p2_rvalid = ~p2_raddr_empty;
+
+    end
+    endgenerate
+
+    assign p2_raddr = beat_addr(p2_araddr_s, p2_arlen_s, p2_arburst_s, p2_rbeat);
+    assign p2_raddr_pull = p2_rvalid & p2_rready & p2_rlast;
+
+    // Get the position of the beat in the RAM line in bits
+    assign p2_rd_position = (p2_raddr[0+:ADDR_LSB_W]/(AXI_DATA_W/8))*AXI_DATA_W;
+
+    assign p2_rdata = mem[p2_raddr[ADDR_LSB_W+:ADDRW]][p2_rd_position+:AXI_DATA_W];
+    assign p2_rlast = p2_rbeat==p2_arlen_s;
+    assign p2_rid = p2_arid_s;
+    assign p2_rresp = 2'b0;
+
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Write channels Port 2
+    //
+    // A beat is written once both its address and data are available, the
+    // write response of a burst being sent along the last beat
+    ///////////////////////////////////////////////////////////////////////////
+
+    friscv_scfifo
+    #(
+        .ADDR_WIDTH ($clog2(OSTDREQ_NUM)),
+        .DATA_WIDTH (AXI_ID_W+2+8+AXI_ADDR_W)
+    )
+    p2_awchannel_fifo
+    (
+        .aclk     (aclk),
+        .aresetn  (aresetn),
+        .srst     (srst),
+        .flush    (1'b0),
+        .data_in  ({p2_awid, p2_awburst, p2_awlen, p2_awaddr}),
+        .push     (p2_awvalid & p2_awready),
+        .full     (p2_awaddr_full),
+        .data_out ({p2_awid_s, p2_awburst_s, p2_awlen_s, p2_awaddr_s}),
+        .pull     (p2_wbeat_en & p2_wlast_s),
+        .empty    (p2_awaddr_empty)
+    );
+
+    assign p2_awready = ~p2_awaddr_full;
+
+    friscv_scfifo
+    #(
+        .ADDR_WIDTH ($clog2(OSTDREQ_NUM)),
+        .DATA_WIDTH (1+AXI_DATA_W/8+AXI_DATA_W)
+    )
+    p2_wdata_fifo
+    (
+        .aclk     (aclk),
+        .aresetn  (aresetn),
+        .srst     (srst),
+        .flush    (1'b0),
+        .data_in  ({p2_wlast, p2_wstrb, p2_wdata}),
+        .push     (p2_wvalid & p2_wready),
+        .full     (p2_wdata_full),
+        .data_out ({p2_wlast_s, p2_wstrb_s, p2_wdata_s}),
+        .pull     (p2_wbeat_en),
+        .empty    (p2_wdata_empty)
+    );
+
+    generate if (MODE=="compliance") begin
+
+        always @ (posedge aclk or negedge aresetn) begin
+
+            if (~aresetn) begin
+                p2_wready_lfsr <= 32'b0;
+            end else if (srst) begin
+                p2_wready_lfsr <= 32'b0;
+            end else begin
+                // At startup init with LFSR default value
+                if (p2_wready_lfsr==32'b0) begin
+                    p2_wready_lfsr <= p2_w_lfsr;
+                // Use to randomly assert wready
+                end else if (~p2_wready) begin
+                    p2_wready_lfsr <= p2_wready_lfsr >> 1;
+                end else if (p2_wvalid) begin
+                    p2_wready_lfsr <= p2_w_lfsr;
+                end
+            end
+        end
+
+        lfsr32
+        #(
+            .KEY (P2_WR_DATA_SEED)
+        )
+        p2_wch_lfsr
+        (
+            .aclk    (aclk),
+            .aresetn (aresetn),
+            .srst    (srst),
+            .en      (p2_wvalid & p2_wready),
+            .lfsr    (p2_w_lfsr)
+        );
+
+        assign p2_wready = p2_wready_lfsr[0] & ~p2_wdata_full;
+
+    // Performance Mode
+    end else begin
+
+        assign p2_wready = ~p2_wdata_full;
+
+    end
+    endgenerate
+
+    assign p2_wbeat_en = ~p2_awaddr_empty & ~p2_wdata_empty & ~p2_bvalid;
+
+    assign p2_waddr = beat_addr(p2_awaddr_s, p2_awlen_s, p2_awburst_s, p2_wbeat);
+
+    // Get the position of the beat in the RAM line in bits
+    assign p2_wr_position = (p2_waddr[0+:ADDR_LSB_W]/(AXI_DATA_W/8))*AXI_DATA_W;
+
+    always @ (posedge aclk or negedge aresetn) begin
+
+        if (~aresetn) begin
+            p2_wbeat <= 8'b0;
+            p2_bvalid <= 1'b0;
+            p2_bid <= {AXI_ID_W{1'b0}};
+        end else if (srst) begin
+            p2_wbeat <= 8'b0;
+            p2_bvalid <= 1'b0;
+            p2_bid <= {AXI_ID_W{1'b0}};
+        end else begin
+
+            if (p2_bvalid && p2_bready) begin
+                p2_bvalid <= 1'b0;
+            end
+
+            if (p2_wbeat_en) begin
+                if (p2_wlast_s) begin
+                    p2_wbeat <= 8'b0;
+                    p2_bvalid <= 1'b1;
+                    p2_bid <= p2_awid_s;
+                end else begin
+                    p2_wbeat <= p2_wbeat + 1'b1;
+                end
+            end
+        end
+    end
+
+    always @ (posedge aclk) begin
+
+        if (p2_wbeat_en) begin
+
+            `ifdef TRACE_TB_RAM
+            $fwrite(f, "(@ %0t) Port 2 - Write Addr=%x Data=%x Strb=%x Last=%x\n", $realtime, p2_waddr, p2_wdata_s, p2_wstrb_s, p2_wlast_s);
+            `endif
+
+            for (int i=0;i<AXI_DATA_W/8;i++) begin
+                if (p2_wstrb_s[i]) begin
+                    mem[p2_waddr[ADDR_LSB_W+:ADDRW]][(p2_wr_position+i*8)+:8] <= p2_wdata_s[8*i+:8];
+                end
+            end
+        end
+    end
+
+    assign p2_bresp = 2'b0;
+
+endmodule
+
+`resetall
@@ -9,8 +9,13 @@ import sys
 # Read the memory content dropped by the compilation and pack it
 # into a cache line. Can have any number of instructions per line, from 1 to N
 # Print in stdout the boot address detected in the dumped file
+# An offset can be given to only extract the window [offset, offset+length[,
+# used to init the tightly-coupled memories
 
-def main(argv0, in_name, out_name, inst_per_line=4, length=1048576):
+def main(argv0, in_name, out_name, inst_per_line=4, length=1048576, offset=None):
+
+    length = int(length)
+    base = int(offset) if offset is not None else 0
 
     opcodes = []
     bootaddr = ''
@@ -47,8 +52,11 @@ def main(argv0, in_name, out_name, inst_per_line=4, length=1048576):
             # print("Bytecount to append: ", newaddr-bytecount)
             bytecount += (newaddr-bytecount)
 
-    if bytecount < length:
-        opcodes.extend((length-bytecount)*["00"])
+    if bytecount < base+length:
+        opcodes.extend((base+length-bytecount)*["00"])
+
+    if offset is not None:
+        opcodes = opcodes[base:base+length]
 
     instrs = []
     instr = ""
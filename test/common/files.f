@@ -1,13 +1,21 @@
 +incdir+../../rtl+../../dep/svlogger+../../dep/axi-crossbar/rtl
 +define+FRISCV_SIM
 ../common/axi4l_ram.sv
+../common/axi4_ram.sv
 ../common/lfsr.sv
 ../../rtl/friscv_rv32i_core.sv
 ../../rtl/friscv_control.sv
+../../rtl/friscv_fetch.sv
+../../rtl/friscv_fusion.sv
+../../rtl/friscv_rvc_expander.sv
+../../rtl/friscv_bpred.sv
 ../../rtl/friscv_decoder.sv
 ../../rtl/friscv_alu.sv
 ../../rtl/friscv_processing.sv
 ../../rtl/friscv_memfy.sv
+../../rtl/friscv_store_buffer.sv
+../../rtl/friscv_tcm.sv
+../../rtl/friscv_addr_tracker.sv
 ../../rtl/friscv_registers.sv
 ../../rtl/friscv_csr.sv
 ../../rtl/friscv_pulser.sv
@@ -21,13 +29,16 @@
 ../../rtl/friscv_cache_io_fetcher.sv
 ../../rtl/friscv_cache_ooo_mgt.sv
 ../../rtl/friscv_cache_pusher.sv
+../../rtl/friscv_cache_evict_buffer.sv
 ../../rtl/friscv_cache_flusher.sv
 ../../rtl/friscv_axi_or_tracker.sv
 ../../rtl/friscv_cache_blocks.sv
+../../rtl/friscv_cache_victim.sv
 ../../rtl/friscv_cache_memctrl.sv
 ../../rtl/friscv_apb_interconnect.sv
 ../../rtl/friscv_io_subsystem.sv
 ../../rtl/friscv_rv32i_platform.sv
+../../rtl/friscv_l2cache.sv
 ../../rtl/friscv_gpios.sv
 ../../rtl/friscv_clint.sv
 ../../rtl/friscv_bit_sync.sv
@@ -36,6 +47,7 @@
 ../../rtl/friscv_m_ext.sv
 ../../rtl/friscv_div.sv
 ../../rtl/friscv_bus_perf.sv
+../../rtl/friscv_event_perf.sv
 ../../rtl/friscv_mpu.sv
 ../../rtl/friscv_pmp_region.sv
 ../../dep/axi-crossbar/rtl/axicb_checker.sv
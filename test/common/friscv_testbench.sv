@@ -61,6 +61,17 @@ module friscv_testbench(
     `define CACHE_BLOCK_W 128
     `endif
 
+    // Instruction/data buses width of the core, the cache blocks being read
+    // and written with bursts if narrower than a block. Core only
+    `ifndef AXI_MEM_W
+    `define AXI_MEM_W `CACHE_BLOCK_W
+    `endif
+
+    // Read the cache blocks with WRAP bursts, else with INCR bursts
+    `ifndef AXI_WRAP
+    `define AXI_WRAP 0
+    `endif
+
     // Architecture selection: 32 or 64 bits
     `ifndef XLEN
     `define XLEN 32
@@ -80,6 +91,121 @@ module friscv_testbench(
     `define USER_MODE 0
     `endif
 
+    // Dynamic branch predictor in the control unit
+    `ifndef BRANCH_PREDICTOR
+    `define BRANCH_PREDICTOR 0
+    `endif
+
+    // Dual-issue of ALU instructions
+    `ifndef DUAL_ISSUE
+    `define DUAL_ISSUE 0
+    `endif
+
+    // Macro-op fusion of the common instruction pairs
+    `ifndef MACRO_FUSION
+    `define MACRO_FUSION 0
+    `endif
+
+    // Compressed instructions extension support
+    `ifndef C_EXTENSION
+    `define C_EXTENSION 0
+    `endif
+
+    // Integer divider architecture
+    `ifndef DIV_RADIX
+    `define DIV_RADIX 2
+    `endif
+    `ifndef DIV_EARLY_TERM
+    `define DIV_EARLY_TERM 0
+    `endif
+    `ifndef DIV_POW2
+    `define DIV_POW2 0
+    `endif
+
+    // Pipelined multiplier
+    `ifndef MUL_LATENCY
+    `define MUL_LATENCY 1
+    `endif
+
+    // Divisions queued ahead of the divider
+    `ifndef DIV_OSTD_NUM
+    `define DIV_OSTD_NUM 0
+    `endif
+
+    // Cache ways, shared by the instruction & data caches
+    `ifndef CACHE_WAYS
+    `define CACHE_WAYS 1
+    `endif
+
+    // Data cache write policy, write-through by default
+    `ifndef DCACHE_WRITE_BACK
+    `define DCACHE_WRITE_BACK 0
+    `endif
+
+    // Data cache miss status holding registers, blocking on a miss by default
+    `ifndef DCACHE_MSHR_NUM
+    `define DCACHE_MSHR_NUM 0
+    `endif
+
+    // Data cache stride prefetcher, disabled by default
+    `ifndef DCACHE_STRIDE_TABLE
+    `define DCACHE_STRIDE_TABLE 0
+    `endif
+
+    `ifndef DCACHE_PREFETCH_DEGREE
+    `define DCACHE_PREFETCH_DEGREE 1
+    `endif
+
+    // Victim cache entries, shared by the instruction & data caches
+    `ifndef CACHE_VICTIM_NB
+    `define CACHE_VICTIM_NB 0
+    `endif
+
+    // Early restart of the misses, shared by the instruction & data caches
+    `ifndef EARLY_RESTART
+    `define EARLY_RESTART 0
+    `endif
+
+    // Store buffer of the LOAD/STORE unit, disabled by default
+    `ifndef STORE_BUFFER_NB
+    `define STORE_BUFFER_NB 0
+    `endif
+
+    // Misaligned LOAD/STORE served in hardware, trapped by default
+    `ifndef MISALIGNED_HW
+    `define MISALIGNED_HW 0
+    `endif
+
+    // Atomic extension, disabled by default
+    `ifndef A_EXTENSION
+    `define A_EXTENSION 0
+    `endif
+
+    // Tightly-coupled memories, disabled by default
+    `ifndef ITCM_EN
+    `define ITCM_EN 0
+    `endif
+    `ifndef ITCM_BASE
+    `define ITCM_BASE 0
+    `endif
+    `ifndef ITCM_SIZE
+    `define ITCM_SIZE 16384
+    `endif
+    `ifndef DTCM_EN
+    `define DTCM_EN 0
+    `endif
+    `ifndef DTCM_BASE
+    `define DTCM_BASE 65536
+    `endif
+    `ifndef DTCM_SIZE
+    `define DTCM_SIZE 16384
+    `endif
+
+    // Unified L2 cache of the platform, disabled by default
+    `ifndef L2_EN
+    `define L2_EN 0
+    `endif
+
     parameter TB_CHOICE = (`TB_CHOICE==0) ? "CORE" : "PLATFORM";
 
     // Instruction length
@@ -94,6 +220,10 @@ module friscv_testbench(
     parameter INST_OSTDREQ_NUM  = 8;
     // Number of outstanding requests used by the LOAD/STORE unit and dcache
     parameter DATA_OSTDREQ_NUM  = 32;
+    // Number of stores buffered by the LOAD/STORE unit
+    parameter STORE_BUFFER_NB = `STORE_BUFFER_NB;
+    // Serve the misaligned LOAD/STORE in hardware
+    parameter MISALIGNED_HW = `MISALIGNED_HW;
     // MHART ID CSR register
     parameter HART_ID = 0;
 
@@ -101,6 +231,10 @@ module friscv_testbench(
     parameter F_EXTENSION = 0;
     // Multiply/Divide extension support
     parameter M_EXTENSION = 1;
+    // Atomic extension support
+    parameter A_EXTENSION = `A_EXTENSION;
+    // Compressed instructions extension support
+    parameter C_EXTENSION = `C_EXTENSION;
     // Support hypervisor mode
     parameter HYPERVISOR_MODE = 0;
     // Support supervisor mode
@@ -109,6 +243,28 @@ module friscv_testbench(
     parameter USER_MODE = `USER_MODE;
     // Insert a pipeline on instruction bus coming from the controller
     parameter PROCESSING_BUS_PIPELINE = 1;
+    // Enable the dynamic branch predictor (BHT + BTB)
+    parameter BRANCH_PREDICTOR = `BRANCH_PREDICTOR;
+    // Number of entries in the branch history table
+    parameter BHT_DEPTH = 64;
+    // Number of entries in the branch target buffer
+    parameter BTB_DEPTH = 16;
+    // Number of entries in the return address stack
+    parameter RAS_DEPTH = 4;
+    // Issue an ALU instruction along the current processing instruction
+    parameter DUAL_ISSUE = `DUAL_ISSUE;
+    // Execute the common instruction pairs as a single operation
+    parameter MACRO_FUSION = `MACRO_FUSION;
+    // Radix of the divider, 2 or 4
+    parameter DIV_RADIX = `DIV_RADIX;
+    // Skip the leading zeros of the dividend to terminate earlier
+    parameter DIV_EARLY_TERM = `DIV_EARLY_TERM;
+    // Divide by a power of two in a single cycle
+    parameter DIV_POW2 = `DIV_POW2;
+    // Number of cycles to complete a multiplication
+    parameter MUL_LATENCY = `MUL_LATENCY;
+    // Number of divisions queued ahead of the divider
+    parameter DIV_OSTD_NUM = `DIV_OSTD_NUM;
 
     `ifdef MPU_SUPPORT
     // PMP / PMA supported
@@ -184,9 +340,11 @@ module friscv_testbench(
     // AXI4 data width
     parameter AXI_DATA_W = `CACHE_BLOCK_W;
     // AXI4 instruction bus width
-    parameter AXI_IMEM_W = `CACHE_BLOCK_W;
+    parameter AXI_IMEM_W = `AXI_MEM_W;
     // AXI4 data bus width
-    parameter AXI_DMEM_W = `CACHE_BLOCK_W;
+    parameter AXI_DMEM_W = `AXI_MEM_W;
+    // Burst type of the cache block reads
+    parameter AXI_WRAP = `AXI_WRAP;
     // ID used by instruction and data buses
     parameter AXI_IMEM_MASK = 'h80;
     parameter AXI_DMEM_MASK = 'h40;
@@ -201,6 +359,12 @@ module friscv_testbench(
     parameter ICACHE_BLOCK_W = `CACHE_BLOCK_W;
     // Number of blocks in the cache
     parameter ICACHE_DEPTH = 512;
+    // Number of ways
+    parameter ICACHE_WAYS = `CACHE_WAYS;
+    // Victim cache entries
+    parameter ICACHE_VICTIM_NB = `CACHE_VICTIM_NB;
+    // Early restart of the misses
+    parameter ICACHE_EARLY_RESTART = `EARLY_RESTART;
 
     // Enable cache block prefetch
     parameter DCACHE_PREFETCH_EN = 1;
@@ -209,6 +373,33 @@ module friscv_testbench(
     parameter DCACHE_BLOCK_W = `CACHE_BLOCK_W;
     // Number of blocks in the cache
     parameter DCACHE_DEPTH = 512;
+    // Number of ways
+    parameter DCACHE_WAYS = `CACHE_WAYS;
+    // Write policy
+    parameter DCACHE_WRITE_BACK = `DCACHE_WRITE_BACK;
+    // Miss status holding registers
+    parameter DCACHE_MSHR_NUM = `DCACHE_MSHR_NUM;
+    // Stride prefetcher table entries and prefetch degree
+    parameter DCACHE_STRIDE_TABLE = `DCACHE_STRIDE_TABLE;
+    parameter DCACHE_PREFETCH_DEGREE = `DCACHE_PREFETCH_DEGREE;
+    // Victim cache entries
+    parameter DCACHE_VICTIM_NB = `CACHE_VICTIM_NB;
+    // Early restart of the misses
+    parameter DCACHE_EARLY_RESTART = `EARLY_RESTART;
+
+    // Tightly-coupled memories, loaded with the image windows extracted
+    // by the flow
+    parameter ITCM_EN = `ITCM_EN;
+    parameter ITCM_BASE = `ITCM_BASE;
+    parameter ITCM_SIZE = `ITCM_SIZE;
+    parameter ITCM_INIT_FILE = "itcm.v";
+    parameter DTCM_EN = `DTCM_EN;
+    parameter DTCM_BASE = `DTCM_BASE;
+    parameter DTCM_SIZE = `DTCM_SIZE;
+    parameter DTCM_INIT_FILE = "dtcm.v";
+
+    // Unified L2 cache, platform only
+    parameter L2_EN = `L2_EN;
 
     // Timeout used in the testbench to break the simulation
     parameter TIMEOUT = `TIMEOUT;
@@ -259,20 +450,26 @@ module friscv_testbench(
     logic [AXI_ADDR_W    -1:0] imem_araddr;
     logic [3             -1:0] imem_arprot;
     logic [AXI_ID_W      -1:0] imem_arid;
+    logic [8             -1:0] imem_arlen;
+    logic [2             -1:0] imem_arburst;
     logic                      imem_rvalid;
     logic                      imem_rready;
     logic [AXI_ID_W      -1:0] imem_rid;
     logic [2             -1:0] imem_rresp;
     logic [AXI_IMEM_W    -1:0] imem_rdata;
+    logic                      imem_rlast;
     logic                      dmem_awvalid;
     logic                      dmem_awready;
     logic [AXI_ADDR_W    -1:0] dmem_awaddr;
     logic [3             -1:0] dmem_awprot;
     logic [AXI_ID_W      -1:0] dmem_awid;
+    logic [8             -1:0] dmem_awlen;
+    logic [2             -1:0] dmem_awburst;
     logic                      dmem_wvalid;
     logic                      dmem_wready;
     logic [AXI_DMEM_W    -1:0] dmem_wdata;
     logic [AXI_DMEM_W/8  -1:0] dmem_wstrb;
+    logic                      dmem_wlast;
     logic                      dmem_bvalid;
     logic                      dmem_bready;
     logic [AXI_ID_W      -1:0] dmem_bid;
@@ -282,11 +479,14 @@ module friscv_testbench(
     logic [AXI_ADDR_W    -1:0] dmem_araddr;
     logic [3             -1:0] dmem_arprot;
     logic [AXI_ID_W      -1:0] dmem_arid;
+    logic [8             -1:0] dmem_arlen;
+    logic [2             -1:0] dmem_arburst;
     logic                      dmem_rvalid;
     logic                      dmem_rready;
     logic [AXI_ID_W      -1:0] dmem_rid;
     logic [2             -1:0] dmem_rresp;
     logic [AXI_DMEM_W    -1:0] dmem_rdata;
+    logic                      dmem_rlast;
 
     logic                      mem_awvalid;
     logic                      mem_awready;
@@ -401,28 +601,62 @@ module friscv_testbench(
             .BOOT_ADDR                  (BOOT_ADDR),
             .INST_OSTDREQ_NUM           (INST_OSTDREQ_NUM),
             .DATA_OSTDREQ_NUM           (DATA_OSTDREQ_NUM),
+            .STORE_BUFFER_NB            (STORE_BUFFER_NB),
+            .MISALIGNED_HW              (MISALIGNED_HW),
             .HART_ID                    (HART_ID),
             .RV32E                      (RV32E),
             .M_EXTENSION                (M_EXTENSION),
+            .A_EXTENSION                (A_EXTENSION),
+            .C_EXTENSION                (C_EXTENSION),
             .F_EXTENSION                (F_EXTENSION),
             .HYPERVISOR_MODE            (HYPERVISOR_MODE),
             .SUPERVISOR_MODE            (SUPERVISOR_MODE),
             .USER_MODE                  (USER_MODE),
             .PROCESSING_BUS_PIPELINE    (PROCESSING_BUS_PIPELINE),
             .WFI_TW                     (WFI_TW),
+            .BRANCH_PREDICTOR           (BRANCH_PREDICTOR),
+            .BHT_DEPTH                  (BHT_DEPTH),
+            .BTB_DEPTH                  (BTB_DEPTH),
+            .RAS_DEPTH                  (RAS_DEPTH),
+            .DUAL_ISSUE                 (DUAL_ISSUE),
+            .MACRO_FUSION               (MACRO_FUSION),
+            .DIV_RADIX                  (DIV_RADIX),
+            .DIV_EARLY_TERM             (DIV_EARLY_TERM),
+            .DIV_POW2                   (DIV_POW2),
+            .MUL_LATENCY                (MUL_LATENCY),
+            .DIV_OSTD_NUM               (DIV_OSTD_NUM),
             .AXI_ADDR_W                 (AXI_ADDR_W),
             .AXI_ID_W                   (AXI_ID_W),
             .AXI_IMEM_W                 (AXI_IMEM_W),
             .AXI_DMEM_W                 (AXI_DMEM_W),
             .AXI_IMEM_MASK              (AXI_IMEM_MASK),
             .AXI_DMEM_MASK              (AXI_DMEM_MASK),
+            .AXI_WRAP                   (AXI_WRAP),
             .CACHE_EN                   (CACHE_EN),
             .ICACHE_BLOCK_W             (ICACHE_BLOCK_W),
             .ICACHE_PREFETCH_EN         (ICACHE_PREFETCH_EN),
             .ICACHE_DEPTH               (ICACHE_DEPTH),
+            .ICACHE_WAYS                (ICACHE_WAYS),
+            .ICACHE_VICTIM_NB           (ICACHE_VICTIM_NB),
+            .ICACHE_EARLY_RESTART       (ICACHE_EARLY_RESTART),
             .DCACHE_BLOCK_W             (DCACHE_BLOCK_W),
             .DCACHE_PREFETCH_EN         (DCACHE_PREFETCH_EN),
             .DCACHE_DEPTH               (DCACHE_DEPTH),
+            .DCACHE_WAYS                (DCACHE_WAYS),
+            .DCACHE_WRITE_BACK          (DCACHE_WRITE_BACK),
+            .DCACHE_MSHR_NUM            (DCACHE_MSHR_NUM),
+            .DCACHE_STRIDE_TABLE        (DCACHE_STRIDE_TABLE),
+            .DCACHE_PREFETCH_DEGREE     (DCACHE_PREFETCH_DEGREE),
+            .DCACHE_VICTIM_NB           (DCACHE_VICTIM_NB),
+            .DCACHE_EARLY_RESTART       (DCACHE_EARLY_RESTART),
+            .ITCM_EN                    (ITCM_EN),
+            .ITCM_BASE                  (ITCM_BASE),
+            .ITCM_SIZE                  (ITCM_SIZE),
+            .ITCM_INIT_FILE             (ITCM_INIT_FILE),
+            .DTCM_EN                    (DTCM_EN),
+            .DTCM_BASE                  (DTCM_BASE),
+            .DTCM_SIZE                  (DTCM_SIZE),
+            .DTCM_INIT_FILE             (DTCM_INIT_FILE),
             .MPU_SUPPORT                (MPU_SUPPORT),
             .PMPCFG0_INIT               (PMPCFG0_INIT),
             .PMPCFG1_INIT               (PMPCFG1_INIT),
@@ -460,20 +694,28 @@ module friscv_testbench(
             .imem_araddr  (imem_araddr),
             .imem_arprot  (imem_arprot),
             .imem_arid    (imem_arid),
+            .imem_arlen   (imem_arlen),
+            .imem_arsize  (),
+            .imem_arburst (imem_arburst),
             .imem_rvalid  (imem_rvalid),
             .imem_rready  (imem_rready),
             .imem_rid     (imem_rid),
             .imem_rresp   (imem_rresp),
             .imem_rdata   (imem_rdata),
+            .imem_rlast   (imem_rlast),
             .dmem_awvalid (dmem_awvalid),
             .dmem_awready (dmem_awready),
             .dmem_awaddr  (dmem_awaddr),
             .dmem_awprot  (dmem_awprot),
             .dmem_awid    (dmem_awid),
+            .dmem_awlen   (dmem_awlen),
+            .dmem_awsize  (),
+            .dmem_awburst (dmem_awburst),
             .dmem_wvalid  (dmem_wvalid),
             .dmem_wready  (dmem_wready),
             .dmem_wdata   (dmem_wdata),
             .dmem_wstrb   (dmem_wstrb),
+            .dmem_wlast   (dmem_wlast),
             .dmem_bvalid  (dmem_bvalid),
             .dmem_bready  (dmem_bready),
             .dmem_bid     (dmem_bid),
@@ -483,80 +725,158 @@ module friscv_testbench(
             .dmem_araddr  (dmem_araddr),
             .dmem_arprot  (dmem_arprot),
             .dmem_arid    (dmem_arid),
+            .dmem_arlen   (dmem_arlen),
+            .dmem_arsize  (),
+            .dmem_arburst (dmem_arburst),
             .dmem_rvalid  (dmem_rvalid),
             .dmem_rready  (dmem_rready),
             .dmem_rid     (dmem_rid),
             .dmem_rresp   (dmem_rresp),
-            .dmem_rdata   (dmem_rdata)
+            .dmem_rdata   (dmem_rdata),
+            .dmem_rlast   (dmem_rlast)
         );
 
 
-        axi4l_ram
-        #(
-            `ifdef RAM_MODE_PERF
-             .MODE ("performance"),
-            `else
-             .MODE ("compliance"),
-            `endif
-            .INIT             ("test.v"),
-            .AXI_ADDR_W       (AXI_ADDR_W),
-            .AXI_ID_W         (AXI_ID_W),
-            .AXI1_DATA_W      (AXI_IMEM_W),
-            .AXI2_DATA_W      (AXI_DMEM_W),
-            .OSTDREQ_NUM      (INST_OSTDREQ_NUM)
-        )
-        axi4l_ram
-        (
-            .aclk       (aclk        ),
-            .aresetn    (aresetn     ),
-            .srst       (srst        ),
-            .p1_awvalid (imem_awvalid),
-            .p1_awready (imem_awready),
-            .p1_awaddr  (imem_awaddr ),
-            .p1_awprot  (imem_awprot ),
-            .p1_awid    (imem_awid   ),
-            .p1_wvalid  (imem_wvalid ),
-            .p1_wready  (imem_wready ),
-            .p1_wdata   (imem_wdata  ),
-            .p1_wstrb   (imem_wstrb  ),
-            .p1_bid     (imem_bid    ),
-            .p1_bresp   (imem_bresp  ),
-            .p1_bvalid  (imem_bvalid ),
-            .p1_bready  (imem_bready ),
-            .p1_arvalid (imem_arvalid),
-            .p1_arready (imem_arready),
-            .p1_araddr  (imem_araddr ),
-            .p1_arprot  (imem_arprot ),
-            .p1_arid    (imem_arid   ),
-            .p1_rvalid  (imem_rvalid ),
-            .p1_rready  (imem_rready ),
-            .p1_rid     (imem_rid    ),
-            .p1_rresp   (imem_rresp  ),
-            .p1_rdata   (imem_rdata  ),
-            .p2_awvalid (dmem_awvalid),
-            .p2_awready (dmem_awready),
-            .p2_awaddr  (dmem_awaddr ),
-            .p2_awprot  (dmem_awprot ),
-            .p2_awid    (dmem_awid   ),
-            .p2_wvalid  (dmem_wvalid ),
-            .p2_wready  (dmem_wready ),
-            .p2_wdata   (dmem_wdata  ),
-            .p2_wstrb   (dmem_wstrb  ),
-            .p2_bid     (dmem_bid    ),
-            .p2_bresp   (dmem_bresp  ),
-            .p2_bvalid  (dmem_bvalid ),
-            .p2_bready  (dmem_bready ),
-            .p2_arvalid (dmem_arvalid),
-            .p2_arready (dmem_arready),
-            .p2_araddr  (dmem_araddr ),
-            .p2_arprot  (dmem_arprot ),
-            .p2_arid    (dmem_arid   ),
-            .p2_rvalid  (dmem_rvalid ),
-            .p2_rready  (dmem_rready ),
-            .p2_rid     (dmem_rid    ),
-            .p2_rresp   (dmem_rresp  ),
-            .p2_rdata   (dmem_rdata  )
-        );
+        // A block is read or written with a burst if the buses are narrower
+        if (CACHE_EN && AXI_IMEM_W<ICACHE_BLOCK_W) begin: BURST_RAM
+
+            axi4_ram
+            #(
+                `ifdef RAM_MODE_PERF
+                 .MODE ("performance"),
+                `else
+                 .MODE ("compliance"),
+                `endif
+                .INIT             ("test.v"),
+                .AXI_ADDR_W       (AXI_ADDR_W),
+                .AXI_ID_W         (AXI_ID_W),
+                .AXI_DATA_W       (AXI_IMEM_W),
+                .MEM_W            (ICACHE_BLOCK_W),
+                .OSTDREQ_NUM      (INST_OSTDREQ_NUM)
+            )
+            axi4_ram
+            (
+                .aclk       (aclk        ),
+                .aresetn    (aresetn     ),
+                .srst       (srst        ),
+                .p1_arvalid (imem_arvalid),
+                .p1_arready (imem_arready),
+                .p1_araddr  (imem_araddr ),
+                .p1_arlen   (imem_arlen  ),
+                .p1_arburst (imem_arburst),
+                .p1_arprot  (imem_arprot ),
+                .p1_arid    (imem_arid   ),
+                .p1_rvalid  (imem_rvalid ),
+                .p1_rready  (imem_rready ),
+                .p1_rid     (imem_rid    ),
+                .p1_rresp   (imem_rresp  ),
+                .p1_rdata   (imem_rdata  ),
+                .p1_rlast   (imem_rlast  ),
+                .p2_awvalid (dmem_awvalid),
+                .p2_awready (dmem_awready),
+                .p2_awaddr  (dmem_awaddr ),
+                .p2_awlen   (dmem_awlen  ),
+                .p2_awburst (dmem_awburst),
+                .p2_awprot  (dmem_awprot ),
+                .p2_awid    (dmem_awid   ),
+                .p2_wvalid  (dmem_wvalid ),
+                .p2_wready  (dmem_wready ),
+                .p2_wdata   (dmem_wdata  ),
+                .p2_wstrb   (dmem_wstrb  ),
+                .p2_wlast   (dmem_wlast  ),
+                .p2_bid     (dmem_bid    ),
+                .p2_bresp   (dmem_bresp  ),
+                .p2_bvalid  (dmem_bvalid ),
+                .p2_bready  (dmem_bready ),
+                .p2_arvalid (dmem_arvalid),
+                .p2_arready (dmem_arready),
+                .p2_araddr  (dmem_araddr ),
+                .p2_arlen   (dmem_arlen  ),
+                .p2_arburst (dmem_arburst),
+                .p2_arprot  (dmem_arprot ),
+                .p2_arid    (dmem_arid   ),
+                .p2_rvalid  (dmem_rvalid ),
+                .p2_rready  (dmem_rready ),
+                .p2_rid     (dmem_rid    ),
+                .p2_rresp   (dmem_rresp  ),
+                .p2_rdata   (dmem_rdata  ),
+                .p2_rlast   (dmem_rlast  )
+            );
+
+        end else begin: SINGLE_BEAT_RAM
+
+            // A block is a single beat
+            assign imem_rlast = 1'b1;
+            assign dmem_rlast = 1'b1;
+
+            axi4l_ram
+            #(
+                `ifdef RAM_MODE_PERF
+                 .MODE ("performance"),
+                `else
+                 .MODE ("compliance"),
+                `endif
+                .INIT             ("test.v"),
+                .AXI_ADDR_W       (AXI_ADDR_W),
+                .AXI_ID_W         (AXI_ID_W),
+                .AXI1_DATA_W      (AXI_IMEM_W),
+                .AXI2_DATA_W      (AXI_DMEM_W),
+                .OSTDREQ_NUM      (INST_OSTDREQ_NUM)
+            )
+            axi4l_ram
+            (
+                .aclk       (aclk        ),
+                .aresetn    (aresetn     ),
+                .srst       (srst        ),
+                .p1_awvalid (imem_awvalid),
+                .p1_awready (imem_awready),
+                .p1_awaddr  (imem_awaddr ),
+                .p1_awprot  (imem_awprot ),
+                .p1_awid    (imem_awid   ),
+                .p1_wvalid  (imem_wvalid ),
+                .p1_wready  (imem_wready ),
+                .p1_wdata   (imem_wdata  ),
+                .p1_wstrb   (imem_wstrb  ),
+                .p1_bid     (imem_bid    ),
+                .p1_bresp   (imem_bresp  ),
+                .p1_bvalid  (imem_bvalid ),
+                .p1_bready  (imem_bready ),
+                .p1_arvalid (imem_arvalid),
+                .p1_arready (imem_arready),
+                .p1_araddr  (imem_araddr ),
+                .p1_arprot  (imem_arprot ),
+                .p1_arid    (imem_arid   ),
+                .p1_rvalid  (imem_rvalid ),
+                .p1_rready  (imem_rready ),
+                .p1_rid     (imem_rid    ),
+                .p1_rresp   (imem_rresp  ),
+                .p1_rdata   (imem_rdata  ),
+                .p2_awvalid (dmem_awvalid),
+                .p2_awready (dmem_awready),
+                .p2_awaddr  (dmem_awaddr ),
+                .p2_awprot  (dmem_awprot ),
+                .p2_awid    (dmem_awid   ),
+                .p2_wvalid  (dmem_wvalid ),
+                .p2_wready  (dmem_wready ),
+                .p2_wdata   (dmem_wdata  ),
+                .p2_wstrb   (dmem_wstrb  ),
+                .p2_bid     (dmem_bid    ),
+                .p2_bresp   (dmem_bresp  ),
+                .p2_bvalid  (dmem_bvalid ),
+                .p2_bready  (dmem_bready ),
+                .p2_arvalid (dmem_arvalid),
+                .p2_arready (dmem_arready),
+                .p2_araddr  (dmem_araddr ),
+                .p2_arprot  (dmem_arprot ),
+                .p2_arid    (dmem_arid   ),
+                .p2_rvalid  (dmem_rvalid ),
+                .p2_rready  (dmem_rready ),
+                .p2_rid     (dmem_rid    ),
+                .p2_rresp   (dmem_rresp  ),
+                .p2_rdata   (dmem_rdata  )
+            );
+
+        end
 
     end else if (TB_CHOICE=="PLATFORM") begin
 
@@ -611,27 +931,62 @@ module friscv_testbench(
             .BOOT_ADDR                  (BOOT_ADDR),
             .INST_OSTDREQ_NUM           (INST_OSTDREQ_NUM),
             .DATA_OSTDREQ_NUM           (DATA_OSTDREQ_NUM),
+            .STORE_BUFFER_NB            (STORE_BUFFER_NB),
+            .MISALIGNED_HW              (MISALIGNED_HW),
             .HART_ID                    (HART_ID),
             .RV32E                      (RV32E),
             .M_EXTENSION                (M_EXTENSION),
+            .A_EXTENSION                (A_EXTENSION),
+            .C_EXTENSION                (C_EXTENSION),
             .F_EXTENSION                (F_EXTENSION),
             .HYPERVISOR_MODE            (HYPERVISOR_MODE),
             .SUPERVISOR_MODE            (SUPERVISOR_MODE),
             .USER_MODE                  (USER_MODE),
             .PROCESSING_BUS_PIPELINE    (PROCESSING_BUS_PIPELINE),
             .WFI_TW                     (WFI_TW),
+            .BRANCH_PREDICTOR           (BRANCH_PREDICTOR),
+            .BHT_DEPTH                  (BHT_DEPTH),
+            .BTB_DEPTH                  (BTB_DEPTH),
+            .RAS_DEPTH                  (RAS_DEPTH),
+            .DUAL_ISSUE                 (DUAL_ISSUE),
+            .MACRO_FUSION               (MACRO_FUSION),
+            .DIV_RADIX                  (DIV_RADIX),
+            .DIV_EARLY_TERM             (DIV_EARLY_TERM),
+            .DIV_POW2                   (DIV_POW2),
+            .MUL_LATENCY                (MUL_LATENCY),
+            .DIV_OSTD_NUM               (DIV_OSTD_NUM),
             .AXI_ADDR_W                 (AXI_ADDR_W),
             .AXI_ID_W                   (AXI_ID_W),
             .AXI_DATA_W                 (AXI_DATA_W),
             .AXI_IMEM_MASK              (AXI_IMEM_MASK),
             .AXI_DMEM_MASK              (AXI_DMEM_MASK),
+            .AXI_WRAP                   (AXI_WRAP),
             .CACHE_EN                   (CACHE_EN),
             .ICACHE_PREFETCH_EN         (ICACHE_PREFETCH_EN),
             .ICACHE_BLOCK_W             (ICACHE_BLOCK_W),
             .ICACHE_DEPTH               (ICACHE_DEPTH),
+            .ICACHE_WAYS                (ICACHE_WAYS),
+            .ICACHE_VICTIM_NB           (ICACHE_VICTIM_NB),
+            .ICACHE_EARLY_RESTART       (ICACHE_EARLY_RESTART),
             .DCACHE_BLOCK_W             (DCACHE_BLOCK_W),
             .DCACHE_PREFETCH_EN         (DCACHE_PREFETCH_EN),
             .DCACHE_DEPTH               (DCACHE_DEPTH),
+            .DCACHE_WAYS                (DCACHE_WAYS),
+            .DCACHE_WRITE_BACK          (DCACHE_WRITE_BACK),
+            .DCACHE_MSHR_NUM            (DCACHE_MSHR_NUM),
+            .DCACHE_STRIDE_TABLE        (DCACHE_STRIDE_TABLE),
+            .DCACHE_PREFETCH_DEGREE     (DCACHE_PREFETCH_DEGREE),
+            .DCACHE_VICTIM_NB           (DCACHE_VICTIM_NB),
+            .DCACHE_EARLY_RESTART       (DCACHE_EARLY_RESTART),
+            .ITCM_EN                    (ITCM_EN),
+            .ITCM_BASE                  (ITCM_BASE),
+            .ITCM_SIZE                  (ITCM_SIZE),
+            .ITCM_INIT_FILE             (ITCM_INIT_FILE),
+            .DTCM_EN                    (DTCM_EN),
+            .DTCM_BASE                  (DTCM_BASE),
+            .DTCM_SIZE                  (DTCM_SIZE),
+            .DTCM_INIT_FILE             (DTCM_INIT_FILE),
+            .L2_EN                      (L2_EN),
             .MPU_SUPPORT                (MPU_SUPPORT),
             .PMPCFG0_INIT               (PMPCFG0_INIT),
             .PMPCFG1_INIT               (PMPCFG1_INIT),
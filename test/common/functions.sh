@@ -72,6 +72,12 @@ read_config() {
 
     cen=0 # cache enable
     cw=32 # cache width
+    ien=0 # ITCM enable
+    iba=0 # ITCM base address
+    isz=16384 # ITCM size
+    den=0 # DTCM enable
+    dba=65536 # DTCM base address
+    dsz=16384 # DTCM size
 
     DEFINES="FRISV_SIM=1;USE_SVL=0;"
 
@@ -79,6 +85,12 @@ read_config() {
         DEFINES="${DEFINES}${name}=${value};"
         [[ "$name" == "CACHE_BLOCK_W" ]] && cw="$value"
         [[ "$name" == "CACHE_EN" ]] && cen="$value"
+        [[ "$name" == "ITCM_EN" ]] && ien="$value"
+        [[ "$name" == "ITCM_BASE" ]] && iba="$value"
+        [[ "$name" == "ITCM_SIZE" ]] && isz="$value"
+        [[ "$name" == "DTCM_EN" ]] && den="$value"
+        [[ "$name" == "DTCM_BASE" ]] && dba="$value"
+        [[ "$name" == "DTCM_SIZE" ]] && dsz="$value"
     done < "$1"
 
     # Compute the number of instruction per line to format in RAM init file for the instruction cache
@@ -86,6 +98,34 @@ read_config() {
 }
 #------------------------------------------------------------------------------
 
+#------------------------------------------------------------------------------
+# Select the architecture the programs are compiled for, the compressed
+# instructions being used if the configuration enables C_EXTENSION. The
+# programs are cleaned if previously compiled for another architecture.
+#------------------------------------------------------------------------------
+get_march() {
+
+    MARCH="rv32im"
+
+    while IFS=, read -r name value; do
+        [[ "$name" == "C_EXTENSION" ]] && [[ "$value" -eq 1 ]] && MARCH="rv32imc"
+    done < "$1"
+
+    prev_march=$(cat tests/.march 2>/dev/null)
+
+    if [[ "${prev_march:-rv32im}" != "$MARCH" ]]; then
+        echo "INFO: Programs compiled for ${prev_march:-rv32im}, clean them to use $MARCH"
+        for dir in tests/*/; do
+            if [ "$dir" != "tests/common/" ]; then
+                make clean -C "$dir"
+            fi
+        done
+        rm -f tests/*.v
+    fi
+    echo "$MARCH" > tests/.march
+}
+#------------------------------------------------------------------------------
+
 #------------------------------------------------------------------------------
 # Clean compiled programs
 #------------------------------------------------------------------------------
@@ -93,6 +133,7 @@ clean() {
     make -C ./tests clean
     rm -fr build
     rm -f ./rv*.*v
+    rm -f ./*tcm.v
     rm -f ./*.vcd
     rm -f ./*.txt
     rm -f ./*.csv
@@ -233,6 +274,10 @@ run_tests() {
         # Grab all defines necessary for testbench & flow setup
         get_defines "$2"
 
+        # Extract the image windows mapped in the TCMs, one word per line
+        [[ "$ien" -eq 1 ]] && ../common/bin2hex.py "$test" itcm.v 1 "$isz" "$iba" > /dev/null
+        [[ "$den" -eq 1 ]] && ../common/bin2hex.py "$test" dtcm.v 1 "$dsz" "$dba" > /dev/null
+
         # Execute the testcase with SVUT
         svutRun -t ./friscv_testbench.sv \
                 -define "$DEFINES" \
@@ -281,6 +326,7 @@ run_testsuite() {
 
     # Erase first the temporary files
     rm -f ./test*.v
+    rm -f ./*tcm.v
     rm -f ./*.log
     rm -f ./*.txt
     rm -f ./*.csv
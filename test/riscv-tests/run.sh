@@ -14,6 +14,24 @@
 cfg_file="config.cfg"
 source ../common/functions.sh
 
+# Directed testsuites, not shipped compiled
+directed="rv32uc rv32umis rv32ua"
+
+
+#------------------------------------------------------------------------------
+# Execute a testsuite with another configuration if its programs have been
+# compiled, forcing to recompile the testbench with the new setup
+#------------------------------------------------------------------------------
+run_config() {
+
+    if [ -n "$(find tests/ -maxdepth 1 -name "$1" -print -quit)" ] ; then
+        rm -f rtl.md5
+        run_testsuite "./tests/$1" "$2"
+    else
+        echo "INFO: No $1 program found, skip $2"
+    fi
+}
+
 
 #------------------------------------------------------------------------------
 # Main
@@ -39,6 +57,13 @@ main() {
             make -C ./tests
             set +e
         fi
+        for suite in $directed; do
+            if [ -z "$(find tests/ -maxdepth 1 -name "$suite-p-*.v" -print -quit)" ] ; then
+                set -e
+                make -C ./tests "$suite"
+                set +e
+            fi
+        done
     fi
 
     # If user specified a testcase, or a testsuite, use it
@@ -52,6 +77,42 @@ main() {
         if [[ -f "./tests/rv32um-p*.v" ]]; then
             run_testsuite "./tests/rv32um-p*.v" "$cfg_file"
         fi
+        # Run again the base ISA with the trap vector and the start of the
+        # tests mapped in the ITCM, the execution crossing the ITCM and the
+        # cached memory. Force to recompile the testbench with the new setup
+        rm -f rtl.md5
+        run_testsuite "./tests/rv32ui-p*.v" "config_itcm.cfg"
+        # Compressed instructions along the branch predictor, the jumps
+        # landing in the upper halfword of the words
+        run_config "rv32u[ic]-p*.v" "config_rvc.cfg"
+        # Misaligned loads and stores served by the hardware
+        run_config "rv32umis-p*.v" "config_misaligned.cfg"
+        # Atomic instructions
+        run_config "rv32ua-p*.v" "config_atomic.cfg"
+        # Cache blocks read and written with INCR bursts over a 32 bits bus,
+        # the write-back evictions being multi-beat writes
+        run_config "rv32ui-p*.v" "config_burst.cfg"
+        # Cache blocks read with WRAP bursts over a 32 bits bus
+        run_config "rv32ui-p*.v" "config_wrap.cfg"
+        # Misses completed early, the fetches on the critical word of the
+        # WRAP bursts, the loads once the block is written
+        run_config "rv32ui-p*.v" "config_early_restart.cfg"
+        # Branch predictor, dual-issue and macro-op fusion in the front-end
+        run_config "rv32u[im]-p*.v" "config_frontend.cfg"
+        # Radix-4 early-terminating divider, queued divisions and pipelined
+        # multiplier
+        run_config "rv32um-p*.v" "config_muldiv.cfg"
+        # Set-associative write-back dCache along the stride prefetcher and
+        # the victim caches
+        run_config "rv32ui-p*.v" "config_dcache.cfg"
+        # Misses served under a miss by the MSHRs, stores forwarded from the
+        # store buffer of the load/store unit
+        run_config "rv32ui-p*.v" "config_mshr.cfg"
+        # Unified L2 cache, only instanced in the platform
+        tb_choice=$TB_CHOICE
+        TB_CHOICE=1
+        run_config "rv32ui-p*.v" "config_l2.cfg"
+        TB_CHOICE=$tb_choice
     fi
 }
 
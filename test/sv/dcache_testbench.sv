@@ -187,6 +187,8 @@ module dcache_testbench();
         .aresetn         (aresetn),
         .srst            (srst),
         .cache_ready     (cache_ready),
+        .clean_blocks    (1'b0),
+        .clean_ack       (),
         .memfy_awvalid   (memfy_awvalid),
         .memfy_awready   (memfy_awready),
         .memfy_awaddr    (memfy_awaddr),
@@ -207,6 +209,7 @@ module dcache_testbench();
         .memfy_arprot    (memfy_arprot),
         .memfy_arcache   (memfy_arcache),
         .memfy_arid      (memfy_arid),
+        .memfy_arpc      ({XLEN{1'b0}}),
         .memfy_rvalid    (memfy_rvalid),
         .memfy_rready    (memfy_rready),
         .memfy_rid       (memfy_rid),
@@ -12,8 +12,10 @@
 ../../rtl/friscv_cache_block_fetcher.sv
 ../../rtl/friscv_cache_prefetcher.sv
 ../../rtl/friscv_cache_blocks.sv
+../../rtl/friscv_cache_victim.sv
 ../../rtl/friscv_cache_memctrl.sv
 ../../rtl/friscv_cache_flusher.sv
 ../../rtl/friscv_cache_pusher.sv
+../../rtl/friscv_cache_evict_buffer.sv
 ../../rtl/friscv_cache_ooo_mgt.sv
 ../../rtl/friscv_axi_or_tracker.sv